@@ -497,12 +497,28 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
         src/MissionManager/VisualMissionItemTest.h \
         src/qgcunittest/ComponentInformationCacheTest.h \
         src/qgcunittest/GeoTest.h \
+        src/qgcunittest/LinkSendSchedulerTest.h \
+        src/qgcunittest/LogReplayLinkTest.h \
+        src/qgcunittest/MAVLinkFrameScannerTest.h \
+        src/qgcunittest/MAVLinkMessagePoolTest.h \
+        src/qgcunittest/MAVLinkRouterTest.h \
+        src/qgcunittest/MAVLinkTimesyncTest.h \
+        src/qgcunittest/MAVLinkTrafficStatsTest.h \
         src/qgcunittest/MavlinkLogTest.h \
+        src/qgcunittest/MockLinkLoadGeneratorTest.h \
         src/qgcunittest/MultiSignalSpy.h \
         src/qgcunittest/MultiSignalSpyV2.h \
+        src/qgcunittest/TelemetryLogWriterTest.h \
+        src/qgcunittest/TlogBuilder.h \
+        src/qgcunittest/TlogColumnarExporterTest.h \
+        src/qgcunittest/TlogIndexTest.h \
+        src/qgcunittest/UDPLinkTest.h \
         src/qgcunittest/UnitTest.h \
         src/Vehicle/FTPManagerTest.h \
         src/Vehicle/InitialConnectTest.h \
+        src/Vehicle/MAVLinkMessageDispatcherTest.h \
+        src/Vehicle/MAVLinkStreamRateControllerTest.h \
+        src/Vehicle/RemoteIDManagerTest.h \
         src/Vehicle/RequestMessageTest.h \
         src/Vehicle/SendMavCommandWithHandlerTest.h \
         src/Vehicle/SendMavCommandWithSignallingTest.h \
@@ -545,13 +561,29 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
         src/MissionManager/VisualMissionItemTest.cc \
         src/qgcunittest/ComponentInformationCacheTest.cc \
         src/qgcunittest/GeoTest.cc \
+        src/qgcunittest/LinkSendSchedulerTest.cc \
+        src/qgcunittest/LogReplayLinkTest.cc \
+        src/qgcunittest/MAVLinkFrameScannerTest.cc \
+        src/qgcunittest/MAVLinkMessagePoolTest.cc \
+        src/qgcunittest/MAVLinkRouterTest.cc \
+        src/qgcunittest/MAVLinkTimesyncTest.cc \
+        src/qgcunittest/MAVLinkTrafficStatsTest.cc \
         src/qgcunittest/MavlinkLogTest.cc \
+        src/qgcunittest/MockLinkLoadGeneratorTest.cc \
         src/qgcunittest/MultiSignalSpy.cc \
         src/qgcunittest/MultiSignalSpyV2.cc \
+        src/qgcunittest/TelemetryLogWriterTest.cc \
+        src/qgcunittest/TlogBuilder.cc \
+        src/qgcunittest/TlogColumnarExporterTest.cc \
+        src/qgcunittest/TlogIndexTest.cc \
+        src/qgcunittest/UDPLinkTest.cc \
         src/qgcunittest/UnitTest.cc \
         src/qgcunittest/UnitTestList.cc \
         src/Vehicle/FTPManagerTest.cc \
         src/Vehicle/InitialConnectTest.cc \
+        src/Vehicle/MAVLinkMessageDispatcherTest.cc \
+        src/Vehicle/MAVLinkStreamRateControllerTest.cc \
+        src/Vehicle/RemoteIDManagerTest.cc \
         src/Vehicle/RequestMessageTest.cc \
         src/Vehicle/SendMavCommandWithHandlerTest.cc \
         src/Vehicle/SendMavCommandWithSignallingTest.cc \
@@ -681,6 +713,7 @@ HEADERS += \
     src/Settings/FirmwareUpgradeSettings.h \
     src/Settings/FlightMapSettings.h \
     src/Settings/FlyViewSettings.h \
+    src/Settings/MAVLinkRouterSettings.h \
     src/Settings/OfflineMapsSettings.h \
     src/Settings/PlanViewSettings.h \
     src/Settings/RTKSettings.h \
@@ -692,6 +725,7 @@ HEADERS += \
     src/SHPFileHelper.h \
     src/Terrain/TerrainQuery.h \
     src/TerrainTile.h \
+    src/TlogColumnarExporter.h \
     src/Vehicle/Actuators/ActuatorActions.h \
     src/Vehicle/Actuators/Actuators.h \
     src/Vehicle/Actuators/ActuatorOutputs.h \
@@ -713,10 +747,16 @@ HEADERS += \
     src/Vehicle/HealthAndArmingCheckReport.h \
     src/Vehicle/ImageProtocolManager.h \
     src/Vehicle/InitialConnectStateMachine.h \
+    src/Vehicle/MAVLinkMessageDispatcher.h \
     src/Vehicle/MAVLinkLogManager.h \
     src/Vehicle/MAVLinkStreamConfig.h \
+    src/Vehicle/MAVLinkStreamRateController.h \
     src/Vehicle/MultiVehicleManager.h \
+    src/Vehicle/RemoteIDAircraft.h \
+    src/Vehicle/RemoteIDFlightRecorder.h \
     src/Vehicle/RemoteIDManager.h \
+    src/Vehicle/RemoteIDObserver.h \
+    src/Vehicle/RemoteIDScheduler.h \
     src/Vehicle/StateMachine.h \
     src/Vehicle/SysStatusSensorInfo.h \
     src/Vehicle/TerrainFactGroup.h \
@@ -742,10 +782,19 @@ HEADERS += \
     src/comm/LinkConfiguration.h \
     src/comm/LinkInterface.h \
     src/comm/LinkManager.h \
+    src/comm/LinkSendScheduler.h \
     src/comm/LogReplayLink.h \
+    src/comm/MAVLinkFrameScanner.h \
+    src/comm/MAVLinkMessagePool.h \
     src/comm/MAVLinkProtocol.h \
+    src/comm/MAVLinkRouter.h \
+    src/comm/MAVLinkTimesync.h \
+    src/comm/MAVLinkTrafficModel.h \
+    src/comm/MAVLinkTrafficStats.h \
     src/comm/QGCMAVLink.h \
     src/comm/TCPLink.h \
+    src/comm/TelemetryLogWriter.h \
+    src/comm/TlogIndex.h \
     src/comm/UDPLink.h \
     src/comm/UdpIODevice.h \
     src/uas/UAS.h \
@@ -768,6 +817,7 @@ DebugBuild {
 HEADERS += \
     src/comm/MockLink.h \
     src/comm/MockLinkFTP.h \
+    src/comm/MockLinkLoadGenerator.h \
     src/comm/MockLinkMissionItemHandler.h \
 }
 
@@ -938,6 +988,7 @@ SOURCES += \
     src/Settings/FirmwareUpgradeSettings.cc \
     src/Settings/FlightMapSettings.cc \
     src/Settings/FlyViewSettings.cc \
+    src/Settings/MAVLinkRouterSettings.cc \
     src/Settings/OfflineMapsSettings.cc \
     src/Settings/PlanViewSettings.cc \
     src/Settings/RTKSettings.cc \
@@ -949,6 +1000,7 @@ SOURCES += \
     src/SHPFileHelper.cc \
     src/Terrain/TerrainQuery.cc \
     src/TerrainTile.cc\
+    src/TlogColumnarExporter.cc \
     src/Vehicle/Actuators/ActuatorActions.cc \
     src/Vehicle/Actuators/Actuators.cc \
     src/Vehicle/Actuators/ActuatorOutputs.cc \
@@ -970,10 +1022,16 @@ SOURCES += \
     src/Vehicle/HealthAndArmingCheckReport.cc \
     src/Vehicle/ImageProtocolManager.cc \
     src/Vehicle/InitialConnectStateMachine.cc \
+    src/Vehicle/MAVLinkMessageDispatcher.cc \
     src/Vehicle/MAVLinkLogManager.cc \
     src/Vehicle/MAVLinkStreamConfig.cc \
+    src/Vehicle/MAVLinkStreamRateController.cc \
     src/Vehicle/MultiVehicleManager.cc \
+    src/Vehicle/RemoteIDAircraft.cc \
+    src/Vehicle/RemoteIDFlightRecorder.cc \
     src/Vehicle/RemoteIDManager.cc \
+    src/Vehicle/RemoteIDObserver.cc \
+    src/Vehicle/RemoteIDScheduler.cc \
     src/Vehicle/StateMachine.cc \
     src/Vehicle/SysStatusSensorInfo.cc \
     src/Vehicle/TerrainFactGroup.cc \
@@ -999,10 +1057,19 @@ SOURCES += \
     src/comm/LinkConfiguration.cc \
     src/comm/LinkInterface.cc \
     src/comm/LinkManager.cc \
+    src/comm/LinkSendScheduler.cc \
     src/comm/LogReplayLink.cc \
+    src/comm/MAVLinkFrameScanner.cc \
+    src/comm/MAVLinkMessagePool.cc \
     src/comm/MAVLinkProtocol.cc \
+    src/comm/MAVLinkRouter.cc \
+    src/comm/MAVLinkTimesync.cc \
+    src/comm/MAVLinkTrafficModel.cc \
+    src/comm/MAVLinkTrafficStats.cc \
     src/comm/QGCMAVLink.cc \
     src/comm/TCPLink.cc \
+    src/comm/TelemetryLogWriter.cc \
+    src/comm/TlogIndex.cc \
     src/comm/UDPLink.cc \
     src/comm/UdpIODevice.cc \
     src/main.cc \
@@ -1020,6 +1087,7 @@ DebugBuild {
 SOURCES += \
     src/comm/MockLink.cc \
     src/comm/MockLinkFTP.cc \
+    src/comm/MockLinkLoadGenerator.cc \
     src/comm/MockLinkMissionItemHandler.cc \
 }
 
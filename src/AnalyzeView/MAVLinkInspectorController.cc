@@ -150,7 +150,7 @@ QGCMAVLinkMessageField::updateSeries()
 }
 
 //-----------------------------------------------------------------------------
-QGCMAVLinkMessage::QGCMAVLinkMessage(QObject *parent, mavlink_message_t* message)
+QGCMAVLinkMessage::QGCMAVLinkMessage(QObject *parent, const mavlink_message_t* message)
     : QObject(parent)
 {
     _message = *message;
@@ -228,7 +228,7 @@ void QGCMAVLinkMessage::setSelected(bool sel)
 
 //-----------------------------------------------------------------------------
 void
-QGCMAVLinkMessage::update(mavlink_message_t* message)
+QGCMAVLinkMessage::update(const mavlink_message_t* message)
 {
     _count++;
     _message = *message;
@@ -729,8 +729,7 @@ MAVLinkInspectorController::MAVLinkInspectorController()
     MultiVehicleManager* multiVehicleManager = qgcApp()->toolbox()->multiVehicleManager();
     connect(multiVehicleManager, &MultiVehicleManager::vehicleAdded,   this, &MAVLinkInspectorController::_vehicleAdded);
     connect(multiVehicleManager, &MultiVehicleManager::vehicleRemoved, this, &MAVLinkInspectorController::_vehicleRemoved);
-    MAVLinkProtocol* mavlinkProtocol = qgcApp()->toolbox()->mavlinkProtocol();
-    connect(mavlinkProtocol, &MAVLinkProtocol::messageReceived, this, &MAVLinkInspectorController::_receiveMessage);
+    connect(multiVehicleManager, &MultiVehicleManager::messageTap,     this, &MAVLinkInspectorController::_receiveMessage);
     connect(&_updateFrequencyTimer, &QTimer::timeout, this, &MAVLinkInspectorController::_refreshFrequency);
     _updateFrequencyTimer.start(1000);
     MultiVehicleManager *manager = qgcApp()->toolbox()->multiVehicleManager();
@@ -864,8 +863,9 @@ MAVLinkInspectorController::_vehicleRemoved(Vehicle* vehicle)
 
 //-----------------------------------------------------------------------------
 void
-MAVLinkInspectorController::_receiveMessage(LinkInterface*, mavlink_message_t message)
+MAVLinkInspectorController::_receiveMessage(LinkInterface*, const MAVLinkMessageRef& messageRef)
 {
+    const mavlink_message_t& message = *messageRef;
     QGCMAVLinkMessage* m = nullptr;
     QGCMAVLinkSystem* v = _findVehicle(message.sysid);
     if(!v) {
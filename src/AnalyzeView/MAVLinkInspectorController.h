@@ -99,7 +99,7 @@ public:
     Q_PROPERTY(bool                 fieldSelected   READ fieldSelected  NOTIFY fieldSelectedChanged)
     Q_PROPERTY(bool                 selected        READ selected       NOTIFY selectedChanged)
 
-    QGCMAVLinkMessage   (QObject* parent, mavlink_message_t* message);
+    QGCMAVLinkMessage   (QObject* parent, const mavlink_message_t* message);
     ~QGCMAVLinkMessage  ();
 
     quint32             id              () const{ return _message.msgid;  }
@@ -113,7 +113,7 @@ public:
     bool                selected        () const{ return _selected; }
 
     void                updateFieldSelection();
-    void                update          (mavlink_message_t* message);
+    void                update          (const mavlink_message_t* message);
     void                updateFreq      ();
     void                setSelected     (bool sel);
 
@@ -290,7 +290,7 @@ signals:
     void rangeListChanged   ();
 
 private slots:
-    void _receiveMessage    (LinkInterface* link, mavlink_message_t message);
+    void _receiveMessage    (LinkInterface* link, const MAVLinkMessageRef& messageRef);
     void _vehicleAdded      (Vehicle* vehicle);
     void _vehicleRemoved    (Vehicle* vehicle);
     void _setActiveVehicle  (Vehicle* vehicle);
@@ -14,6 +14,7 @@
 #include "QGCApplication.h"
 #include "APMAutoPilotPlugin.h"
 #include "ParameterManager.h"
+#include "MultiVehicleManager.h"
 
 #include <QVariant>
 #include <QQmlProperty>
@@ -109,7 +110,7 @@ void APMSensorsComponentController::_startLogCalibration(void)
     }
     _cancelButton->setEnabled(_calTypeInProgress == CalTypeOnboardCompass);
 
-    connect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, &APMSensorsComponentController::_mavlinkMessageReceived);
+    connect(qgcApp()->toolbox()->multiVehicleManager(), &MultiVehicleManager::messageTap, this, &APMSensorsComponentController::_mavlinkMessageReceived);
 }
 
 void APMSensorsComponentController::_startVisualCalibration(void)
@@ -122,7 +123,7 @@ void APMSensorsComponentController::_startVisualCalibration(void)
     
     _progressBar->setProperty("value", 0);
 
-    connect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, &APMSensorsComponentController::_mavlinkMessageReceived);
+    connect(qgcApp()->toolbox()->multiVehicleManager(), &MultiVehicleManager::messageTap, this, &APMSensorsComponentController::_mavlinkMessageReceived);
 }
 
 void APMSensorsComponentController::_resetInternalState(void)
@@ -153,7 +154,7 @@ void APMSensorsComponentController::_resetInternalState(void)
 
 void APMSensorsComponentController::_stopCalibration(APMSensorsComponentController::StopCalibrationCode code)
 {
-    disconnect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, &APMSensorsComponentController::_mavlinkMessageReceived);
+    disconnect(qgcApp()->toolbox()->multiVehicleManager(), &MultiVehicleManager::messageTap, this, &APMSensorsComponentController::_mavlinkMessageReceived);
     _vehicle->vehicleLinkManager()->setCommunicationLostEnabled(true);
 
     disconnect(_vehicle, &Vehicle::textMessageReceived, this, &APMSensorsComponentController::_handleUASTextMessage);
@@ -516,7 +517,7 @@ bool APMSensorsComponentController::usingUDPLink(void)
     }
 }
 
-void APMSensorsComponentController::_handleCommandAck(mavlink_message_t& message)
+void APMSensorsComponentController::_handleCommandAck(const mavlink_message_t& message)
 {
     if (_calTypeInProgress == CalTypeLevelHorizon || _calTypeInProgress == CalTypeGyro || _calTypeInProgress == CalTypePressure || _calTypeInProgress == CalTypeAccelFast) {
         mavlink_command_ack_t commandAck;
@@ -537,7 +538,7 @@ void APMSensorsComponentController::_handleCommandAck(mavlink_message_t& message
     }
 }
 
-void APMSensorsComponentController::_handleMagCalProgress(mavlink_message_t& message)
+void APMSensorsComponentController::_handleMagCalProgress(const mavlink_message_t& message)
 {
     if (_calTypeInProgress == CalTypeOnboardCompass) {
         mavlink_mag_cal_progress_t magCalProgress;
@@ -565,7 +566,7 @@ void APMSensorsComponentController::_handleMagCalProgress(mavlink_message_t& mes
     }
 }
 
-void APMSensorsComponentController::_handleMagCalReport(mavlink_message_t& message)
+void APMSensorsComponentController::_handleMagCalReport(const mavlink_message_t& message)
 {
     if (_calTypeInProgress == CalTypeOnboardCompass) {
         mavlink_mag_cal_report_t magCalReport;
@@ -613,7 +614,7 @@ void APMSensorsComponentController::_handleMagCalReport(mavlink_message_t& messa
     }
 }
 
-void APMSensorsComponentController::_handleCommandLong(mavlink_message_t& message)
+void APMSensorsComponentController::_handleCommandLong(const mavlink_message_t& message)
 {
     bool                    updateImages = false;
     mavlink_command_long_t  commandLong;
@@ -693,10 +694,12 @@ void APMSensorsComponentController::_handleCommandLong(mavlink_message_t& messag
     }
 }
 
-void APMSensorsComponentController::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message)
+void APMSensorsComponentController::_mavlinkMessageReceived(LinkInterface* link, const MAVLinkMessageRef& messageRef)
 {
     Q_UNUSED(link);
 
+    const mavlink_message_t& message = *messageRef;
+
     if (message.sysid != _vehicle->id()) {
         return;
     }
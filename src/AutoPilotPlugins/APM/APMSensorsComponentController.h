@@ -16,6 +16,7 @@
 #include "QGCLoggingCategory.h"
 #include "APMSensorsComponent.h"
 #include "APMCompassCal.h"
+#include "MAVLinkMessagePool.h"
 
 Q_DECLARE_LOGGING_CATEGORY(APMSensorsComponentControllerLog)
 Q_DECLARE_LOGGING_CATEGORY(APMSensorsComponentControllerVerboseLog)
@@ -135,7 +136,7 @@ signals:
 
 private slots:
     void _handleUASTextMessage  (int uasId, int compId, int severity, QString text);
-    void _mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message);
+    void _mavlinkMessageReceived(LinkInterface* link, const MAVLinkMessageRef& messageRef);
     void _mavCommandResult      (int vehicleId, int component, int command, int result, bool noReponseFromVehicle);
 
 private:
@@ -145,10 +146,10 @@ private:
     void _refreshParams                     (void);
     void _hideAllCalAreas                   (void);
     void _resetInternalState                (void);
-    void _handleCommandAck                  (mavlink_message_t& message);
-    void _handleMagCalProgress              (mavlink_message_t& message);
-    void _handleMagCalReport                (mavlink_message_t& message);
-    void _handleCommandLong                 (mavlink_message_t& message);
+    void _handleCommandAck                  (const mavlink_message_t& message);
+    void _handleMagCalProgress              (const mavlink_message_t& message);
+    void _handleMagCalReport                (const mavlink_message_t& message);
+    void _handleCommandLong                 (const mavlink_message_t& message);
     void _restorePreviousCompassCalFitness  (void);
 
     enum StopCalibrationCode {
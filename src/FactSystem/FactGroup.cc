@@ -10,6 +10,7 @@
 
 #include "FactGroup.h"
 #include "JsonHelper.h"
+#include "MAVLinkMessageDispatcher.h"
 
 #include <QJsonDocument>
 #include <QJsonParseError>
@@ -185,6 +186,11 @@ void FactGroup::handleMessage(Vehicle* /* vehicle */, mavlink_message_t& /* mess
     // Default implementation does nothing
 }
 
+QList<uint32_t> FactGroup::handledMessageIds(void) const
+{
+    return { MAVLinkMessageDispatcher::allMessageIds };
+}
+
 void FactGroup::_setTelemetryAvailable (bool telemetryAvailable)
 {
     if (telemetryAvailable != _telemetryAvailable) {
@@ -54,6 +54,10 @@ public:
     /// Allows a FactGroup to parse incoming messages and fill in values
     virtual void handleMessage(Vehicle* vehicle, mavlink_message_t& message);
 
+    /// Message ids which handleMessage is interested in, Vehicle only passes these to the group. An empty list means the
+    /// group doesn't use messages at all. The default is every message.
+    virtual QList<uint32_t> handledMessageIds(void) const;
+
 signals:
     void factNamesChanged           (void);
     void factGroupNamesChanged      (void);
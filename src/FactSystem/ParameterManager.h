@@ -54,7 +54,7 @@ public:
     /// @return Location of parameter cache file
     static QString parameterCacheFile(int vehicleId, int componentId);
 
-    void mavlinkMessageReceived(mavlink_message_t message);
+    void mavlinkMessageReceived(const mavlink_message_t& message);
 
     QList<int> componentIds(void);
 
@@ -347,6 +347,24 @@ bool APMFirmwarePlugin::adjustIncomingMavlinkMessage(Vehicle* vehicle, mavlink_m
     return true;
 }
 
+bool APMFirmwarePlugin::adjustsIncomingMavlinkMessage(Vehicle* vehicle, const mavlink_message_t& message)
+{
+    // Must match the messages adjustIncomingMavlinkMessage translates
+    if (!_ardupilotComponentMap.value(vehicle->id()).value(message.compid, false)) {
+        return false;
+    }
+
+    switch (message.msgid) {
+    case MAVLINK_MSG_ID_PARAM_VALUE:
+    case MAVLINK_MSG_ID_STATUSTEXT:
+    case MAVLINK_MSG_ID_RC_CHANNELS:
+    case MAVLINK_MSG_ID_RC_CHANNELS_RAW:
+        return true;
+    default:
+        return false;
+    }
+}
+
 void APMFirmwarePlugin::adjustOutgoingMavlinkMessageThreadSafe(Vehicle* vehicle, LinkInterface* outgoingLink, mavlink_message_t* message)
 {
     switch (message->msgid) {
@@ -162,6 +162,12 @@ bool FirmwarePlugin::adjustIncomingMavlinkMessage(Vehicle* vehicle, mavlink_mess
     return true;
 }
 
+bool FirmwarePlugin::adjustsIncomingMavlinkMessage(Vehicle* /*vehicle*/, const mavlink_message_t& /*message*/)
+{
+    // Generic plugin does no message adjustment
+    return false;
+}
+
 void FirmwarePlugin::adjustOutgoingMavlinkMessageThreadSafe(Vehicle* /*vehicle*/, LinkInterface* /*outgoingLink*/, mavlink_message_t* /*message*/)
 {
     // Generic plugin does no message adjustment
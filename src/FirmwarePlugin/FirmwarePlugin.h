@@ -217,6 +217,13 @@ public:
     /// @return false: skip message, true: process message
     virtual bool adjustIncomingMavlinkMessage(Vehicle* vehicle, mavlink_message_t* message);
 
+    /// Received messages are shared between everything which looks at them. A plugin which changes the contents of
+    /// a message in adjustIncomingMavlinkMessage must say so here, the vehicle then hands it a private copy.
+    ///     @param vehicle Vehicle message came from
+    ///     @param message Mavlink message about to be passed to adjustIncomingMavlinkMessage
+    /// @return true: adjustIncomingMavlinkMessage may change the message
+    virtual bool adjustsIncomingMavlinkMessage(Vehicle* vehicle, const mavlink_message_t& message);
+
     /// Called before any mavlink message is sent to the Vehicle so plugin can adjust any message characteristics.
     /// This is handy to adjust or differences in mavlink spec implementations such that the base code can remain
     /// mavlink generic.
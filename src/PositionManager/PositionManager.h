@@ -20,6 +20,8 @@
 class QGCPositionManager : public QGCTool {
     Q_OBJECT
 
+    friend class RemoteIDManagerTest;   // Unit test
+
 public:
     static constexpr size_t MinHorizonalAccuracyMeters = 100;
     QGCPositionManager(QGCApplication* app, QGCToolbox* toolbox);
@@ -69,13 +69,41 @@ Rectangle {
                 ListElement { text: "1x";   value: 1 }
                 ListElement { text: "2x";   value: 2 }
                 ListElement { text: "5x";   value: 5 }
+                ListElement { text: "Max";  value: 0 }
             }
 
-            onActivated: controller.playbackSpeed = model.get(currentIndex).value
+            // Max replays unthrottled, as fast as the log can be processed
+            onActivated: {
+                var value = model.get(currentIndex).value
+                controller.unthrottled = value === 0
+                if (value !== 0) {
+                    controller.playbackSpeed = value
+                }
+            }
         }
 
         QGCLabel { text: controller.playheadTime }
 
+        // Seconds from the start of the log, playback pauses when it gets there
+        QGCTextField {
+            placeholderText:    qsTr("Pause at (secs)")
+            text:               controller.pauseAtSecs ? controller.pauseAtSecs : ""
+            validator:          IntValidator { bottom: 0 }
+            onEditingFinished:  controller.pauseAtSecs = text === "" ? 0 : parseInt(text)
+        }
+
+        // Comma separated message names, only those messages are replayed
+        QGCTextField {
+            placeholderText:    qsTr("All messages")
+            text:               controller.messageFilter
+            onEditingFinished:  controller.messageFilter = text
+        }
+
+        QGCLabel {
+            text:       qsTr("%1 msg/s").arg(controller.messagesPerSecond.toFixed(0))
+            visible:    controller.unthrottled
+        }
+
         Slider {
             id:                 slider
             Layout.fillWidth:   true
@@ -173,6 +173,16 @@ void QGroundControlQmlGlobal::startAPMArduRoverMockLink(bool sendStatusText)
 #endif
 }
 
+void QGroundControlQmlGlobal::startLoadMockLinks(int vehicleCount, int linkCount)
+{
+#ifdef QT_DEBUG
+    MockLink::startLoadMockLinks(vehicleCount, linkCount);
+#else
+    Q_UNUSED(vehicleCount);
+    Q_UNUSED(linkCount);
+#endif
+}
+
 void QGroundControlQmlGlobal::stopOneMockLink(void)
 {
 #ifdef QT_DEBUG
@@ -0,0 +1,25 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkRouterSettings.h"
+
+#include <QQmlEngine>
+#include <QtQml>
+
+DECLARE_SETTINGGROUP(MAVLinkRouter, "MAVLinkRouter")
+{
+    qmlRegisterUncreatableType<MAVLinkRouterSettings>("QGroundControl.SettingsManager", 1, 0, "MAVLinkRouterSettings", "Reference only");
+}
+
+DECLARE_SETTINGSFACT(MAVLinkRouterSettings, outputs)
+DECLARE_SETTINGSFACT(MAVLinkRouterSettings, allowedSysids)
+DECLARE_SETTINGSFACT(MAVLinkRouterSettings, deniedSysids)
+DECLARE_SETTINGSFACT(MAVLinkRouterSettings, allowedMsgids)
+DECLARE_SETTINGSFACT(MAVLinkRouterSettings, deniedMsgids)
+DECLARE_SETTINGSFACT(MAVLinkRouterSettings, maxRateHz)
@@ -0,0 +1,29 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "SettingsGroup.h"
+
+/// Outputs and forwarding rules of the MAVLinkRouter. The rules apply to the mavlink forwarding link as well as to
+/// the outputs listed here.
+class MAVLinkRouterSettings : public SettingsGroup
+{
+    Q_OBJECT
+public:
+    MAVLinkRouterSettings(QObject* parent = nullptr);
+    DEFINE_SETTING_NAME_GROUP()
+
+    DEFINE_SETTINGFACT(outputs)
+    DEFINE_SETTINGFACT(allowedSysids)
+    DEFINE_SETTINGFACT(deniedSysids)
+    DEFINE_SETTINGFACT(allowedMsgids)
+    DEFINE_SETTINGFACT(deniedMsgids)
+    DEFINE_SETTINGFACT(maxRateHz)
+};
@@ -36,4 +36,10 @@ DECLARE_SETTINGSFACT(RemoteIDSettings,  longitudeFixed)
 DECLARE_SETTINGSFACT(RemoteIDSettings,  altitudeFixed)
 DECLARE_SETTINGSFACT(RemoteIDSettings,  classificationType)
 DECLARE_SETTINGSFACT(RemoteIDSettings,  categoryEU)
-DECLARE_SETTINGSFACT(RemoteIDSettings,  classEU)
\ No newline at end of file
+DECLARE_SETTINGSFACT(RemoteIDSettings,  classEU)
+DECLARE_SETTINGSFACT(RemoteIDSettings,  sendMessagePack)
+DECLARE_SETTINGSFACT(RemoteIDSettings,  systemMinInterval)
+DECLARE_SETTINGSFACT(RemoteIDSettings,  systemMaxInterval)
+DECLARE_SETTINGSFACT(RemoteIDSettings,  systemMovementThreshold)
+DECLARE_SETTINGSFACT(RemoteIDSettings,  observerMode)
+DECLARE_SETTINGSFACT(RemoteIDSettings,  flightRecorder)
\ No newline at end of file
@@ -38,4 +38,10 @@ public:
     DEFINE_SETTINGFACT(classificationType)
     DEFINE_SETTINGFACT(categoryEU)
     DEFINE_SETTINGFACT(classEU)
+    DEFINE_SETTINGFACT(sendMessagePack)
+    DEFINE_SETTINGFACT(systemMinInterval)
+    DEFINE_SETTINGFACT(systemMaxInterval)
+    DEFINE_SETTINGFACT(systemMovementThreshold)
+    DEFINE_SETTINGFACT(observerMode)
+    DEFINE_SETTINGFACT(flightRecorder)
 };
\ No newline at end of file
@@ -0,0 +1,443 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogColumnarExporter.h"
+#include "MAVLinkFrameScanner.h"
+#include "TlogIndex.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QtEndian>
+
+#include <cmath>
+#include <limits>
+#include <string.h>
+
+QGC_LOGGING_CATEGORY(TlogColumnarExporterLog, "TlogColumnarExporterLog")
+
+const char* TlogColumnarExporter::schemaFileName        = "schema.json";
+const char* TlogColumnarExporter::columnFileExtension   = "bin";
+
+TlogColumnarExporter::TlogColumnarExporter(void)
+{
+
+}
+
+void TlogColumnarExporter::setFieldProjection(const QStringList& projection)
+{
+    _projection.clear();
+    for (const QString& entry : projection) {
+        if (!entry.trimmed().isEmpty()) {
+            _projection.insert(entry.trimmed());
+        }
+    }
+}
+
+bool TlogColumnarExporter::exportLog(const QString& tlogFile, const QString& outputDir, QString& errorString)
+{
+    QElapsedTimer   timer;
+    QFile           file(tlogFile);
+
+    timer.start();
+    _exportedRowCount = 0;
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorString = QObject::tr("Unable to open %1: %2").arg(tlogFile, file.errorString());
+        return false;
+    }
+    const quint64   size = static_cast<quint64>(file.size());
+    const uint8_t*  data = size ? file.map(0, static_cast<qint64>(size)) : nullptr;
+    if (!data) {
+        errorString = QObject::tr("Unable to map %1: %2").arg(tlogFile, file.errorString());
+        return false;
+    }
+
+    if (!QDir().mkpath(outputDir)) {
+        errorString = QObject::tr("Unable to create %1").arg(outputDir);
+        return false;
+    }
+
+    // Chunks are decoded a window at a time, one chunk per pool thread, and each window is written out in chunk order
+    // before the next one is decoded. Columns stay in log order and only a window of decoded chunks is ever in memory.
+    const int   windowSize  = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    int         chunkCount  = 0;
+    bool        success     = true;
+
+    _messageOrder.clear();
+    _messageOutputs.clear();
+
+    for (quint64 windowStart=0; windowStart<size && success; ) {
+        QList<Chunk_t> chunks;
+        while (chunks.count() < windowSize && windowStart < size) {
+            chunks.append(Chunk_t{ windowStart, qMin(windowStart + static_cast<quint64>(_chunkSize), size) });
+            windowStart += static_cast<quint64>(_chunkSize);
+        }
+        chunkCount += chunks.count();
+
+        const QList<ChunkResult_t> results = QtConcurrent::blockingMapped<QList<ChunkResult_t>>(chunks, [this, data, size](const Chunk_t& chunk) {
+            return _decodeChunk(data, size, chunk);
+        });
+
+        for (const ChunkResult_t& result : results) {
+            for (int i=0; success && i<result.messageIds.count(); i++) {
+                success = _writeRowGroup(outputDir, result.messageIds[i], *result.messages.constFind(result.messageIds[i]), errorString);
+            }
+        }
+    }
+
+    if (success) {
+        success = _writeSchema(outputDir, errorString);
+    }
+    for (const MessageOutput_t& messageOutput : _messageOutputs) {
+        qDeleteAll(messageOutput.columnFiles);
+    }
+    _messageOutputs.clear();
+    if (!success) {
+        return false;
+    }
+
+    qCDebug(TlogColumnarExporterLog) << "Exported" << tlogFile << "rows" << _exportedRowCount << "chunks" << chunkCount << "msecs" << timer.elapsed();
+    return true;
+}
+
+/// Decodes every frame which starts inside the chunk. The scan runs a frame length past the end of the chunk so a frame
+/// straddling the boundary is seen whole, the next chunk skips it since it does not start there.
+TlogColumnarExporter::ChunkResult_t TlogColumnarExporter::_decodeChunk(const uint8_t* data, quint64 size, const Chunk_t& chunk) const
+{
+    ChunkResult_t       result;
+    QSet<uint32_t>      skippedMessageIds;
+    MAVLinkFrameScanner scanner;
+    const quint64       scanEnd = qMin(chunk.end + MAVLINK_MAX_PACKET_LEN, size);
+
+    scanner.scan(data + chunk.start, static_cast<int>(scanEnd - chunk.start), [&](const MAVLinkFrameScanner::Frame_t& frame) {
+        const quint64 offset = static_cast<quint64>(frame.data - data);
+        if (offset >= chunk.end || offset < sizeof(quint64)) {
+            return;
+        }
+
+        mavlink_message_t message;
+        MAVLinkFrameScanner::decode(frame, message);
+        if (skippedMessageIds.contains(message.msgid)) {
+            return;
+        }
+
+        auto chunkMessage = result.messages.find(message.msgid);
+        if (chunkMessage == result.messages.end()) {
+            ChunkMessage_t newChunkMessage;
+            if (!_initChunkMessage(message, newChunkMessage)) {
+                skippedMessageIds.insert(message.msgid);
+                return;
+            }
+            chunkMessage = result.messages.insert(message.msgid, newChunkMessage);
+            result.messageIds.append(message.msgid);
+        }
+
+        _appendRow(message, TlogIndex::frameTimestamp(data, offset), chunkMessage.value());
+    });
+
+    return result;
+}
+
+/// Sets up the columns for a message id, applying the field projection
+/// @return false: message is unknown or projected out
+bool TlogColumnarExporter::_initChunkMessage(const mavlink_message_t& message, ChunkMessage_t& chunkMessage) const
+{
+    const mavlink_message_info_t* messageInfo = mavlink_get_message_info(&message);
+    if (!messageInfo) {
+        return false;
+    }
+
+    const QString   messageName = QString::fromLatin1(messageInfo->name);
+    const bool      allFields   = _projection.isEmpty() || _projection.contains(messageName);
+
+    for (unsigned int i=0; i<messageInfo->num_fields; i++) {
+        const mavlink_field_info_t& fieldInfo = messageInfo->fields[i];
+        const QString               fieldName = QString::fromLatin1(fieldInfo.name);
+
+        if (!allFields && !_projection.contains(QStringLiteral("%1.%2").arg(messageName, fieldName))) {
+            continue;
+        }
+
+        Column_t column;
+        column.name         = fieldName;
+        column.type         = fieldInfo.type;
+        column.arrayLength  = static_cast<int>(fieldInfo.array_length);
+        column.wireOffset   = static_cast<int>(fieldInfo.wire_offset);
+        column.valueSize    = _mavlinkTypeSize(fieldInfo.type) * qMax(1, column.arrayLength);
+        chunkMessage.columns.append(column);
+    }
+    if (chunkMessage.columns.isEmpty()) {
+        return false;
+    }
+
+    const int columnCount = _fixedColumnCount + chunkMessage.columns.count();
+    chunkMessage.messageName    = messageName;
+    chunkMessage.rowCount       = 0;
+    chunkMessage.columnData.resize(columnCount);
+    chunkMessage.minimums.fill(std::numeric_limits<double>::quiet_NaN(), columnCount);
+    chunkMessage.maximums.fill(std::numeric_limits<double>::quiet_NaN(), columnCount);
+
+    return true;
+}
+
+void TlogColumnarExporter::_appendRow(const mavlink_message_t& message, quint64 timestampUSecs, ChunkMessage_t& chunkMessage) const
+{
+    const uint8_t* payload = reinterpret_cast<const uint8_t*>(_MAV_PAYLOAD(&message));
+
+    // Payload bytes are already little endian on the wire, so every column apart from the timestamp is a straight copy
+    uint8_t timestamp[sizeof(quint64)];
+    qToLittleEndian<quint64>(timestampUSecs, timestamp);
+    chunkMessage.columnData[0].append(reinterpret_cast<const char*>(timestamp), sizeof(timestamp));
+    chunkMessage.columnData[1].append(static_cast<char>(message.sysid));
+    chunkMessage.columnData[2].append(static_cast<char>(message.compid));
+
+    const double timestampValue = static_cast<double>(timestampUSecs);
+    if (chunkMessage.rowCount == 0) {
+        chunkMessage.minimums[0] = chunkMessage.maximums[0] = timestampValue;
+    } else {
+        chunkMessage.minimums[0] = qMin(chunkMessage.minimums[0], timestampValue);
+        chunkMessage.maximums[0] = qMax(chunkMessage.maximums[0], timestampValue);
+    }
+
+    for (int i=0; i<chunkMessage.columns.count(); i++) {
+        const Column_t& column      = chunkMessage.columns[i];
+        const int       dataIndex   = _fixedColumnCount + i;
+
+        chunkMessage.columnData[dataIndex].append(reinterpret_cast<const char*>(payload + column.wireOffset), column.valueSize);
+
+        if (_isStatsColumn(column)) {
+            const double value = _columnValue(column, payload + column.wireOffset);
+            if (chunkMessage.rowCount == 0 || std::isnan(chunkMessage.minimums[dataIndex])) {
+                chunkMessage.minimums[dataIndex] = chunkMessage.maximums[dataIndex] = value;
+            } else if (!std::isnan(value)) {
+                chunkMessage.minimums[dataIndex] = qMin(chunkMessage.minimums[dataIndex], value);
+                chunkMessage.maximums[dataIndex] = qMax(chunkMessage.maximums[dataIndex], value);
+            }
+        }
+    }
+
+    chunkMessage.rowCount++;
+}
+
+/// Creates the column files of a message the first time it shows up in the log
+bool TlogColumnarExporter::_openMessageOutput(const QString& outputDir, uint32_t messageId, const ChunkMessage_t& chunkMessage, QString& errorString)
+{
+    MessageOutput_t& messageOutput = _messageOutputs[messageId];
+
+    _messageOrder.append(messageId);
+    messageOutput.messageName   = chunkMessage.messageName;
+    messageOutput.rowCount      = 0;
+
+    messageOutput.columnNames = QStringList({ QStringLiteral("timestamp_usec"), QStringLiteral("sysid"), QStringLiteral("compid") });
+    QStringList columnTypes = { _typeName(MAVLINK_TYPE_UINT64_T), _typeName(MAVLINK_TYPE_UINT8_T), _typeName(MAVLINK_TYPE_UINT8_T) };
+    for (const Column_t& column : chunkMessage.columns) {
+        messageOutput.columnNames.append(column.name);
+        columnTypes.append(_typeName(column.type));
+    }
+    for (int i=0; i<messageOutput.columnNames.count(); i++) {
+        QJsonObject jsonColumn;
+        jsonColumn[QStringLiteral("name")]          = messageOutput.columnNames[i];
+        jsonColumn[QStringLiteral("type")]          = columnTypes[i];
+        jsonColumn[QStringLiteral("arrayLength")]   = i < _fixedColumnCount ? 0 : chunkMessage.columns[i - _fixedColumnCount].arrayLength;
+        jsonColumn[QStringLiteral("file")]          = QStringLiteral("%1/%2.%3").arg(chunkMessage.messageName, messageOutput.columnNames[i], columnFileExtension);
+        messageOutput.jsonColumns.append(jsonColumn);
+    }
+
+    const QString messageDir = QDir(outputDir).absoluteFilePath(chunkMessage.messageName);
+    if (!QDir().mkpath(messageDir)) {
+        errorString = QObject::tr("Unable to create %1").arg(messageDir);
+        return false;
+    }
+
+    for (const QString& columnName : messageOutput.columnNames) {
+        QFile* columnFile = new QFile(QDir(messageDir).absoluteFilePath(QStringLiteral("%1.%2").arg(columnName, columnFileExtension)));
+        messageOutput.columnFiles.append(columnFile);
+        if (!columnFile->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            errorString = QObject::tr("Unable to create %1: %2").arg(columnFile->fileName(), columnFile->errorString());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/// Appends the rows of one chunk to the column files of the message as a new row group
+bool TlogColumnarExporter::_writeRowGroup(const QString& outputDir, uint32_t messageId, const ChunkMessage_t& chunkMessage, QString& errorString)
+{
+    if (!_messageOutputs.contains(messageId) && !_openMessageOutput(outputDir, messageId, chunkMessage, errorString)) {
+        return false;
+    }
+    MessageOutput_t& messageOutput = _messageOutputs[messageId];
+
+    QJsonObject jsonStats;
+    for (int i=0; i<messageOutput.columnFiles.count(); i++) {
+        QFile* columnFile = messageOutput.columnFiles[i];
+        if (columnFile->write(chunkMessage.columnData[i]) != chunkMessage.columnData[i].size()) {
+            errorString = QObject::tr("Unable to write %1: %2").arg(columnFile->fileName(), columnFile->errorString());
+            return false;
+        }
+        if (!std::isnan(chunkMessage.minimums[i])) {
+            QJsonObject jsonMinMax;
+            jsonMinMax[QStringLiteral("min")] = chunkMessage.minimums[i];
+            jsonMinMax[QStringLiteral("max")] = chunkMessage.maximums[i];
+            jsonStats[messageOutput.columnNames[i]] = jsonMinMax;
+        }
+    }
+
+    QJsonObject jsonRowGroup;
+    jsonRowGroup[QStringLiteral("firstRow")]    = static_cast<qint64>(messageOutput.rowCount);
+    jsonRowGroup[QStringLiteral("rowCount")]    = static_cast<qint64>(chunkMessage.rowCount);
+    jsonRowGroup[QStringLiteral("stats")]       = jsonStats;
+    messageOutput.jsonRowGroups.append(jsonRowGroup);
+
+    messageOutput.rowCount  += chunkMessage.rowCount;
+    _exportedRowCount       += chunkMessage.rowCount;
+
+    return true;
+}
+
+bool TlogColumnarExporter::_writeSchema(const QString& outputDir, QString& errorString)
+{
+    // Messages in the order they first show up in the log
+    QJsonArray jsonMessages;
+    for (uint32_t messageId : _messageOrder) {
+        const MessageOutput_t& messageOutput = _messageOutputs[messageId];
+
+        QJsonObject jsonMessage;
+        jsonMessage[QStringLiteral("name")]         = messageOutput.messageName;
+        jsonMessage[QStringLiteral("messageId")]    = static_cast<qint64>(messageId);
+        jsonMessage[QStringLiteral("rowCount")]     = static_cast<qint64>(messageOutput.rowCount);
+        jsonMessage[QStringLiteral("columns")]      = messageOutput.jsonColumns;
+        jsonMessage[QStringLiteral("rowGroups")]    = messageOutput.jsonRowGroups;
+        jsonMessages.append(jsonMessage);
+    }
+
+    QJsonObject jsonRoot;
+    jsonRoot[QStringLiteral("version")]     = 1;
+    jsonRoot[QStringLiteral("byteOrder")]   = QStringLiteral("little");
+    jsonRoot[QStringLiteral("messages")]    = jsonMessages;
+
+    QFile schemaFile(QDir(outputDir).absoluteFilePath(schemaFileName));
+    if (!schemaFile.open(QIODevice::WriteOnly | QIODevice::Truncate) || schemaFile.write(QJsonDocument(jsonRoot).toJson()) == -1) {
+        errorString = QObject::tr("Unable to write %1: %2").arg(schemaFile.fileName(), schemaFile.errorString());
+        return false;
+    }
+
+    return true;
+}
+
+/// Min/max stats are kept for numeric scalars, they have no useful meaning for arrays and strings
+bool TlogColumnarExporter::_isStatsColumn(const Column_t& column)
+{
+    return column.arrayLength == 0 && column.type != MAVLINK_TYPE_CHAR;
+}
+
+double TlogColumnarExporter::_columnValue(const Column_t& column, const uint8_t* value)
+{
+    switch (column.type) {
+    case MAVLINK_TYPE_UINT8_T:
+        return *value;
+    case MAVLINK_TYPE_INT8_T:
+        return *reinterpret_cast<const int8_t*>(value);
+    case MAVLINK_TYPE_UINT16_T:
+        return qFromLittleEndian<quint16>(value);
+    case MAVLINK_TYPE_INT16_T:
+        return qFromLittleEndian<qint16>(value);
+    case MAVLINK_TYPE_UINT32_T:
+        return qFromLittleEndian<quint32>(value);
+    case MAVLINK_TYPE_INT32_T:
+        return qFromLittleEndian<qint32>(value);
+    case MAVLINK_TYPE_UINT64_T:
+        return static_cast<double>(qFromLittleEndian<quint64>(value));
+    case MAVLINK_TYPE_INT64_T:
+        return static_cast<double>(qFromLittleEndian<qint64>(value));
+    case MAVLINK_TYPE_FLOAT:
+    {
+        float f;
+        memcpy(&f, value, sizeof(f));
+        return static_cast<double>(f);
+    }
+    case MAVLINK_TYPE_DOUBLE:
+    {
+        double d;
+        memcpy(&d, value, sizeof(d));
+        return d;
+    }
+    default:
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+int TlogColumnarExporter::_mavlinkTypeSize(int type)
+{
+    switch (type) {
+    case MAVLINK_TYPE_CHAR:
+    case MAVLINK_TYPE_UINT8_T:
+    case MAVLINK_TYPE_INT8_T:
+        return 1;
+    case MAVLINK_TYPE_UINT16_T:
+    case MAVLINK_TYPE_INT16_T:
+        return 2;
+    case MAVLINK_TYPE_UINT32_T:
+    case MAVLINK_TYPE_INT32_T:
+    case MAVLINK_TYPE_FLOAT:
+        return 4;
+    default:
+        return 8;
+    }
+}
+
+QString TlogColumnarExporter::_typeName(int type)
+{
+    switch (type) {
+    case MAVLINK_TYPE_CHAR:     return QStringLiteral("char");
+    case MAVLINK_TYPE_UINT8_T:  return QStringLiteral("uint8_t");
+    case MAVLINK_TYPE_INT8_T:   return QStringLiteral("int8_t");
+    case MAVLINK_TYPE_UINT16_T: return QStringLiteral("uint16_t");
+    case MAVLINK_TYPE_INT16_T:  return QStringLiteral("int16_t");
+    case MAVLINK_TYPE_UINT32_T: return QStringLiteral("uint32_t");
+    case MAVLINK_TYPE_INT32_T:  return QStringLiteral("int32_t");
+    case MAVLINK_TYPE_FLOAT:    return QStringLiteral("float");
+    case MAVLINK_TYPE_DOUBLE:   return QStringLiteral("double");
+    case MAVLINK_TYPE_UINT64_T: return QStringLiteral("uint64_t");
+    case MAVLINK_TYPE_INT64_T:  return QStringLiteral("int64_t");
+    default:                    return QStringLiteral("?");
+    }
+}
+
+int TlogColumnarExporter::runCommandLine(const QString& tlogFiles, const QString& outputDir, const QString& fieldProjection)
+{
+    TlogColumnarExporter    exporter;
+    int                     failureCount = 0;
+
+    exporter.setFieldProjection(fieldProjection.split(QLatin1Char(','), Qt::SkipEmptyParts));
+
+    for (const QString& tlogFile : tlogFiles.split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+        QElapsedTimer   timer;
+        QString         errorString;
+        const QString   logOutputDir = QDir(outputDir.isEmpty() ? QFileInfo(tlogFile).absolutePath() : outputDir).absoluteFilePath(QFileInfo(tlogFile).completeBaseName());
+
+        timer.start();
+        if (exporter.exportLog(tlogFile, logOutputDir, errorString)) {
+            qInfo().noquote() << QStringLiteral("%1 -> %2: %3 rows in %4 msecs").arg(tlogFile, logOutputDir).arg(exporter.exportedRowCount()).arg(timer.elapsed());
+        } else {
+            qWarning().noquote() << errorString;
+            failureCount++;
+        }
+    }
+
+    return failureCount ? 1 : 0;
+}
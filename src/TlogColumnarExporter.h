@@ -0,0 +1,118 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonArray>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "QGCLoggingCategory.h"
+#include "QGCMAVLink.h"
+
+Q_DECLARE_LOGGING_CATEGORY(TlogColumnarExporterLog)
+
+class QFile;
+
+/// Exports a telemetry log (tlog) to a columnar layout for offline analysis. Where LogCompressor turns a text log into
+/// one CSV line at a time, this decodes the memory mapped tlog in byte range chunks on all cores and writes the raw
+/// little endian field values, so no value is ever formatted as text.
+///
+/// Output directory layout:
+///     schema.json             Messages, columns and per row group min/max stats
+///     <MESSAGE>/<column>.bin  One file per column. Every message has timestamp_usec, sysid and compid columns
+///                             followed by its fields. Array fields store array_length values per row.
+///
+/// Each chunk of the log becomes one row group of every message found in it, in log order. Chunks are written out as
+/// soon as they are decoded, so memory use is bounded by the chunk size times the thread count, not by the log size.
+class TlogColumnarExporter
+{
+public:
+    TlogColumnarExporter(void);
+
+    /// Restricts the export to the specified messages and fields. Each entry is either a message name (all its fields)
+    /// or MESSAGE.field. An empty list exports everything.
+    void setFieldProjection(const QStringList& projection);
+
+    /// Size of the byte ranges the log is split into for decoding, which is also the row group size
+    void setChunkSize(int chunkSize) { _chunkSize = chunkSize; }
+
+    bool exportLog(const QString& tlogFile, const QString& outputDir, QString& errorString);
+
+    quint64 exportedRowCount(void) const { return _exportedRowCount; }
+
+    /// Runs a headless export of each of the comma separated tlogFiles to its own directory below outputDir
+    /// @return Process exit code
+    static int runCommandLine(const QString& tlogFiles, const QString& outputDir, const QString& fieldProjection);
+
+    static const char* schemaFileName;
+    static const char* columnFileExtension;
+
+private:
+    typedef struct {
+        QString name;
+        int     type;           ///< MAVLINK_TYPE_*
+        int     arrayLength;    ///< 0 for a scalar
+        int     wireOffset;
+        int     valueSize;      ///< Bytes per row
+    } Column_t;
+
+    typedef struct {
+        QString             messageName;
+        QVector<Column_t>   columns;            ///< Payload fields only, the fixed columns come first in the data
+        QVector<QByteArray> columnData;
+        QVector<double>     minimums;
+        QVector<double>     maximums;
+        quint64             rowCount;
+    } ChunkMessage_t;
+
+    typedef struct {
+        quint64 start;
+        quint64 end;
+    } Chunk_t;
+
+    typedef struct {
+        QList<uint32_t>                     messageIds;     ///< In the order they first show up in the chunk
+        QHash<uint32_t, ChunkMessage_t>     messages;
+    } ChunkResult_t;
+
+    typedef struct {
+        QString         messageName;
+        QStringList     columnNames;
+        QList<QFile*>   columnFiles;
+        QJsonArray      jsonColumns;
+        QJsonArray      jsonRowGroups;
+        quint64         rowCount;
+    } MessageOutput_t;
+
+    ChunkResult_t   _decodeChunk        (const uint8_t* data, quint64 size, const Chunk_t& chunk) const;
+    bool            _initChunkMessage   (const mavlink_message_t& message, ChunkMessage_t& chunkMessage) const;
+    void            _appendRow          (const mavlink_message_t& message, quint64 timestampUSecs, ChunkMessage_t& chunkMessage) const;
+    bool            _openMessageOutput  (const QString& outputDir, uint32_t messageId, const ChunkMessage_t& chunkMessage, QString& errorString);
+    bool            _writeRowGroup      (const QString& outputDir, uint32_t messageId, const ChunkMessage_t& chunkMessage, QString& errorString);
+    bool            _writeSchema        (const QString& outputDir, QString& errorString);
+
+    static bool     _isStatsColumn      (const Column_t& column);
+    static double   _columnValue        (const Column_t& column, const uint8_t* value);
+    static int      _mavlinkTypeSize    (int type);
+    static QString  _typeName           (int type);
+
+    QSet<QString>   _projection;
+    int             _chunkSize          = 32 * 1024 * 1024;
+    quint64         _exportedRowCount   = 0;
+
+    QList<uint32_t>                     _messageOrder;      ///< Message ids in the order they first show up in the log
+    QHash<uint32_t, MessageOutput_t>    _messageOutputs;
+
+    static const int _fixedColumnCount = 3;    ///< timestamp_usec, sysid, compid
+};
@@ -0,0 +1,143 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkMessageDispatcher.h"
+
+#include <QElapsedTimer>
+#include <QVariantMap>
+
+#include <algorithm>
+
+QGC_LOGGING_CATEGORY(MAVLinkMessageDispatcherLog, "MAVLinkMessageDispatcherLog")
+
+MAVLinkMessageDispatcher::MAVLinkMessageDispatcher(QObject* parent)
+    : QObject(parent)
+{
+
+}
+
+MAVLinkMessageDispatcher::~MAVLinkMessageDispatcher()
+{
+    qDeleteAll(_subscriptions);
+}
+
+void MAVLinkMessageDispatcher::subscribe(const QString& name, const QList<uint32_t>& messageIds, MessageHandler handler)
+{
+    if (messageIds.isEmpty()) {
+        return;
+    }
+
+    Subscription_t* subscription = new Subscription_t;
+
+    subscription->name          = name;
+    subscription->messageIds    = messageIds;
+    subscription->allMessages   = messageIds.contains(allMessageIds);
+    subscription->handler       = handler;
+    subscription->callCount     = 0;
+    subscription->totalNSecs    = 0;
+
+    _subscriptions.append(subscription);
+
+    // Tables are rebuilt lazily as message ids show up again
+    _dispatchTable.clear();
+    _subscriptionGeneration++;
+
+    qCDebug(MAVLinkMessageDispatcherLog) << "subscribe" << name << messageIds;
+}
+
+const QVector<MAVLinkMessageDispatcher::Subscription_t*>& MAVLinkMessageDispatcher::_subscriptionsForId(uint32_t messageId)
+{
+    auto entry = _dispatchTable.constFind(messageId);
+    if (entry != _dispatchTable.constEnd()) {
+        return entry.value();
+    }
+
+    QVector<Subscription_t*>& subscriptions = _dispatchTable[messageId];
+    for (Subscription_t* subscription : _subscriptions) {
+        if (subscription->allMessages || subscription->messageIds.contains(messageId)) {
+            subscriptions.append(subscription);
+        }
+    }
+
+    return subscriptions;
+}
+
+void MAVLinkMessageDispatcher::dispatch(mavlink_message_t& message)
+{
+    // Take a shared copy of the list, the table may be rebuilt by a handler subscribing while we loop
+    QVector<Subscription_t*>    subscriptions   = _subscriptionsForId(message.msgid);
+    quint32                     generation      = _subscriptionGeneration;
+    const bool                  timeHandlers    = MAVLinkMessageDispatcherLog().isDebugEnabled();
+    QElapsedTimer               timer;
+
+    for (int i=0; i<subscriptions.count(); i++) {
+        Subscription_t* subscription = subscriptions[i];
+
+        // Reading the clock twice per handler adds up at full telemetry rates, so it is only done when someone is looking
+        if (timeHandlers) {
+            timer.start();
+            subscription->handler(message);
+            subscription->totalNSecs += timer.nsecsElapsed();
+        } else {
+            subscription->handler(message);
+        }
+        subscription->callCount++;
+
+        if (generation != _subscriptionGeneration) {
+            // Subscriptions are only ever appended, so the new list starts with the handlers already called
+            subscriptions   = _subscriptionsForId(message.msgid);
+            generation      = _subscriptionGeneration;
+        }
+    }
+}
+
+QVariantList MAVLinkMessageDispatcher::handlerStats(void) const
+{
+    QVariantList stats;
+
+    for (const Subscription_t* subscription : _subscriptions) {
+        QVariantMap handlerStats;
+
+        handlerStats[QStringLiteral("name")]            = subscription->name;
+        handlerStats[QStringLiteral("callCount")]       = subscription->callCount;
+        handlerStats[QStringLiteral("totalUSecs")]      = subscription->totalNSecs / 1000;
+        handlerStats[QStringLiteral("averageUSecs")]    = subscription->callCount ? static_cast<double>(subscription->totalNSecs) / 1000.0 / subscription->callCount : 0.0;
+
+        stats.append(handlerStats);
+    }
+
+    return stats;
+}
+
+void MAVLinkMessageDispatcher::resetStats(void)
+{
+    for (Subscription_t* subscription : _subscriptions) {
+        subscription->callCount     = 0;
+        subscription->totalNSecs    = 0;
+    }
+}
+
+void MAVLinkMessageDispatcher::logStats(void) const
+{
+    if (!MAVLinkMessageDispatcherLog().isDebugEnabled()) {
+        return;
+    }
+
+    QList<const Subscription_t*> sorted;
+    for (const Subscription_t* subscription : _subscriptions) {
+        sorted.append(subscription);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Subscription_t* a, const Subscription_t* b) { return a->totalNSecs > b->totalNSecs; });
+
+    for (const Subscription_t* subscription : sorted) {
+        qCDebug(MAVLinkMessageDispatcherLog) << subscription->name
+                                             << "calls" << subscription->callCount
+                                             << "total usecs" << subscription->totalNSecs / 1000;
+    }
+}
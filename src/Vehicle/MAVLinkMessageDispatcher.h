@@ -0,0 +1,71 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QVariantList>
+#include <QVector>
+
+#include <functional>
+
+#include "QGCLoggingCategory.h"
+#include "QGCMAVLink.h"
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkMessageDispatcherLog)
+
+/// Routes incoming messages to the handlers which declared an interest in their message id, instead of offering every
+/// message to every handler. Handlers are called in subscription order. The handler list for a message id is built the
+/// first time that id is seen, after that dispatch is a single hash lookup.
+///
+/// Call counts are kept per handler, see handlerStats. Time spent is only measured while MAVLinkMessageDispatcherLog is enabled.
+class MAVLinkMessageDispatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    MAVLinkMessageDispatcher(QObject* parent = nullptr);
+    ~MAVLinkMessageDispatcher();
+
+    typedef std::function<void(mavlink_message_t& message)> MessageHandler;
+
+    /// Pass as one of the message ids to receive every message
+    static const uint32_t allMessageIds = 0xFFFFFFFF;
+
+    /// Adds a handler for the specified message ids. An empty list of ids is ignored.
+    /// Subscribing from inside a handler is allowed, the new handler sees the message being dispatched if it matches.
+    void subscribe(const QString& name, const QList<uint32_t>& messageIds, MessageHandler handler);
+
+    /// Calls all the handlers subscribed to the id of message
+    void dispatch(mavlink_message_t& message);
+
+    /// @return One map per handler: name, callCount, totalUSecs, averageUSecs
+    Q_INVOKABLE QVariantList    handlerStats    (void) const;
+    Q_INVOKABLE void            resetStats      (void);
+
+    /// Logs handlerStats to MAVLinkMessageDispatcherLog, most expensive handler first
+    void logStats(void) const;
+
+private:
+    typedef struct {
+        QString         name;
+        QList<uint32_t> messageIds;
+        bool            allMessages;
+        MessageHandler  handler;
+        quint64         callCount;
+        qint64          totalNSecs;
+    } Subscription_t;
+
+    const QVector<Subscription_t*>& _subscriptionsForId(uint32_t messageId);
+
+    QList<Subscription_t*>                      _subscriptions;     ///< Pointers so a handler can subscribe while it is running
+    QHash<uint32_t, QVector<Subscription_t*>>   _dispatchTable;
+    quint32                                     _subscriptionGeneration = 0;
+};
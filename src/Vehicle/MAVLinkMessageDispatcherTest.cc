@@ -0,0 +1,85 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkMessageDispatcherTest.h"
+#include "MAVLinkMessageDispatcher.h"
+
+MAVLinkMessageDispatcherTest::MAVLinkMessageDispatcherTest(void)
+{
+
+}
+
+void MAVLinkMessageDispatcherTest::_dispatchByIdTest(void)
+{
+    MAVLinkMessageDispatcher    dispatcher;
+    QStringList                 calls;
+    mavlink_message_t           message = {};
+
+    dispatcher.subscribe(QStringLiteral("attitude"),    { MAVLINK_MSG_ID_ATTITUDE },                                [&calls](mavlink_message_t&) { calls.append(QStringLiteral("attitude")); });
+    dispatcher.subscribe(QStringLiteral("all"),         { MAVLinkMessageDispatcher::allMessageIds },                [&calls](mavlink_message_t&) { calls.append(QStringLiteral("all")); });
+    dispatcher.subscribe(QStringLiteral("heartbeat"),   { MAVLINK_MSG_ID_HEARTBEAT, MAVLINK_MSG_ID_ATTITUDE },      [&calls](mavlink_message_t&) { calls.append(QStringLiteral("heartbeat")); });
+    dispatcher.subscribe(QStringLiteral("none"),        { },                                                        [&calls](mavlink_message_t&) { calls.append(QStringLiteral("none")); });
+
+    message.msgid = MAVLINK_MSG_ID_ATTITUDE;
+    dispatcher.dispatch(message);
+    QCOMPARE(calls, QStringList({ QStringLiteral("attitude"), QStringLiteral("all"), QStringLiteral("heartbeat") }));
+
+    calls.clear();
+    message.msgid = MAVLINK_MSG_ID_HEARTBEAT;
+    dispatcher.dispatch(message);
+    QCOMPARE(calls, QStringList({ QStringLiteral("all"), QStringLiteral("heartbeat") }));
+
+    calls.clear();
+    message.msgid = MAVLINK_MSG_ID_VFR_HUD;
+    dispatcher.dispatch(message);
+    QCOMPARE(calls, QStringList({ QStringLiteral("all") }));
+}
+
+// Mirrors battery fact group creation: a handler adds a new subscriber which must see the message being dispatched
+void MAVLinkMessageDispatcherTest::_subscribeDuringDispatchTest(void)
+{
+    MAVLinkMessageDispatcher    dispatcher;
+    int                         createdCalls = 0;
+    mavlink_message_t           message = {};
+
+    dispatcher.subscribe(QStringLiteral("creator"), { MAVLINK_MSG_ID_BATTERY_STATUS }, [&](mavlink_message_t&) {
+        if (createdCalls == 0) {
+            dispatcher.subscribe(QStringLiteral("created"), { MAVLINK_MSG_ID_BATTERY_STATUS }, [&createdCalls](mavlink_message_t&) { createdCalls++; });
+        }
+    });
+
+    message.msgid = MAVLINK_MSG_ID_BATTERY_STATUS;
+    dispatcher.dispatch(message);
+    QCOMPARE(createdCalls, 1);
+    dispatcher.dispatch(message);
+    QCOMPARE(createdCalls, 2);
+}
+
+void MAVLinkMessageDispatcherTest::_statsTest(void)
+{
+    MAVLinkMessageDispatcher    dispatcher;
+    mavlink_message_t           message = {};
+
+    dispatcher.subscribe(QStringLiteral("attitude"), { MAVLINK_MSG_ID_ATTITUDE }, [](mavlink_message_t&) { });
+
+    message.msgid = MAVLINK_MSG_ID_ATTITUDE;
+    for (int i=0; i<10; i++) {
+        dispatcher.dispatch(message);
+    }
+    message.msgid = MAVLINK_MSG_ID_HEARTBEAT;
+    dispatcher.dispatch(message);
+
+    QVariantList stats = dispatcher.handlerStats();
+    QCOMPARE(stats.count(), 1);
+    QCOMPARE(stats[0].toMap()[QStringLiteral("name")].toString(), QStringLiteral("attitude"));
+    QCOMPARE(stats[0].toMap()[QStringLiteral("callCount")].toULongLong(), 10ull);
+
+    dispatcher.resetStats();
+    QCOMPARE(dispatcher.handlerStats()[0].toMap()[QStringLiteral("callCount")].toULongLong(), 0ull);
+}
@@ -0,0 +1,25 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class MAVLinkMessageDispatcherTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MAVLinkMessageDispatcherTest(void);
+
+private slots:
+    void _dispatchByIdTest           (void);
+    void _subscribeDuringDispatchTest(void);
+    void _statsTest                  (void);
+};
@@ -58,6 +58,9 @@ void MAVLinkStreamConfig::gotSetMessageIntervalAck()
         case State::RestoringDefaults:
             restoreNextDefault();
             break;
+        case State::Adapting:
+            nextAdaptiveRate();
+            break;
         default:
             break;
     }
@@ -66,6 +69,7 @@ void MAVLinkStreamConfig::gotSetMessageIntervalAck()
 void MAVLinkStreamConfig::setNextState(State state)
 {
     _nextState = state;
+    // while adapting the next ack switches over
     if (_state == State::Idle) {
         // first restore defaults no matter what the next state is
         _state = State::RestoringDefaults;
@@ -97,6 +101,56 @@ void MAVLinkStreamConfig::restoreDefaults()
     setNextState(State::RestoringDefaults);
 }
 
+void MAVLinkStreamConfig::setAdaptiveRates(const QVector<DesiredStreamRate>& rates)
+{
+    if (highRateActive()) {
+        return;
+    }
+
+    // newer requests for the same stream replace queued ones
+    for (const DesiredStreamRate& rate : rates) {
+        bool replaced = false;
+        for (DesiredStreamRate& queuedRate : _adaptiveRates) {
+            if (queuedRate.messageId == rate.messageId) {
+                queuedRate.rate = rate.rate;
+                replaced = true;
+                break;
+            }
+        }
+        if (!replaced) {
+            _adaptiveRates.push_front(rate);
+        }
+    }
+
+    if (_state == State::Idle) {
+        _state = State::Adapting;
+        nextAdaptiveRate();
+    }
+}
+
+bool MAVLinkStreamConfig::highRateActive() const
+{
+    return (_state != State::Idle && _state != State::Adapting) || _nextState != State::Idle || !_changedIds.empty();
+}
+
+void MAVLinkStreamConfig::nextAdaptiveRate()
+{
+    if (_nextState != State::Idle) { // high rate requests take over
+        _adaptiveRates.clear();
+        _state = State::RestoringDefaults;
+        restoreNextDefault();
+        return;
+    }
+
+    if (_adaptiveRates.empty()) {
+        _state = State::Idle;
+        return;
+    }
+    const DesiredStreamRate rate = _adaptiveRates.last();
+    _adaptiveRates.pop_back();
+    _messageIntervalCb(rate.messageId, rate.rate);
+}
+
 void MAVLinkStreamConfig::restoreNextDefault()
 {
     if (_changedIds.empty()) {
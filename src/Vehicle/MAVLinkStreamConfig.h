@@ -18,12 +18,19 @@
  * Allows to configure a set of mavlink streams to a specific rate,
  * and restore back to default.
  * Note that only one set is active at a time.
+ * The adaptive stream rate controller also sends its rate changes through here, since
+ * all SET_MESSAGE_INTERVAL commands have to go out one at a time.
  */
 class MAVLinkStreamConfig
 {
 public:
     using SetMessageIntervalCb = std::function<void(int messageId, int rate)>;
 
+    struct DesiredStreamRate {
+        int messageId;
+        int rate;       ///< Interval in usecs, 0 for the default rate
+    };
+
     MAVLinkStreamConfig(const SetMessageIntervalCb& messageIntervalCb);
 
     void setHighRateRateAndAttitude();
@@ -32,21 +39,27 @@ public:
 
     void restoreDefaults();
 
+    /**
+     * Queues rate changes from the adaptive stream rate controller. They are dropped
+     * while a high rate set is active, which takes priority.
+     */
+    void setAdaptiveRates(const QVector<DesiredStreamRate>& rates);
+
+    /// @return true: a high rate set is active or being configured
+    bool highRateActive() const;
+
     void gotSetMessageIntervalAck();
 private:
     enum class State {
         Idle,
         RestoringDefaults,
-        Configuring
-    };
-
-    struct DesiredStreamRate {
-        int messageId;
-        int rate;
+        Configuring,
+        Adapting
     };
 
     void restoreNextDefault();
     void nextDesiredRate();
+    void nextAdaptiveRate();
     void setNextState(State state);
 
     State _state{State::Idle};
@@ -56,5 +69,7 @@ private:
     State _nextState{State::Idle};
     QVector<DesiredStreamRate> _nextDesiredRates;
 
+    QVector<DesiredStreamRate> _adaptiveRates;
+
     const SetMessageIntervalCb _messageIntervalCb;
 };
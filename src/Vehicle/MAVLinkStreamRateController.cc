@@ -0,0 +1,161 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkStreamRateController.h"
+#include "QGCMAVLink.h"
+
+QGC_LOGGING_CATEGORY(MAVLinkStreamRateControllerLog, "MAVLinkStreamRateControllerLog")
+
+// Rate of each reduction step relative to the baseline rate
+static const double levelScales[] = { 1.0, 0.5, 0.25, 0.1 };
+
+MAVLinkStreamRateController::MAVLinkStreamRateController(const MessageRateCb& messageRateCb)
+    : _messageRateCb(messageRateCb)
+    , _classStates(_streamClasses().count())
+{
+    static_assert(sizeof(levelScales) / sizeof(levelScales[0]) == _levelCount, "levelScales must have _levelCount entries");
+}
+
+const QVector<MAVLinkStreamRateController::StreamClass>& MAVLinkStreamRateController::_streamClasses()
+{
+    // Most important first, the last class is slowed down first
+    static const QVector<StreamClass> streamClasses = {
+        { "Attitude",   { MAVLINK_MSG_ID_ATTITUDE, MAVLINK_MSG_ID_ATTITUDE_QUATERNION } },
+        { "Position",   { MAVLINK_MSG_ID_GLOBAL_POSITION_INT, MAVLINK_MSG_ID_GPS_RAW_INT, MAVLINK_MSG_ID_LOCAL_POSITION_NED } },
+        { "Status",     { MAVLINK_MSG_ID_SYS_STATUS, MAVLINK_MSG_ID_BATTERY_STATUS, MAVLINK_MSG_ID_EXTENDED_SYS_STATE } },
+        { "Hud",        { MAVLINK_MSG_ID_VFR_HUD, MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT } },
+        { "Sensors",    { MAVLINK_MSG_ID_RC_CHANNELS, MAVLINK_MSG_ID_SERVO_OUTPUT_RAW, MAVLINK_MSG_ID_VIBRATION, MAVLINK_MSG_ID_SCALED_PRESSURE } },
+    };
+    return streamClasses;
+}
+
+int MAVLinkStreamRateController::classCount()
+{
+    return _streamClasses().count();
+}
+
+void MAVLinkStreamRateController::radioStatusReceived(int txbufPercent)
+{
+    _radioSeen = true;
+    _txbufPercent = txbufPercent;
+}
+
+bool MAVLinkStreamRateController::_congested() const
+{
+    return _txbufPercent < _txbufLowPercent || _lossRate > _maxLossRate;
+}
+
+QVector<MAVLinkStreamConfig::DesiredStreamRate> MAVLinkStreamRateController::update(double lossRate)
+{
+    QVector<MAVLinkStreamConfig::DesiredStreamRate> changes;
+
+    _lossRate = lossRate;
+    if (!_enabled || !_radioSeen) {
+        return changes;
+    }
+    _sinceDecreaseCount++;
+
+    if (_congested()) {
+        _clearCount = 0;
+        if (_sinceDecreaseCount < _decreaseHoldCount) {
+            return changes;
+        }
+        // Cut the least important class which still has room to go down
+        for (int i = _classStates.count() - 1; i >= 0; i--) {
+            ClassState& classState = _classStates[i];
+            if (classState.level < _levelCount - 1) {
+                if (classState.level == 0) {
+                    classState.baselineHz.clear();
+                    for (int messageId : _streamClasses()[i].messageIds) {
+                        classState.baselineHz.append(_messageRateCb(messageId));
+                    }
+                }
+                classState.level++;
+                _sinceDecreaseCount = 0;
+                qCDebug(MAVLinkStreamRateControllerLog) << "Congested, slowing down" << _streamClasses()[i].name << "to level" << classState.level
+                                                        << "txbuf" << _txbufPercent << "loss" << _lossRate;
+                _changes(i, changes);
+                break;
+            }
+        }
+        return changes;
+    }
+
+    const bool clear = _txbufPercent > _txbufClearPercent && _lossRate < _clearLossRate;
+    _clearCount = clear ? _clearCount + 1 : 0;
+    if (_clearCount < _increaseHoldCount) {
+        return changes;
+    }
+    _clearCount = 0;
+
+    // Give back to the most important class first
+    for (int i = 0; i < _classStates.count(); i++) {
+        ClassState& classState = _classStates[i];
+        if (classState.level > 0) {
+            classState.level--;
+            qCDebug(MAVLinkStreamRateControllerLog) << "Link clear, speeding up" << _streamClasses()[i].name << "to level" << classState.level;
+            _changes(i, changes);
+            break;
+        }
+    }
+
+    return changes;
+}
+
+void MAVLinkStreamRateController::_changes(int classIndex, QVector<MAVLinkStreamConfig::DesiredStreamRate>& changes) const
+{
+    const StreamClass& streamClass = _streamClasses()[classIndex];
+    const ClassState& classState = _classStates[classIndex];
+
+    for (int i = 0; i < streamClass.messageIds.count(); i++) {
+        const double baselineHz = classState.baselineHz.value(i);
+        if (classState.level == 0) {
+            changes.append({ streamClass.messageIds[i], 0 });
+        } else if (baselineHz > 0) {
+            // Streams which weren't coming in when the class was first cut are left alone
+            changes.append({ streamClass.messageIds[i], static_cast<int>(1000000.0 / (baselineHz * levelScales[classState.level])) });
+        }
+    }
+}
+
+QVector<MAVLinkStreamConfig::DesiredStreamRate> MAVLinkStreamRateController::reset()
+{
+    QVector<MAVLinkStreamConfig::DesiredStreamRate> changes;
+
+    for (int i = 0; i < _classStates.count(); i++) {
+        if (_classStates[i].level > 0) {
+            _classStates[i].level = 0;
+            _changes(i, changes);
+        }
+    }
+    _clearCount = 0;
+    _sinceDecreaseCount = 0;
+
+    return changes;
+}
+
+QVector<MAVLinkStreamConfig::DesiredStreamRate> MAVLinkStreamRateController::linkChanged()
+{
+    _radioSeen = false;
+    _txbufPercent = 100;
+    _lossRate = 0;
+
+    return reset();
+}
+
+QVector<int> MAVLinkStreamRateController::levels() const
+{
+    QVector<int> levels;
+
+    for (const ClassState& classState : _classStates) {
+        levels.append(classState.level);
+    }
+
+    return levels;
+}
@@ -0,0 +1,101 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QVector>
+
+#include <functional>
+
+#include "MAVLinkStreamConfig.h"
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkStreamRateControllerLog)
+
+/**
+ * @class MAVLinkStreamRateController
+ * Keeps a telemetry radio link below saturation by lowering the rate of the vehicle's
+ * telemetry streams when the link is congested and raising them back once it recovers.
+ * Streams are grouped in classes by priority: the least important class is slowed down
+ * first and restored last. Rates are cut in steps relative to the rate the stream was
+ * measured at before the first cut, and recovered one step at a time, so a congested
+ * link backs off quickly and creeps back up.
+ *
+ * Congestion is judged from the free transmit buffer in RADIO_STATUS and the loss measured
+ * on the link. A weak signal alone is not a reason to cut rates, it only matters once it
+ * shows up as loss. The controller does nothing until a RADIO_STATUS has been seen, so
+ * links without a telemetry radio are never touched.
+ */
+class MAVLinkStreamRateController
+{
+public:
+    /// @return Current rate of the message in Hz, 0 if unknown
+    using MessageRateCb = std::function<double(int messageId)>;
+
+    MAVLinkStreamRateController(const MessageRateCb& messageRateCb);
+
+    /// @param txbufPercent Free space in the radio transmit buffer
+    void radioStatusReceived(int txbufPercent);
+
+    /**
+     * Evaluates the link, call once a second.
+     * @param lossRate Fraction of messages lost on the link, 0-1
+     * @return Stream rate changes to send to the vehicle
+     */
+    QVector<MAVLinkStreamConfig::DesiredStreamRate> update(double lossRate);
+
+    /// Forget all adjustments, for example after the streams were reconfigured by someone else
+    /// @return Changes which restore every adjusted stream to its default rate
+    QVector<MAVLinkStreamConfig::DesiredStreamRate> reset();
+
+    /// Starts over on a new link: forgets all adjustments and the radio, a link without a radio is then left alone
+    /// @return Changes which restore every adjusted stream to its default rate
+    QVector<MAVLinkStreamConfig::DesiredStreamRate> linkChanged();
+
+    void setEnabled (bool enabled) { _enabled = enabled; }
+    bool enabled    () const { return _enabled; }
+
+    /// @return Reduction step of each stream class, 0 is full rate
+    QVector<int> levels() const;
+
+    static int classCount();
+
+private:
+    struct StreamClass {
+        const char* name;
+        QVector<int> messageIds;
+    };
+
+    struct ClassState {
+        int level{0};
+        QVector<double> baselineHz;     ///< Measured rate of each message before the first cut, 0 if unknown
+    };
+
+    bool _congested() const;
+    void _changes(int classIndex, QVector<MAVLinkStreamConfig::DesiredStreamRate>& changes) const;
+
+    static const QVector<StreamClass>& _streamClasses();
+
+    const MessageRateCb _messageRateCb;
+    QVector<ClassState> _classStates;
+    bool _enabled{true};
+    bool _radioSeen{false};
+    int _txbufPercent{100};
+    double _lossRate{0};
+    int _clearCount{0};          ///< Updates in a row without congestion
+    int _sinceDecreaseCount{0};  ///< Updates since the last rate cut
+
+    static const int _levelCount = 4;           ///< Steps of rate reduction, including full rate
+    static const int _txbufLowPercent = 40;      ///< Less free radio buffer than this is congestion
+    static const int _txbufClearPercent = 70;    ///< More than this is clear
+    static constexpr double _maxLossRate = 0.05;
+    static constexpr double _clearLossRate = 0.01;
+    static const int _decreaseHoldCount = 2;     ///< Let a cut take effect before cutting again
+    static const int _increaseHoldCount = 5;     ///< Stay clear this long before raising a rate
+};
@@ -0,0 +1,162 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkStreamRateControllerTest.h"
+#include "MAVLinkStreamRateController.h"
+
+MAVLinkStreamRateControllerTest::MAVLinkStreamRateControllerTest(void)
+{
+
+}
+
+// Every stream comes in at 10Hz
+static double measuredRate(int messageId)
+{
+    Q_UNUSED(messageId);
+    return 10.0;
+}
+
+void MAVLinkStreamRateControllerTest::_noRadioTest(void)
+{
+    MAVLinkStreamRateController controller(measuredRate);
+
+    // Loss alone doesn't touch a link without a telemetry radio
+    for (int i=0; i<10; i++) {
+        QVERIFY(controller.update(0.5).isEmpty());
+    }
+}
+
+void MAVLinkStreamRateControllerTest::_backoffTest(void)
+{
+    MAVLinkStreamRateController controller(measuredRate);
+    const int                   classCount = MAVLinkStreamRateController::classCount();
+
+    controller.radioStatusReceived(10 /* txbuf */);
+
+    // The least important class goes first, to half its measured rate
+    QVector<MAVLinkStreamConfig::DesiredStreamRate> changes;
+    for (int i=0; i<3 && changes.isEmpty(); i++) {
+        changes = controller.update(0);
+    }
+    QVERIFY(!changes.isEmpty());
+    for (const MAVLinkStreamConfig::DesiredStreamRate& change : changes) {
+        QCOMPARE(change.rate, 200000);
+    }
+    QCOMPARE(controller.levels().last(), 1);
+    QCOMPARE(controller.levels().first(), 0);
+
+    // Staying congested walks it down to the bottom before the next class is touched
+    for (int i=0; i<10; i++) {
+        controller.update(0);
+    }
+    QCOMPARE(controller.levels().last(), 3);
+    QVERIFY(controller.levels()[classCount - 2] > 0);
+
+    // Everything ends up at the bottom, nothing more to send
+    for (int i=0; i<100; i++) {
+        controller.update(0);
+    }
+    for (int level : controller.levels()) {
+        QCOMPARE(level, 3);
+    }
+    QVERIFY(controller.update(0).isEmpty());
+}
+
+void MAVLinkStreamRateControllerTest::_recoveryTest(void)
+{
+    MAVLinkStreamRateController controller(measuredRate);
+
+    controller.radioStatusReceived(10);
+    for (int i=0; i<6; i++) {
+        controller.update(0);
+    }
+    const QVector<int> congestedLevels = controller.levels();
+
+    // A clear link gives rates back slowly, one step at a time
+    controller.radioStatusReceived(90);
+    for (int i=0; i<4; i++) {
+        QVERIFY(controller.update(0).isEmpty());
+    }
+    QVERIFY(!controller.update(0).isEmpty());
+
+    int levelSum = 0;
+    int congestedLevelSum = 0;
+    for (int i=0; i<congestedLevels.count(); i++) {
+        levelSum += controller.levels()[i];
+        congestedLevelSum += congestedLevels[i];
+    }
+    QCOMPARE(levelSum, congestedLevelSum - 1);
+
+    // Fully recovered streams go back to their default rate
+    QVector<MAVLinkStreamConfig::DesiredStreamRate> changes;
+    for (int i=0; i<100; i++) {
+        changes.append(controller.update(0));
+    }
+    for (int level : controller.levels()) {
+        QCOMPARE(level, 0);
+    }
+    QCOMPARE(changes.last().rate, 0);
+
+    // Restoring everything at once asks for nothing when nothing is cut
+    QVERIFY(controller.reset().isEmpty());
+}
+
+void MAVLinkStreamRateControllerTest::_lossTest(void)
+{
+    MAVLinkStreamRateController controller(measuredRate);
+
+    // Plenty of buffer, but messages go missing
+    controller.radioStatusReceived(100);
+    QVERIFY(controller.update(0.2).isEmpty());
+    QVERIFY(!controller.update(0.2).isEmpty());
+
+    // Free buffer and no loss is never congestion, whatever the signal strength
+    controller.reset();
+    controller.radioStatusReceived(100);
+    for (int i=0; i<10; i++) {
+        QVERIFY(controller.update(0).isEmpty());
+    }
+
+    controller.setEnabled(false);
+    for (int i=0; i<10; i++) {
+        QVERIFY(controller.update(0.5).isEmpty());
+    }
+}
+
+void MAVLinkStreamRateControllerTest::_linkChangedTest(void)
+{
+    MAVLinkStreamRateController controller(measuredRate);
+
+    // Congested radio link gets cut
+    controller.radioStatusReceived(10);
+    for (int i=0; i<4; i++) {
+        controller.update(0);
+    }
+    QVERIFY(controller.levels().last() > 0);
+
+    // Failover to a link without a radio restores every stream...
+    const QVector<MAVLinkStreamConfig::DesiredStreamRate> changes = controller.linkChanged();
+    QVERIFY(!changes.isEmpty());
+    for (const MAVLinkStreamConfig::DesiredStreamRate& change : changes) {
+        QCOMPARE(change.rate, 0);
+    }
+
+    // ...and the stale radio status never cuts the new link
+    for (int i=0; i<10; i++) {
+        QVERIFY(controller.update(0).isEmpty());
+    }
+    for (int level : controller.levels()) {
+        QCOMPARE(level, 0);
+    }
+
+    // A radio on the new link is picked up again
+    controller.radioStatusReceived(10);
+    controller.update(0);
+    QVERIFY(!controller.update(0).isEmpty());
+}
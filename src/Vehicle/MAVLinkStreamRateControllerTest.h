@@ -0,0 +1,28 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Drives MAVLinkStreamRateController through congestion and recovery and checks the rates it asks for
+class MAVLinkStreamRateControllerTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MAVLinkStreamRateControllerTest(void);
+
+private slots:
+    void _noRadioTest       (void);
+    void _backoffTest       (void);
+    void _recoveryTest      (void);
+    void _lossTest          (void);
+    void _linkChangedTest   (void);
+};
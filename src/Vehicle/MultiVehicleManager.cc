@@ -28,6 +28,7 @@
 QGC_LOGGING_CATEGORY(MultiVehicleManagerLog, "MultiVehicleManagerLog")
 
 const char* MultiVehicleManager::_gcsHeartbeatEnabledKey = "gcsHeartbeatEnabled";
+const char* MultiVehicleManager::_timesyncEnabledKey = "timesyncEnabled";
 
 MultiVehicleManager::MultiVehicleManager(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
@@ -38,12 +39,18 @@ MultiVehicleManager::MultiVehicleManager(QGCApplication* app, QGCToolbox* toolbo
     , _firmwarePluginManager(nullptr)
     , _joystickManager(nullptr)
     , _mavlinkProtocol(nullptr)
+    , _remoteIDScheduler(new RemoteIDScheduler(this))
+    , _remoteIDObserver(new RemoteIDObserver(this))
     , _gcsHeartbeatEnabled(true)
+    , _timesyncEnabled(true)
 {
     QSettings settings;
     _gcsHeartbeatEnabled = settings.value(_gcsHeartbeatEnabledKey, true).toBool();
+    _timesyncEnabled = settings.value(_timesyncEnabledKey, true).toBool();
     _gcsHeartbeatTimer.setInterval(_gcsHeartbeatRateMSecs);
     _gcsHeartbeatTimer.setSingleShot(false);
+    _timesyncTimer.setInterval(_timesyncRateMSecs);
+    _timesyncTimer.setSingleShot(false);
 }
 
 void MultiVehicleManager::setToolbox(QGCToolbox *toolbox)
@@ -56,14 +63,23 @@ void MultiVehicleManager::setToolbox(QGCToolbox *toolbox)
 
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
     qmlRegisterUncreatableType<MultiVehicleManager>("QGroundControl.MultiVehicleManager", 1, 0, "MultiVehicleManager", "Reference only");
+    qmlRegisterUncreatableType<RemoteIDScheduler>  ("QGroundControl.MultiVehicleManager", 1, 0, "RemoteIDScheduler",   "Reference only");
+    qmlRegisterUncreatableType<RemoteIDObserver>   ("QGroundControl.MultiVehicleManager", 1, 0, "RemoteIDObserver",    "Reference only");
+    qmlRegisterUncreatableType<RemoteIDAircraft>   ("QGroundControl.MultiVehicleManager", 1, 0, "RemoteIDAircraft",    "Reference only");
 
     connect(_mavlinkProtocol, &MAVLinkProtocol::vehicleHeartbeatInfo, this, &MultiVehicleManager::_vehicleHeartbeatInfo);
+    connect(_mavlinkProtocol, &MAVLinkProtocol::messageReceived,      this, &MultiVehicleManager::_routeMessage);
     connect(&_gcsHeartbeatTimer, &QTimer::timeout, this, &MultiVehicleManager::_sendGCSHeartbeat);
 
     if (_gcsHeartbeatEnabled) {
         _gcsHeartbeatTimer.start();
     }
 
+    connect(&_timesyncTimer, &QTimer::timeout, this, &MultiVehicleManager::_sendTimesyncRequests);
+    if (_timesyncEnabled) {
+        _timesyncTimer.start();
+    }
+
     _offlineEditingVehicle = new Vehicle(Vehicle::MAV_AUTOPILOT_TRACK, Vehicle::MAV_TYPE_TRACK, _firmwarePluginManager, this);
 }
 
@@ -136,6 +152,7 @@ void MultiVehicleManager::_vehicleHeartbeatInfo(LinkInterface* link, int vehicle
     connect(vehicle->parameterManager(),    &ParameterManager::parametersReadyChanged,  this, &MultiVehicleManager::_vehicleParametersReadyChanged);
 
     _vehicles.append(vehicle);
+    _vehicleBySysId[vehicleId] = vehicle;
 
     // Send QGC heartbeat ASAP, this allows PX4 to start accepting commands
     _sendGCSHeartbeat();
@@ -160,6 +177,36 @@ void MultiVehicleManager::_vehicleHeartbeatInfo(LinkInterface* link, int vehicle
 
 }
 
+/// Hands each message only to the vehicle it came from, rather than every vehicle receiving and filtering all traffic.
+/// Broadcasts (sysid 0) go to every vehicle. RADIO_STATUS is sent from the radio's own sysid, so it also goes to each
+/// vehicle which is using the link it arrived on.
+///
+/// Every vehicle gets the same shared message. A vehicle whose firmware plugin rewrites the message takes its own copy
+/// first, so no vehicle sees another vehicle's adjustments.
+void MultiVehicleManager::_routeMessage(LinkInterface* link, const MAVLinkMessageRef& message)
+{
+    if (message->sysid == 0) {
+        for (Vehicle* vehicle : _vehicleBySysId.values()) {
+            vehicle->_mavlinkMessageReceived(link, message);
+        }
+    } else {
+        Vehicle* owner = _vehicleBySysId.value(message->sysid, nullptr);
+        if (owner) {
+            owner->_mavlinkMessageReceived(link, message);
+        }
+
+        if (message->msgid == MAVLINK_MSG_ID_RADIO_STATUS) {
+            for (Vehicle* vehicle : _vehicleBySysId.values()) {
+                if (vehicle != owner && vehicle->vehicleLinkManager()->containsLink(link)) {
+                    vehicle->_mavlinkMessageReceived(link, message);
+                }
+            }
+        }
+    }
+
+    emit messageTap(link, message);
+}
+
 /// This slot is connected to the Vehicle::requestProtocolVersion signal such that the vehicle manager
 /// tries to switch MAVLink to v2 if all vehicles support it
 void MultiVehicleManager::_requestProtocolVersion(unsigned version)
@@ -204,6 +251,9 @@ void MultiVehicleManager::_deleteVehiclePhase1(Vehicle* vehicle)
     if (!found) {
         qWarning() << "Vehicle not found in map!";
     }
+    if (_vehicleBySysId.value(vehicle->id()) == vehicle) {
+        _vehicleBySysId.remove(vehicle->id());
+    }
 
     vehicle->uas()->shutdownVehicle();
 
@@ -371,6 +421,23 @@ void MultiVehicleManager::setGcsHeartbeatEnabled(bool gcsHeartBeatEnabled)
     }
 }
 
+void MultiVehicleManager::setTimesyncEnabled(bool timesyncEnabled)
+{
+    if (timesyncEnabled != _timesyncEnabled) {
+        _timesyncEnabled = timesyncEnabled;
+        emit timesyncEnabledChanged(timesyncEnabled);
+
+        QSettings settings;
+        settings.setValue(_timesyncEnabledKey, timesyncEnabled);
+
+        if (timesyncEnabled) {
+            _timesyncTimer.start();
+        } else {
+            _timesyncTimer.stop();
+        }
+    }
+}
+
 void MultiVehicleManager::_sendGCSHeartbeat(void)
 {
     LinkManager*                    linkManager = qgcApp()->toolbox()->linkManager();
@@ -394,7 +461,43 @@ void MultiVehicleManager::_sendGCSHeartbeat(void)
 
             uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
             int len = mavlink_msg_to_send_buffer(buffer, &message);
-            link->writeBytesThreadSafe((const char*)buffer, len);
+            link->writeBytesThreadSafe((const char*)buffer, len, LinkSendScheduler::TrafficClassCommand);
+        }
+    }
+}
+
+/// Sends a single broadcast TIMESYNC request on each link, however many vehicles share it. Each vehicle on the link
+/// answers it and picks its own reply out of the traffic routed to it by sysid, so replies grow with the vehicle count
+/// rather than its square.
+void MultiVehicleManager::_sendTimesyncRequests(void)
+{
+    QHash<LinkInterface*, QList<VehicleLinkManager*>> linkVehicles;
+
+    for (int i=0; i<_vehicles.count(); i++) {
+        VehicleLinkManager* vehicleLinkManager = qobject_cast<Vehicle*>(_vehicles[i])->vehicleLinkManager();
+        for (LinkInterface* link: vehicleLinkManager->timesyncLinks()) {
+            linkVehicles[link].append(vehicleLinkManager);
+        }
+    }
+
+    for (auto iter = linkVehicles.constBegin(); iter != linkVehicles.constEnd(); iter++) {
+        LinkInterface* link = iter.key();
+        if (!link->isConnected()) {
+            continue;
+        }
+
+        const qint64        nowNSecs    = MAVLinkTimesync::nowNSecs();
+        mavlink_message_t   message     = MAVLinkTimesync::requestMessage(static_cast<uint8_t>(_mavlinkProtocol->getSystemId()),
+                                                                          static_cast<uint8_t>(_mavlinkProtocol->getComponentId()),
+                                                                          link->mavlinkChannel(),
+                                                                          nowNSecs);
+
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        int len = mavlink_msg_to_send_buffer(buffer, &message);
+        link->writeBytesThreadSafe((const char*)buffer, len, LinkSendScheduler::trafficClassForMessage(message.msgid));
+
+        for (VehicleLinkManager* vehicleLinkManager: iter.value()) {
+            vehicleLinkManager->timesyncRequestSent(link, nowNSecs);
         }
     }
 }
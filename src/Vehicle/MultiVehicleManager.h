@@ -19,6 +19,8 @@
 #include "QmlObjectListModel.h"
 #include "QGCToolbox.h"
 #include "QGCLoggingCategory.h"
+#include "RemoteIDScheduler.h"
+#include "RemoteIDObserver.h"
 
 class FirmwarePluginManager;
 class FollowMe;
@@ -43,8 +45,11 @@ public:
     Q_PROPERTY(Vehicle*             activeVehicle                   READ activeVehicle                  WRITE setActiveVehicle          NOTIFY activeVehicleChanged)
     Q_PROPERTY(QmlObjectListModel*  vehicles                        READ vehicles                                                       CONSTANT)
     Q_PROPERTY(bool                 gcsHeartBeatEnabled             READ gcsHeartbeatEnabled            WRITE setGcsHeartbeatEnabled    NOTIFY gcsHeartBeatEnabledChanged)
+    Q_PROPERTY(bool                 timesyncEnabled                 READ timesyncEnabled                WRITE setTimesyncEnabled        NOTIFY timesyncEnabledChanged)
     Q_PROPERTY(Vehicle*             offlineEditingVehicle           READ offlineEditingVehicle                                          CONSTANT)
     Q_PROPERTY(QGeoCoordinate       lastKnownLocation               READ lastKnownLocation                                              NOTIFY lastKnownLocationChanged) //< Current vehicles last know location
+    Q_PROPERTY(RemoteIDScheduler*   remoteIDScheduler               READ remoteIDScheduler                                              CONSTANT)
+    Q_PROPERTY(RemoteIDObserver*    remoteIDObserver                READ remoteIDObserver                                               CONSTANT)
 
     // Methods
 
@@ -66,6 +71,9 @@ public:
     bool gcsHeartbeatEnabled(void) const { return _gcsHeartbeatEnabled; }
     void setGcsHeartbeatEnabled(bool gcsHeartBeatEnabled);
 
+    bool timesyncEnabled(void) const { return _timesyncEnabled; }
+    void setTimesyncEnabled(bool timesyncEnabled);
+
     Vehicle* offlineEditingVehicle(void) { return _offlineEditingVehicle; }
 
     // Override from QGCTool
@@ -73,6 +81,9 @@ public:
 
     QGeoCoordinate lastKnownLocation    () { return _lastKnownLocation; }
 
+    RemoteIDScheduler* remoteIDScheduler(void) { return _remoteIDScheduler; }
+    RemoteIDObserver*  remoteIDObserver (void) { return _remoteIDObserver; }
+
 signals:
     void vehicleAdded                   (Vehicle* vehicle);
     void vehicleRemoved                 (Vehicle* vehicle);
@@ -80,7 +91,12 @@ signals:
     void parameterReadyVehicleAvailableChanged(bool parameterReadyVehicleAvailable);
     void activeVehicleChanged           (Vehicle* activeVehicle);
     void gcsHeartBeatEnabledChanged     (bool gcsHeartBeatEnabled);
+    void timesyncEnabledChanged         (bool timesyncEnabled);
     void lastKnownLocationChanged       ();
+
+    /// Every message received on any link, after the owning vehicle has handled it. For tools like the inspector which
+    /// need all traffic. Vehicles are not connected to this, they only get their own traffic through _routeMessage.
+    void messageTap                     (LinkInterface* link, const MAVLinkMessageRef& message);
 #ifndef DOXYGEN_SKIP
     void _deleteVehiclePhase2Signal     (void);
 #endif
@@ -91,9 +107,11 @@ private slots:
     void _setActiveVehiclePhase2        (void);
     void _vehicleParametersReadyChanged (bool parametersReady);
     void _sendGCSHeartbeat              (void);
+    void _sendTimesyncRequests          (void);
     void _vehicleHeartbeatInfo          (LinkInterface* link, int vehicleId, int componentId, int vehicleFirmwareType, int vehicleType);
     void _requestProtocolVersion        (unsigned version);
     void _coordinateChanged             (QGeoCoordinate coordinate);
+    void _routeMessage                  (LinkInterface* link, const MAVLinkMessageRef& message);
 
 private:
     bool _vehicleExists(int vehicleId);
@@ -109,16 +127,24 @@ private:
     QList<int>  _ignoreVehicleIds;          ///< List of vehicle id for which we ignore further communication
 
     QmlObjectListModel  _vehicles;
+    QHash<int, Vehicle*> _vehicleBySysId;           ///< Routing table for incoming messages
 
     FirmwarePluginManager*      _firmwarePluginManager;
     JoystickManager*            _joystickManager;
     MAVLinkProtocol*            _mavlinkProtocol;
     QGeoCoordinate              _lastKnownLocation;
+    RemoteIDScheduler*          _remoteIDScheduler;     ///< Drives Remote ID transmissions for all vehicles
+    RemoteIDObserver*           _remoteIDObserver;      ///< Other aircraft seen through Remote ID by any of the vehicles
 
     QTimer              _gcsHeartbeatTimer;             ///< Timer to emit heartbeats
     bool                _gcsHeartbeatEnabled;           ///< Enabled/disable heartbeat emission
     static const int    _gcsHeartbeatRateMSecs = 1000;  ///< Heartbeat rate
     static const char*  _gcsHeartbeatEnabledKey;
+
+    QTimer              _timesyncTimer;                 ///< Timer to send TIMESYNC requests
+    bool                _timesyncEnabled;               ///< Enable/disable TIMESYNC requests
+    static const int    _timesyncRateMSecs = 1000;      ///< TIMESYNC request rate
+    static const char*  _timesyncEnabledKey;
 };
 
 #endif
@@ -0,0 +1,69 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "RemoteIDAircraft.h"
+#include "QGC.h"
+
+#include <QtMath>
+
+RemoteIDAircraft::RemoteIDAircraft(const RemoteIDAircraftInfo_t& aircraftInfo, QObject* parent)
+    : QObject           (parent)
+    , _idOrMac          (aircraftInfo.idOrMac)
+    , _uasIDType        (0)
+    , _uaType           (0)
+    , _coordinate       (QGeoCoordinate(qQNaN(),qQNaN()))
+    , _altitude         (qQNaN())
+    , _heading          (qQNaN())
+    , _speed            (qQNaN())
+    , _lastUpdateMSecs  (0)
+{
+    update(aircraftInfo);
+}
+
+void RemoteIDAircraft::update(const RemoteIDAircraftInfo_t& aircraftInfo)
+{
+    if (aircraftInfo.availableFlags & BasicIDAvailable) {
+        if (aircraftInfo.uasID != _uasID || aircraftInfo.uaType != _uaType || aircraftInfo.uasIDType != _uasIDType) {
+            _uasID      = aircraftInfo.uasID;
+            _uasIDType  = aircraftInfo.uasIDType;
+            _uaType     = aircraftInfo.uaType;
+            emit uasIDChanged();
+        }
+    }
+    if (aircraftInfo.availableFlags & LocationAvailable) {
+        if (_coordinate != aircraftInfo.location) {
+            _coordinate = aircraftInfo.location;
+            emit coordinateChanged();
+        }
+    }
+    if (aircraftInfo.availableFlags & AltitudeAvailable) {
+        if (!QGC::fuzzyCompare(aircraftInfo.altitude, _altitude)) {
+            _altitude = aircraftInfo.altitude;
+            emit altitudeChanged();
+        }
+    }
+    if (aircraftInfo.availableFlags & HeadingAvailable) {
+        if (!QGC::fuzzyCompare(aircraftInfo.heading, _heading)) {
+            _heading = aircraftInfo.heading;
+            emit headingChanged();
+        }
+    }
+    if (aircraftInfo.availableFlags & SpeedAvailable) {
+        if (!QGC::fuzzyCompare(aircraftInfo.speed, _speed)) {
+            _speed = aircraftInfo.speed;
+            emit speedChanged();
+        }
+    }
+    if (aircraftInfo.availableFlags & OperatorAvailable) {
+        if (_operatorCoordinate != aircraftInfo.operatorLocation) {
+            _operatorCoordinate = aircraftInfo.operatorLocation;
+            emit operatorCoordinateChanged();
+        }
+    }
+}
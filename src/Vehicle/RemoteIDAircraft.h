@@ -0,0 +1,95 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QGeoCoordinate>
+#include <QElapsedTimer>
+
+#include "QGCMAVLink.h"
+
+/// Another aircraft whose Open Drone ID broadcast was relayed to us by a receive capable transponder
+class RemoteIDAircraft : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum {
+        BasicIDAvailable =      1 << 1,
+        LocationAvailable =     1 << 2,
+        AltitudeAvailable =     1 << 3,
+        HeadingAvailable =      1 << 4,
+        SpeedAvailable =        1 << 5,
+        OperatorAvailable =     1 << 6,
+    };
+
+    typedef struct {
+        QByteArray      idOrMac;            // Required, identifies the broadcasting aircraft
+        QString         uasID;
+        int             uasIDType;
+        int             uaType;
+        QGeoCoordinate  location;
+        double          altitude;
+        double          heading;
+        double          speed;
+        QGeoCoordinate  operatorLocation;
+        uint32_t        availableFlags;
+    } RemoteIDAircraftInfo_t;
+
+    RemoteIDAircraft(const RemoteIDAircraftInfo_t& aircraftInfo, QObject* parent);
+
+    Q_PROPERTY(QString          id                  READ id                 CONSTANT)
+    Q_PROPERTY(QString          uasID               READ uasID              NOTIFY uasIDChanged)
+    Q_PROPERTY(int              uaType              READ uaType             NOTIFY uasIDChanged)
+    Q_PROPERTY(QGeoCoordinate   coordinate          READ coordinate         NOTIFY coordinateChanged)
+    Q_PROPERTY(double           altitude            READ altitude           NOTIFY altitudeChanged)     // NaN for not available
+    Q_PROPERTY(double           heading             READ heading            NOTIFY headingChanged)      // NaN for not available
+    Q_PROPERTY(double           speed               READ speed              NOTIFY speedChanged)        // NaN for not available
+    Q_PROPERTY(QGeoCoordinate   operatorCoordinate  READ operatorCoordinate NOTIFY operatorCoordinateChanged)
+
+    QString         id                  (void) const { return QString::fromLatin1(_idOrMac.toHex()); }
+    QString         uasID               (void) const { return _uasID; }
+    int             uaType              (void) const { return _uaType; }
+    QGeoCoordinate  coordinate          (void) const { return _coordinate; }
+    double          altitude            (void) const { return _altitude; }
+    double          heading             (void) const { return _heading; }
+    double          speed               (void) const { return _speed; }
+    QGeoCoordinate  operatorCoordinate  (void) const { return _operatorCoordinate; }
+
+    const QByteArray& idOrMac(void) const { return _idOrMac; }
+
+    void update(const RemoteIDAircraftInfo_t& aircraftInfo);
+
+    /// Time of the last update, from the observer's monotonic clock
+    qint64 lastUpdateMSecs(void) const { return _lastUpdateMSecs; }
+    void setLastUpdateMSecs(qint64 lastUpdateMSecs) { _lastUpdateMSecs = lastUpdateMSecs; }
+
+signals:
+    void uasIDChanged               ();
+    void coordinateChanged          ();
+    void altitudeChanged            ();
+    void headingChanged             ();
+    void speedChanged               ();
+    void operatorCoordinateChanged  ();
+
+private:
+    QByteArray      _idOrMac;
+    QString         _uasID;
+    int             _uasIDType;
+    int             _uaType;
+    QGeoCoordinate  _coordinate;
+    double          _altitude;
+    double          _heading;
+    double          _speed;
+    QGeoCoordinate  _operatorCoordinate;
+    qint64          _lastUpdateMSecs;
+};
+
+Q_DECLARE_METATYPE(RemoteIDAircraft::RemoteIDAircraftInfo_t)
@@ -0,0 +1,405 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "RemoteIDFlightRecorder.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QtEndian>
+
+#include <string.h>
+
+QGC_LOGGING_CATEGORY(RemoteIDFlightRecorderLog, "RemoteIDFlightRecorderLog")
+
+const char* RemoteIDFlightRecorder::fileExtension   = "odid";
+const char  RemoteIDFlightRecorder::_fileMagic[8]   = { 'Q', 'G', 'C', 'O', 'D', 'I', 'D', 'R' };
+
+static_assert((RemoteIDFlightRecorder::ringCapacity & (RemoteIDFlightRecorder::ringCapacity - 1)) == 0, "ringCapacity must be a power of two");
+
+RemoteIDFlightRecorder::RemoteIDFlightRecorder(uint8_t systemId, QObject* parent)
+    : QThread   (parent)
+    , _systemId (systemId)
+    , _ring     (new Record_t[ringCapacity])
+{
+
+}
+
+RemoteIDFlightRecorder::~RemoteIDFlightRecorder()
+{
+    stopFlight();
+    {
+        // Queued flights are still written out before the thread exits
+        QMutexLocker locker(&_wakeMutex);
+        _quit = true;
+        _wakeCondition.wakeOne();
+    }
+    wait();
+    delete[] _ring;
+}
+
+void RemoteIDFlightRecorder::startFlight(const QString& directory)
+{
+    stopFlight();
+
+    const qint64 startUtcMSecs = QDateTime::currentMSecsSinceEpoch();
+    _fileName = QDir(directory).absoluteFilePath(QStringLiteral("RemoteID_%1_%2.%3")
+                                                 .arg(_systemId)
+                                                 .arg(QDateTime::fromMSecsSinceEpoch(startUtcMSecs).toString(QStringLiteral("yyyy-MM-dd_hh.mm.ss")))
+                                                 .arg(fileExtension));
+
+    // The ring carries on from where the previous flight left off, its tail may still be draining
+    _droppedCount.storeRelaxed(0);
+    _flightClock.start();
+    _flightActive = true;
+
+    Flight_t flight = { _fileName, startUtcMSecs, false, 0, 0 };
+    {
+        QMutexLocker locker(&_wakeMutex);
+        _flights.append(flight);
+        _wakeCondition.wakeOne();
+    }
+
+    qCDebug(RemoteIDFlightRecorderLog) << "Recording flight to" << _fileName;
+    if (!isRunning()) {
+        start(QThread::LowPriority);
+    }
+}
+
+void RemoteIDFlightRecorder::stopFlight(void)
+{
+    if (!_flightActive) {
+        return;
+    }
+    _flightActive = false;
+
+    // The recorder thread finishes writing in the background and signals flightFinished when done
+    QMutexLocker locker(&_wakeMutex);
+    Flight_t& flight    = _flights.last();
+    flight.stopped      = true;
+    flight.endHead      = _head.loadRelaxed();
+    flight.droppedCount = _droppedCount.loadRelaxed();
+    _wakeCondition.wakeOne();
+}
+
+void RemoteIDFlightRecorder::record(const mavlink_message_t& message)
+{
+    if (!_flightActive) {
+        return;
+    }
+
+    const quint32 head = _head.loadRelaxed();
+    const quint32 tail = _tail.loadAcquire();
+    if (head - tail >= static_cast<quint32>(ringCapacity)) {
+        // Recorder thread is behind, losing the newest message is better than blocking the sender
+        _droppedCount.fetchAndAddRelaxed(1);
+        return;
+    }
+
+    Record_t& slot      = _ring[head & (ringCapacity - 1)];
+    slot.timestampUSecs = _flightClock.nsecsElapsed() / 1000;
+    slot.msgId          = message.msgid;
+    slot.payloadLength  = message.len;
+    memcpy(slot.payload, _MAV_PAYLOAD(&message), message.len);
+    _head.storeRelease(head + 1);
+
+    if (head + 1 - tail >= static_cast<quint32>(ringCapacity / 2)) {
+        QMutexLocker locker(&_wakeMutex);
+        _wakeCondition.wakeOne();
+    }
+}
+
+void RemoteIDFlightRecorder::run(void)
+{
+    forever {
+        Flight_t flight;
+        {
+            QMutexLocker locker(&_wakeMutex);
+            while (_flights.isEmpty() && !_quit) {
+                _wakeCondition.wait(&_wakeMutex);
+            }
+            if (_flights.isEmpty()) {
+                return;
+            }
+            flight = _flights.first();
+        }
+
+        _recordFlight(flight);
+    }
+}
+
+// Writes out the oldest queued flight and removes it from the queue once its last record is on disk
+void RemoteIDFlightRecorder::_recordFlight(const Flight_t& flight)
+{
+    QFile   file(flight.fileName);
+    bool    fileOk = file.open(QIODevice::WriteOnly) && _writeHeader(file, flight.startUtcMSecs);
+
+    if (!fileOk) {
+        qCWarning(RemoteIDFlightRecorderLog) << "Unable to create flight recording" << flight.fileName << file.errorString();
+    }
+
+    quint32 end;
+    bool    active;
+    do {
+        active = _waitForWork(end);
+        if (fileOk) {
+            if (_drain(file, end)) {
+                file.flush();
+            }
+        } else {
+            // Keep draining so the ring does not fill up and count everything as dropped
+            _tail.storeRelease(end);
+        }
+    } while (active);
+
+    quint32 droppedCount;
+    {
+        QMutexLocker locker(&_wakeMutex);
+        droppedCount = _flights.first().droppedCount;
+        _flights.removeFirst();
+    }
+
+    if (!fileOk) {
+        emit flightFinished(QString());
+        return;
+    }
+    file.close();
+
+    if (droppedCount) {
+        qCWarning(RemoteIDFlightRecorderLog) << "Ring overflow, messages not recorded:" << droppedCount << flight.fileName;
+    }
+    qCDebug(RemoteIDFlightRecorderLog) << "Flight recording complete" << flight.fileName;
+    emit flightFinished(flight.fileName);
+}
+
+// Sleeps until the ring needs draining or the flush interval is up, then sets end to the ring position the current flight
+// can be drained up to. Returns false once the flight has been stopped, end is then the last record of the flight. The
+// stop is checked while holding the mutex, so a stop which comes in just before the wait is never missed.
+bool RemoteIDFlightRecorder::_waitForWork(quint32& end)
+{
+    QMutexLocker locker(&_wakeMutex);
+
+    if (!_flights.first().stopped) {
+        _wakeCondition.wait(&_wakeMutex, _flushIntervalMSecs);
+    }
+
+    // Records past the end of a stopped flight belong to the next one
+    const Flight_t& flight = _flights.first();
+    end = flight.stopped ? flight.endHead : _head.loadAcquire();
+
+    return !flight.stopped;
+}
+
+bool RemoteIDFlightRecorder::_writeHeader(QFile& file, qint64 startUtcMSecs)
+{
+    uint8_t header[_fileHeaderSize];
+
+    memcpy(header, _fileMagic, sizeof(_fileMagic));
+    header[8] = _fileVersion;
+    header[9] = _systemId;
+    qToLittleEndian<qint64>(startUtcMSecs, &header[10]);
+
+    return file.write(reinterpret_cast<const char*>(header), _fileHeaderSize) == _fileHeaderSize;
+}
+
+// Writes out everything between tail and end. Returns true if anything was written.
+bool RemoteIDFlightRecorder::_drain(QFile& file, quint32 end)
+{
+    quint32 tail = _tail.loadRelaxed();
+
+    if (tail == end) {
+        return false;
+    }
+
+    uint8_t buffer[_recordHeaderSize + MAVLINK_MAX_PAYLOAD_LEN];
+    while (tail != end) {
+        const Record_t& slot = _ring[tail & (ringCapacity - 1)];
+
+        qToLittleEndian<qint64>(slot.timestampUSecs, &buffer[0]);
+        qToLittleEndian<quint32>(slot.msgId, &buffer[8]);
+        buffer[12] = slot.payloadLength;
+        memcpy(&buffer[_recordHeaderSize], slot.payload, slot.payloadLength);
+
+        const qint64 recordSize = _recordHeaderSize + slot.payloadLength;
+        if (file.write(reinterpret_cast<const char*>(buffer), recordSize) != recordSize) {
+            qCWarning(RemoteIDFlightRecorderLog) << "Flight recording write failed" << file.errorString();
+        }
+
+        // Hand the slot back straight away so a long drain does not cause drops
+        _tail.storeRelease(++tail);
+    }
+
+    return true;
+}
+
+bool RemoteIDFlightRecorder::_readRecording(const QString& recordingFile, uint8_t& systemId, qint64& startUtcMSecs, QList<ExportRecord_t>& records, QString& errorString)
+{
+    QFile file(recordingFile);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorString = QObject::tr("Unable to open %1: %2").arg(recordingFile, file.errorString());
+        return false;
+    }
+
+    const QByteArray bytes = file.readAll();
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(bytes.constData());
+
+    if (bytes.size() < _fileHeaderSize || memcmp(data, _fileMagic, sizeof(_fileMagic)) != 0) {
+        errorString = QObject::tr("%1 is not a RemoteID flight recording").arg(recordingFile);
+        return false;
+    }
+    if (data[8] != _fileVersion) {
+        errorString = QObject::tr("%1 has unsupported version %2").arg(recordingFile).arg(static_cast<int>(data[8]));
+        return false;
+    }
+    systemId        = data[9];
+    startUtcMSecs   = qFromLittleEndian<qint64>(&data[10]);
+
+    int offset = _fileHeaderSize;
+    while (offset + _recordHeaderSize <= bytes.size()) {
+        ExportRecord_t record;
+        record.timestampUSecs   = qFromLittleEndian<qint64>(&data[offset]);
+        record.msgId            = qFromLittleEndian<quint32>(&data[offset + 8]);
+        const int payloadLength = data[offset + 12];
+
+        offset += _recordHeaderSize;
+        if (offset + payloadLength > bytes.size()) {
+            // Truncated final record, most likely the application went down mid flight
+            qCWarning(RemoteIDFlightRecorderLog) << "Truncated record at end of" << recordingFile;
+            break;
+        }
+        record.payload = bytes.mid(offset, payloadLength);
+        offset += payloadLength;
+
+        records.append(record);
+    }
+
+    return true;
+}
+
+QString RemoteIDFlightRecorder::_messageName(uint32_t msgId)
+{
+    switch (msgId) {
+    case MAVLINK_MSG_ID_OPEN_DRONE_ID_BASIC_ID:
+        return QStringLiteral("OPEN_DRONE_ID_BASIC_ID");
+    case MAVLINK_MSG_ID_OPEN_DRONE_ID_LOCATION:
+        return QStringLiteral("OPEN_DRONE_ID_LOCATION");
+    case MAVLINK_MSG_ID_OPEN_DRONE_ID_AUTHENTICATION:
+        return QStringLiteral("OPEN_DRONE_ID_AUTHENTICATION");
+    case MAVLINK_MSG_ID_OPEN_DRONE_ID_SELF_ID:
+        return QStringLiteral("OPEN_DRONE_ID_SELF_ID");
+    case MAVLINK_MSG_ID_OPEN_DRONE_ID_SYSTEM:
+        return QStringLiteral("OPEN_DRONE_ID_SYSTEM");
+    case MAVLINK_MSG_ID_OPEN_DRONE_ID_OPERATOR_ID:
+        return QStringLiteral("OPEN_DRONE_ID_OPERATOR_ID");
+    case MAVLINK_MSG_ID_OPEN_DRONE_ID_MESSAGE_PACK:
+        return QStringLiteral("OPEN_DRONE_ID_MESSAGE_PACK");
+    case MAVLINK_MSG_ID_OPEN_DRONE_ID_SYSTEM_UPDATE:
+        return QStringLiteral("OPEN_DRONE_ID_SYSTEM_UPDATE");
+    default:
+        return QString::number(msgId);
+    }
+}
+
+bool RemoteIDFlightRecorder::exportToCSV(const QString& recordingFile, const QString& csvFile, QString& errorString)
+{
+    uint8_t                 systemId;
+    qint64                  startUtcMSecs;
+    QList<ExportRecord_t>   records;
+
+    if (!_readRecording(recordingFile, systemId, startUtcMSecs, records, errorString)) {
+        return false;
+    }
+
+    QFile file(csvFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+        errorString = QObject::tr("Unable to create %1: %2").arg(csvFile, file.errorString());
+        return false;
+    }
+
+    QTextStream stream(&file);
+    stream << "system_id,time_usecs,utc,message_id,message,payload\n";
+    for (const ExportRecord_t& record : records) {
+        stream << static_cast<int>(systemId) << ','
+               << record.timestampUSecs << ','
+               << QDateTime::fromMSecsSinceEpoch(startUtcMSecs + record.timestampUSecs / 1000, Qt::UTC).toString(Qt::ISODateWithMs) << ','
+               << record.msgId << ','
+               << _messageName(record.msgId) << ','
+               << record.payload.toHex() << '\n';
+    }
+
+    return true;
+}
+
+bool RemoteIDFlightRecorder::exportToJSON(const QString& recordingFile, const QString& jsonFile, QString& errorString)
+{
+    uint8_t                 systemId;
+    qint64                  startUtcMSecs;
+    QList<ExportRecord_t>   records;
+
+    if (!_readRecording(recordingFile, systemId, startUtcMSecs, records, errorString)) {
+        return false;
+    }
+
+    QJsonArray jsonMessages;
+    for (const ExportRecord_t& record : records) {
+        QJsonObject jsonMessage;
+        jsonMessage[QStringLiteral("timeUSecs")]    = record.timestampUSecs;
+        jsonMessage[QStringLiteral("utc")]          = QDateTime::fromMSecsSinceEpoch(startUtcMSecs + record.timestampUSecs / 1000, Qt::UTC).toString(Qt::ISODateWithMs);
+        jsonMessage[QStringLiteral("messageId")]    = static_cast<qint64>(record.msgId);
+        jsonMessage[QStringLiteral("message")]      = _messageName(record.msgId);
+        jsonMessage[QStringLiteral("payload")]      = QString::fromLatin1(record.payload.toHex());
+        jsonMessages.append(jsonMessage);
+    }
+
+    QJsonObject jsonRoot;
+    jsonRoot[QStringLiteral("version")]     = static_cast<int>(_fileVersion);
+    jsonRoot[QStringLiteral("systemId")]    = static_cast<int>(systemId);
+    jsonRoot[QStringLiteral("startUtc")]    = QDateTime::fromMSecsSinceEpoch(startUtcMSecs, Qt::UTC).toString(Qt::ISODateWithMs);
+    jsonRoot[QStringLiteral("messages")]    = jsonMessages;
+
+    QFile file(jsonFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        errorString = QObject::tr("Unable to create %1: %2").arg(jsonFile, file.errorString());
+        return false;
+    }
+    if (file.write(QJsonDocument(jsonRoot).toJson()) == -1) {
+        errorString = QObject::tr("Unable to write %1: %2").arg(jsonFile, file.errorString());
+        return false;
+    }
+
+    return true;
+}
+
+int RemoteIDFlightRecorder::runCommandLine(const QString& recordingFiles, const QString& outputDir)
+{
+    int failureCount = 0;
+
+    for (const QString& recordingFile : recordingFiles.split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+        QString         errorString;
+        const QString   baseFile = QDir(outputDir.isEmpty() ? QFileInfo(recordingFile).absolutePath() : outputDir).absoluteFilePath(QFileInfo(recordingFile).completeBaseName());
+        const QString   csvFile  = baseFile + QStringLiteral(".csv");
+        const QString   jsonFile = baseFile + QStringLiteral(".json");
+
+        if (exportToCSV(recordingFile, csvFile, errorString) && exportToJSON(recordingFile, jsonFile, errorString)) {
+            qInfo().noquote() << QStringLiteral("%1 -> %2, %3").arg(recordingFile, csvFile, jsonFile);
+        } else {
+            qWarning().noquote() << errorString;
+            failureCount++;
+        }
+    }
+
+    return failureCount ? 1 : 0;
+}
@@ -0,0 +1,123 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QThread>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QList>
+
+#include "QGCLoggingCategory.h"
+#include "QGCMAVLink.h"
+
+Q_DECLARE_LOGGING_CATEGORY(RemoteIDFlightRecorderLog)
+
+class QFile;
+
+/// Compliance record of the Open Drone ID messages sent to the transponder. Messages are copied into a fixed size ring on
+/// the GUI thread and the recorder thread writes them out to a binary file, one per flight. The ring is allocated once up
+/// front, so recording a message never allocates and never touches the disk on the GUI thread. Flights are queued on the
+/// one recorder thread, so a new flight can start while the previous one is still being written out.
+///
+/// File layout, all values little endian:
+///     Header: magic "QGCODIDR", uint8 version, uint8 system id, int64 flight start UTC msecs
+///     Record: int64 monotonic usecs since flight start, uint32 message id, uint8 payload length, payload
+class RemoteIDFlightRecorder : public QThread
+{
+    Q_OBJECT
+
+public:
+    RemoteIDFlightRecorder(uint8_t systemId, QObject* parent = nullptr);
+    ~RemoteIDFlightRecorder();
+
+    /// Starts recording to a new file in directory. A flight which is already being recorded is finished first. Returns
+    /// straight away, the new file is created once the recorder thread has written out the previous flight.
+    void startFlight(const QString& directory);
+
+    /// Asks the recorder thread to flush everything still in the ring and close the file. Returns straight away,
+    /// flightFinished is signalled once the file is complete.
+    void stopFlight(void);
+
+    bool    flightActive    (void) const { return _flightActive; }
+    QString fileName        (void) const { return _fileName; }
+    quint32 droppedCount    (void) const { return _droppedCount.loadRelaxed(); }   ///< Messages lost to a full ring this flight
+
+    /// Copies message into the ring. Must be called from the thread which owns the recorder.
+    void record(const mavlink_message_t& message);
+
+    static bool exportToCSV (const QString& recordingFile, const QString& csvFile, QString& errorString);
+    static bool exportToJSON(const QString& recordingFile, const QString& jsonFile, QString& errorString);
+
+    /// Runs a headless export of each of the comma separated recordingFiles to a csv and a json file in outputDir
+    /// @return Process exit code
+    static int runCommandLine(const QString& recordingFiles, const QString& outputDir);
+
+    static const int        ringCapacity = 1024;    ///< Must be a power of two. Several minutes of traffic at the 1Hz send rate.
+    static const char*      fileExtension;
+
+signals:
+    /// Signalled from the recorder thread once a flight has been written out
+    /// @param fileName Completed recording, empty if the file could not be created
+    void flightFinished(const QString& fileName);
+
+protected:
+    // QThread override
+    void run(void) final;
+
+private:
+    typedef struct {
+        qint64      timestampUSecs;
+        uint32_t    msgId;
+        uint8_t     payloadLength;
+        uint8_t     payload[MAVLINK_MAX_PAYLOAD_LEN];
+    } Record_t;
+
+    typedef struct {
+        qint64      timestampUSecs;
+        uint32_t    msgId;
+        QByteArray  payload;
+    } ExportRecord_t;
+
+    typedef struct {
+        QString     fileName;
+        qint64      startUtcMSecs;
+        bool        stopped;
+        quint32     endHead;        ///< Ring position the flight ends at, valid once stopped
+        quint32     droppedCount;   ///< Valid once stopped
+    } Flight_t;
+
+    void            _recordFlight   (const Flight_t& flight);
+    bool            _waitForWork    (quint32& end);
+    bool            _writeHeader    (QFile& file, qint64 startUtcMSecs);
+    bool            _drain          (QFile& file, quint32 end);
+    static bool     _readRecording  (const QString& recordingFile, uint8_t& systemId, qint64& startUtcMSecs, QList<ExportRecord_t>& records, QString& errorString);
+    static QString  _messageName    (uint32_t msgId);
+
+    uint8_t                 _systemId;
+    QString                 _fileName;
+    bool                    _flightActive   = false;
+    QElapsedTimer           _flightClock;
+    Record_t*               _ring;
+    QAtomicInteger<quint32> _head;                  ///< Next slot to fill, only advanced by the owning thread
+    QAtomicInteger<quint32> _tail;                  ///< Next slot to write out, only advanced by the recorder thread
+    QAtomicInteger<quint32> _droppedCount;
+    QList<Flight_t>         _flights;               ///< Flights not yet written out, the active one last. Guarded by _wakeMutex.
+    bool                    _quit           = false;
+    QMutex                  _wakeMutex;
+    QWaitCondition          _wakeCondition;
+
+    static const uint8_t    _fileVersion            = 1;
+    static const int        _fileHeaderSize         = 8 + 1 + 1 + 8;
+    static const int        _recordHeaderSize       = 8 + 4 + 1;
+    static const int        _flushIntervalMSecs     = 1000;
+    static const char       _fileMagic[8];
+};
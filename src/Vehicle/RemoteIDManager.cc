@@ -13,6 +13,11 @@
 #include "RemoteIDSettings.h"
 #include "QGCQGeoCoordinate.h"
 #include "PositionManager.h"
+#include "MultiVehicleManager.h"
+#include "RemoteIDScheduler.h"
+#include "RemoteIDObserver.h"
+#include "RemoteIDFlightRecorder.h"
+#include "AppSettings.h"
 
 #include <QDebug>
 
@@ -23,13 +28,83 @@ QGC_LOGGING_CATEGORY(RemoteIDManagerLog, "RemoteIDManagerLog")
 #define AREA_RADIUS 0
 #define SENDING_RATE_MSEC 1000
 #define ALLOWED_GPS_DELAY 1000
-#define HEARTBEAT_TIMEOUT 5000
+
+// ASTM F3411 wire format used inside OPEN_DRONE_ID_MESSAGE_PACK
+#define ODID_PROTOCOL_VERSION       2
+#define ODID_MESSAGE_TYPE_BASIC_ID  0x0
+#define ODID_MESSAGE_TYPE_SELF_ID   0x3
+#define ODID_MESSAGE_TYPE_SYSTEM    0x4
+#define ODID_MESSAGE_TYPE_OPERATOR  0x5
+
+static void _odidPutLE16(uint8_t* dest, uint16_t value)
+{
+    dest[0] = static_cast<uint8_t>(value & 0xFF);
+    dest[1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+}
+
+static void _odidPutLE32(uint8_t* dest, uint32_t value)
+{
+    _odidPutLE16(dest,      static_cast<uint16_t>(value & 0xFFFF));
+    _odidPutLE16(dest + 2,  static_cast<uint16_t>((value >> 16) & 0xFFFF));
+}
+
+// Altitudes are encoded in 0.5m steps with a -1000m offset. -1000 means invalid/unknown
+static uint16_t _odidEncodeAltitude(float altitude)
+{
+    if (altitude <= -1000.0f) {
+        return 0;
+    }
+    float encoded = (altitude + 1000.0f) / 0.5f;
+    return encoded >= 65535.0f ? 65535 : static_cast<uint16_t>(encoded);
+}
+
+static uint8_t _odidHeader(uint8_t messageType)
+{
+    return static_cast<uint8_t>((messageType << 4) | ODID_PROTOCOL_VERSION);
+}
+
+static void _odidEncodeBasicID(const mavlink_open_drone_id_basic_id_t& basicID, uint8_t* encoded)
+{
+    encoded[0] = _odidHeader(ODID_MESSAGE_TYPE_BASIC_ID);
+    encoded[1] = static_cast<uint8_t>(((basicID.id_type & 0x0F) << 4) | (basicID.ua_type & 0x0F));
+    memcpy(&encoded[2], basicID.uas_id, sizeof(basicID.uas_id));
+}
+
+static void _odidEncodeSelfID(const mavlink_open_drone_id_self_id_t& selfID, uint8_t* encoded)
+{
+    encoded[0] = _odidHeader(ODID_MESSAGE_TYPE_SELF_ID);
+    encoded[1] = selfID.description_type;
+    memcpy(&encoded[2], selfID.description, sizeof(selfID.description));
+}
+
+static void _odidEncodeOperatorID(const mavlink_open_drone_id_operator_id_t& operatorID, uint8_t* encoded)
+{
+    encoded[0] = _odidHeader(ODID_MESSAGE_TYPE_OPERATOR);
+    encoded[1] = operatorID.operator_id_type;
+    memcpy(&encoded[2], operatorID.operator_id, sizeof(operatorID.operator_id));
+}
+
+static void _odidEncodeSystem(const mavlink_open_drone_id_system_t& system, uint8_t* encoded)
+{
+    encoded[0] = _odidHeader(ODID_MESSAGE_TYPE_SYSTEM);
+    encoded[1] = static_cast<uint8_t>(((system.classification_type & 0x07) << 2) | (system.operator_location_type & 0x03));
+    _odidPutLE32(&encoded[2], static_cast<uint32_t>(system.operator_latitude));
+    _odidPutLE32(&encoded[6], static_cast<uint32_t>(system.operator_longitude));
+    _odidPutLE16(&encoded[10], system.area_count);
+    encoded[12] = static_cast<uint8_t>(qMin(system.area_radius / 10, 255)); // Encoded in 10m steps
+    _odidPutLE16(&encoded[13], _odidEncodeAltitude(system.area_ceiling));
+    _odidPutLE16(&encoded[15], _odidEncodeAltitude(system.area_floor));
+    encoded[17] = static_cast<uint8_t>(((system.category_eu & 0x0F) << 4) | (system.class_eu & 0x0F));
+    _odidPutLE16(&encoded[18], _odidEncodeAltitude(system.operator_altitude_geo));
+    _odidPutLE32(&encoded[20], system.timestamp);
+}
 
 RemoteIDManager::RemoteIDManager(Vehicle* vehicle)
     : QObject               (vehicle)
     , _mavlink              (nullptr)
     , _vehicle              (vehicle)
     , _settings             (nullptr)
+    , _flightRecorder       (nullptr)
     , _armStatusGood        (false)
     , _commsGood            (false)
     , _gcsGPSGood           (false)
@@ -38,27 +113,115 @@ RemoteIDManager::RemoteIDManager(Vehicle* vehicle)
     , _emergencyDeclared    (false)
     , _targetSystem         (0) // By default 0 means broadcast
     , _targetComponent      (0) // By default 0 means broadcast
+    , _messageCacheDirty    (true)
+    , _cachedEnable         (false)
+    , _cachedSendSelfID     (false)
+    , _cachedSendOperatorID (false)
+    , _cachedRegion         (Region::FAA)
+    , _cachedLocationType   (LocationTypes::LiveGNSS)
+    , _cachedFixedPositionValid (false)
+    , _cachedSystemMinInterval  (200)
+    , _cachedSystemMaxInterval  (SENDING_RATE_MSEC)
+    , _cachedSystemMovementThreshold(1.0)
+    , _cachedObserverMode   (false)
+    , _cachedSendMessagePack(false)
+    , _transponderSupportsMessagePack(false)
 {
     _mavlink = qgcApp()->toolbox()->mavlinkProtocol();
     _settings = qgcApp()->toolbox()->settingsManager()->remoteIDSettings();
     _positionManager = qgcApp()->toolbox()->qgcPositionManager();
 
-    // Timer to track a healthy RID device. When expired we let the operator know
-    _heartbeatTimeoutTimer.setSingleShot(true);
-    _heartbeatTimeoutTimer.setInterval(HEARTBEAT_TIMEOUT);
-    connect(&_heartbeatTimeoutTimer, &QTimer::timeout, this, &RemoteIDManager::_heartbeatTimeout);
-
-    // Timer to send messages at a constant rate
-    _sendMessagesTimer.setInterval(SENDING_RATE_MSEC);
-    connect(&_sendMessagesTimer, &QTimer::timeout, this, &RemoteIDManager::_sendMessages);
+    // Periodic sends, SYSTEM keep alive and the RID device heartbeat timeout are all driven by the fleet wide scheduler
+    _scheduler = qgcApp()->toolbox()->multiVehicleManager()->remoteIDScheduler();
+    _scheduler->addManager(this);
+    _observer = qgcApp()->toolbox()->multiVehicleManager()->remoteIDObserver();
 
     // GCS GPS position updates to track the health of the GPS data
     connect(_positionManager, &QGCPositionManager::positionInfoUpdated, this, &RemoteIDManager::_updateLastGCSPositionInfo);
 
+    // Any change to the settings which end up in the ODID payloads invalidates the pre-packed messages
+    const QList<Fact*> cachedFacts = {
+        _settings->enable(),
+        _settings->operatorID(),
+        _settings->operatorIDType(),
+        _settings->sendOperatorID(),
+        _settings->selfIDFree(),
+        _settings->selfIDEmergency(),
+        _settings->selfIDExtended(),
+        _settings->selfIDType(),
+        _settings->sendSelfID(),
+        _settings->uasID(),
+        _settings->uasIDType(),
+        _settings->uasType(),
+        _settings->region(),
+        _settings->locationType(),
+        _settings->latitudeFixed(),
+        _settings->longitudeFixed(),
+        _settings->altitudeFixed(),
+        _settings->classificationType(),
+        _settings->categoryEU(),
+        _settings->classEU(),
+        _settings->sendMessagePack(),
+        _settings->systemMinInterval(),
+        _settings->systemMaxInterval(),
+        _settings->systemMovementThreshold(),
+        _settings->observerMode(),
+    };
+    for (Fact* fact : cachedFacts) {
+        connect(fact, &Fact::rawValueChanged, this, &RemoteIDManager::_invalidateMessageCache);
+    }
+
+    // A new recording is started for each flight
+    connect(_vehicle, &Vehicle::armedChanged, this, &RemoteIDManager::_updateFlightRecorder);
+    connect(_settings->flightRecorder(), &Fact::rawValueChanged, this, &RemoteIDManager::_updateFlightRecorder);
+
+    memset(&_basicIDCache,      0, sizeof(_basicIDCache));
+    memset(&_selfIDCache,       0, sizeof(_selfIDCache));
+    memset(&_operatorIDCache,   0, sizeof(_operatorIDCache));
+    memset(&_systemCache,       0, sizeof(_systemCache));
+
     // Set first position for the live gps
     _setInitialPosition();
 }
 
+RemoteIDManager::~RemoteIDManager()
+{
+    if (_scheduler) {
+        _scheduler->removeManager(this);
+    }
+    // Make sure the end of the flight makes it to disk
+    if (_flightRecorder) {
+        _flightRecorder->stopFlight();
+    }
+}
+
+void RemoteIDManager::_sendODIDMessage(LinkInterface* link, const mavlink_message_t& message)
+{
+    if (_flightRecorder) {
+        _flightRecorder->record(message);
+    }
+    _vehicle->sendMessageOnLinkThreadSafe(link, message);
+}
+
+void RemoteIDManager::_updateFlightRecorder()
+{
+    bool recordFlight = _settings->flightRecorder()->rawValue().toBool() && _vehicle->armed() && !_vehicle->isOfflineEditingVehicle();
+
+    if (recordFlight && !(_flightRecorder && _flightRecorder->flightActive())) {
+        QString logSavePath = qgcApp()->toolbox()->settingsManager()->appSettings()->logSavePath();
+        if (logSavePath.isEmpty()) {
+            qCWarning(RemoteIDManagerLog) << "No log save path, RemoteID flight will not be recorded";
+            return;
+        }
+        if (!_flightRecorder) {
+            _flightRecorder = new RemoteIDFlightRecorder(static_cast<uint8_t>(_vehicle->id()), this);
+        }
+        _flightRecorder->startFlight(logSavePath);
+    } else if (!recordFlight && _flightRecorder && _flightRecorder->flightActive()) {
+        _flightRecorder->stopFlight();
+    }
+}
+
 void RemoteIDManager::mavlinkMessageReceived(mavlink_message_t& message )
 {
     switch (message.msgid)
@@ -68,6 +231,16 @@ void RemoteIDManager::mavlinkMessageReceived(mavlink_message_t& message )
         break;
     case MAVLINK_MSG_ID_OPEN_DRONE_ID_ARM_STATUS: 
         _handleArmStatus(message);
+        break;
+    case MAVLINK_MSG_ID_OPEN_DRONE_ID_LOCATION:
+        _handleObservedLocation(message);
+        break;
+    case MAVLINK_MSG_ID_OPEN_DRONE_ID_BASIC_ID:
+        _handleObservedBasicID(message);
+        break;
+    case MAVLINK_MSG_ID_OPEN_DRONE_ID_SYSTEM:
+        _handleObservedSystem(message);
+        break;
     default:
         break;
     }
@@ -86,20 +259,22 @@ void RemoteIDManager::_handleHeartBeat(mavlink_message_t& message)
     // We set the targetsystem
     if (_targetSystem != message.sysid) {
         _targetSystem = message.sysid;
+        _invalidateMessageCache();
         qCDebug(RemoteIDManagerLog) << "We subscribe to the ODID coming from system " << _targetSystem;
     }
 
     if (!_commsGood) {
         _commsGood = true;
-        _sendMessagesTimer.start(); // We start sending our own messages
+        _scheduler->scheduleSystem(this, 0); // First SYSTEM goes out straight away, the rest follow position updates
         checkBasicID(); // We check if basicID is good to send 
         checkOperatorID(); // We check if OperatorID is good in case we want to send it from start because of the settings
+        _queryMessagePackSupport(message.compid); // May be a different device than the last time we had comms
         emit commsGoodChanged();
         qCDebug(RemoteIDManagerLog) << "We are receiving heartbeat from RID device.";
     }
 
-    // We restart the timeout timer
-    _heartbeatTimeoutTimer.start();
+    // The scheduler starts sending our own messages and restarts the heartbeat timeout
+    _scheduler->heartbeatReceived(this);
 
 }
 
@@ -107,11 +282,132 @@ void RemoteIDManager::_handleHeartBeat(mavlink_message_t& message)
 void RemoteIDManager::_heartbeatTimeout()
 {
     _commsGood = false;
-    _sendMessagesTimer.stop(); // We stop sending messages if the communication with the RID device is down
+    // The transponder may come back as a different device, its support is asked for again on reconnect
+    _transponderSupportsMessagePack = false;
+    // The scheduler stops sending messages if the communication with the RID device is down
     emit commsGoodChanged();
     qCDebug(RemoteIDManagerLog) << "We stopped receiving heartbeat from RID device.";
 }
 
+// There is no capability bit for message packs, so the transponder is asked directly. A device which implements
+// OPEN_DRONE_ID_MESSAGE_PACK accepts a request for it, anything else means individual messages.
+void RemoteIDManager::_queryMessagePackSupport(uint8_t transponderComponentId)
+{
+    _transponderSupportsMessagePack = false;
+    _vehicle->sendMavCommandWithHandler(_messagePackSupportResultHandler,
+                                        this,
+                                        transponderComponentId,
+                                        MAV_CMD_REQUEST_MESSAGE,
+                                        MAVLINK_MSG_ID_OPEN_DRONE_ID_MESSAGE_PACK);
+}
+
+void RemoteIDManager::_messagePackSupportResultHandler(void* resultHandlerData, int /*compId*/, MAV_RESULT commandResult, uint8_t /*progress*/, Vehicle::MavCmdResultFailureCode_t /*failureCode*/)
+{
+    RemoteIDManager* remoteIDManager = static_cast<RemoteIDManager*>(resultHandlerData);
+
+    // The transponder may have gone away while the request was outstanding
+    if (commandResult == MAV_RESULT_ACCEPTED && remoteIDManager->_commsGood) {
+        remoteIDManager->_transponderSupportsMessagePack = true;
+        qCDebug(RemoteIDManagerLog) << "RID device supports OPEN_DRONE_ID_MESSAGE_PACK, switching to message pack transmission.";
+    }
+}
+
+// Messages about other aircraft are relayed by our RID device with the id_or_mac of the broadcasting aircraft filled in.
+// Our own ODID traffic always leaves id_or_mac empty.
+bool RemoteIDManager::_isObservedMessage(const mavlink_message_t& message, const uint8_t* idOrMac)
+{
+    if (message.compid < MAV_COMP_ID_ODID_TXRX_1 || message.compid > MAV_COMP_ID_ODID_TXRX_3 || _vehicle->id() != message.sysid) {
+        return false;
+    }
+
+    if (_messageCacheDirty) {
+        _rebuildMessageCache();
+    }
+    if (!_cachedObserverMode || !_observer) {
+        return false;
+    }
+
+    for (int i=0; i<MAVLINK_MSG_OPEN_DRONE_ID_BASIC_ID_FIELD_ID_OR_MAC_LEN; i++) {
+        if (idOrMac[i] != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void RemoteIDManager::_handleObservedLocation(mavlink_message_t& message)
+{
+    mavlink_open_drone_id_location_t location;
+
+    mavlink_msg_open_drone_id_location_decode(&message, &location);
+    if (!_isObservedMessage(message, location.id_or_mac)) {
+        return;
+    }
+
+    RemoteIDAircraft::RemoteIDAircraftInfo_t aircraftInfo;
+    aircraftInfo.idOrMac        = QByteArray(reinterpret_cast<const char*>(location.id_or_mac), sizeof(location.id_or_mac));
+    aircraftInfo.availableFlags = 0;
+
+    // Lat/lon of 0 means not available
+    if (location.latitude != 0 || location.longitude != 0) {
+        aircraftInfo.location = QGeoCoordinate(location.latitude / 1.0e7, location.longitude / 1.0e7);
+        aircraftInfo.availableFlags |= RemoteIDAircraft::LocationAvailable;
+    }
+    if (location.altitude_geodetic > -1000.0f) {
+        aircraftInfo.altitude = static_cast<double>(location.altitude_geodetic);
+        aircraftInfo.availableFlags |= RemoteIDAircraft::AltitudeAvailable;
+    }
+    if (location.direction <= 36000) {
+        aircraftInfo.heading = location.direction / 100.0;
+        aircraftInfo.availableFlags |= RemoteIDAircraft::HeadingAvailable;
+    }
+    if (location.speed_horizontal < 25500) {
+        aircraftInfo.speed = location.speed_horizontal / 100.0;
+        aircraftInfo.availableFlags |= RemoteIDAircraft::SpeedAvailable;
+    }
+
+    _observer->aircraftUpdate(aircraftInfo);
+}
+
+void RemoteIDManager::_handleObservedBasicID(mavlink_message_t& message)
+{
+    mavlink_open_drone_id_basic_id_t basicID;
+
+    mavlink_msg_open_drone_id_basic_id_decode(&message, &basicID);
+    if (!_isObservedMessage(message, basicID.id_or_mac)) {
+        return;
+    }
+
+    RemoteIDAircraft::RemoteIDAircraftInfo_t aircraftInfo;
+    aircraftInfo.idOrMac        = QByteArray(reinterpret_cast<const char*>(basicID.id_or_mac), sizeof(basicID.id_or_mac));
+    aircraftInfo.uasID          = QString::fromLatin1(reinterpret_cast<const char*>(basicID.uas_id), static_cast<int>(qstrnlen(reinterpret_cast<const char*>(basicID.uas_id), sizeof(basicID.uas_id))));
+    aircraftInfo.uasIDType      = basicID.id_type;
+    aircraftInfo.uaType         = basicID.ua_type;
+    aircraftInfo.availableFlags = RemoteIDAircraft::BasicIDAvailable;
+
+    _observer->aircraftUpdate(aircraftInfo);
+}
+
+void RemoteIDManager::_handleObservedSystem(mavlink_message_t& message)
+{
+    mavlink_open_drone_id_system_t system;
+
+    mavlink_msg_open_drone_id_system_decode(&message, &system);
+    if (!_isObservedMessage(message, system.id_or_mac)) {
+        return;
+    }
+
+    RemoteIDAircraft::RemoteIDAircraftInfo_t aircraftInfo;
+    aircraftInfo.idOrMac        = QByteArray(reinterpret_cast<const char*>(system.id_or_mac), sizeof(system.id_or_mac));
+    aircraftInfo.availableFlags = 0;
+    if (system.operator_latitude != 0 || system.operator_longitude != 0) {
+        aircraftInfo.operatorLocation = QGeoCoordinate(system.operator_latitude / 1.0e7, system.operator_longitude / 1.0e7);
+        aircraftInfo.availableFlags |= RemoteIDAircraft::OperatorAvailable;
+    }
+
+    _observer->aircraftUpdate(aircraftInfo);
+}
+
 // Parsing of the ARM_STATUS message comming from the RID device
 void RemoteIDManager::_handleArmStatus(mavlink_message_t& message)
 {
@@ -137,137 +433,204 @@ void RemoteIDManager::_handleArmStatus(mavlink_message_t& message)
 // Function that sends messages periodically
 void RemoteIDManager::_sendMessages()
 {
+    // Payloads are only repacked if some of the settings changed since the last send
+    if (_messageCacheDirty) {
+        _rebuildMessageCache();
+    }
+
     //We only send RemoteID messages if we have it enabled in the General settings
-    if (!_settings->enable()->rawValue().toBool()) {
+    if (!_cachedEnable) {
         return;
     }
-    
-    // We always try to send System
-    _sendSystem();
-    
-    // We always send Basic ID, but only send them if the information is correct
-    if (_basicIDGood) {
-        _sendBasicID();
+
+    WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
+    if (weakLink.expired()) {
+        return;
     }
-    
+    SharedLinkInterfacePtr sharedLink = weakLink.lock();
+
+    // We always send Basic ID, but only send them if the information is correct
+    bool sendBasicID = _basicIDGood;
+
     // We only send selfID if the pilot wants it or in case of a declared emergency
-    if (_settings->sendSelfID()->rawValue().toBool() || _emergencyDeclared) {
-        _sendSelfIDMsg();
-    }
+    bool sendSelfID = _cachedSendSelfID || _emergencyDeclared;
 
     // We only send the OperatorID if the pilot wants it or if the region we have set is europe. 
     // To be able to send it, it needs to be filled correclty
-    if ((_settings->sendOperatorID()->rawValue().toBool() || (_settings->region()->rawValue().toInt() == Region::EU)) && _operatorIDGood) {
-        _sendOperatorID();
+    bool sendOperatorID = (_cachedSendOperatorID || (_cachedRegion == Region::EU)) && _operatorIDGood;
+
+    // If the transponder can take them, everything goes out in a single OPEN_DRONE_ID_MESSAGE_PACK frame.
+    // The pack always carries the latest System, which then counts as the keep alive for the max interval.
+    if (_messagePackActive()) {
+        bool sendSystem = _updateSystem();
+        _sendMessagePack(sharedLink.get(), sendSystem, sendBasicID, sendSelfID, sendOperatorID);
+        if (sendSystem) {
+            _lastSystemSentTimer.start();
+            _lastSystemSentPosition = QGeoCoordinate(_systemCache.operator_latitude / 1.0e7, _systemCache.operator_longitude / 1.0e7);
+            _scheduler->cancelSystem(this);
+            _scheduler->scheduleSystem(this, _cachedSystemMaxInterval);
+        }
+        return;
     }
 
+    // Outside of message packs System is sent from _sendSystemUpdate
+    if (sendBasicID) {
+        _sendBasicID(sharedLink.get());
+    }
+    if (sendSelfID) {
+        _sendSelfIDMsg(sharedLink.get());
+    }
+    if (sendOperatorID) {
+        _sendOperatorID(sharedLink.get());
+    }
 }
 
-void RemoteIDManager::_sendSelfIDMsg()
+// Called whenever one of the settings which feed the ODID payloads changes. The actual repack is deferred to the next send
+// so a burst of setting changes coming from the UI only results in a single rebuild.
+void RemoteIDManager::_invalidateMessageCache()
 {
-    WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
-
-    if (!weakLink.expired()) {
-        mavlink_message_t       msg;
-        SharedLinkInterfacePtr  sharedLink = weakLink.lock();
-
-        mavlink_msg_open_drone_id_self_id_pack_chan(_mavlink->getSystemId(),
-                                                    _mavlink->getComponentId(),
-                                                    sharedLink->mavlinkChannel(),
-                                                    &msg,
-                                                    _targetSystem,
-                                                    _targetComponent,
-                                                    ID_OR_MAC_UNKNOWN,
-                                                    _emergencyDeclared ? 1 : _settings->selfIDType()->rawValue().toInt(), // If emergency is delcared we send directly a 1 (1 = EMERGENCY)
-                                                    _getSelfIDDescription());// Depending on the type of SelfID we send a different description
-        _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
-    }
+    _messageCacheDirty = true;
 }
 
-// We need to return the correct description for the self ID type we have selected
-const char* RemoteIDManager::_getSelfIDDescription()
+// Repacks all the static parts of the ODID messages from the current settings
+void RemoteIDManager::_rebuildMessageCache()
 {
-    QByteArray bytesFree = (_settings->selfIDFree()->rawValue().toString()).toLocal8Bit();
-    QByteArray bytesEmergency = (_settings->selfIDEmergency()->rawValue().toString()).toLocal8Bit();
-    QByteArray bytesExtended = (_settings->selfIDExtended()->rawValue().toString()).toLocal8Bit();
+    _cachedEnable           = _settings->enable()->rawValue().toBool();
+    _cachedSendSelfID       = _settings->sendSelfID()->rawValue().toBool();
+    _cachedSendOperatorID   = _settings->sendOperatorID()->rawValue().toBool();
+    _cachedRegion           = _settings->region()->rawValue().toInt();
+    _cachedLocationType     = static_cast<uint8_t>(_settings->locationType()->rawValue().toUInt());
+    _cachedSendMessagePack  = _settings->sendMessagePack()->rawValue().toBool();
+    _cachedObserverMode     = _settings->observerMode()->rawValue().toBool();
+    _cachedSystemMinInterval        = _settings->systemMinInterval()->rawValue().toInt();
+    _cachedSystemMaxInterval        = qMax(_settings->systemMaxInterval()->rawValue().toInt(), _cachedSystemMinInterval);
+    _cachedSystemMovementThreshold  = _settings->systemMovementThreshold()->rawValue().toDouble();
+
+    double latitudeFixed    = _settings->latitudeFixed()->rawValue().toDouble();
+    double longitudeFixed   = _settings->longitudeFixed()->rawValue().toDouble();
+    _cachedFixedPositionValid = latitudeFixed >= -90 && latitudeFixed <= 90 && longitudeFixed >= -180 && longitudeFixed <= 180;
+    _cachedFixedPosition    = QGeoCoordinate(latitudeFixed, longitudeFixed, _settings->altitudeFixed()->rawValue().toDouble());
+
+    // Basic ID
+    memset(&_basicIDCache, 0, sizeof(_basicIDCache));
+    _basicIDCache.target_system     = static_cast<uint8_t>(_targetSystem);
+    _basicIDCache.target_component  = static_cast<uint8_t>(_targetComponent);
+    _basicIDCache.id_type           = static_cast<uint8_t>(_settings->uasIDType()->rawValue().toUInt());
+    _basicIDCache.ua_type           = static_cast<uint8_t>(_settings->uasType()->rawValue().toUInt());
+    _copyToCharArray(_settings->uasID()->rawValue().toString(), reinterpret_cast<char*>(_basicIDCache.uas_id), sizeof(_basicIDCache.uas_id));
+
+    // Self ID. If emergency is declared we send directly a 1 (1 = EMERGENCY)
+    memset(&_selfIDCache, 0, sizeof(_selfIDCache));
+    _selfIDCache.target_system      = static_cast<uint8_t>(_targetSystem);
+    _selfIDCache.target_component   = static_cast<uint8_t>(_targetComponent);
+    _selfIDCache.description_type   = static_cast<uint8_t>(_emergencyDeclared ? 1 : _settings->selfIDType()->rawValue().toInt());
+    _copyToCharArray(_getSelfIDDescription(), _selfIDCache.description, sizeof(_selfIDCache.description));
+
+    // Operator ID
+    memset(&_operatorIDCache, 0, sizeof(_operatorIDCache));
+    _operatorIDCache.target_system      = static_cast<uint8_t>(_targetSystem);
+    _operatorIDCache.target_component   = static_cast<uint8_t>(_targetComponent);
+    _operatorIDCache.operator_id_type   = static_cast<uint8_t>(_settings->operatorIDType()->rawValue().toUInt());
+    _copyToCharArray(_settings->operatorID()->rawValue().toString(), _operatorIDCache.operator_id, sizeof(_operatorIDCache.operator_id));
+
+    // System. Position and timestamp are filled in at send time
+    memset(&_systemCache, 0, sizeof(_systemCache));
+    _systemCache.target_system          = static_cast<uint8_t>(_targetSystem);
+    _systemCache.target_component       = static_cast<uint8_t>(_targetComponent);
+    _systemCache.operator_location_type = _cachedLocationType;
+    _systemCache.classification_type    = static_cast<uint8_t>(_settings->classificationType()->rawValue().toUInt());
+    _systemCache.area_count             = AREA_COUNT;
+    _systemCache.area_radius            = AREA_RADIUS;
+    _systemCache.area_ceiling           = -1000.0f;
+    _systemCache.area_floor             = -1000.0f;
+    _systemCache.category_eu            = static_cast<uint8_t>(_settings->categoryEU()->rawValue().toUInt());
+    _systemCache.class_eu               = static_cast<uint8_t>(_settings->classEU()->rawValue().toUInt());
+
+    memset(_encodedBasicID,     0, sizeof(_encodedBasicID));
+    memset(_encodedSelfID,      0, sizeof(_encodedSelfID));
+    memset(_encodedOperatorID,  0, sizeof(_encodedOperatorID));
+    _odidEncodeBasicID      (_basicIDCache,     _encodedBasicID);
+    _odidEncodeSelfID       (_selfIDCache,      _encodedSelfID);
+    _odidEncodeOperatorID   (_operatorIDCache,  _encodedOperatorID);
+
+    _messageCacheDirty = false;
+    qCDebug(RemoteIDManagerLog) << "ODID message cache rebuilt.";
+}
 
-    const char* descriptionToSend;
+// ODID string fields are fixed size and not necessarily null terminated
+void RemoteIDManager::_copyToCharArray(const QString& source, char* dest, size_t destSize)
+{
+    QByteArray bytes = source.toLocal8Bit();
 
-    if (_emergencyDeclared) {
-        // If emergency is declared we dont care about the settings and we send emergency directly
-        descriptionToSend = bytesEmergency.data();
-    } else {
-        switch (_settings->selfIDType()->rawValue().toInt()) {
-            case 0:
-                descriptionToSend = bytesFree.data();
-                break;
-            case 1:
-                descriptionToSend = bytesEmergency.data();
-                break;
-            case 2:
-                descriptionToSend = bytesExtended.data();
-                break;
-            default:
-                descriptionToSend = bytesEmergency.data();
-        }
-    }
-    
-    return descriptionToSend;
+    memset(dest, 0, destSize);
+    memcpy(dest, bytes.constData(), qMin(static_cast<size_t>(bytes.size()), destSize));
 }
 
-void RemoteIDManager::_sendOperatorID()
+void RemoteIDManager::_sendSelfIDMsg(LinkInterface* link)
 {
-    WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
+    mavlink_message_t msg;
+
+    mavlink_msg_open_drone_id_self_id_encode_chan(_mavlink->getSystemId(),
+                                                  _mavlink->getComponentId(),
+                                                  link->mavlinkChannel(),
+                                                  &msg,
+                                                  &_selfIDCache);
+    _sendODIDMessage(link, msg);
+}
 
-    if (!weakLink.expired()) {
-        mavlink_message_t       msg;
-        SharedLinkInterfacePtr  sharedLink = weakLink.lock();
+// We need to return the correct description for the self ID type we have selected
+QString RemoteIDManager::_getSelfIDDescription()
+{
+    if (_emergencyDeclared) {
+        // If emergency is declared we dont care about the settings and we send emergency directly
+        return _settings->selfIDEmergency()->rawValue().toString();
+    }
 
-        mavlink_msg_open_drone_id_self_id_pack_chan(_mavlink->getSystemId(),
-                                                    _mavlink->getComponentId(),
-                                                    sharedLink->mavlinkChannel(),
-                                                    &msg,
-                                                    _targetSystem,
-                                                    _targetComponent,
-                                                    ID_OR_MAC_UNKNOWN,
-                                                    _settings->operatorIDType()->rawValue().toInt(),
-                                                    _getOperatorIDDescription());// Depending on the type of OperatorID we send a different description
-        _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
+    switch (_settings->selfIDType()->rawValue().toInt()) {
+    case 0:
+        return _settings->selfIDFree()->rawValue().toString();
+    case 1:
+        return _settings->selfIDEmergency()->rawValue().toString();
+    case 2:
+        return _settings->selfIDExtended()->rawValue().toString();
+    default:
+        return _settings->selfIDEmergency()->rawValue().toString();
     }
 }
 
-// We need to return the correct description for the OperatorID type we have selected
-const char* RemoteIDManager::_getOperatorIDDescription()
+void RemoteIDManager::_sendOperatorID(LinkInterface* link)
 {
-    QByteArray bytesOperatorID = (_settings->operatorID()->rawValue().toString()).toLocal8Bit();
-
-    const char* descriptionToSend = bytesOperatorID.data();
-
-    return descriptionToSend;
+    mavlink_message_t msg;
+
+    mavlink_msg_open_drone_id_operator_id_encode_chan(_mavlink->getSystemId(),
+                                                      _mavlink->getComponentId(),
+                                                      link->mavlinkChannel(),
+                                                      &msg,
+                                                      &_operatorIDCache);
+    _sendODIDMessage(link, msg);
 }
 
-void RemoteIDManager::_sendSystem()
+// Refreshes the dynamic part of the SYSTEM payload. Returns false if the GCS position is not good enough to be sent.
+bool RemoteIDManager::_updateSystem()
 {
-    WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
-
     QGeoCoordinate      gcsPosition;
     QGeoPositionInfo    geoPositionInfo;
     // Location types:
     // 0 -> TAKEOFF (not supported yet)
     // 1 -> LIVE GNNS 
     // 2 -> FIXED
-    if (_settings->locationType()->rawValue().toUInt() == LocationTypes::FIXED) {
+    if (_cachedLocationType == LocationTypes::FIXED) {
         // For FIXED location, we first check that the values are valid. Then we populate our position
-        if (_settings->latitudeFixed()->rawValue().toFloat() >= -90 && _settings->latitudeFixed()->rawValue().toFloat() <= 90 && _settings->longitudeFixed()->rawValue().toFloat() >= -180 && _settings->longitudeFixed()->rawValue().toFloat() <= 180) {
-            gcsPosition = QGeoCoordinate(_settings->latitudeFixed()->rawValue().toFloat(), _settings->longitudeFixed()->rawValue().toFloat(), _settings->altitudeFixed()->rawValue().toFloat());
-            geoPositionInfo = QGeoPositionInfo(gcsPosition, QDateTime::currentDateTime().currentDateTimeUtc());
+        if (_cachedFixedPositionValid) {
+            gcsPosition = _cachedFixedPosition;
+            geoPositionInfo = QGeoPositionInfo(gcsPosition, QDateTime::currentDateTimeUtc());
             if (!_gcsGPSGood) {
                 _gcsGPSGood = true;
                 emit gcsGPSGoodChanged();
             }
         } else {
             gcsPosition = QGeoCoordinate(0,0,0);
-            geoPositionInfo = QGeoPositionInfo(gcsPosition, QDateTime::currentDateTime().currentDateTimeUtc());
+            geoPositionInfo = QGeoPositionInfo(gcsPosition, QDateTime::currentDateTimeUtc());
             if (_gcsGPSGood) {
                 _gcsGPSGood = false;
                 emit gcsGPSGoodChanged();
@@ -282,15 +645,15 @@ void RemoteIDManager::_sendSystem()
         // GPS position needs to be valid before checking other stuff
         if (geoPositionInfo.isValid()) {
             // If we dont have altitude for FAA then the GPS data is no good
-            if ((_settings->region()->rawValue().toInt() == Region::FAA) && !(gcsPosition.altitude() >= 0) && _gcsGPSGood) {
+            if ((_cachedRegion == Region::FAA) && !(gcsPosition.altitude() >= 0) && _gcsGPSGood) {
                 _gcsGPSGood = false;
                 emit gcsGPSGoodChanged();
                 qCDebug(RemoteIDManagerLog) << "GCS GPS data error (no altitude): Altitude data is mandatory for GCS GPS data in FAA regions.";
-                return;
+                return false;
             }
 
             // If the GPS data is older than ALLOWED_GPS_DELAY we cannot use this data 
-            if (_lastGeoPositionTimeStamp.msecsTo(QDateTime::currentDateTime().currentDateTimeUtc()) > ALLOWED_GPS_DELAY) {
+            if (_lastGeoPositionTimeStamp.msecsTo(QDateTime::currentDateTimeUtc()) > ALLOWED_GPS_DELAY) {
                 if (_gcsGPSGood) {
                     _gcsGPSGood = false;
                     emit gcsGPSGoodChanged();
@@ -311,34 +674,85 @@ void RemoteIDManager::_sendSystem()
     }
 
     if (!_gcsGPSGood) {
+        return false;
+    }
+
+    // Only the dynamic part of the SYSTEM payload changes from one send to the next
+    // If position not valid, send a 0
+    _systemCache.operator_latitude      = geoPositionInfo.isValid() ? static_cast<int32_t>(gcsPosition.latitude() * 1.0e7) : 0;
+    _systemCache.operator_longitude     = geoPositionInfo.isValid() ? static_cast<int32_t>(gcsPosition.longitude() * 1.0e7) : 0;
+    _systemCache.operator_altitude_geo  = geoPositionInfo.isValid() ? static_cast<float>(gcsPosition.altitude()) : 0;
+    _systemCache.timestamp              = _timestamp2019(); // Time stamp needs to be since 00:00:00 1/1/2019
+
+    return true;
+}
+
+// Sends SYSTEM right away. Called on GCS position changes and by the scheduler for min/max intervals.
+void RemoteIDManager::_sendSystemUpdate()
+{
+    if (!_commsGood) {
+        return;
+    }
+    if (_messageCacheDirty) {
+        _rebuildMessageCache();
+    }
+
+    // Keep alive runs regardless of whether we manage to send this time
+    _scheduler->cancelSystem(this);
+    _scheduler->scheduleSystem(this, _cachedSystemMaxInterval);
+
+    if (!_cachedEnable) {
         return;
     }
 
-    if (!weakLink.expired()) {
-        mavlink_message_t       msg;
-        SharedLinkInterfacePtr  sharedLink = weakLink.lock();
-
-        mavlink_msg_open_drone_id_system_pack_chan(_mavlink->getSystemId(),
-                                                    _mavlink->getComponentId(),
-                                                    sharedLink->mavlinkChannel(),
-                                                    &msg,
-                                                    _targetSystem,
-                                                    _targetComponent,
-                                                    ID_OR_MAC_UNKNOWN,
-                                                    _settings->locationType()->rawValue().toUInt(),
-                                                    _settings->classificationType()->rawValue().toUInt(),
-                                                    geoPositionInfo.isValid() ? gcsPosition.latitude() : 0, // If position not valid, send a 0
-                                                    geoPositionInfo.isValid() ? gcsPosition.longitude() : 0, // If position not valid, send a 0
-                                                    AREA_COUNT,
-                                                    AREA_RADIUS,
-                                                    -1000.0f,
-                                                    -1000.0f,
-                                                    _settings->categoryEU()->rawValue().toUInt(),
-                                                    _settings->classEU()->rawValue().toUInt(),
-                                                    geoPositionInfo.isValid() ? gcsPosition.altitude() : 0, // If position not valid, send a 0
-                                                    _timestamp2019()),// Time stamp needs to be since 00:00:00 1/1/2019
-        _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
+    WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
+    if (weakLink.expired() || !_updateSystem()) {
+        return;
     }
+    SharedLinkInterfacePtr sharedLink = weakLink.lock();
+
+    _sendSystem(sharedLink.get());
+    _lastSystemSentTimer.start();
+    _lastSystemSentPosition = QGeoCoordinate(_systemCache.operator_latitude / 1.0e7, _systemCache.operator_longitude / 1.0e7);
+}
+
+// Decides whether a new GCS position is worth an early SYSTEM update
+void RemoteIDManager::_gcsPositionChanged(const QGeoPositionInfo& update)
+{
+    if (!_commsGood || !update.isValid()) {
+        return;
+    }
+    if (_messageCacheDirty) {
+        _rebuildMessageCache();
+    }
+    // A FIXED location never moves, so it only goes out with the keep alive
+    if (!_cachedEnable || _cachedLocationType == LocationTypes::FIXED) {
+        return;
+    }
+
+    if (_lastSystemSentPosition.isValid() && _lastSystemSentPosition.distanceTo(update.coordinate()) < _cachedSystemMovementThreshold) {
+        return;
+    }
+
+    if (_lastSystemSentTimer.isValid() && _lastSystemSentTimer.elapsed() < _cachedSystemMinInterval) {
+        // Too soon, the latest position will be picked up once the min interval expires
+        _scheduler->scheduleSystem(this, _cachedSystemMinInterval - static_cast<int>(_lastSystemSentTimer.elapsed()));
+        return;
+    }
+
+    _sendSystemUpdate();
+}
+
+void RemoteIDManager::_sendSystem(LinkInterface* link)
+{
+    mavlink_message_t msg;
+
+    mavlink_msg_open_drone_id_system_encode_chan(_mavlink->getSystemId(),
+                                                 _mavlink->getComponentId(),
+                                                 link->mavlinkChannel(),
+                                                 &msg,
+                                                 &_systemCache);
+    _sendODIDMessage(link, msg);
 }
 
 // Returns seconds elapsed since 00:00:00 1/1/2019
@@ -346,13 +760,12 @@ uint32_t RemoteIDManager::_timestamp2019()
 {
     uint32_t secsSinceEpoch2019 = 1546300800;// Secs elapsed since epoch to 1-1-2019
 
-    return ((QDateTime::currentDateTime().currentSecsSinceEpoch()) - secsSinceEpoch2019);
+    return ((QDateTime::currentSecsSinceEpoch()) - secsSinceEpoch2019);
 }
 
 // Function to initialize first gcs position in case it exists
 void RemoteIDManager::_setInitialPosition()
 {
-    QGeoCoordinate gcsPosition = _positionManager->gcsPosition();
     QGeoPositionInfo geoPositionInfo = _positionManager->geoPositionInfo();
 
     if (geoPositionInfo.isValid()) {
@@ -360,30 +773,74 @@ void RemoteIDManager::_setInitialPosition()
     }
 }
 
-void RemoteIDManager::_sendBasicID()
+void RemoteIDManager::_sendBasicID(LinkInterface* link)
 {
-    WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
+    mavlink_message_t msg;
+
+    mavlink_msg_open_drone_id_basic_id_encode_chan(_mavlink->getSystemId(),
+                                                   _mavlink->getComponentId(),
+                                                   link->mavlinkChannel(),
+                                                   &msg,
+                                                   &_basicIDCache);
+    _sendODIDMessage(link, msg);
+}
 
-    QString uasIDTemp = _settings->uasID()->rawValue().toString();
-    QByteArray ba = uasIDTemp.toLocal8Bit();
+void RemoteIDManager::_sendMessagePack(LinkInterface* link, bool sendSystem, bool sendBasicID, bool sendSelfID, bool sendOperatorID)
+{
+    mavlink_open_drone_id_message_pack_t messagePack;
 
-    if (!weakLink.expired()) {
-        mavlink_message_t       msg;
-        SharedLinkInterfacePtr  sharedLink = weakLink.lock();
+    memset(&messagePack, 0, sizeof(messagePack));
+    messagePack.target_system       = static_cast<uint8_t>(_targetSystem);
+    messagePack.target_component    = static_cast<uint8_t>(_targetComponent);
+    messagePack.single_message_size = _odidEncodedMessageSize;
 
-        mavlink_msg_open_drone_id_basic_id_pack_chan(_mavlink->getSystemId(),
-                                                    _mavlink->getComponentId(),
-                                                    sharedLink->mavlinkChannel(),
-                                                    &msg,
-                                                    _targetSystem,
-                                                    _targetComponent,
-                                                    ID_OR_MAC_UNKNOWN,
-                                                    _settings->uasIDType()->rawValue().toUInt(),
-                                                    _settings->uasType()->rawValue().toUInt(),
-                                                    reinterpret_cast<const unsigned char*>(ba.constData())),
+    uint8_t* nextMessage = messagePack.messages;
+    if (sendSystem) {
+        _odidEncodeSystem(_systemCache, nextMessage);
+        nextMessage += _odidEncodedMessageSize;
+    }
+    if (sendBasicID) {
+        memcpy(nextMessage, _encodedBasicID, _odidEncodedMessageSize);
+        nextMessage += _odidEncodedMessageSize;
+    }
+    if (sendSelfID) {
+        memcpy(nextMessage, _encodedSelfID, _odidEncodedMessageSize);
+        nextMessage += _odidEncodedMessageSize;
+    }
+    if (sendOperatorID) {
+        memcpy(nextMessage, _encodedOperatorID, _odidEncodedMessageSize);
+        nextMessage += _odidEncodedMessageSize;
+    }
 
-        _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
+    messagePack.msg_pack_size = static_cast<uint8_t>((nextMessage - messagePack.messages) / _odidEncodedMessageSize);
+    if (messagePack.msg_pack_size == 0) {
+        return;
     }
+
+    mavlink_message_t msg;
+
+    mavlink_msg_open_drone_id_message_pack_encode_chan(_mavlink->getSystemId(),
+                                                       _mavlink->getComponentId(),
+                                                       link->mavlinkChannel(),
+                                                       &msg,
+                                                       &messagePack);
+    _sendODIDMessage(link, msg);
+}
+
+bool RemoteIDManager::compliant() const
+{
+    if (!_commsGood || !_armStatusGood || !_basicIDGood || !_gcsGPSGood) {
+        return false;
+    }
+
+    // Operator ID is mandatory in the EU, otherwise only when the pilot asked for it. Read from the settings rather
+    // than the message cache, which isn't rebuilt until the next send after a setting changes.
+    const bool sendOperatorID = _settings->sendOperatorID()->rawValue().toBool() || (_settings->region()->rawValue().toInt() == Region::EU);
+    if (sendOperatorID && !_operatorIDGood) {
+        return false;
+    }
+
+    return true;
 }
 
 void RemoteIDManager::checkBasicID()
@@ -414,6 +871,7 @@ void RemoteIDManager::declareEmergency()
 {
     if (!_emergencyDeclared) {
         _emergencyDeclared = true;
+        _invalidateMessageCache();
         emit emergencyDeclaredChanged();
         qCDebug(RemoteIDManagerLog) << "Emergency declared.";
     }
@@ -423,5 +881,6 @@ void RemoteIDManager::_updateLastGCSPositionInfo(QGeoPositionInfo update)
 {
     if (update.isValid()) {
         _lastGeoPositionTimeStamp = update.timestamp().toUTC();
+        _gcsPositionChanged(update);
     }
 }
\ No newline at end of file
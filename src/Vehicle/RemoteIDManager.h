@@ -12,6 +12,8 @@
 #include <QObject>
 #include <QDateTime>
 #include <QGeoPositionInfo>
+#include <QElapsedTimer>
+#include <QPointer>
 
 #include "QGCLoggingCategory.h"
 #include "QGCMAVLink.h"
@@ -21,14 +23,20 @@ Q_DECLARE_LOGGING_CATEGORY(RemoteIDManagerLog)
 
 class RemoteIDSettings;
 class QGCPositionManager;
+class RemoteIDScheduler;
+class RemoteIDObserver;
+class RemoteIDFlightRecorder;
 
 // Supporting Opend Dron ID protocol
 class RemoteIDManager : public QObject
 {
     Q_OBJECT
 
+    friend class RemoteIDScheduler;
+
 public:
     RemoteIDManager(Vehicle* vehicle);
+    ~RemoteIDManager();
 
     Q_PROPERTY (bool    armStatusGood       READ armStatusGood      NOTIFY armStatusGoodChanged)
     Q_PROPERTY (QString armStatusError      READ armStatusError     NOTIFY armStatusErrorChanged)
@@ -55,6 +63,9 @@ public:
     bool    emergencyDeclared   (void) const { return _emergencyDeclared;}
     bool    operatorIDGood      (void) const { return _operatorIDGood; }
 
+    /// All the checks required to fly compliant are passing
+    bool    compliant           (void) const;
+
     void mavlinkMessageReceived (mavlink_message_t& message);
 
     enum LocationTypes {
@@ -86,32 +97,55 @@ private slots:
     void _heartbeatTimeout();
     void _sendMessages();
     void _updateLastGCSPositionInfo(QGeoPositionInfo update);
+    void _invalidateMessageCache();
+    void _sendSystemUpdate();
+    void _updateFlightRecorder();
 
 private:
     void _handleArmStatus(mavlink_message_t& message);
     void _handleHeartBeat(mavlink_message_t& message);
+    void _queryMessagePackSupport(uint8_t transponderComponentId);
+    void _handleObservedLocation(mavlink_message_t& message);
+    void _handleObservedBasicID(mavlink_message_t& message);
+    void _handleObservedSystem(mavlink_message_t& message);
+    bool _isObservedMessage(const mavlink_message_t& message, const uint8_t* idOrMac);
+
+    // Every ODID message we transmit goes through here so the flight recorder sees it
+    void        _sendODIDMessage(LinkInterface* link, const mavlink_message_t& message);
+
+    // Message cache
+    void        _rebuildMessageCache();
+    void        _copyToCharArray(const QString& source, char* dest, size_t destSize);
 
     // Self ID 
-    void        _sendSelfIDMsg ();
-    const char* _getSelfIDDescription();
+    void        _sendSelfIDMsg (LinkInterface* link);
+    QString     _getSelfIDDescription();
 
     // Operator ID
-    void        _sendOperatorID ();
-    const char* _getOperatorIDDescription();
+    void        _sendOperatorID (LinkInterface* link);
 
     // System
-    void        _sendSystem();
+    bool        _updateSystem();
+    void        _gcsPositionChanged(const QGeoPositionInfo& update);
+    void        _sendSystem(LinkInterface* link);
     uint32_t    _timestamp2019();
     void        _setInitialPosition();
 
 
     // Basic ID
-    void        _sendBasicID();
+    void        _sendBasicID(LinkInterface* link);
+
+    // Message pack
+    bool        _messagePackActive() const { return _cachedSendMessagePack || _transponderSupportsMessagePack; }
+    void        _sendMessagePack(LinkInterface* link, bool sendSystem, bool sendBasicID, bool sendSelfID, bool sendOperatorID);
     
     MAVLinkProtocol*    _mavlink;
     Vehicle*            _vehicle;
     RemoteIDSettings*   _settings;
     QGCPositionManager* _positionManager;
+    QPointer<RemoteIDScheduler> _scheduler;
+    QPointer<RemoteIDObserver>  _observer;
+    RemoteIDFlightRecorder*     _flightRecorder;    ///< Created on the first recorded flight
 
     // Flags ODID
     bool    _armStatusGood;
@@ -126,7 +160,38 @@ private:
     int         _targetSystem;
     int         _targetComponent;
 
-    // Timers
-    QTimer _heartbeatTimeoutTimer;
-    QTimer _sendMessagesTimer;
+    /// Pre-packed ODID payloads. These are only rebuilt when one of the RemoteIDSettings facts changes or an emergency is
+    /// declared, so the send path only needs to stamp sequence and channel. The SYSTEM payload also gets its position
+    /// and timestamp refreshed on every send.
+    bool                                _messageCacheDirty;
+    bool                                _cachedEnable;
+    bool                                _cachedSendSelfID;
+    bool                                _cachedSendOperatorID;
+    int                                 _cachedRegion;
+    uint8_t                             _cachedLocationType;
+    bool                                _cachedFixedPositionValid;
+    QGeoCoordinate                      _cachedFixedPosition;
+    mavlink_open_drone_id_basic_id_t    _basicIDCache;
+    mavlink_open_drone_id_self_id_t     _selfIDCache;
+    mavlink_open_drone_id_operator_id_t _operatorIDCache;
+    mavlink_open_drone_id_system_t      _systemCache;
+
+    /// Static messages already encoded in the ASTM F3411 25 byte wire format used by OPEN_DRONE_ID_MESSAGE_PACK
+    static const int _odidEncodedMessageSize = 25;
+    uint8_t     _encodedBasicID     [_odidEncodedMessageSize];
+    uint8_t     _encodedSelfID      [_odidEncodedMessageSize];
+    uint8_t     _encodedOperatorID  [_odidEncodedMessageSize];
+
+    // SYSTEM is sent on GCS position changes, rate limited by min interval and movement threshold, and at least every max interval
+    int             _cachedSystemMinInterval;
+    int             _cachedSystemMaxInterval;
+    double          _cachedSystemMovementThreshold;
+    QElapsedTimer   _lastSystemSentTimer;
+    QGeoCoordinate  _lastSystemSentPosition;
+
+    bool        _cachedObserverMode;
+    bool        _cachedSendMessagePack;
+    bool        _transponderSupportsMessagePack;    ///< Transponder accepted our request for a message pack, cleared when it is lost
+
+    static void _messagePackSupportResultHandler(void* resultHandlerData, int compId, MAV_RESULT commandResult, uint8_t progress, Vehicle::MavCmdResultFailureCode_t failureCode);
 };
\ No newline at end of file
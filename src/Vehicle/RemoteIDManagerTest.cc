@@ -0,0 +1,471 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "RemoteIDManagerTest.h"
+#include "RemoteIDManager.h"
+#include "RemoteIDScheduler.h"
+#include "RemoteIDFlightRecorder.h"
+#include "RemoteIDObserver.h"
+#include "RemoteIDSettings.h"
+#include "MultiVehicleManager.h"
+#include "PositionManager.h"
+#include "SettingsManager.h"
+#include "QGCApplication.h"
+#include "LinkManager.h"
+#include "MockLink.h"
+
+#include <QGeoPositionInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QDir>
+#include <QFileInfo>
+
+const char* RemoteIDManagerTest::_benchmarkEnvVar = "QGC_BENCHMARK_REMOTEID";
+
+RemoteIDManagerTest::RemoteIDManagerTest(void)
+{
+
+}
+
+void RemoteIDManagerTest::init(void)
+{
+    UnitTest::init();
+
+    _multiVehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+
+    QCOMPARE(_linkManager->links().count(),         0);
+    QCOMPARE(_multiVehicleMgr->vehicles()->count(), 0);
+
+    RemoteIDSettings* settings = qgcApp()->toolbox()->settingsManager()->remoteIDSettings();
+    settings->enable()->setRawValue(true);
+    settings->uasID()->setRawValue(QStringLiteral("QGCTEST0123456789"));
+    settings->locationType()->setRawValue(RemoteIDManager::LiveGNSS);
+    // Every position change should go straight out so latency is measured without rate limiting
+    settings->systemMinInterval()->setRawValue(0);
+}
+
+void RemoteIDManagerTest::cleanup(void)
+{
+    _mockLinks.clear();
+    _mockConfigs.clear();
+
+    if (_linkManager->links().count()) {
+        QSignalSpy spyActiveVehicleChanged(_multiVehicleMgr, &MultiVehicleManager::activeVehicleChanged);
+        _linkManager->disconnectAll();
+        QCOMPARE(spyActiveVehicleChanged.wait(1000), true);
+        QVERIFY(QTest::qWaitFor([&]() { return _multiVehicleMgr->vehicles()->count() == 0; }, 5000));
+    }
+
+    RemoteIDSettings* settings = qgcApp()->toolbox()->settingsManager()->remoteIDSettings();
+    settings->enable()->setRawValue(settings->enable()->rawDefaultValue());
+    settings->uasID()->setRawValue(settings->uasID()->rawDefaultValue());
+    settings->locationType()->setRawValue(settings->locationType()->rawDefaultValue());
+    settings->systemMinInterval()->setRawValue(settings->systemMinInterval()->rawDefaultValue());
+
+    _multiVehicleMgr = nullptr;
+
+    UnitTest::cleanup();
+}
+
+void RemoteIDManagerTest::_startTransponderMockLinks(int count)
+{
+    for (int i=0; i<count; i++) {
+        MockConfiguration* pMockConfig = new MockConfiguration(QStringLiteral("RemoteID Mock %1").arg(i));
+        SharedLinkConfigurationPtr mockConfig(pMockConfig);
+
+        // No initial connect sequence, the vehicle only needs to exist for its RemoteIDManager to run
+        pMockConfig->setDynamic             (true);
+        pMockConfig->setFirmwareType        (MAV_AUTOPILOT_INVALID);
+        pMockConfig->setIncrementVehicleId  (true);
+        pMockConfig->setRemoteIDTransponder (true);
+
+        QVERIFY(_linkManager->createConnectedLink(mockConfig));
+        QVERIFY(mockConfig->link());
+
+        _mockConfigs.append(mockConfig);
+        _mockLinks.append(_linkManager->sharedLinkInterfacePointerForLink(mockConfig->link()));
+    }
+
+    QVERIFY(QTest::qWaitFor([&]() { return _multiVehicleMgr->vehicles()->count() == count; }, 10000));
+}
+
+bool RemoteIDManagerTest::_waitForCommsGood(bool commsGood, int timeoutMSecs)
+{
+    return QTest::qWaitFor([&]() {
+        for (int i=0; i<_multiVehicleMgr->vehicles()->count(); i++) {
+            Vehicle* vehicle = _multiVehicleMgr->vehicles()->value<Vehicle*>(i);
+            if (vehicle->remoteIDManager()->commsGood() != commsGood) {
+                return false;
+            }
+        }
+        return true;
+    }, timeoutMSecs);
+}
+
+MockLink* RemoteIDManagerTest::_mockLinkAt(int index)
+{
+    return qobject_cast<MockLink*>(_mockLinks[index].get());
+}
+
+void RemoteIDManagerTest::_injectGCSPosition(const QGeoCoordinate& coordinate)
+{
+    QGeoPositionInfo update(coordinate, QDateTime::currentDateTimeUtc());
+    update.setAttribute(QGeoPositionInfo::HorizontalAccuracy, 1.0);
+    qgcApp()->toolbox()->qgcPositionManager()->_positionUpdated(update);
+}
+
+void RemoteIDManagerTest::_commsGoodTest(void)
+{
+    _startTransponderMockLinks(1);
+
+    Vehicle* vehicle = _multiVehicleMgr->activeVehicle();
+    QVERIFY(vehicle);
+
+    QVERIFY(_waitForCommsGood(true, 3000));
+
+    // Static messages follow once the scheduler has picked up the transponder
+    MockLink* mockLink = _mockLinkAt(0);
+    QVERIFY(QTest::qWaitFor([&]() { return mockLink->remoteIDReceivedMessageCount(MAVLINK_MSG_ID_OPEN_DRONE_ID_BASIC_ID) > 0; }, 3000));
+}
+
+void RemoteIDManagerTest::_armStatusTest(void)
+{
+    _startTransponderMockLinks(1);
+    QVERIFY(_waitForCommsGood(true, 3000));
+
+    RemoteIDManager* remoteIDManager = _multiVehicleMgr->activeVehicle()->remoteIDManager();
+    QVERIFY(QTest::qWaitFor([&]() { return remoteIDManager->armStatusGood(); }, 3000));
+
+    const QString armError("Simulated transponder failure");
+    _mockLinkAt(0)->setRemoteIDArmStatus(false, armError);
+    QVERIFY(QTest::qWaitFor([&]() { return !remoteIDManager->armStatusGood(); }, 3000));
+    QCOMPARE(remoteIDManager->armStatusError(), armError);
+
+    _mockLinkAt(0)->setRemoteIDArmStatus(true);
+    QVERIFY(QTest::qWaitFor([&]() { return remoteIDManager->armStatusGood(); }, 3000));
+}
+
+void RemoteIDManagerTest::_heartbeatDropoutTest(void)
+{
+    _startTransponderMockLinks(1);
+    QVERIFY(_waitForCommsGood(true, 3000));
+
+    MockLink* mockLink = _mockLinkAt(0);
+    mockLink->setRemoteIDHeartbeatDropout(true);
+    QVERIFY(_waitForCommsGood(false, RemoteIDScheduler::heartbeatTimeoutMSecs * 2));
+
+    // Nothing goes out while the transponder is gone
+    mockLink->clearRemoteIDReceivedMessages();
+    QTest::qWait(RemoteIDScheduler::sendPeriodMSecs * 2);
+    QCOMPARE(mockLink->remoteIDReceivedMessages().count(), 0);
+
+    mockLink->setRemoteIDHeartbeatDropout(false);
+    QVERIFY(_waitForCommsGood(true, 3000));
+}
+
+void RemoteIDManagerTest::_packetLossTest(void)
+{
+    _startTransponderMockLinks(1);
+    QVERIFY(_waitForCommsGood(true, 3000));
+
+    // Total loss looks the same as a dead transponder from the GCS side
+    MockLink* mockLink = _mockLinkAt(0);
+    mockLink->setRemoteIDPacketLossPercent(100);
+    QVERIFY(_waitForCommsGood(false, RemoteIDScheduler::heartbeatTimeoutMSecs * 2));
+    mockLink->clearRemoteIDReceivedMessages();
+
+    mockLink->setRemoteIDPacketLossPercent(0);
+    QVERIFY(_waitForCommsGood(true, 3000));
+    QVERIFY(QTest::qWaitFor([&]() { return mockLink->remoteIDReceivedMessageCount(MAVLINK_MSG_ID_OPEN_DRONE_ID_BASIC_ID) > 0; }, 3000));
+}
+
+void RemoteIDManagerTest::_messagePackSupportTest(void)
+{
+    _startTransponderMockLinks(1);
+    QVERIFY(_waitForCommsGood(true, 3000));
+
+    // The transponder turned the request down, so static messages go out one by one
+    MockLink* mockLink = _mockLinkAt(0);
+    QVERIFY(QTest::qWaitFor([&]() { return mockLink->remoteIDReceivedMessageCount(MAVLINK_MSG_ID_OPEN_DRONE_ID_BASIC_ID) > 0; }, 3000));
+    QCOMPARE(mockLink->remoteIDReceivedMessageCount(MAVLINK_MSG_ID_OPEN_DRONE_ID_MESSAGE_PACK), 0);
+
+    // A device which handles message packs shows up in its place
+    mockLink->setRemoteIDHeartbeatDropout(true);
+    QVERIFY(_waitForCommsGood(false, RemoteIDScheduler::heartbeatTimeoutMSecs * 2));
+    mockLink->setRemoteIDMessagePackSupport(true);
+    mockLink->setRemoteIDHeartbeatDropout(false);
+    QVERIFY(_waitForCommsGood(true, 3000));
+    QVERIFY(QTest::qWaitFor([&]() { return mockLink->remoteIDReceivedMessageCount(MAVLINK_MSG_ID_OPEN_DRONE_ID_MESSAGE_PACK) > 0; }, 3000));
+
+    // And is swapped back for one which doesn't
+    mockLink->setRemoteIDHeartbeatDropout(true);
+    QVERIFY(_waitForCommsGood(false, RemoteIDScheduler::heartbeatTimeoutMSecs * 2));
+    mockLink->setRemoteIDMessagePackSupport(false);
+    mockLink->setRemoteIDHeartbeatDropout(false);
+    QVERIFY(_waitForCommsGood(true, 3000));
+    mockLink->clearRemoteIDReceivedMessages();
+    QVERIFY(QTest::qWaitFor([&]() { return mockLink->remoteIDReceivedMessageCount(MAVLINK_MSG_ID_OPEN_DRONE_ID_BASIC_ID) > 0; }, 3000));
+    QCOMPARE(mockLink->remoteIDReceivedMessageCount(MAVLINK_MSG_ID_OPEN_DRONE_ID_MESSAGE_PACK), 0);
+}
+
+void RemoteIDManagerTest::_flightRecorderTest(void)
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    const int       messageCount    = 3;
+    const uint8_t   systemId        = 42;
+    QString         recordingFile;
+
+    {
+        RemoteIDFlightRecorder recorder(systemId);
+
+        // Nothing is recorded outside of a flight
+        mavlink_message_t msg;
+        mavlink_open_drone_id_system_t system;
+        memset(&system, 0, sizeof(system));
+        mavlink_msg_open_drone_id_system_encode(255, MAV_COMP_ID_MISSIONPLANNER, &msg, &system);
+        recorder.record(msg);
+
+        recorder.startFlight(tempDir.path());
+        QVERIFY(recorder.flightActive());
+        for (int i=0; i<messageCount; i++) {
+            system.operator_latitude = 473970000 + i;
+            mavlink_msg_open_drone_id_system_encode(255, MAV_COMP_ID_MISSIONPLANNER, &msg, &system);
+            recorder.record(msg);
+        }
+        // Stopping does not block, the file is complete once flightFinished comes through
+        QSignalSpy finishedSpy(&recorder, &RemoteIDFlightRecorder::flightFinished);
+        recorder.stopFlight();
+        QVERIFY(!recorder.flightActive());
+        QVERIFY(finishedSpy.count() == 1 || finishedSpy.wait(3000));
+        QCOMPARE(finishedSpy[0][0].toString(), recorder.fileName());
+        QCOMPARE(recorder.droppedCount(), 0u);
+
+        recordingFile = recorder.fileName();
+    }
+    QVERIFY(QFile::exists(recordingFile));
+
+    QString errorString;
+    QString csvFile = tempDir.filePath("recording.csv");
+    QVERIFY2(RemoteIDFlightRecorder::exportToCSV(recordingFile, csvFile, errorString), qPrintable(errorString));
+    QFile csv(csvFile);
+    QVERIFY(csv.open(QIODevice::ReadOnly | QIODevice::Text));
+    QStringList csvLines = QString(csv.readAll()).split('\n', Qt::SkipEmptyParts);
+    QCOMPARE(csvLines.count(), messageCount + 1);
+    QVERIFY(csvLines[1].startsWith(QStringLiteral("42,")));
+    QVERIFY(csvLines[1].contains(QStringLiteral("OPEN_DRONE_ID_SYSTEM")));
+
+    QString jsonFile = tempDir.filePath("recording.json");
+    QVERIFY2(RemoteIDFlightRecorder::exportToJSON(recordingFile, jsonFile, errorString), qPrintable(errorString));
+    QFile json(jsonFile);
+    QVERIFY(json.open(QIODevice::ReadOnly));
+    QJsonObject jsonRoot = QJsonDocument::fromJson(json.readAll()).object();
+    QCOMPARE(jsonRoot["systemId"].toInt(), static_cast<int>(systemId));
+    QJsonArray jsonMessages = jsonRoot["messages"].toArray();
+    QCOMPARE(jsonMessages.count(), messageCount);
+
+    // Timestamps are monotonic
+    qint64 lastTimeUSecs = -1;
+    for (const QJsonValue& jsonMessage : jsonMessages) {
+        qint64 timeUSecs = static_cast<qint64>(jsonMessage.toObject()["timeUSecs"].toDouble());
+        QVERIFY(timeUSecs >= lastTimeUSecs);
+        lastTimeUSecs = timeUSecs;
+        QCOMPARE(jsonMessage.toObject()["messageId"].toInt(), static_cast<int>(MAVLINK_MSG_ID_OPEN_DRONE_ID_SYSTEM));
+    }
+
+    // Command line export writes both formats next to each other
+    QDir exportDir(tempDir.filePath("export"));
+    QVERIFY(exportDir.mkpath("."));
+    QCOMPARE(RemoteIDFlightRecorder::runCommandLine(recordingFile, exportDir.path()), 0);
+    const QString exportBaseName = QFileInfo(recordingFile).completeBaseName();
+    QVERIFY(exportDir.exists(exportBaseName + ".csv"));
+    QVERIFY(exportDir.exists(exportBaseName + ".json"));
+    QCOMPARE(RemoteIDFlightRecorder::runCommandLine(tempDir.filePath("missing.odid"), exportDir.path()), 1);
+
+    // A new flight starts straight away while the previous one is still being written out. Separate directories
+    // since both flights start within the same second.
+    QDir firstDir(tempDir.filePath("first"));
+    QDir secondDir(tempDir.filePath("second"));
+    QVERIFY(firstDir.mkpath("."));
+    QVERIFY(secondDir.mkpath("."));
+    {
+        RemoteIDFlightRecorder recorder(systemId);
+        QSignalSpy finishedSpy(&recorder, &RemoteIDFlightRecorder::flightFinished);
+
+        mavlink_message_t msg;
+        mavlink_open_drone_id_system_t system;
+        memset(&system, 0, sizeof(system));
+        mavlink_msg_open_drone_id_system_encode(255, MAV_COMP_ID_MISSIONPLANNER, &msg, &system);
+
+        recorder.startFlight(firstDir.path());
+        const QString firstFile = recorder.fileName();
+        recorder.record(msg);
+        recorder.startFlight(secondDir.path());
+        const QString secondFile = recorder.fileName();
+        QVERIFY(recorder.flightActive());
+        for (int i=0; i<messageCount; i++) {
+            recorder.record(msg);
+        }
+        recorder.stopFlight();
+
+        QVERIFY(QTest::qWaitFor([&]() { return finishedSpy.count() == 2; }, 3000));
+        QCOMPARE(finishedSpy[0][0].toString(), firstFile);
+        QCOMPARE(finishedSpy[1][0].toString(), secondFile);
+
+        // Each flight only holds its own messages
+        const QStringList flightFiles = { firstFile, secondFile };
+        const QList<int> flightMessageCounts = { 1, messageCount };
+        for (int i=0; i<flightFiles.count(); i++) {
+            QString flightJsonFile = tempDir.filePath(QStringLiteral("flight%1.json").arg(i));
+            QVERIFY2(RemoteIDFlightRecorder::exportToJSON(flightFiles[i], flightJsonFile, errorString), qPrintable(errorString));
+            QFile flightJson(flightJsonFile);
+            QVERIFY(flightJson.open(QIODevice::ReadOnly));
+            QCOMPARE(QJsonDocument::fromJson(flightJson.readAll()).object()["messages"].toArray().count(), flightMessageCounts[i]);
+        }
+    }
+}
+
+void RemoteIDManagerTest::_observerNearTest(void)
+{
+    RemoteIDObserver observer;
+
+    // Two aircraft close by and enough on the far side of the world that a small search goes through the grid cells
+    const QGeoCoordinate center(47.3977, 8.5456);
+    QList<QGeoCoordinate> locations = {
+        center.atDistanceAndAzimuth(100, 0),
+        center.atDistanceAndAzimuth(5000, 90),
+    };
+    const QGeoCoordinate farCenter(-33.8688, 151.2093);
+    for (int i=0; i<100; i++) {
+        locations.append(farCenter.atDistanceAndAzimuth(i * 100, i * 3.6));
+    }
+
+    for (int i=0; i<locations.count(); i++) {
+        RemoteIDAircraft::RemoteIDAircraftInfo_t aircraftInfo = {};
+        aircraftInfo.idOrMac        = QByteArray::number(i);
+        aircraftInfo.location       = locations[i];
+        aircraftInfo.availableFlags = RemoteIDAircraft::LocationAvailable;
+        observer.aircraftUpdate(aircraftInfo);
+    }
+    // No location yet, never near anything
+    RemoteIDAircraft::RemoteIDAircraftInfo_t noLocationInfo = {};
+    noLocationInfo.idOrMac = QByteArray("noLocation");
+    observer.aircraftUpdate(noLocationInfo);
+    QCOMPARE(observer.aircraftCount(), locations.count() + 1);
+
+    // Small radius covers fewer cells than there are aircraft, larger ones check each aircraft
+    QCOMPARE(observer.aircraftNear(center, 950).count(), 1);
+    QCOMPARE(observer.aircraftNear(farCenter, 950).count(), 10);
+    QCOMPARE(observer.aircraftNear(center, 10000).count(), 2);
+    QCOMPARE(observer.aircraftNear(center, -1).count(), 0);
+
+    // A radius larger than the earth must neither walk billions of cells nor miss anything
+    QElapsedTimer timer;
+    timer.start();
+    QCOMPARE(observer.aircraftNear(center, 1e7).count(), 2);
+    QCOMPARE(observer.aircraftNear(center, 1e12).count(), locations.count());
+    QCOMPARE(observer.aircraftNearList(center, 1e12).count(), locations.count());
+    QVERIFY(timer.elapsed() < 1000);
+}
+
+// Measures the time from a GCS position update to the matching SYSTEM frame arriving at the transponder
+void RemoteIDManagerTest::_systemLatencyBenchmark(void)
+{
+    if (!qEnvironmentVariableIsSet(_benchmarkEnvVar)) {
+        QSKIP("Set QGC_BENCHMARK_REMOTEID to run");
+    }
+
+    _startTransponderMockLinks(1);
+    QVERIFY(_waitForCommsGood(true, 3000));
+
+    MockLink*       mockLink        = _mockLinkAt(0);
+    QGeoCoordinate  startPosition   (47.397, 8.5455, 100);
+    QList<qint64>   latencies;
+
+    for (int i=1; i<=_latencySampleCount; i++) {
+        QGeoCoordinate position = startPosition.atDistanceAndAzimuth(10.0 * i, 90);
+        position.setAltitude(startPosition.altitude());
+        const int32_t expectedLatitude  = static_cast<int32_t>(position.latitude() * 1.0e7);
+        const int32_t expectedLongitude = static_cast<int32_t>(position.longitude() * 1.0e7);
+
+        qint64 startNSecs = mockLink->runningTimeNSecs();
+        _injectGCSPosition(position);
+
+        qint64 receivedNSecs = -1;
+        QVERIFY(QTest::qWaitFor([&]() {
+            for (const MockLink::RemoteIDReceivedMessage_t& received : mockLink->remoteIDReceivedMessages()) {
+                if (received.message.msgid != MAVLINK_MSG_ID_OPEN_DRONE_ID_SYSTEM || received.receivedNSecs < startNSecs) {
+                    continue;
+                }
+                mavlink_open_drone_id_system_t system;
+                mavlink_msg_open_drone_id_system_decode(&received.message, &system);
+                if (system.operator_latitude == expectedLatitude && system.operator_longitude == expectedLongitude) {
+                    receivedNSecs = received.receivedNSecs;
+                    return true;
+                }
+            }
+            return false;
+        }, 1000));
+
+        latencies.append(receivedNSecs - startNSecs);
+        mockLink->clearRemoteIDReceivedMessages();
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    QTest::setBenchmarkResult(latencies[latencies.count() / 2], QTest::WalltimeNanoseconds);
+}
+
+void RemoteIDManagerTest::_vehicleCountBenchmark_data(void)
+{
+    QTest::addColumn<int>("vehicleCount");
+
+    QTest::newRow("1 vehicle")      << 1;
+    QTest::newRow("4 vehicles")     << 4;
+    QTest::newRow("16 vehicles")    << 16;
+}
+
+// Measures the GUI thread cost of a single GCS position update fanning out to every vehicle's RemoteIDManager
+void RemoteIDManagerTest::_vehicleCountBenchmark(void)
+{
+    if (!qEnvironmentVariableIsSet(_benchmarkEnvVar)) {
+        QSKIP("Set QGC_BENCHMARK_REMOTEID to run");
+    }
+
+    QFETCH(int, vehicleCount);
+
+    _startTransponderMockLinks(vehicleCount);
+    QVERIFY(_waitForCommsGood(true, 5000));
+
+    RemoteIDScheduler* scheduler = _multiVehicleMgr->remoteIDScheduler();
+    scheduler->resetJitterStats();
+
+    QGeoCoordinate  startPosition(47.397, 8.5455, 100);
+    int             step = 0;
+
+    QBENCHMARK {
+        QGeoCoordinate position = startPosition.atDistanceAndAzimuth(10.0 * (++step % 1000), 90);
+        position.setAltitude(startPosition.altitude());
+        _injectGCSPosition(position);
+    }
+
+    // Every transponder must have seen the updates
+    for (int i=0; i<vehicleCount; i++) {
+        MockLink* mockLink = _mockLinkAt(i);
+        QVERIFY(QTest::qWaitFor([&]() { return mockLink->remoteIDReceivedMessageCount(MAVLINK_MSG_ID_OPEN_DRONE_ID_SYSTEM) > 0; }, 3000));
+    }
+
+    // Let the scheduler run a couple of periods, it has to hold its slots at this vehicle count
+    QTest::qWait(RemoteIDScheduler::sendPeriodMSecs * 2);
+    QVERIFY(scheduler->maxSendJitterMSecs() < RemoteIDScheduler::sendPeriodMSecs);
+}
@@ -0,0 +1,59 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "LinkInterface.h"
+#include "LinkConfiguration.h"
+
+#include <QGeoCoordinate>
+
+class MockLink;
+class MultiVehicleManager;
+
+/// Exercises RemoteIDManager against the MockLink Open Drone ID transponder simulation. Also holds the RemoteID
+/// latency and scaling benchmarks, which are skipped unless QGC_BENCHMARK_REMOTEID is set.
+class RemoteIDManagerTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    RemoteIDManagerTest(void);
+
+protected:
+    void init   (void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _commsGoodTest             (void);
+    void _armStatusTest             (void);
+    void _heartbeatDropoutTest      (void);
+    void _packetLossTest            (void);
+    void _messagePackSupportTest    (void);
+    void _flightRecorderTest        (void);
+    void _observerNearTest          (void);
+    void _systemLatencyBenchmark    (void);
+    void _vehicleCountBenchmark_data(void);
+    void _vehicleCountBenchmark     (void);
+
+private:
+    void        _startTransponderMockLinks  (int count);
+    bool        _waitForCommsGood           (bool commsGood, int timeoutMSecs);
+    MockLink*   _mockLinkAt                 (int index);
+    void        _injectGCSPosition          (const QGeoCoordinate& coordinate);
+
+    MultiVehicleManager*                _multiVehicleMgr = nullptr;
+    QList<SharedLinkConfigurationPtr>   _mockConfigs;
+    QList<SharedLinkInterfacePtr>       _mockLinks;
+
+    static const int _latencySampleCount = 50;
+
+    static const char* _benchmarkEnvVar;    ///< Benchmarks only run when this environment variable is set
+};
@@ -0,0 +1,185 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "RemoteIDObserver.h"
+
+#include <QQmlEngine>
+#include <QtMath>
+
+QGC_LOGGING_CATEGORY(RemoteIDObserverLog, "RemoteIDObserverLog")
+
+RemoteIDObserver::RemoteIDObserver(QObject* parent)
+    : QObject(parent)
+{
+    QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
+
+    _clock.start();
+
+    _cleanupTimer.setSingleShot(false);
+    _cleanupTimer.setInterval(1000);
+    connect(&_cleanupTimer, &QTimer::timeout, this, &RemoteIDObserver::_cleanupStaleAircraft);
+}
+
+void RemoteIDObserver::aircraftUpdate(const RemoteIDAircraft::RemoteIDAircraftInfo_t& aircraftInfo)
+{
+    RemoteIDAircraft* aircraft = _aircraftMap.value(aircraftInfo.idOrMac, nullptr);
+
+    if (aircraft) {
+        aircraft->update(aircraftInfo);
+    } else {
+        aircraft = new RemoteIDAircraft(aircraftInfo, this);
+        _aircraftMap[aircraftInfo.idOrMac] = aircraft;
+        _aircraftList.append(aircraft);
+        emit aircraftCountChanged();
+        qCDebug(RemoteIDObserverLog) << "Added" << aircraft->id();
+
+        if (!_cleanupTimer.isActive()) {
+            _cleanupTimer.start();
+        }
+    }
+
+    if (aircraftInfo.availableFlags & RemoteIDAircraft::LocationAvailable) {
+        _updateGridCell(aircraft);
+    }
+
+    qint64 nowMSecs = _clock.elapsed();
+    aircraft->setLastUpdateMSecs(nowMSecs);
+    _expiryQueue.enqueue(ExpiryEntry_t(nowMSecs, aircraftInfo.idOrMac));
+}
+
+QList<RemoteIDAircraft*> RemoteIDObserver::aircraftNear(const QGeoCoordinate& center, double radiusMeters) const
+{
+    QList<RemoteIDAircraft*> nearAircraft;
+
+    if (!center.isValid() || radiusMeters < 0) {
+        return nearAircraft;
+    }
+
+    // Work out the span of cells which cover the search circle, never more than the whole globe
+    const double metersPerDegreeLat = 111320.0;
+    double latSpan = qMin(radiusMeters / metersPerDegreeLat, 180.0);
+    double lonSpan = qMin(radiusMeters / (metersPerDegreeLat * qMax(qCos(qDegreesToRadians(center.latitude())), 0.01)), 360.0);
+
+    int minLatIndex = _cellIndex(qMax(center.latitude() - latSpan, -90.0));
+    int maxLatIndex = _cellIndex(qMin(center.latitude() + latSpan, 90.0));
+    int minLonIndex = _cellIndex(qMax(center.longitude() - lonSpan, -180.0));
+    int maxLonIndex = _cellIndex(qMin(center.longitude() + lonSpan, 180.0));
+
+    // A large radius covers far more cells than there are aircraft, checking each aircraft is cheaper then
+    const qint64 cellCount = static_cast<qint64>(maxLatIndex - minLatIndex + 1) * (maxLonIndex - minLonIndex + 1);
+    if (cellCount > _aircraftMap.count()) {
+        for (RemoteIDAircraft* aircraft : _aircraftMap) {
+            QGeoCoordinate coordinate = aircraft->coordinate();
+            if (coordinate.isValid() && coordinate.distanceTo(center) <= radiusMeters) {
+                nearAircraft.append(aircraft);
+            }
+        }
+        return nearAircraft;
+    }
+
+    for (int latIndex=minLatIndex; latIndex<=maxLatIndex; latIndex++) {
+        for (int lonIndex=minLonIndex; lonIndex<=maxLonIndex; lonIndex++) {
+            auto cell = _grid.constFind(_cellKey(latIndex, lonIndex));
+            if (cell == _grid.constEnd()) {
+                continue;
+            }
+            for (RemoteIDAircraft* aircraft : cell.value()) {
+                if (aircraft->coordinate().distanceTo(center) <= radiusMeters) {
+                    nearAircraft.append(aircraft);
+                }
+            }
+        }
+    }
+
+    return nearAircraft;
+}
+
+QVariantList RemoteIDObserver::aircraftNearList(const QGeoCoordinate& center, double radiusMeters) const
+{
+    QVariantList list;
+
+    for (RemoteIDAircraft* aircraft : aircraftNear(center, radiusMeters)) {
+        list.append(QVariant::fromValue(aircraft));
+    }
+
+    return list;
+}
+
+// Each update pushed an entry on the expiry queue. An aircraft is only expired when the entry for its latest update
+// times out, older entries for aircraft which were updated since are simply dropped.
+void RemoteIDObserver::_cleanupStaleAircraft(void)
+{
+    qint64 nowMSecs = _clock.elapsed();
+
+    while (!_expiryQueue.isEmpty() && nowMSecs - _expiryQueue.head().first >= expirationTimeoutMSecs) {
+        ExpiryEntry_t entry = _expiryQueue.dequeue();
+
+        RemoteIDAircraft* aircraft = _aircraftMap.value(entry.second, nullptr);
+        if (aircraft && aircraft->lastUpdateMSecs() == entry.first) {
+            qCDebug(RemoteIDObserverLog) << "Expired" << aircraft->id();
+            _removeAircraft(aircraft);
+        }
+    }
+
+    if (_aircraftMap.isEmpty()) {
+        _cleanupTimer.stop();
+    }
+}
+
+int RemoteIDObserver::_cellIndex(double degrees)
+{
+    return static_cast<int>(qFloor(degrees / gridCellDegrees));
+}
+
+quint64 RemoteIDObserver::_cellKey(int latIndex, int lonIndex)
+{
+    return (static_cast<quint64>(static_cast<quint32>(latIndex)) << 32) | static_cast<quint32>(lonIndex);
+}
+
+void RemoteIDObserver::_updateGridCell(RemoteIDAircraft* aircraft)
+{
+    QGeoCoordinate coordinate = aircraft->coordinate();
+    if (!coordinate.isValid()) {
+        return;
+    }
+
+    quint64 newCell = _cellKey(_cellIndex(coordinate.latitude()), _cellIndex(coordinate.longitude()));
+
+    auto currentCell = _aircraftCell.constFind(aircraft);
+    if (currentCell != _aircraftCell.constEnd()) {
+        if (currentCell.value() == newCell) {
+            return;
+        }
+        _grid[currentCell.value()].removeOne(aircraft);
+        if (_grid[currentCell.value()].isEmpty()) {
+            _grid.remove(currentCell.value());
+        }
+    }
+
+    _grid[newCell].append(aircraft);
+    _aircraftCell[aircraft] = newCell;
+}
+
+void RemoteIDObserver::_removeAircraft(RemoteIDAircraft* aircraft)
+{
+    auto cell = _aircraftCell.constFind(aircraft);
+    if (cell != _aircraftCell.constEnd()) {
+        quint64 cellKey = cell.value();
+        _grid[cellKey].removeOne(aircraft);
+        if (_grid[cellKey].isEmpty()) {
+            _grid.remove(cellKey);
+        }
+        _aircraftCell.remove(aircraft);
+    }
+
+    _aircraftMap.remove(aircraft->idOrMac());
+    _aircraftList.removeOne(aircraft);
+    aircraft->deleteLater();
+    emit aircraftCountChanged();
+}
@@ -0,0 +1,71 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QQueue>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QGeoCoordinate>
+
+#include "QGCLoggingCategory.h"
+#include "QmlObjectListModel.h"
+#include "RemoteIDAircraft.h"
+
+Q_DECLARE_LOGGING_CATEGORY(RemoteIDObserverLog)
+
+/// Store for the other aircraft seen through Open Drone ID. Aircraft are indexed on a lat/lon grid so proximity queries
+/// only look at the nearby cells, and they expire from a time ordered queue so cleanup never walks the whole store.
+class RemoteIDObserver : public QObject
+{
+    Q_OBJECT
+
+public:
+    RemoteIDObserver(QObject* parent = nullptr);
+
+    Q_PROPERTY(QmlObjectListModel*  aircraft        READ aircraft       CONSTANT)
+    Q_PROPERTY(int                  aircraftCount   READ aircraftCount  NOTIFY aircraftCountChanged)
+
+    /// Returns the aircraft with a known location within radiusMeters of center
+    Q_INVOKABLE QVariantList aircraftNearList(const QGeoCoordinate& center, double radiusMeters) const;
+
+    QmlObjectListModel* aircraft        (void) { return &_aircraftList; }
+    int                 aircraftCount   (void) const { return _aircraftMap.count(); }
+
+    QList<RemoteIDAircraft*> aircraftNear(const QGeoCoordinate& center, double radiusMeters) const;
+
+    void aircraftUpdate(const RemoteIDAircraft::RemoteIDAircraftInfo_t& aircraftInfo);
+
+    static constexpr double gridCellDegrees         = 0.01;     ///< Roughly 1.1km of latitude per cell
+    static constexpr qint64 expirationTimeoutMSecs  = 30000;    ///< Aircraft are dropped after this long with no update. ODID broadcasts at 1Hz minimum.
+
+signals:
+    void aircraftCountChanged(void);
+
+private slots:
+    void _cleanupStaleAircraft(void);
+
+private:
+    typedef QPair<qint64, QByteArray> ExpiryEntry_t;
+
+    static int      _cellIndex      (double degrees);
+    static quint64  _cellKey        (int latIndex, int lonIndex);
+    void            _updateGridCell (RemoteIDAircraft* aircraft);
+    void            _removeAircraft (RemoteIDAircraft* aircraft);
+
+    QmlObjectListModel                          _aircraftList;
+    QHash<QByteArray, RemoteIDAircraft*>        _aircraftMap;
+    QHash<quint64, QList<RemoteIDAircraft*>>    _grid;
+    QHash<RemoteIDAircraft*, quint64>           _aircraftCell;
+    QQueue<ExpiryEntry_t>                       _expiryQueue;   ///< One entry per update, in update time order
+    QElapsedTimer                               _clock;
+    QTimer                                      _cleanupTimer;
+};
@@ -0,0 +1,261 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "RemoteIDScheduler.h"
+#include "RemoteIDManager.h"
+#include "Vehicle.h"
+
+#include <QQmlEngine>
+#include <QVector>
+
+QGC_LOGGING_CATEGORY(RemoteIDSchedulerLog, "RemoteIDSchedulerLog")
+
+RemoteIDScheduler::RemoteIDScheduler(QObject* parent)
+    : QObject(parent)
+{
+    QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
+
+    _clock.start();
+
+    _tickTimer.setTimerType(Qt::PreciseTimer);
+    _tickTimer.setInterval(tickIntervalMSecs);
+    connect(&_tickTimer, &QTimer::timeout, this, &RemoteIDScheduler::_tick);
+}
+
+void RemoteIDScheduler::addManager(RemoteIDManager* manager)
+{
+    if (_findEntry(manager) != -1) {
+        return;
+    }
+
+    ManagerEntry_t entry;
+    entry.manager               = manager;
+    entry.phaseMSecs            = _leastLoadedPhase();
+    entry.commsGood             = false;
+    entry.lastHeartbeatMSecs    = 0;
+    entry.nextSendMSecs         = _nextSlotTime(entry.phaseMSecs, _clock.elapsed());
+    entry.systemDueMSecs        = -1;
+    _entries.append(entry);
+
+    qCDebug(RemoteIDSchedulerLog) << "Added manager with phase" << entry.phaseMSecs << "count" << _entries.count();
+    _updateHealth();
+}
+
+void RemoteIDScheduler::removeManager(RemoteIDManager* manager)
+{
+    int index = _findEntry(manager);
+    if (index == -1) {
+        return;
+    }
+
+    _entries.removeAt(index);
+    _updateTickTimer();
+    _updateHealth();
+}
+
+void RemoteIDScheduler::heartbeatReceived(RemoteIDManager* manager)
+{
+    int index = _findEntry(manager);
+    if (index == -1) {
+        return;
+    }
+
+    ManagerEntry_t& entry = _entries[index];
+    entry.lastHeartbeatMSecs = _clock.elapsed();
+    if (!entry.commsGood) {
+        entry.commsGood     = true;
+        entry.nextSendMSecs = _nextSlotTime(entry.phaseMSecs, entry.lastHeartbeatMSecs);
+        _updateTickTimer();
+    }
+}
+
+void RemoteIDScheduler::scheduleSystem(RemoteIDManager* manager, int delayMSecs)
+{
+    int index = _findEntry(manager);
+    if (index == -1) {
+        return;
+    }
+
+    ManagerEntry_t& entry = _entries[index];
+    qint64 dueMSecs = _clock.elapsed() + qMax(delayMSecs, 0);
+    if (entry.systemDueMSecs == -1 || dueMSecs < entry.systemDueMSecs) {
+        entry.systemDueMSecs = dueMSecs;
+    }
+}
+
+void RemoteIDScheduler::cancelSystem(RemoteIDManager* manager)
+{
+    int index = _findEntry(manager);
+    if (index != -1) {
+        _entries[index].systemDueMSecs = -1;
+    }
+}
+
+void RemoteIDScheduler::resetJitterStats(void)
+{
+    _maxSendJitterMSecs = 0;
+    _jitterSumMSecs     = 0;
+    _jitterSampleCount  = 0;
+    emit jitterChanged();
+}
+
+void RemoteIDScheduler::_tick(void)
+{
+    qint64 nowMSecs     = _clock.elapsed();
+    bool jitterUpdated  = false;
+
+    // Managers may remove themselves or others from within the calls below, so work from a copy of the manager list
+    // and re-lookup each entry.
+    QList<RemoteIDManager*> managers;
+    managers.reserve(_entries.count());
+    for (const ManagerEntry_t& entry : _entries) {
+        managers.append(entry.manager);
+    }
+
+    for (RemoteIDManager* manager : managers) {
+        int index = _findEntry(manager);
+        if (index == -1) {
+            continue;
+        }
+        ManagerEntry_t& entry = _entries[index];
+
+        if (entry.commsGood && nowMSecs - entry.lastHeartbeatMSecs > heartbeatTimeoutMSecs) {
+            entry.commsGood         = false;
+            entry.systemDueMSecs    = -1;
+            manager->_heartbeatTimeout();
+            continue;
+        }
+        if (!entry.commsGood) {
+            continue;
+        }
+
+        if (nowMSecs >= entry.nextSendMSecs) {
+            int jitterMSecs = static_cast<int>(nowMSecs - entry.nextSendMSecs);
+            _maxSendJitterMSecs = qMax(_maxSendJitterMSecs, jitterMSecs);
+            _jitterSumMSecs += jitterMSecs;
+            _jitterSampleCount++;
+            jitterUpdated = true;
+
+            // Stay on our own phase even if we fell behind for more than a full period
+            entry.nextSendMSecs = _nextSlotTime(entry.phaseMSecs, nowMSecs);
+            manager->_sendMessages();
+
+            index = _findEntry(manager);
+            if (index == -1) {
+                continue;
+            }
+        }
+
+        ManagerEntry_t& systemEntry = _entries[index];
+        if (systemEntry.systemDueMSecs != -1 && nowMSecs >= systemEntry.systemDueMSecs) {
+            systemEntry.systemDueMSecs = -1;
+            manager->_sendSystemUpdate();
+        }
+    }
+
+    if (jitterUpdated) {
+        emit jitterChanged();
+    }
+
+    if (nowMSecs >= _nextHealthUpdateMSecs) {
+        _nextHealthUpdateMSecs = nowMSecs + sendPeriodMSecs;
+        _updateHealth();
+    }
+
+    _updateTickTimer();
+}
+
+int RemoteIDScheduler::_findEntry(RemoteIDManager* manager) const
+{
+    for (int i=0; i<_entries.count(); i++) {
+        if (_entries[i].manager == manager) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Picks the tick slot within the send period which currently has the fewest managers on it
+int RemoteIDScheduler::_leastLoadedPhase(void) const
+{
+    const int slotCount = sendPeriodMSecs / tickIntervalMSecs;
+
+    QVector<int> slotLoad(slotCount, 0);
+    for (const ManagerEntry_t& entry : _entries) {
+        slotLoad[entry.phaseMSecs / tickIntervalMSecs]++;
+    }
+
+    // Walk the slots with a stride which is coprime to the slot count so consecutive managers end up spread across the period
+    const int slotStride = 7;
+    int bestSlot = 0;
+    int bestLoad = -1;
+    for (int i=0; i<slotCount; i++) {
+        int slot = (i * slotStride) % slotCount;
+        if (bestLoad == -1 || slotLoad[slot] < bestLoad) {
+            bestLoad = slotLoad[slot];
+            bestSlot = slot;
+        }
+    }
+
+    return bestSlot * tickIntervalMSecs;
+}
+
+qint64 RemoteIDScheduler::_nextSlotTime(int phaseMSecs, qint64 nowMSecs) const
+{
+    qint64 slotTime = nowMSecs - (nowMSecs % sendPeriodMSecs) + phaseMSecs;
+    if (slotTime <= nowMSecs) {
+        slotTime += sendPeriodMSecs;
+    }
+    return slotTime;
+}
+
+// The tick timer only runs while at least one transponder is alive
+void RemoteIDScheduler::_updateTickTimer(void)
+{
+    bool anyCommsGood = false;
+    for (const ManagerEntry_t& entry : _entries) {
+        if (entry.commsGood) {
+            anyCommsGood = true;
+            break;
+        }
+    }
+
+    if (anyCommsGood && !_tickTimer.isActive()) {
+        _tickTimer.start();
+    } else if (!anyCommsGood && _tickTimer.isActive()) {
+        _tickTimer.stop();
+        _updateHealth();
+    }
+}
+
+void RemoteIDScheduler::_updateHealth(void)
+{
+    int             vehicleCount    = 0;
+    int             compliantCount  = 0;
+    QVariantList    nonCompliantVehicleIds;
+
+    for (const ManagerEntry_t& entry : _entries) {
+        if (entry.manager->_vehicle->isOfflineEditingVehicle()) {
+            continue;
+        }
+        vehicleCount++;
+        if (entry.manager->compliant()) {
+            compliantCount++;
+        } else {
+            nonCompliantVehicleIds.append(entry.manager->_vehicle->id());
+        }
+    }
+
+    if (vehicleCount != _vehicleCount || compliantCount != _compliantCount || nonCompliantVehicleIds != _nonCompliantVehicleIds) {
+        _vehicleCount           = vehicleCount;
+        _compliantCount         = compliantCount;
+        _nonCompliantVehicleIds = nonCompliantVehicleIds;
+        emit healthChanged();
+    }
+}
@@ -0,0 +1,99 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVariantList>
+
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(RemoteIDSchedulerLog)
+
+class RemoteIDManager;
+
+/// Drives the Remote ID transmissions for the whole fleet from a single timer. Each RemoteIDManager gets its own phase
+/// within the send period so transponders are not all hit in the same burst. Transponder heartbeats for all vehicles are
+/// tracked in a single table, which is also used to provide the aggregate compliance state of the fleet.
+class RemoteIDScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    RemoteIDScheduler(QObject* parent = nullptr);
+
+    Q_PROPERTY(int          vehicleCount            READ vehicleCount           NOTIFY healthChanged)
+    Q_PROPERTY(int          compliantCount          READ compliantCount         NOTIFY healthChanged)
+    Q_PROPERTY(QVariantList nonCompliantVehicleIds  READ nonCompliantVehicleIds NOTIFY healthChanged)
+    Q_PROPERTY(int          maxSendJitterMSecs      READ maxSendJitterMSecs     NOTIFY jitterChanged)
+    Q_PROPERTY(double       averageSendJitterMSecs  READ averageSendJitterMSecs NOTIFY jitterChanged)
+
+    /// Restarts the send jitter statistics
+    Q_INVOKABLE void resetJitterStats(void);
+
+    int             vehicleCount            (void) const { return _vehicleCount; }
+    int             compliantCount          (void) const { return _compliantCount; }
+    QVariantList    nonCompliantVehicleIds  (void) const { return _nonCompliantVehicleIds; }
+    int             maxSendJitterMSecs      (void) const { return _maxSendJitterMSecs; }
+    double          averageSendJitterMSecs  (void) const { return _jitterSampleCount ? static_cast<double>(_jitterSumMSecs) / _jitterSampleCount : 0; }
+
+    void addManager         (RemoteIDManager* manager);
+    void removeManager      (RemoteIDManager* manager);
+
+    /// Called each time a transponder heartbeat is received for the manager
+    void heartbeatReceived  (RemoteIDManager* manager);
+
+    /// Makes sure a SYSTEM update is sent for the manager no later than delayMSecs from now
+    void scheduleSystem     (RemoteIDManager* manager, int delayMSecs);
+
+    /// Drops any pending SYSTEM update for the manager
+    void cancelSystem       (RemoteIDManager* manager);
+
+    static const int tickIntervalMSecs      = 50;
+    static const int sendPeriodMSecs        = 1000;
+    static const int heartbeatTimeoutMSecs  = 5000;
+
+signals:
+    void healthChanged(void);
+    void jitterChanged(void);
+
+private slots:
+    void _tick(void);
+
+private:
+    typedef struct {
+        RemoteIDManager*    manager;
+        int                 phaseMSecs;         ///< Offset of this manager's sends within the send period
+        bool                commsGood;
+        qint64              lastHeartbeatMSecs;
+        qint64              nextSendMSecs;
+        qint64              systemDueMSecs;     ///< -1: no SYSTEM update pending
+    } ManagerEntry_t;
+
+    int     _findEntry          (RemoteIDManager* manager) const;
+    int     _leastLoadedPhase   (void) const;
+    qint64  _nextSlotTime       (int phaseMSecs, qint64 nowMSecs) const;
+    void    _updateTickTimer    (void);
+    void    _updateHealth       (void);
+
+    QList<ManagerEntry_t>   _entries;
+    QElapsedTimer           _clock;
+    QTimer                  _tickTimer;
+    qint64                  _nextHealthUpdateMSecs  = 0;
+
+    int             _vehicleCount       = 0;
+    int             _compliantCount     = 0;
+    QVariantList    _nonCompliantVehicleIds;
+
+    int             _maxSendJitterMSecs = 0;
+    qint64          _jitterSumMSecs     = 0;
+    qint64          _jitterSampleCount  = 0;
+};
@@ -29,6 +29,9 @@ public:
     static const char* _blocksPendingFactName;
     static const char* _blocksLoadedFactName;
 
+    // Overrides from FactGroup
+    QList<uint32_t> handledMessageIds(void) const override { return {}; }  ///< Values are set by TerrainProtocolHandler
+
 private:
     Fact _blocksPendingFact;
     Fact _blocksLoadedFact;
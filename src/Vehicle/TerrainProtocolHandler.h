@@ -28,7 +28,7 @@ public:
     explicit TerrainProtocolHandler(Vehicle* vehicle, TerrainFactGroup* terrainFactGroup, QObject *parent = nullptr);
 
     /// @return true: Allow vehicle to continue processing, false: Vehicle should not process message
-    bool mavlinkMessageReceived(const mavlink_message_t message);
+    bool mavlinkMessageReceived(const mavlink_message_t& message);
 
 private slots:
     void _sendNextTerrainData(void);
@@ -133,6 +133,7 @@ Vehicle::Vehicle(LinkInterface*             link,
     , _joystickManager              (joystickManager)
     , _trajectoryPoints             (new TrajectoryPoints(this, this))
     , _mavlinkStreamConfig          (std::bind(&Vehicle::_setMessageInterval, this, std::placeholders::_1, std::placeholders::_2))
+    , _streamRateController         (std::bind(&Vehicle::_measuredMessageRateHz, this, std::placeholders::_1))
     , _rollFact                     (0, _rollFactName,              FactMetaData::valueTypeDouble)
     , _pitchFact                    (0, _pitchFactName,             FactMetaData::valueTypeDouble)
     , _headingFact                  (0, _headingFactName,           FactMetaData::valueTypeDouble)
@@ -181,7 +182,6 @@ Vehicle::Vehicle(LinkInterface*             link,
     _mavlink = _toolbox->mavlinkProtocol();
     qCDebug(VehicleLog) << "Link started with Mavlink " << (_mavlink->getCurrentVersion() >= 200 ? "V2" : "V1");
 
-    connect(_mavlink, &MAVLinkProtocol::messageReceived,        this, &Vehicle::_mavlinkMessageReceived);
     connect(_mavlink, &MAVLinkProtocol::mavlinkMessageStatus,   this, &Vehicle::_mavlinkMessageStatus);
 
     connect(this, &Vehicle::flightModeChanged,          this, &Vehicle::_handleFlightModeChanged);
@@ -229,6 +229,12 @@ Vehicle::Vehicle(LinkInterface*             link,
     _mavCommandResponseCheckTimer.start();
     connect(&_mavCommandResponseCheckTimer, &QTimer::timeout, this, &Vehicle::_sendMavCommandResponseTimeoutCheck);
 
+    // Adaptive stream rates, idle until a telemetry radio reports in
+    _streamRateTimer.setSingleShot(false);
+    _streamRateTimer.setInterval(_streamRateUpdateMSecs);
+    _streamRateTimer.start();
+    connect(&_streamRateTimer, &QTimer::timeout, this, &Vehicle::_updateStreamRates);
+
     // Chunked status text timeout timer
     _chunkedStatusTextTimer.setSingleShot(true);
     _chunkedStatusTextTimer.setInterval(1000);
@@ -287,6 +293,7 @@ Vehicle::Vehicle(MAV_AUTOPILOT              firmwareType,
     , _firmwarePluginManager            (firmwarePluginManager)
     , _trajectoryPoints                 (new TrajectoryPoints(this, this))
     , _mavlinkStreamConfig              (std::bind(&Vehicle::_setMessageInterval, this, std::placeholders::_1, std::placeholders::_2))
+    , _streamRateController             (std::bind(&Vehicle::_measuredMessageRateHz, this, std::placeholders::_1))
     , _rollFact                         (0, _rollFactName,              FactMetaData::valueTypeDouble)
     , _pitchFact                        (0, _pitchFactName,             FactMetaData::valueTypeDouble)
     , _headingFact                      (0, _headingFactName,           FactMetaData::valueTypeDouble)
@@ -406,6 +413,31 @@ void Vehicle::_commonInit()
     // Remote ID manager might want to acces parameters so make sure to create it after
     _remoteIDManager = new RemoteIDManager(this);
 
+    // These only look at a handful of message ids, so they are dispatched by id rather than offered every message.
+    // Subscription order is call order: managers first, then waitForMavlinkMessage, then the fact groups.
+    // Battery fact groups are created dynamically as new batteries are discovered, creation must be subscribed ahead
+    // of the fact groups so a new battery group sees the message which created it.
+    _messageDispatcher = new MAVLinkMessageDispatcher(this);
+    _messageDispatcher->subscribe(QStringLiteral("FTPManager"),
+                                  { MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL },
+                                  [this](mavlink_message_t& message) { _ftpManager->_mavlinkMessageReceived(message); });
+    _messageDispatcher->subscribe(QStringLiteral("ParameterManager"),
+                                  { MAVLINK_MSG_ID_PARAM_VALUE },
+                                  [this](mavlink_message_t& message) { _parameterManager->mavlinkMessageReceived(message); });
+    _messageDispatcher->subscribe(QStringLiteral("ImageProtocolManager"),
+                                  { MAVLINK_MSG_ID_DATA_TRANSMISSION_HANDSHAKE, MAVLINK_MSG_ID_ENCAPSULATED_DATA },
+                                  [this](mavlink_message_t& message) { _imageProtocolManager->mavlinkMessageReceived(message); });
+    _messageDispatcher->subscribe(QStringLiteral("RemoteIDManager"),
+                                  { MAVLINK_MSG_ID_HEARTBEAT, MAVLINK_MSG_ID_OPEN_DRONE_ID_ARM_STATUS, MAVLINK_MSG_ID_OPEN_DRONE_ID_MESSAGE_PACK,
+                                    MAVLINK_MSG_ID_OPEN_DRONE_ID_LOCATION, MAVLINK_MSG_ID_OPEN_DRONE_ID_BASIC_ID, MAVLINK_MSG_ID_OPEN_DRONE_ID_SYSTEM },
+                                  [this](mavlink_message_t& message) { _remoteIDManager->mavlinkMessageReceived(message); });
+    _messageDispatcher->subscribe(QStringLiteral("WaitForMavlinkMessage"),
+                                  { MAVLinkMessageDispatcher::allMessageIds },
+                                  [this](mavlink_message_t& message) { _waitForMavlinkMessageMessageReceived(message); });
+    _messageDispatcher->subscribe(QStringLiteral("BatteryFactGroupCreation"),
+                                  { MAVLINK_MSG_ID_HIGH_LATENCY, MAVLINK_MSG_ID_HIGH_LATENCY2, MAVLINK_MSG_ID_BATTERY_STATUS },
+                                  [this](mavlink_message_t& message) { VehicleBatteryFactGroup::handleMessageForFactGroupCreation(this, message); });
+
     // Flight modes can differ based on advanced mode
     connect(_toolbox->corePlugin(), &QGCCorePlugin::showAdvancedUIChanged, this, &Vehicle::flightModesChanged);
 
@@ -493,6 +525,10 @@ Vehicle::~Vehicle()
 {
     qCDebug(VehicleLog) << "~Vehicle" << this;
 
+    if (_messageDispatcher) {
+        _messageDispatcher->logStats();
+    }
+
     delete _missionManager;
     _missionManager = nullptr;
 
@@ -596,8 +632,26 @@ void Vehicle::resetCounters()
     _heardFrom          = false;
 }
 
-void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message)
+void Vehicle::_addFactGroup(FactGroup* factGroup, const QString& name)
+{
+    bool alreadyAdded = _nameToFactGroupMap.contains(name);
+
+    FactGroup::_addFactGroup(factGroup, name);
+
+    if (!alreadyAdded) {
+        _messageDispatcher->subscribe(name, factGroup->handledMessageIds(), [this, factGroup](mavlink_message_t& message) { factGroup->handleMessage(this, message); });
+    }
+}
+
+void Vehicle::_mavlinkMessageReceived(LinkInterface* link, MAVLinkMessageRef messageRef)
 {
+    // The pooled message is shared with the router, messageTap and the other vehicles. It is only copied when the
+    // firmware plugin is going to rewrite it, everything else works on the shared message and must not change it.
+    if (_firmwarePlugin->adjustsIncomingMavlinkMessage(this, *messageRef)) {
+        messageRef = messageRef.clone();
+    }
+    mavlink_message_t& message = messageRef.mutableMessage();
+
     // If the link is already running at Mavlink V2 set our max proto version to it.
     unsigned mavlinkVersion = _mavlink->getCurrentVersion();
     if (_maxProtoVersion != mavlinkVersion && mavlinkVersion >= 200) {
@@ -605,15 +659,11 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
         qCDebug(VehicleLog) << "_mavlinkMessageReceived Link already running Mavlink v2. Setting _maxProtoVersion" << _maxProtoVersion;
     }
 
-    if (message.sysid != _id && message.sysid != 0) {
-        // We allow RADIO_STATUS messages which come from a link the vehicle is using to pass through and be handled
-        if (!(message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _vehicleLinkManager->containsLink(link))) {
-            return;
-        }
-    }
+    // MultiVehicleManager only routes our own traffic, broadcasts and RADIO_STATUS from a link we are using to us
+    Q_ASSERT(message.sysid == _id || message.sysid == 0 || (message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _vehicleLinkManager->containsLink(link)));
 
     // We give the link manager first whack since it it reponsible for adding new links
-    _vehicleLinkManager->mavlinkMessageReceived(link, message);
+    _vehicleLinkManager->mavlinkMessageReceived(link, message, messageRef.receivedNSecs());
 
     //-- Check link status
     _messagesReceived++;
@@ -654,20 +704,8 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
     if (!_terrainProtocolHandler->mavlinkMessageReceived(message)) {
         return;
     }
-    _ftpManager->_mavlinkMessageReceived(message);
-    _parameterManager->mavlinkMessageReceived(message);
-    _imageProtocolManager->mavlinkMessageReceived(message);
-    _remoteIDManager->mavlinkMessageReceived(message);
-
-    _waitForMavlinkMessageMessageReceived(message);
-
-    // Battery fact groups are created dynamically as new batteries are discovered
-    VehicleBatteryFactGroup::handleMessageForFactGroupCreation(this, message);
-
-    // Let the fact groups take a whack at the mavlink traffic
-    for (FactGroup* factGroup : factGroups()) {
-        factGroup->handleMessage(this, message);
-    }
+    // Managers and fact groups which subscribed to this message id
+    _messageDispatcher->dispatch(message);
 
     switch (message.msgid) {
     case MAVLINK_MSG_ID_HOME_POSITION:
@@ -677,7 +715,7 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
         _handleHeartbeat(message);
         break;
     case MAVLINK_MSG_ID_RADIO_STATUS:
-        _handleRadioStatus(message);
+        _handleRadioStatus(link, message);
         break;
     case MAVLINK_MSG_ID_RC_CHANNELS:
         _handleRCChannels(message);
@@ -704,7 +742,7 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
         _handleExtendedSysState(message);
         break;
     case MAVLINK_MSG_ID_COMMAND_ACK:
-        _handleCommandAck(message);
+        _handleCommandAck(link, message);
         break;
     case MAVLINK_MSG_ID_LOGGING_DATA:
         _handleMavlinkLoggingData(message);
@@ -1748,7 +1786,7 @@ void Vehicle::_handleHeartbeat(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleRadioStatus(mavlink_message_t& message)
+void Vehicle::_handleRadioStatus(LinkInterface* link, mavlink_message_t& message)
 {
 
     //-- Process telemetry status message
@@ -1777,6 +1815,11 @@ void Vehicle::_handleRadioStatus(mavlink_message_t& message)
         rssi    = (int)(int8_t)rstatus.rssi;
         remrssi = (int)(int8_t)rstatus.remrssi;
     }
+    // A radio on a secondary link says nothing about the link the streams are coming in on
+    if (link == _vehicleLinkManager->primaryLink().lock().get()) {
+        _streamRateController.radioStatusReceived(rstatus.txbuf);
+    }
+
     //-- Check for changes
     if(_telemetryLRSSI != rssi) {
         _telemetryLRSSI = rssi;
@@ -1875,7 +1918,7 @@ bool Vehicle::sendMessageOnLinkThreadSafe(LinkInterface* link, mavlink_message_t
     uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
     int len = mavlink_msg_to_send_buffer(buffer, &message);
 
-    link->writeBytesThreadSafe((const char*)buffer, len);
+    link->writeBytesThreadSafe((const char*)buffer, len, LinkSendScheduler::trafficClassForMessage(message.msgid));
     _messagesSent++;
     emit messagesSentChanged();
 
@@ -3038,6 +3081,10 @@ void Vehicle::_sendMavCommandFromList(int index)
         if (commandEntry.showError) {
             qgcApp()->showAppMessage(tr("Vehicle did not respond to command: %1").arg(rawCommandName));
         }
+        if (commandEntry.command == MAV_CMD_SET_MESSAGE_INTERVAL) {
+            // The ack is never coming, keep the stream configuration moving
+            _mavlinkStreamConfig.gotSetMessageIntervalAck();
+        }
         return;
     }
 
@@ -3055,51 +3102,81 @@ void Vehicle::_sendMavCommandFromList(int index)
         return;
     }
 
-    mavlink_message_t  msg;
-
-    if (commandEntry.useCommandInt) {
-        mavlink_command_int_t  cmd;
-
-        memset(&cmd, 0, sizeof(cmd));
-        cmd.target_system =     _id;
-        cmd.target_component =  commandEntry.targetCompId;
-        cmd.command =           commandEntry.command;
-        cmd.frame =             commandEntry.frame;
-        cmd.param1 =            commandEntry.rgParam[0];
-        cmd.param2 =            commandEntry.rgParam[1];
-        cmd.param3 =            commandEntry.rgParam[2];
-        cmd.param4 =            commandEntry.rgParam[3];
-        cmd.x =                 commandEntry.frame == MAV_FRAME_MISSION ? commandEntry.rgParam[4] : commandEntry.rgParam[4] * 1e7;
-        cmd.y =                 commandEntry.frame == MAV_FRAME_MISSION ? commandEntry.rgParam[5] : commandEntry.rgParam[5] * 1e7;
-        cmd.z =                 commandEntry.rgParam[6];
-        mavlink_msg_command_int_encode_chan(_mavlink->getSystemId(),
-                                            _mavlink->getComponentId(),
-                                            sharedLink->mavlinkChannel(),
-                                            &msg,
-                                            &cmd);
-    } else {
-        mavlink_command_long_t  cmd;
-
-        memset(&cmd, 0, sizeof(cmd));
-        cmd.target_system =     _id;
-        cmd.target_component =  commandEntry.targetCompId;
-        cmd.command =           commandEntry.command;
-        cmd.confirmation =      0;
-        cmd.param1 =            commandEntry.rgParam[0];
-        cmd.param2 =            commandEntry.rgParam[1];
-        cmd.param3 =            commandEntry.rgParam[2];
-        cmd.param4 =            commandEntry.rgParam[3];
-        cmd.param5 =            commandEntry.rgParam[4];
-        cmd.param6 =            commandEntry.rgParam[5];
-        cmd.param7 =            commandEntry.rgParam[6];
-        mavlink_msg_command_long_encode_chan(_mavlink->getSystemId(),
-                                             _mavlink->getComponentId(),
-                                             sharedLink->mavlinkChannel(),
-                                             &msg,
-                                             &cmd);
+    // Critical commands also go out over the other working links once an attempt has gone unanswered, or straight away
+    // if the primary link was lost recently, in case the primary link is failing right now
+    QList<SharedLinkInterfacePtr> links = { sharedLink };
+    if (_vehicleLinkManager->duplicateCriticalCommands() && VehicleLinkManager::isCriticalCommand(commandEntry.command) &&
+            (commandEntry.tryCount > 1 || _vehicleLinkManager->primaryLinkRecentlyLost())) {
+        links.append(_vehicleLinkManager->secondaryLinks());
+    }
+
+    for (const SharedLinkInterfacePtr& link : links) {
+        mavlink_message_t  msg;
+
+        if (commandEntry.useCommandInt) {
+            mavlink_command_int_t  cmd;
+
+            memset(&cmd, 0, sizeof(cmd));
+            cmd.target_system =     _id;
+            cmd.target_component =  commandEntry.targetCompId;
+            cmd.command =           commandEntry.command;
+            cmd.frame =             commandEntry.frame;
+            cmd.param1 =            commandEntry.rgParam[0];
+            cmd.param2 =            commandEntry.rgParam[1];
+            cmd.param3 =            commandEntry.rgParam[2];
+            cmd.param4 =            commandEntry.rgParam[3];
+            cmd.x =                 commandEntry.frame == MAV_FRAME_MISSION ? commandEntry.rgParam[4] : commandEntry.rgParam[4] * 1e7;
+            cmd.y =                 commandEntry.frame == MAV_FRAME_MISSION ? commandEntry.rgParam[5] : commandEntry.rgParam[5] * 1e7;
+            cmd.z =                 commandEntry.rgParam[6];
+            mavlink_msg_command_int_encode_chan(_mavlink->getSystemId(),
+                                                _mavlink->getComponentId(),
+                                                link->mavlinkChannel(),
+                                                &msg,
+                                                &cmd);
+        } else {
+            mavlink_command_long_t  cmd;
+
+            memset(&cmd, 0, sizeof(cmd));
+            cmd.target_system =     _id;
+            cmd.target_component =  commandEntry.targetCompId;
+            cmd.command =           commandEntry.command;
+            cmd.confirmation =      static_cast<uint8_t>(commandEntry.tryCount - 1);
+            cmd.param1 =            commandEntry.rgParam[0];
+            cmd.param2 =            commandEntry.rgParam[1];
+            cmd.param3 =            commandEntry.rgParam[2];
+            cmd.param4 =            commandEntry.rgParam[3];
+            cmd.param5 =            commandEntry.rgParam[4];
+            cmd.param6 =            commandEntry.rgParam[5];
+            cmd.param7 =            commandEntry.rgParam[6];
+            mavlink_msg_command_long_encode_chan(_mavlink->getSystemId(),
+                                                 _mavlink->getComponentId(),
+                                                 link->mavlinkChannel(),
+                                                 &msg,
+                                                 &cmd);
+        }
+
+        if (sendMessageOnLinkThreadSafe(link.get(), msg) && !_mavCommandList[index].sentLinks.contains(link.get())) {
+            _mavCommandList[index].sentLinks.append(link.get());
+        }
     }
+}
 
-    sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
+/// @return true: The ack answers another copy of a command which has already been answered, it is removed from the expected acks
+bool Vehicle::_takeDuplicateCommandAck(LinkInterface* link, int compId, MAV_CMD command)
+{
+    bool found = false;
+
+    for (int i=_duplicateCommandAcks.count()-1; i>=0; i--) {
+        const DuplicateCommandAck_t& duplicateAck = _duplicateCommandAcks[i];
+        if (duplicateAck.elapsedTimer.elapsed() > _mavCommandAckTimeoutMSecs) {
+            _duplicateCommandAcks.removeAt(i);
+        } else if (!found && duplicateAck.link == link && duplicateAck.compId == compId && duplicateAck.command == command) {
+            _duplicateCommandAcks.removeAt(i);
+            found = true;
+        }
+    }
+
+    return found;
 }
 
 void Vehicle::_sendMavCommandResponseTimeoutCheck(void)
@@ -3118,7 +3195,7 @@ void Vehicle::_sendMavCommandResponseTimeoutCheck(void)
     }
 }
 
-void Vehicle::_handleCommandAck(mavlink_message_t& message)
+void Vehicle::_handleCommandAck(LinkInterface* link, mavlink_message_t& message)
 {
     mavlink_command_ack_t ack;
     mavlink_msg_command_ack_decode(&message, &ack);
@@ -3151,10 +3228,29 @@ void Vehicle::_handleCommandAck(mavlink_message_t& message)
     }
 #endif
 
+    if (_takeDuplicateCommandAck(link, message.compid, static_cast<MAV_CMD>(ack.command))) {
+        // Must not complete a newer copy of the same command
+        qCDebug(VehicleLog) << "_handleCommandAck Dropping ack to duplicate of answered command" << rawCommandName;
+        return;
+    }
+
     int entryIndex = _findMavCommandListEntryIndex(message.compid, static_cast<MAV_CMD>(ack.command));
+    if (entryIndex != -1 && !_mavCommandList[entryIndex].sentLinks.contains(link)) {
+        // The vehicle answers on the link a command arrived on, so this is not the answer to the pending command
+        qCDebug(VehicleLog) << "_handleCommandAck Dropping ack from link command was not sent on" << rawCommandName;
+        return;
+    }
+
     bool commandInList = false;
     if (entryIndex != -1) {
         MavCommandListEntry_t commandEntry = _mavCommandList.takeAt(entryIndex);
+        for (LinkInterface* sentLink: commandEntry.sentLinks) {
+            if (sentLink != link) {
+                DuplicateCommandAck_t duplicateAck = { message.compid, commandEntry.command, sentLink, QElapsedTimer() };
+                duplicateAck.elapsedTimer.start();
+                _duplicateCommandAcks.append(duplicateAck);
+            }
+        }
         if (commandEntry.command == ack.command) {
             if (commandEntry.resultHandler) {
                 (*commandEntry.resultHandler)(commandEntry.resultHandlerData, message.compid, static_cast<MAV_RESULT>(ack.result), ack.progress, MavCmdResultCommandResultOnly);
@@ -3190,6 +3286,10 @@ void Vehicle::_handleCommandAck(mavlink_message_t& message)
 
     // advance PID tuning setup/teardown
     if (ack.command == MAV_CMD_SET_MESSAGE_INTERVAL) {
+        if (ack.result == MAV_RESULT_UNSUPPORTED && _streamRateController.enabled()) {
+            qCDebug(VehicleLog) << "SET_MESSAGE_INTERVAL not supported, adaptive stream rates disabled";
+            _streamRateController.setEnabled(false);
+        }
         _mavlinkStreamConfig.gotSetMessageIntervalAck();
     }
 }
@@ -3922,6 +4022,57 @@ void Vehicle::_setMessageInterval(int messageId, int rate)
                    rate);
 }
 
+void Vehicle::_updateStreamRates(void)
+{
+    SharedLinkInterfacePtr sharedLink = vehicleLinkManager()->primaryLink().lock();
+    if (!sharedLink) {
+        return;
+    }
+
+    // The radio status and cuts were for the old primary link, the new one may not even have a radio
+    if (sharedLink.get() != _streamRateLink) {
+        _streamRateLink = sharedLink.get();
+        _mavlinkStreamConfig.setAdaptiveRates(_streamRateController.linkChanged());
+    }
+
+    // High rate telemetry for PID tuning owns the streams while it is active. Start over from the defaults once it is done.
+    const bool highRateActive = _mavlinkStreamConfig.highRateActive();
+    if (highRateActive != _streamRateHighRateActive) {
+        _streamRateHighRateActive = highRateActive;
+        if (!highRateActive) {
+            _mavlinkStreamConfig.setAdaptiveRates(_streamRateController.reset());
+        }
+    }
+    if (highRateActive) {
+        return;
+    }
+
+    const QVector<MAVLinkStreamConfig::DesiredStreamRate> changes = _streamRateController.update(vehicleLinkManager()->linkLossRate(sharedLink.get()));
+    if (!changes.isEmpty()) {
+        _mavlinkStreamConfig.setAdaptiveRates(changes);
+    }
+}
+
+double Vehicle::_measuredMessageRateHz(int messageId)
+{
+    SharedLinkInterfacePtr sharedLink = vehicleLinkManager()->primaryLink().lock();
+    if (!sharedLink) {
+        return 0;
+    }
+
+    const MAVLinkTrafficStats& trafficStats = sharedLink->trafficStats();
+    for (const MAVLinkTrafficStats::Stream_t& stream : trafficStats.streams()) {
+        if (stream.sysid == _id && stream.compid == defaultComponentId() && static_cast<int>(stream.msgid) == messageId) {
+            // A stream which has stopped has no rate
+            if (stream.meanIntervalMSecs > 0 && trafficStats.elapsedMSecs() - stream.lastArrivalMSecs < 5000) {
+                return 1000.0 / stream.meanIntervalMSecs;
+            }
+            break;
+        }
+    }
+    return 0;
+}
+
 bool Vehicle::isInitialConnectComplete() const
 {
     return !_initialConnectStateMachine->active();
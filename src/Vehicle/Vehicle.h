@@ -22,6 +22,7 @@
 #include "QmlObjectListModel.h"
 #include "MAVLinkProtocol.h"
 #include "MAVLinkStreamConfig.h"
+#include "MAVLinkStreamRateController.h"
 #include "UASMessageHandler.h"
 #include "SettingsFact.h"
 #include "QGCMapCircle.h"
@@ -48,6 +49,7 @@
 #include "ImageProtocolManager.h"
 #include "HealthAndArmingCheckReport.h"
 #include "RemoteIDManager.h"
+#include "MAVLinkMessageDispatcher.h"
 
 class Actuators;
 class EventHandler;
@@ -93,6 +95,7 @@ class Vehicle : public FactGroup
     Q_OBJECT
 
     friend class InitialConnectStateMachine;
+    friend class MultiVehicleManager;               // Routes incoming messages to _mavlinkMessageReceived
     friend class VehicleLinkManager;
     friend class VehicleBatteryFactGroup;           // Allow VehicleBatteryFactGroup to call _addFactGroup
     friend class SendMavCommandWithSignallingTest;  // Unit test
@@ -282,6 +285,7 @@ public:
     Q_PROPERTY(VehicleObjectAvoidance*  objectAvoidance     READ objectAvoidance    CONSTANT)
     Q_PROPERTY(Autotune*                autotune            READ autotune           CONSTANT)
     Q_PROPERTY(RemoteIDManager*         remoteIDManager     READ remoteIDManager    CONSTANT)
+    Q_PROPERTY(MAVLinkMessageDispatcher* messageDispatcher  READ messageDispatcher  CONSTANT)
 
     // FactGroup object model properties
 
@@ -709,6 +713,7 @@ public:
     VehicleObjectAvoidance*         objectAvoidance     () { return _objectAvoidance; }
     Autotune*                       autotune            () const { return _autotune; }
     RemoteIDManager*                remoteIDManager     () {return _remoteIDManager; }
+    MAVLinkMessageDispatcher*       messageDispatcher   () { return _messageDispatcher; }
 
     static const int cMaxRcChannels = 18;
 
@@ -983,7 +988,7 @@ signals:
     void sensorsParametersResetAck      (bool success);
 
 private slots:
-    void _mavlinkMessageReceived            (LinkInterface* link, mavlink_message_t message);
+    void _mavlinkMessageReceived            (LinkInterface* link, MAVLinkMessageRef messageRef);
     void _sendMessageMultipleNext           ();
     void _parametersReady                   (bool parametersReady);
     void _remoteControlRSSIChanged          (uint8_t rssi);
@@ -1022,12 +1027,12 @@ private:
     void _handlePing                    (LinkInterface* link, mavlink_message_t& message);
     void _handleHomePosition            (mavlink_message_t& message);
     void _handleHeartbeat               (mavlink_message_t& message);
-    void _handleRadioStatus             (mavlink_message_t& message);
+    void _handleRadioStatus             (LinkInterface* link, mavlink_message_t& message);
     void _handleRCChannels              (mavlink_message_t& message);
     void _handleBatteryStatus           (mavlink_message_t& message);
     void _handleSysStatus               (mavlink_message_t& message);
     void _handleExtendedSysState        (mavlink_message_t& message);
-    void _handleCommandAck              (mavlink_message_t& message);
+    void _handleCommandAck              (LinkInterface* link, mavlink_message_t& message);
     void _handleGpsRawInt               (mavlink_message_t& message);
     void _handleGlobalPositionInt       (mavlink_message_t& message);
     void _handleAltitude                (mavlink_message_t& message);
@@ -1058,6 +1063,7 @@ private:
     void _handleMavlinkLoggingDataAcked (mavlink_message_t& message);
     void _ackMavlinkLogData             (uint16_t sequence);
     void _commonInit                    ();
+    void _addFactGroup                  (FactGroup* factGroup, const QString& name);
     void _setupAutoDisarmSignalling     ();
     void _setCapabilities               (uint64_t capabilityBits);
     void _updateArmed                   (bool armed);
@@ -1069,6 +1075,8 @@ private:
     void _chunkedStatusTextTimeout      (void);
     void _chunkedStatusTextCompleted    (uint8_t compId);
     void _setMessageInterval            (int messageId, int rate);
+    void _updateStreamRates             (void);
+    double _measuredMessageRateHz       (int messageId);
     EventHandler& _eventHandler         (uint8_t compid);
 
     static void _rebootCommandResultHandler(void* resultHandlerData, int compId, MAV_RESULT commandResult, uint8_t progress, MavCmdResultFailureCode_t failureCode);
@@ -1244,6 +1252,13 @@ private:
 
     MAVLinkStreamConfig _mavlinkStreamConfig;
 
+    // Adaptive telemetry rates for radio links
+    MAVLinkStreamRateController _streamRateController;
+    QTimer                      _streamRateTimer;
+    bool                        _streamRateHighRateActive = false;  ///< Last known MAVLinkStreamConfig::highRateActive
+    LinkInterface*              _streamRateLink = nullptr;          ///< Primary link the stream rates were last adjusted for
+    static const int            _streamRateUpdateMSecs = 1000;
+
     // Chunked status text support
     typedef struct {
         uint16_t    chunkId;
@@ -1300,9 +1315,19 @@ private:
         int                 tryCount            = 0;
         QElapsedTimer       elapsedTimer;
         int                 ackTimeoutMSecs     = _mavCommandAckTimeoutMSecs;
+        QList<LinkInterface*> sentLinks;                    ///< Links any attempt went out on, acks from other links answer someone else
     } MavCommandListEntry_t;
 
+    // An answered command which went out over more than one link will be answered again on the other links
+    typedef struct DuplicateCommandAck {
+        int                 compId;
+        MAV_CMD             command;
+        LinkInterface*      link;
+        QElapsedTimer       elapsedTimer;
+    } DuplicateCommandAck_t;
+
     QList<MavCommandListEntry_t>    _mavCommandList;
+    QList<DuplicateCommandAck_t>    _duplicateCommandAcks;
     QTimer                          _mavCommandResponseCheckTimer;
     static const int                _mavCommandMaxRetryCount                = 3;
     static const int                _mavCommandResponseCheckTimeoutMSecs    = 500;
@@ -1314,6 +1339,7 @@ private:
     int  _findMavCommandListEntryIndex(int targetCompId, MAV_CMD command);
     bool _sendMavCommandShouldRetry(MAV_CMD command);
     bool _commandCanBeDuplicated(MAV_CMD command);
+    bool _takeDuplicateCommandAck(LinkInterface* link, int compId, MAV_CMD command);
 
     QMap<uint8_t /* batteryId */, uint8_t /* MAV_BATTERY_CHARGE_STATE_OK */> _lowestBatteryChargeStateAnnouncedMap;
 
@@ -1377,6 +1403,7 @@ private:
     InitialConnectStateMachine*     _initialConnectStateMachine = nullptr;
     Actuators*                      _actuators                  = nullptr;
     RemoteIDManager*                _remoteIDManager            = nullptr;
+    MAVLinkMessageDispatcher*       _messageDispatcher          = nullptr;
 
     static const char* _rollFactName;
     static const char* _pitchFactName;
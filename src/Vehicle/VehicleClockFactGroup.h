@@ -32,6 +32,9 @@ public:
 
     static const char* _settingsGroup;
 
+    // Overrides from FactGroup
+    QList<uint32_t> handledMessageIds(void) const override { return {}; }  ///< Values come from the local clock
+
 private slots:
     void _updateAllValues() override;
 
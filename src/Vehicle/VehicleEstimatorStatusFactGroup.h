@@ -65,6 +65,7 @@ public:
 
     // Overrides from FactGroup
     void handleMessage(Vehicle* vehicle, mavlink_message_t& message) override;
+    QList<uint32_t> handledMessageIds(void) const override;
 
     static const char* _goodAttitudeEstimateFactName;
     static const char* _goodHorizVelEstimateFactName;
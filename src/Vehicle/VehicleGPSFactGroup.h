@@ -39,6 +39,7 @@ public:
 
     // Overrides from FactGroup
     virtual void handleMessage(Vehicle* vehicle, mavlink_message_t& message) override;
+    virtual QList<uint32_t> handledMessageIds(void) const override;
 
     static const char* _latFactName;
     static const char* _lonFactName;
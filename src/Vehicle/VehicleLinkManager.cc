@@ -12,6 +12,7 @@
 #include "QGCLoggingCategory.h"
 #include "LinkManager.h"
 #include "QGCApplication.h"
+#include "MAVLinkRouter.h"
 
 QGC_LOGGING_CATEGORY(VehicleLinkManagerLog, "VehicleLinkManagerLog")
 
@@ -22,12 +23,16 @@ VehicleLinkManager::VehicleLinkManager(Vehicle* vehicle)
 {
     connect(this,                   &VehicleLinkManager::linkNamesChanged,  this, &VehicleLinkManager::linkStatusesChanged);
     connect(&_commLostCheckTimer,   &QTimer::timeout,                       this, &VehicleLinkManager::_commLostCheck);
+    connect(&_linkMetricsTimer,     &QTimer::timeout,                       this, &VehicleLinkManager::_updateLinkMetrics);
 
     _commLostCheckTimer.setSingleShot(false);
     _commLostCheckTimer.setInterval(_commLostCheckTimeoutMSecs);
+    _linkMetricsTimer.setSingleShot(false);
+    _linkMetricsTimer.setInterval(_linkMetricsIntervalMSecs);
+    _primaryLinkElapsedTimer.start();
 }
 
-void VehicleLinkManager::mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message)
+void VehicleLinkManager::mavlinkMessageReceived(LinkInterface* link, const mavlink_message_t& message, qint64 receivedNSecs)
 {
     // Radio status messages come from Sik Radios directly. It doesn't indicate there is any life on the other end.
     if (message.msgid != MAVLINK_MSG_ID_RADIO_STATUS) {
@@ -37,11 +42,182 @@ void VehicleLinkManager::mavlinkMessageReceived(LinkInterface* link, mavlink_mes
         } else {
             LinkInfo_t& linkInfo = _rgLinkInfo[linkIndex];
             linkInfo.heartbeatElapsedTimer.restart();
+
+            // Loss from sequence gaps, per component since each one numbers its own messages
+            auto lastSeq = linkInfo.lastSeq.find(message.compid);
+            if (lastSeq != linkInfo.lastSeq.end()) {
+                const uint8_t seqDelta = static_cast<uint8_t>(message.seq - lastSeq.value());
+                // Anything far off is a reordered message or a component restart rather than loss
+                if (seqDelta > 0 && seqDelta < 128) {
+                    linkInfo.lostCount += seqDelta - 1;
+                }
+                lastSeq.value() = message.seq;
+            } else {
+                linkInfo.lastSeq.insert(message.compid, message.seq);
+            }
+            linkInfo.receivedCount++;
+            linkInfo.receivedBytes += MAVLinkRouter::frameLength(message);
+
             if (_rgLinkInfo[linkIndex].commLost) {
                 _commRegainedOnLink(link);
             }
         }
     }
+
+    if (message.msgid == MAVLINK_MSG_ID_TIMESYNC) {
+        _handleTimesync(link, message, receivedNSecs ? receivedNSecs : MAVLinkTimesync::nowNSecs());
+    }
+}
+
+void VehicleLinkManager::_handleTimesync(LinkInterface* link, const mavlink_message_t& message, qint64 receivedNSecs)
+{
+    int linkIndex = _containsLinkIndex(link);
+    if (linkIndex == -1) {
+        return;
+    }
+
+    mavlink_timesync_t timesync;
+    mavlink_msg_timesync_decode(&message, &timesync);
+
+    LinkInfo_t& linkInfo = _rgLinkInfo[linkIndex];
+
+    if (timesync.tc1 == 0) {
+        // The vehicle is syncing its clock to ours. Our reply goes out untargeted, so stay quiet when something else on the
+        // vehicle, such as a companion computer, is already answering, otherwise the vehicle gets two conflicting answers.
+        if (linkInfo.otherTimesyncSourceElapsedTimer.isValid() && linkInfo.otherTimesyncSourceElapsedTimer.elapsed() < _otherTimesyncSourceMSecs) {
+            qCDebug(VehicleLinkManagerLog) << "TIMESYNC request not answered, another component is the time source" << link->linkConfiguration()->name();
+            return;
+        }
+        _vehicle->sendMessageOnLinkThreadSafe(link, MAVLinkTimesync::replyMessage(static_cast<uint8_t>(_vehicle->_mavlink->getSystemId()),
+                                                                                   static_cast<uint8_t>(_vehicle->_mavlink->getComponentId()),
+                                                                                   link->mavlinkChannel(),
+                                                                                   timesync,
+                                                                                   MAVLinkTimesync::nowNSecs()));
+        return;
+    }
+
+    if (message.compid != _vehicle->defaultComponentId()) {
+        // Only the autopilot clock is tracked, any other component replying is answering the autopilot's requests
+        linkInfo.otherTimesyncSourceElapsedTimer.start();
+        return;
+    }
+
+    MAVLinkTimesync& linkTimesync = linkInfo.timesync;
+    if (linkTimesync.replyReceived(timesync, receivedNSecs)) {
+        qCDebug(VehicleLinkManagerLog) << "TIMESYNC" << link->linkConfiguration()->name()
+                                       << "rtt(ms)" << linkTimesync.rttNSecs() / 1e6
+                                       << "offset(ms)" << linkTimesync.offsetNSecs() / 1e6;
+    }
+}
+
+QList<LinkInterface*> VehicleLinkManager::timesyncLinks(void) const
+{
+    QList<LinkInterface*> links;
+
+    for (const LinkInfo_t& linkInfo: _rgLinkInfo) {
+        // Don't spend high latency bandwidth on this, nor talk into a link which has gone quiet
+        if (!linkInfo.commLost && !linkInfo.link->linkConfiguration()->isHighLatency()) {
+            links.append(linkInfo.link.get());
+        }
+    }
+
+    return links;
+}
+
+void VehicleLinkManager::timesyncRequestSent(LinkInterface* link, qint64 ts1NSecs)
+{
+    int linkIndex = _containsLinkIndex(link);
+    if (linkIndex != -1) {
+        _rgLinkInfo[linkIndex].timesync.requestSent(ts1NSecs);
+    }
+}
+
+void VehicleLinkManager::_updateLinkMetrics(void)
+{
+    const double elapsedSecs = qMax(_linkMetricsElapsedTimer.restart(), static_cast<qint64>(1)) / 1000.0;
+
+    for (LinkInfo_t& linkInfo: _rgLinkInfo) {
+        const int totalCount = linkInfo.receivedCount + linkInfo.lostCount;
+        // Nothing at all arriving is as bad as it gets
+        const double lossSample = totalCount ? static_cast<double>(linkInfo.lostCount) / totalCount : 1.0;
+
+        if (!linkInfo.link->linkConfiguration()->isHighLatency()) {
+            linkInfo.lossRate += (lossSample - linkInfo.lossRate) * _metricsSmoothing;
+        }
+        linkInfo.byteRate       += (linkInfo.receivedBytes / elapsedSecs - linkInfo.byteRate) * _metricsSmoothing;
+        linkInfo.cost           = _linkCost(linkInfo);
+        linkInfo.receivedCount  = 0;
+        linkInfo.lostCount      = 0;
+        linkInfo.receivedBytes  = 0;
+    }
+
+    if (_switchToCheaperLink()) {
+        QString msg = tr("%1Switching communication to faster link.").arg(_vehicle->_vehicleIdSpeech());
+        _vehicle->_say(msg);
+        qgcApp()->showAppMessage(msg);
+    }
+}
+
+double VehicleLinkManager::_linkCost(const LinkInfo_t& linkInfo)
+{
+    double cost = linkInfo.timesync.valid() ? linkInfo.timesync.rttNSecs() / 1e6 : _unknownRttCostMSecs;
+
+    cost += linkInfo.lossRate * _lossCostMSecs;
+    if (linkInfo.byteRate < _minByteRate) {
+        cost += (1.0 - linkInfo.byteRate / _minByteRate) * _lowByteRateCostMSecs;
+    }
+
+    return cost;
+}
+
+bool VehicleLinkManager::_switchToCheaperLink(void)
+{
+    SharedLinkInterfacePtr  primaryLink = _primaryLink.lock();
+    int                     linkIndex   = _containsLinkIndex(primaryLink.get());
+
+    // Lost and high latency primary links are handled by _updatePrimaryLink
+    if (_primaryLinkPinned || linkIndex == -1 || _rgLinkInfo[linkIndex].commLost || primaryLink->linkConfiguration()->isHighLatency()) {
+        _cheaperLinkCount = 0;
+        return false;
+    }
+
+    const LinkInfo_t*   cheapestLinkInfo    = nullptr;
+    const double        primaryCost         = _rgLinkInfo[linkIndex].cost;
+    for (const LinkInfo_t& linkInfo: _rgLinkInfo) {
+        if (linkInfo.link == primaryLink || linkInfo.commLost || linkInfo.link->linkConfiguration()->isHighLatency()) {
+            continue;
+        }
+        if (!cheapestLinkInfo || linkInfo.cost < cheapestLinkInfo->cost) {
+            cheapestLinkInfo = &linkInfo;
+        }
+    }
+
+    // Hysteresis: the other link has to be clearly cheaper, for a while, and the primary link can't have just changed
+    if (!cheapestLinkInfo || cheapestLinkInfo->cost > qMin(primaryCost * _switchCostRatio, primaryCost - _switchCostMarginMSecs)) {
+        _cheaperLinkCount = 0;
+        return false;
+    }
+    if (cheapestLinkInfo->link.get() != _cheaperLink) {
+        _cheaperLink        = cheapestLinkInfo->link.get();
+        _cheaperLinkCount   = 0;
+    }
+    if (++_cheaperLinkCount < _switchHoldCount || _primaryLinkElapsedTimer.elapsed() < _minPrimaryLinkHoldMSecs) {
+        return false;
+    }
+
+    qCDebug(VehicleLinkManagerLog) << "Switching primary link on cost" << primaryLink->linkConfiguration()->name() << primaryCost
+                                   << "->" << cheapestLinkInfo->link->linkConfiguration()->name() << cheapestLinkInfo->cost;
+    _setPrimaryLink(cheapestLinkInfo->link);
+
+    return true;
+}
+
+void VehicleLinkManager::_setPrimaryLink(const SharedLinkInterfacePtr& link)
+{
+    _primaryLink = link;
+    _primaryLinkElapsedTimer.restart();
+    _cheaperLinkCount = 0;
+    emit primaryLinkChanged();
 }
 
 void VehicleLinkManager::_commRegainedOnLink(LinkInterface* link)
@@ -111,6 +287,9 @@ void VehicleLinkManager::_commLostCheck(void)
 
             // Notify the user of individual link communication loss
             bool isPrimaryLink = linkInfo.link.get() == _primaryLink.lock().get();
+            if (isPrimaryLink) {
+                _primaryLinkLostElapsedTimer.start();
+            }
             if (_rgLinkInfo.count() > 1) {
                 QString msg = tr("%1Communication lost on %2 link.").arg(_vehicle->_vehicleIdSpeech()).arg(isPrimaryLink ? tr("primary") : tr("secondary"));
                 _vehicle->_say(msg);
@@ -191,6 +370,8 @@ void VehicleLinkManager::_addLink(LinkInterface* link)
 
         if (_rgLinkInfo.count() == 1) {
             _commLostCheckTimer.start();
+            _linkMetricsTimer.start();
+            _linkMetricsElapsedTimer.start();
         }
     }
 }
@@ -217,6 +398,7 @@ void VehicleLinkManager::_removeLink(LinkInterface* link)
 
         if (_rgLinkInfo.count() == 0) {
             _commLostCheckTimer.stop();
+            _linkMetricsTimer.stop();
         }
     }
 }
@@ -257,16 +439,19 @@ SharedLinkInterfacePtr VehicleLinkManager::_bestActivePrimaryLink(void)
     }
 #endif
 
-    // Next best is normal latency link
+    // Next best is the cheapest normal latency link
+    const LinkInfo_t* cheapestLinkInfo = nullptr;
     for (const LinkInfo_t& linkInfo: _rgLinkInfo) {
         if (!linkInfo.commLost) {
-            SharedLinkInterfacePtr      link    = linkInfo.link;
-            SharedLinkConfigurationPtr  config  = link->linkConfiguration();
-            if (config && !config->isHighLatency()) {
-                return link;
+            SharedLinkConfigurationPtr config = linkInfo.link->linkConfiguration();
+            if (config && !config->isHighLatency() && (!cheapestLinkInfo || linkInfo.cost < cheapestLinkInfo->cost)) {
+                cheapestLinkInfo = &linkInfo;
             }
         }
     }
+    if (cheapestLinkInfo) {
+        return cheapestLinkInfo->link;
+    }
 
     // Last possible choice is a high latency link
     SharedLinkInterfacePtr link = _primaryLink.lock();
@@ -312,8 +497,8 @@ bool VehicleLinkManager::_updatePrimaryLink(void)
                                0); // Stop transmission on this link
             }
 
-            _primaryLink = bestActivePrimaryLink;
-            emit primaryLinkChanged();
+            _primaryLinkPinned = false;
+            _setPrimaryLink(bestActivePrimaryLink);
 
             if (bestActivePrimaryLink && bestActivePrimaryLink->linkConfiguration()->isHighLatency()) {
                 _vehicle->sendMavCommand(MAV_COMP_ID_AUTOPILOT1,
@@ -367,8 +552,8 @@ void VehicleLinkManager::setPrimaryLinkByName(const QString& name)
 {
     for (const LinkInfo_t& linkInfo: _rgLinkInfo) {
         if (linkInfo.link->linkConfiguration()->name() == name) {
-            _primaryLink = linkInfo.link;
-            emit primaryLinkChanged();
+            _primaryLinkPinned = true;
+            _setPrimaryLink(linkInfo.link);
         }
     }
 }
@@ -404,3 +589,88 @@ bool VehicleLinkManager::primaryLinkIsPX4Flow(void) const
         return sharedLink->isPX4Flow();
     }
 }
+
+qint64 VehicleLinkManager::linkRttNSecs(LinkInterface* link) const
+{
+    for (const LinkInfo_t& linkInfo: _rgLinkInfo) {
+        if (linkInfo.link.get() == link) {
+            return linkInfo.timesync.valid() ? linkInfo.timesync.rttNSecs() : -1;
+        }
+    }
+    return -1;
+}
+
+double VehicleLinkManager::linkLossRate(LinkInterface* link) const
+{
+    for (const LinkInfo_t& linkInfo: _rgLinkInfo) {
+        if (linkInfo.link.get() == link) {
+            return linkInfo.lossRate;
+        }
+    }
+    return 0;
+}
+
+qint64 VehicleLinkManager::vehicleTimeNSecs(LinkInterface* link, qint64 localNSecs) const
+{
+    for (const LinkInfo_t& linkInfo: _rgLinkInfo) {
+        if (linkInfo.link.get() == link) {
+            return linkInfo.timesync.valid() ? linkInfo.timesync.vehicleNSecs(localNSecs) : -1;
+        }
+    }
+    return -1;
+}
+
+QVariantList VehicleLinkManager::linkStats(void) const
+{
+    QVariantList linkStats;
+
+    for (const LinkInfo_t& linkInfo: _rgLinkInfo) {
+        QVariantMap map;
+
+        map[QStringLiteral("name")]             = linkInfo.link->linkConfiguration()->name();
+        map[QStringLiteral("commLost")]         = linkInfo.commLost;
+        map[QStringLiteral("timesyncValid")]    = linkInfo.timesync.valid();
+        map[QStringLiteral("rttMSecs")]         = linkInfo.timesync.rttNSecs() / 1e6;
+        map[QStringLiteral("rttJitterMSecs")]   = linkInfo.timesync.rttJitterNSecs() / 1e6;
+        map[QStringLiteral("clockOffsetMSecs")] = linkInfo.timesync.offsetNSecs() / 1e6;
+        map[QStringLiteral("lossRate")]         = linkInfo.lossRate;
+        map[QStringLiteral("byteRate")]         = linkInfo.byteRate;
+        map[QStringLiteral("cost")]             = linkInfo.cost;
+        linkStats.append(map);
+    }
+
+    return linkStats;
+}
+
+QList<SharedLinkInterfacePtr> VehicleLinkManager::secondaryLinks(void) const
+{
+    QList<SharedLinkInterfacePtr>   links;
+    SharedLinkInterfacePtr          primaryLink = _primaryLink.lock();
+
+    for (const LinkInfo_t& linkInfo: _rgLinkInfo) {
+        if (linkInfo.link != primaryLink && !linkInfo.commLost && !linkInfo.link->linkConfiguration()->isHighLatency()) {
+            links.append(linkInfo.link);
+        }
+    }
+
+    return links;
+}
+
+bool VehicleLinkManager::primaryLinkRecentlyLost(void) const
+{
+    return _primaryLinkLostElapsedTimer.isValid() && _primaryLinkLostElapsedTimer.elapsed() < _primaryLinkLostHoldMSecs;
+}
+
+bool VehicleLinkManager::isCriticalCommand(MAV_CMD command)
+{
+    switch (command) {
+    case MAV_CMD_COMPONENT_ARM_DISARM:
+    case MAV_CMD_DO_FLIGHTTERMINATION:
+    case MAV_CMD_DO_SET_MODE:
+    case MAV_CMD_NAV_LAND:
+    case MAV_CMD_NAV_RETURN_TO_LAUNCH:
+        return true;
+    default:
+        return false;
+    }
+}
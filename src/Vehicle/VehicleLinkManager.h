@@ -17,6 +17,7 @@
 
 #include "QGCMAVLink.h"
 #include "LinkInterface.h"
+#include "MAVLinkTimesync.h"
 
 Q_DECLARE_LOGGING_CATEGORY(VehicleLinkManagerLog)
 
@@ -41,9 +42,10 @@ public:
     Q_PROPERTY(bool             communicationLost           READ communicationLost                                              NOTIFY communicationLostChanged)
     Q_PROPERTY(bool             communicationLostEnabled    READ communicationLostEnabled   WRITE setCommunicationLostEnabled   NOTIFY communicationLostEnabledChanged)
     Q_PROPERTY(bool             autoDisconnect              MEMBER _autoDisconnect                                              NOTIFY autoDisconnectChanged)
+    Q_PROPERTY(bool             duplicateCriticalCommands   MEMBER _duplicateCriticalCommands                                   NOTIFY duplicateCriticalCommandsChanged)
 
     bool                    primaryLinkIsPX4Flow        (void) const;
-    void                    mavlinkMessageReceived      (LinkInterface* link, mavlink_message_t message);
+    void                    mavlinkMessageReceived      (LinkInterface* link, const mavlink_message_t& message, qint64 receivedNSecs = 0);
     bool                    containsLink                (LinkInterface* link);
     WeakLinkInterfacePtr    primaryLink                 (void) { return _primaryLink; }
     QString                 primaryLinkName             (void) const;
@@ -54,6 +56,37 @@ public:
     void                    setPrimaryLinkByName        (const QString& name);
     void                    setCommunicationLostEnabled (bool communicationLostEnabled);
     void                    closeVehicle                (void);
+    bool                    duplicateCriticalCommands   (void) const { return _duplicateCriticalCommands; }
+
+    /// @return Links other than the primary which are currently working, excluding high latency links
+    QList<SharedLinkInterfacePtr> secondaryLinks(void) const;
+
+    /// @return true: Communication on the primary link was lost within the last _primaryLinkLostHoldMSecs
+    bool primaryLinkRecentlyLost(void) const;
+
+    /// @return true: Command is safe to execute more than once and important enough to send over every working link
+    ///               when the primary link is in doubt
+    static bool isCriticalCommand(MAV_CMD command);
+
+    /// @return Links TIMESYNC requests should go out on for this vehicle
+    QList<LinkInterface*> timesyncLinks(void) const;
+
+    /// Remembers a TIMESYNC request sent on the link, so the vehicle's reply to it updates the link estimate
+    void timesyncRequestSent(LinkInterface* link, qint64 ts1NSecs);
+
+    /// @return Smoothed round trip time of the link from TIMESYNC, -1 if not known (yet)
+    qint64 linkRttNSecs(LinkInterface* link) const;
+
+    /// @return Smoothed fraction of the vehicle's messages lost on the link
+    double linkLossRate(LinkInterface* link) const;
+
+    /// Converts a local timestamp, such as MAVLinkMessageRef::receivedNSecs, to the vehicle clock
+    ///     @param link Link whose TIMESYNC estimate to use
+    /// @return Vehicle time in nanoseconds, -1 if the clock offset is not known (yet)
+    qint64 vehicleTimeNSecs(LinkInterface* link, qint64 localNSecs) const;
+
+    /// @return One map per link: name, commLost, timesyncValid, rttMSecs, rttJitterMSecs, clockOffsetMSecs, lossRate, byteRate, cost
+    Q_INVOKABLE QVariantList linkStats(void) const;
 
 signals:
     void primaryLinkChanged             (void);
@@ -63,9 +96,11 @@ signals:
     void linkNamesChanged               (void);
     void linkStatusesChanged            (void);
     void autoDisconnectChanged          (bool autoDisconnect);
+    void duplicateCriticalCommandsChanged(bool duplicateCriticalCommands);
 
 private slots:
-    void _commLostCheck(void);
+    void _commLostCheck     (void);
+    void _updateLinkMetrics (void);
 
 private:
     int                     _containsLinkIndex      (LinkInterface* link);
@@ -75,22 +110,58 @@ private:
     bool                    _updatePrimaryLink      (void);
     SharedLinkInterfacePtr  _bestActivePrimaryLink  (void);
     void                    _commRegainedOnLink     (LinkInterface*  link);
+    void                    _handleTimesync         (LinkInterface* link, const mavlink_message_t& message, qint64 receivedNSecs);
+    bool                    _switchToCheaperLink    (void);
+    void                    _setPrimaryLink         (const SharedLinkInterfacePtr& link);
 
     typedef struct LinkInfo {
         SharedLinkInterfacePtr  link;
         bool                    commLost = false;
         QElapsedTimer           heartbeatElapsedTimer;
+        MAVLinkTimesync         timesync;
+        QElapsedTimer           otherTimesyncSourceElapsedTimer;    ///< Time since another vehicle component last answered TIMESYNC, invalid if never
+        QHash<uint8_t, uint8_t> lastSeq;                ///< Last sequence number seen by compid
+        int                     receivedCount   = 0;    ///< Messages since the last metrics update
+        int                     lostCount       = 0;    ///< Sequence gaps since the last metrics update
+        qint64                  receivedBytes   = 0;    ///< Bytes since the last metrics update
+        double                  lossRate        = 0;    ///< Smoothed fraction of messages lost
+        double                  byteRate        = 0;    ///< Smoothed bytes per second received from the vehicle
+        double                  cost            = 0;    ///< See _linkCost, lower is better
     } LinkInfo_t;
 
+    static double _linkCost(const LinkInfo_t& linkInfo);
+
     Vehicle*                _vehicle                    = nullptr;
     LinkManager*            _linkMgr                    = nullptr;
     QTimer                  _commLostCheckTimer;
+    QTimer                  _linkMetricsTimer;
+    QElapsedTimer           _linkMetricsElapsedTimer;
     QList<LinkInfo_t>       _rgLinkInfo;
     WeakLinkInterfacePtr    _primaryLink;
+    QElapsedTimer           _primaryLinkElapsedTimer;                   ///< Time since the primary link last changed
+    QElapsedTimer           _primaryLinkLostElapsedTimer;               ///< Time since communication was last lost on the primary link, invalid if never
+    bool                    _primaryLinkPinned          = false;        ///< true: User picked the primary link, only change it on comm loss
+    LinkInterface*          _cheaperLink                = nullptr;      ///< Link which has been cheaper than the primary for _cheaperLinkCount updates
+    int                     _cheaperLinkCount           = 0;
     bool                    _communicationLost          = false;
     bool                    _communicationLostEnabled   = true;
     bool                    _autoDisconnect             = false;    ///< true: Automatically disconnect vehicle when last connection goes away or lost heartbeat
+    bool                    _duplicateCriticalCommands  = false;    ///< true: Retries of critical commands, and critical commands sent soon after the primary link was lost, also go over the secondary links
 
     static const int _commLostCheckTimeoutMSecs     = 1000;  // Check for comm lost once a second
     static const int _heartbeatMaxElpasedMSecs      = 3500;  // No heartbeat for longer than this indicates comm loss
+    static const int _linkMetricsIntervalMSecs      = 1000;  // Link metrics update rate
+    static const int _otherTimesyncSourceMSecs      = 5000;  // Don't answer the vehicle's TIMESYNC requests for this long after another component did
+
+    // Link cost, in milliseconds of round trip time, and switching hysteresis
+    static constexpr double _metricsSmoothing           = 0.25;     // Loss and byte rate move this far towards each new sample
+    static constexpr double _unknownRttCostMSecs        = 500;      // Cost of a link which doesn't answer TIMESYNC
+    static constexpr double _lossCostMSecs              = 2000;     // Cost of 100% loss, so 5% loss costs as much as 100ms of RTT
+    static constexpr double _minByteRate                = 500;      // Links receiving less than this many bytes per second are penalized...
+    static constexpr double _lowByteRateCostMSecs       = 500;      // ...by up to this much
+    static constexpr double _switchCostRatio            = 0.7;      // A link must cost less than this fraction of the primary...
+    static constexpr double _switchCostMarginMSecs      = 20;       // ...and at least this much less...
+    static const int        _switchHoldCount            = 3;        // ...for this many updates in a row to take over
+    static const int        _minPrimaryLinkHoldMSecs    = 10000;    // Primary link is kept at least this long before switching to a cheaper one
+    static const int        _primaryLinkLostHoldMSecs   = 10000;    // Critical commands are duplicated for this long after the primary link was lost
 };
@@ -314,6 +314,103 @@ void VehicleLinkManagerTest::_highLatencyLinkTest(void)
     spyTransmissionEnabledChanged.clear();
 }
 
+void VehicleLinkManagerTest::_timesyncTest(void)
+{
+    SharedLinkConfigurationPtr  mockConfig;
+    SharedLinkInterfacePtr      mockLink;
+
+    QSignalSpy spyVehicleCreate(_multiVehicleMgr, &MultiVehicleManager::activeVehicleChanged);
+
+    _startMockLink(1, false /*highLatency*/, true /*incrementVehicleId*/, mockConfig, mockLink);
+
+    QCOMPARE(spyVehicleCreate.wait(1000),           true);
+    Vehicle* vehicle = _multiVehicleMgr->activeVehicle();
+    QVERIFY(vehicle);
+    VehicleLinkManager* vehicleLinkManager = vehicle->vehicleLinkManager();
+
+    QCOMPARE(vehicleLinkManager->linkRttNSecs(mockLink.get()),          static_cast<qint64>(-1));
+    QCOMPARE(vehicleLinkManager->vehicleTimeNSecs(mockLink.get(), 0),   static_cast<qint64>(-1));
+
+    // MockLink answers TIMESYNC requests, a few of them give a usable estimate
+    auto rttKnown = [vehicleLinkManager, &mockLink]() { return vehicleLinkManager->linkRttNSecs(mockLink.get()) >= 0; };
+    QVERIFY(QTest::qWaitFor(rttKnown, VehicleLinkManager::_linkMetricsIntervalMSecs * 10));
+
+    // MockLink runs on our clock, so the offset is only estimation error
+    const qint64 nowNSecs = MAVLinkTimesync::nowNSecs();
+    QVERIFY(qAbs(vehicleLinkManager->vehicleTimeNSecs(mockLink.get(), nowNSecs) - nowNSecs) < 100000000LL);
+
+    const QVariantList linkStats = vehicleLinkManager->linkStats();
+    QCOMPARE(linkStats.count(), 1);
+    QCOMPARE(linkStats[0].toMap()[QStringLiteral("timesyncValid")].toBool(), true);
+}
+
+void VehicleLinkManagerTest::_timesyncReplyTest(void)
+{
+    SharedLinkConfigurationPtr  mockConfig;
+    SharedLinkInterfacePtr      mockLink;
+
+    QSignalSpy spyVehicleCreate(_multiVehicleMgr, &MultiVehicleManager::activeVehicleChanged);
+
+    _startMockLink(1, false /*highLatency*/, true /*incrementVehicleId*/, mockConfig, mockLink);
+
+    QCOMPARE(spyVehicleCreate.wait(1000),           true);
+    Vehicle* vehicle = _multiVehicleMgr->activeVehicle();
+    QVERIFY(vehicle);
+    MockLink* pMockLink = qobject_cast<MockLink*>(mockLink.get());
+    QVERIFY(pMockLink);
+
+    const uint8_t   vehicleId   = static_cast<uint8_t>(vehicle->id());
+    const qint64    ts1NSecs    = 1234567890LL;
+    mavlink_timesync_t request;
+    memset(&request, 0, sizeof(request));
+    request.ts1 = ts1NSecs;
+
+    // We answer the autopilot's requests while nothing else on the vehicle does
+    pMockLink->respondWithMavlinkMessage(MAVLinkTimesync::requestMessage(vehicleId, static_cast<uint8_t>(vehicle->defaultComponentId()), pMockLink->mavlinkChannel(), ts1NSecs));
+    QVERIFY(QTest::qWaitFor([pMockLink]() { return pMockLink->timesyncReplyCount() == 1; }, 1000));
+
+    // Once a companion computer has answered, it is the time source and we stay quiet
+    pMockLink->respondWithMavlinkMessage(MAVLinkTimesync::replyMessage(vehicleId, MAV_COMP_ID_ONBOARD_COMPUTER, pMockLink->mavlinkChannel(), request, MAVLinkTimesync::nowNSecs()));
+    pMockLink->respondWithMavlinkMessage(MAVLinkTimesync::requestMessage(vehicleId, static_cast<uint8_t>(vehicle->defaultComponentId()), pMockLink->mavlinkChannel(), ts1NSecs + 1));
+    QTest::qWait(500);
+    QCOMPARE(pMockLink->timesyncReplyCount(), 1);
+}
+
+void VehicleLinkManagerTest::_linkCostTest(void)
+{
+    VehicleLinkManager::LinkInfo_t  fastLink;
+    VehicleLinkManager::LinkInfo_t  slowLink;
+    mavlink_timesync_t              reply;
+
+    // 40ms RTT on the fast link, 300ms on the slow one, otherwise the same
+    qint64 nowNSecs = 1000000000LL;
+    for (int i=0; i<5; i++) {
+        fastLink.timesync.requestSent(nowNSecs);
+        slowLink.timesync.requestSent(nowNSecs);
+        reply.ts1 = nowNSecs;
+        reply.tc1 = nowNSecs;
+        QVERIFY(fastLink.timesync.replyReceived(reply, nowNSecs + 40000000LL));
+        QVERIFY(slowLink.timesync.replyReceived(reply, nowNSecs + 300000000LL));
+        nowNSecs += 1000000000LL;
+    }
+    fastLink.byteRate = slowLink.byteRate = 10000;
+
+    QVERIFY(VehicleLinkManager::_linkCost(fastLink) < VehicleLinkManager::_linkCost(slowLink));
+
+    // Enough loss makes the fast link the worse one
+    fastLink.lossRate = 0.2;
+    QVERIFY(VehicleLinkManager::_linkCost(fastLink) > VehicleLinkManager::_linkCost(slowLink));
+
+    // A link which doesn't answer TIMESYNC, or barely carries anything, costs more than a measured one
+    VehicleLinkManager::LinkInfo_t unknownLink;
+    unknownLink.byteRate = 10000;
+    fastLink.lossRate = 0;
+    QVERIFY(VehicleLinkManager::_linkCost(unknownLink) > VehicleLinkManager::_linkCost(fastLink));
+    const double fastLinkCost = VehicleLinkManager::_linkCost(fastLink);
+    fastLink.byteRate = 0;
+    QVERIFY(VehicleLinkManager::_linkCost(fastLink) > fastLinkCost);
+}
+
 void VehicleLinkManagerTest::_startMockLink(int mockIndex, bool highLatency, bool incrementVehicleId, SharedLinkConfigurationPtr& mockConfig, SharedLinkInterfacePtr& mockLink)
 {
     MockConfiguration* pMockConfig = new MockConfiguration(QStringLiteral("Mock %1").arg(mockIndex));
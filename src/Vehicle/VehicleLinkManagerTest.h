@@ -34,6 +34,9 @@ private slots:
     void _multiLinkSingleVehicleTest(void);
     void _connectionRemovedTest     (void);
     void _highLatencyLinkTest       (void);
+    void _timesyncTest              (void);
+    void _timesyncReplyTest         (void);
+    void _linkCostTest              (void);
 
 private:
     void _startMockLink(int mockIndex, bool highLatency, bool incrementVehicleId, SharedLinkConfigurationPtr& sharedConfig, SharedLinkInterfacePtr& mockLink);
@@ -137,6 +137,14 @@ public:
      */
     virtual void copyFrom(LinkConfiguration* source);
 
+    /*!
+     * @brief Outgoing bandwidth
+     *
+     * Rate outgoing messages are paced to, so they queue up by priority inside QGC rather than in order further down.
+     * @return Bytes per second, 0 if the link has no known limit
+     */
+    virtual int sendBytesPerSecond() { return 0; }
+
     /// Helper static methods
 
     /*!
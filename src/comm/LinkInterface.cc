@@ -9,6 +9,8 @@
 
 #include "LinkInterface.h"
 #include "LinkManager.h"
+#include "MAVLinkRouter.h"
+#include "MAVLinkTimesync.h"
 #include "QGCApplication.h"
 
 QGC_LOGGING_CATEGORY(LinkInterfaceLog, "LinkInterfaceLog")
@@ -20,12 +22,20 @@ LinkInterface::LinkInterface(SharedLinkConfigurationPtr& config, bool isPX4Flow)
     : QThread   (0)
     , _config   (config)
     , _isPX4Flow(isPX4Flow)
+    , _sendTimer(new QTimer(this))
 {
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
     qRegisterMetaType<LinkInterface*>("LinkInterface*");
 
-    // This will cause the writeBytes calls to end up on the thread of the link
-    QObject::connect(this, &LinkInterface::_invokeWriteBytes, this, &LinkInterface::_writeBytes);
+    // Outgoing messages are queued by traffic class and written from the thread of the link, paced to the bandwidth
+    // of the link when it has one
+    _sendScheduler.setBytesPerSecond(_config ? _config->sendBytesPerSecond() : 0);
+    _sendTimer->setSingleShot(true);
+    QObject::connect(this,          &LinkInterface::_invokeSendQueued,  this, &LinkInterface::_sendQueued);
+    QObject::connect(_sendTimer,    &QTimer::timeout,                   this, &LinkInterface::_sendQueued);
+
+    // Framing runs directly on whichever thread emits bytesReceived
+    _frameBytesConnection = QObject::connect(this, &LinkInterface::bytesReceived, this, &LinkInterface::_frameBytes, Qt::DirectConnection);
 }
 
 LinkInterface::~LinkInterface()
@@ -80,9 +90,31 @@ void LinkInterface::_freeMavlinkChannel()
     _mavlinkChannel = LinkManager::invalidMavlinkChannel();
 }
 
-void LinkInterface::writeBytesThreadSafe(const char *bytes, int length)
+void LinkInterface::writeBytesThreadSafe(const char *bytes, int length, LinkSendScheduler::TrafficClass trafficClass)
 {
-    emit _invokeWriteBytes(QByteArray(bytes, length));
+    _sendScheduler.enqueue(trafficClass, QByteArray(bytes, length));
+    emit _invokeSendQueued();
+}
+
+void LinkInterface::_sendQueued(void)
+{
+    int waitMSecs;
+
+    const QList<QByteArray> sendable = _sendScheduler.takeSendable(waitMSecs);
+    if (!sendable.isEmpty()) {
+        _writeBytesList(sendable);
+    }
+
+    if (waitMSecs > 0) {
+        _sendTimer->start(waitMSecs);
+    }
+}
+
+void LinkInterface::_writeBytesList(const QList<QByteArray>& list)
+{
+    for (const QByteArray& bytes : list) {
+        _writeBytes(bytes);
+    }
 }
 
 void LinkInterface::addVehicleReference(void)
@@ -119,3 +151,57 @@ bool LinkInterface::isMockLink(void)
     return dynamic_cast<MockLink*>(this);
 }
 #endif
+
+void LinkInterface::_frameMessages(MAVLinkFrameScanner& scanner, const QByteArray& bytes, QVector<MAVLinkMessageRef>& messages, QByteArray* frames)
+{
+    // Every frame in the chunk arrived together
+    const qint64 receivedNSecs = MAVLinkTimesync::nowNSecs();
+
+    scanner.scan(bytes, [this, &messages, frames, receivedNSecs](const MAVLinkFrameScanner::Frame_t& frame) {
+        MAVLinkMessageRef message = MAVLinkMessageRef::create();
+        MAVLinkFrameScanner::decode(frame, message.mutableMessage());
+        message.setReceivedNSecs(receivedNSecs);
+        _trafficStats.record(*message, frame.length);
+        messages.append(std::move(message));
+        if (frames) {
+            frames->append(reinterpret_cast<const char*>(frame.data), frame.length);
+        }
+    });
+}
+
+bool LinkInterface::_routingActive(void) const
+{
+    return _router && _router->isActive();
+}
+
+void LinkInterface::_emitMessagesReceived(QVector<MAVLinkMessageRef>& messages, QByteArray& frames)
+{
+    if (messages.isEmpty()) {
+        return;
+    }
+    if (!frames.isEmpty()) {
+        _router->route(this, messages, frames);
+        frames.clear();
+    }
+    emit messagesReceived(this, messages);
+    messages.clear();
+}
+
+void LinkInterface::_disableBytesReceivedFraming(void)
+{
+    QObject::disconnect(_frameBytesConnection);
+}
+
+void LinkInterface::_frameBytes(LinkInterface* link, const QByteArray& bytes)
+{
+    Q_UNUSED(link);
+
+    QVector<MAVLinkMessageRef>  messages;
+    QByteArray                  frames;
+
+    QMutexLocker lock(&_rxMutex);
+    _frameMessages(_frameScanner, bytes, messages, _routingActive() ? &frames : nullptr);
+    lock.unlock();
+
+    _emitMessagesReceived(messages, frames);
+}
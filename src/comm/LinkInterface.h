@@ -18,14 +18,20 @@
 #include <QSharedPointer>
 #include <QDebug>
 #include <QTimer>
+#include <QVector>
 
 #include <memory>
 
 #include "QGCMAVLink.h"
 #include "LinkConfiguration.h"
+#include "MAVLinkFrameScanner.h"
+#include "MAVLinkMessagePool.h"
+#include "LinkSendScheduler.h"
+#include "MAVLinkTrafficStats.h"
 #include "MavlinkMessagesTimer.h"
 
 class LinkManager;
+class MAVLinkRouter;
 
 Q_DECLARE_LOGGING_CATEGORY(LinkInterfaceLog)
 
@@ -66,17 +72,29 @@ public:
 
     bool    decodedFirstMavlinkPacket   (void) const { return _decodedFirstMavlinkPacket; }
     bool    setDecodedFirstMavlinkPacket(bool decodedFirstMavlinkPacket) { return _decodedFirstMavlinkPacket = decodedFirstMavlinkPacket; }
-    void    writeBytesThreadSafe        (const char *bytes, int length);
+    void    writeBytesThreadSafe        (const char *bytes, int length, LinkSendScheduler::TrafficClass trafficClass = LinkSendScheduler::TrafficClassDefault);
     void    addVehicleReference         (void);
     void    removeVehicleReference      (void);
 
+    /// Per traffic class queue depth and latency of outgoing messages, see LinkSendScheduler::statsList
+    Q_INVOKABLE QVariantList sendQueueStats(void) const { return _sendScheduler.statsList(); }
+
+    /// Received message counters by sysid/compid/msgid, may be read from any thread
+    const MAVLinkTrafficStats& trafficStats(void) const { return _trafficStats; }
+
 signals:
     void bytesReceived      (LinkInterface* link, QByteArray data);
     void bytesSent          (LinkInterface* link, QByteArray data);
     void connected          (void);
     void disconnected       (void);
     void communicationError (const QString& title, const QString& error);
-    void _invokeWriteBytes  (QByteArray);
+
+    /// Complete, CRC validated messages framed from the data in a bytesReceived signal. Emitted on the thread which
+    /// received the bytes, so framing happens on the link thread and only whole messages cross to the main thread.
+    /// The messages are decoded straight into pooled storage and are not copied again on the way to their handlers.
+    void messagesReceived   (LinkInterface* link, QVector<MAVLinkMessageRef> messages);
+
+    void _invokeSendQueued  (void);
 
 protected:
     // Links are only created by LinkManager so constructor is not public
@@ -97,21 +115,59 @@ protected:
     virtual bool _allocateMavlinkChannel();
     virtual void _freeMavlinkChannel    ();
 
+    /// Frames bytes with the specified scanner, appending the decoded messages stamped with the receive time and
+    /// counting them in trafficStats.
+    /// Calls must be serialized.
+    ///     @param frames If not null the raw frames are appended to it back to back, for the router
+    void _frameMessages(MAVLinkFrameScanner& scanner, const QByteArray& bytes, QVector<MAVLinkMessageRef>& messages, QByteArray* frames = nullptr);
+
+    /// @return true if received frames should be collected for the router
+    bool _routingActive(void) const;
+
+    /// Hands the messages to the router when their frames were collected, emits messagesReceived and clears both
+    void _emitMessagesReceived(QVector<MAVLinkMessageRef>& messages, QByteArray& frames);
+
+    /// Links which frame their own input, for example per remote sender, call this and emit messagesReceived
+    /// themselves. bytesReceived is then only informational.
+    void _disableBytesReceivedFraming(void);
+
+    /// Writes everything taken from the send queue in one go. The default calls _writeBytes for each message, links
+    /// which can hand several messages to the system at once override it.
+    virtual void _writeBytesList(const QList<QByteArray>& list);
+
 private slots:
     virtual void _writeBytes(const QByteArray) = 0; // Not thread safe if called directly, only writeBytesThreadSafe is thread safe
 
+    void _sendQueued(void);
+
 private:
     // connect is private since all links should be created through LinkManager::createConnectedLink calls
     virtual bool _connect(void) = 0;
 
+    void _frameBytes(LinkInterface* link, const QByteArray& bytes);
+
     uint8_t _mavlinkChannel             = std::numeric_limits<uint8_t>::max();
     bool    _decodedFirstMavlinkPacket  = false;
     bool    _isPX4Flow                  = false;
     int     _vehicleReferenceCount      = 0;
 
+    // Framing state for incoming data. This is private to the link rather than using the global mavlink channel status,
+    // since the main thread uses the channel status for sending at the same time.
+    QMutex              _rxMutex;       ///< Some links emit bytesReceived from more than one thread
+    MAVLinkFrameScanner _frameScanner;
+    QMetaObject::Connection _frameBytesConnection;
+
+    MAVLinkRouter*      _router = nullptr;  ///< Set by LinkManager
+    MAVLinkTrafficStats _trafficStats;
+
+    LinkSendScheduler   _sendScheduler;
+    QTimer*             _sendTimer;     ///< Child, so it follows the link to its thread
+
     QMap<int /* vehicle id */, MavlinkMessagesTimer*> _mavlinkMessagesTimers;
 };
 
+Q_DECLARE_METATYPE(mavlink_message_t)
+
 typedef std::shared_ptr<LinkInterface>  SharedLinkInterfacePtr;
 typedef std::weak_ptr<LinkInterface>    WeakLinkInterfacePtr;
 
@@ -24,6 +24,8 @@
 #include "TCPLink.h"
 #include "SettingsManager.h"
 #include "LogReplayLink.h"
+#include "MAVLinkRouter.h"
+#include "MAVLinkTrafficModel.h"
 #ifdef QGC_ENABLE_BLUETOOTH
 #include "BluetoothLink.h"
 #endif
@@ -48,6 +50,7 @@ QGC_LOGGING_CATEGORY(LinkManagerVerboseLog, "LinkManagerVerboseLog")
 
 const char* LinkManager::_defaultUDPLinkName =       "UDP Link (AutoConnect)";
 const char* LinkManager::_mavlinkForwardingLinkName =       "MAVLink Forwarding Link";
+const char* LinkManager::_mavlinkRouterOutputLinkPrefix =   "MAVLink Router Output ";
 
 const int LinkManager::_autoconnectUpdateTimerMSecs =   1000;
 #ifdef Q_OS_WIN
@@ -57,6 +60,19 @@ const int LinkManager::_autoconnectConnectDelayMSecs =  6000;
 const int LinkManager::_autoconnectConnectDelayMSecs =  1000;
 #endif
 
+static MAVLinkRouter::Rules_t _mavlinkRouterRules(MAVLinkRouterSettings* routerSettings)
+{
+    MAVLinkRouter::Rules_t rules;
+
+    rules.allowedSysids = MAVLinkRouter::parseIdList(routerSettings->allowedSysids()->rawValue().toString());
+    rules.deniedSysids  = MAVLinkRouter::parseIdList(routerSettings->deniedSysids()->rawValue().toString());
+    rules.allowedMsgids = MAVLinkRouter::parseIdList(routerSettings->allowedMsgids()->rawValue().toString());
+    rules.deniedMsgids  = MAVLinkRouter::parseIdList(routerSettings->deniedMsgids()->rawValue().toString());
+    rules.maxRateHz     = routerSettings->maxRateHz()->rawValue().toDouble();
+
+    return rules;
+}
+
 LinkManager::LinkManager(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
     , _configUpdateSuspended(false)
@@ -65,6 +81,8 @@ LinkManager::LinkManager(QGCApplication* app, QGCToolbox* toolbox)
     , _mavlinkChannelsUsedBitMask(1)    // We never use channel 0 to avoid sequence numbering problems
     , _autoConnectSettings(nullptr)
     , _mavlinkProtocol(nullptr)
+    , _mavlinkRouter(new MAVLinkRouter(this))
+    , _trafficModel(new MAVLinkTrafficModel(this))
     #ifndef __mobile__
     #ifndef NO_SERIAL_LINK
     , _nmeaPort(nullptr)
@@ -74,6 +92,7 @@ LinkManager::LinkManager(QGCApplication* app, QGCToolbox* toolbox)
     qmlRegisterUncreatableType<LinkManager>         ("QGroundControl", 1, 0, "LinkManager",         "Reference only");
     qmlRegisterUncreatableType<LinkConfiguration>   ("QGroundControl", 1, 0, "LinkConfiguration",   "Reference only");
     qmlRegisterUncreatableType<LinkInterface>       ("QGroundControl", 1, 0, "LinkInterface",       "Reference only");
+    qmlRegisterUncreatableType<MAVLinkTrafficModel> ("QGroundControl", 1, 0, "MAVLinkTrafficModel", "Reference only");
 }
 
 LinkManager::~LinkManager()
@@ -93,6 +112,13 @@ void LinkManager::setToolbox(QGCToolbox *toolbox)
     _mavlinkProtocol = _toolbox->mavlinkProtocol();
 
     connect(&_portListTimer, &QTimer::timeout, this, &LinkManager::_updateAutoConnectLinks);
+    connect(toolbox->settingsManager()->appSettings()->forwardMavlink(), &Fact::rawValueChanged, this, &LinkManager::_updateMAVLinkForwardingOutput);
+
+    MAVLinkRouterSettings* routerSettings = toolbox->settingsManager()->mavlinkRouterSettings();
+    connect(routerSettings->outputs(), &Fact::rawValueChanged, this, &LinkManager::_updateMAVLinkRouterOutputs);
+    for (Fact* ruleFact : { routerSettings->allowedSysids(), routerSettings->deniedSysids(), routerSettings->allowedMsgids(), routerSettings->deniedMsgids(), routerSettings->maxRateHz() }) {
+        connect(ruleFact, &Fact::rawValueChanged, this, &LinkManager::_updateMAVLinkRouterRules);
+    }
     _portListTimer.start(_autoconnectUpdateTimerMSecs); // timeout must be long enough to get past bootloader on second pass
 
 }
@@ -152,13 +178,15 @@ bool LinkManager::createConnectedLink(SharedLinkConfigurationPtr& config, bool i
         config->setLink(link);
 
         connect(link.get(), &LinkInterface::communicationError,  _app,                &QGCApplication::criticalMessageBoxOnMainThread);
-        connect(link.get(), &LinkInterface::bytesReceived,       _mavlinkProtocol,    &MAVLinkProtocol::receiveBytes);
+        connect(link.get(), &LinkInterface::messagesReceived,    _mavlinkProtocol,    &MAVLinkProtocol::receiveMessages);
         connect(link.get(), &LinkInterface::bytesSent,           _mavlinkProtocol,    &MAVLinkProtocol::logSentBytes);
         connect(link.get(), &LinkInterface::disconnected,        this,                &LinkManager::_linkDisconnected);
 
         _mavlinkProtocol->resetMetadataForLink(link.get());
         _mavlinkProtocol->setVersion(_mavlinkProtocol->getCurrentVersion());
 
+        link->_router = _mavlinkRouter;
+
         if (!link->_connect()) {
             link->_freeMavlinkChannel();
             _rgLinks.removeAt(_rgLinks.indexOf(link));
@@ -203,7 +231,7 @@ void LinkManager::_linkDisconnected(void)
     }
 
     disconnect(link, &LinkInterface::communicationError,  _app,                &QGCApplication::criticalMessageBoxOnMainThread);
-    disconnect(link, &LinkInterface::bytesReceived,       _mavlinkProtocol,    &MAVLinkProtocol::receiveBytes);
+    disconnect(link, &LinkInterface::messagesReceived,    _mavlinkProtocol,    &MAVLinkProtocol::receiveMessages);
     disconnect(link, &LinkInterface::bytesSent,           _mavlinkProtocol,    &MAVLinkProtocol::logSentBytes);
     disconnect(link, &LinkInterface::disconnected,        this,                &LinkManager::_linkDisconnected);
 
@@ -395,8 +423,84 @@ void LinkManager::_addUDPAutoConnectLink(void)
     }
 }
 
+void LinkManager::_updateMAVLinkForwardingOutput(void)
+{
+    SharedLinkInterfacePtr forwardingLink = mavlinkForwardingLink();
+    if (!forwardingLink) {
+        return;
+    }
+
+    if (_toolbox->settingsManager()->appSettings()->forwardMavlink()->rawValue().toBool()) {
+        if (!_mavlinkRouter->hasOutput(forwardingLink.get())) {
+            _mavlinkRouter->setOutput(forwardingLink, _mavlinkRouterRules(_toolbox->settingsManager()->mavlinkRouterSettings()));
+        }
+    } else {
+        _mavlinkRouter->removeOutput(forwardingLink.get());
+    }
+    _updateMAVLinkRouterOutputs();
+}
+
+/// Adds a link for each host in the router outputs setting which doesn't have one yet and disconnects the links of
+/// hosts which are no longer in it. Outputs are only active while mavlink forwarding is enabled.
+void LinkManager::_updateMAVLinkRouterOutputs(void)
+{
+    MAVLinkRouterSettings*  routerSettings  = _toolbox->settingsManager()->mavlinkRouterSettings();
+    QStringList             hosts;
+
+    if (_toolbox->settingsManager()->appSettings()->forwardMavlink()->rawValue().toBool()) {
+        for (const QString& host : routerSettings->outputs()->rawValue().toString().split(',', Qt::SkipEmptyParts)) {
+            if (!host.trimmed().isEmpty()) {
+                hosts.append(host.trimmed());
+            }
+        }
+    }
+
+    const QString                   prefix  = _mavlinkRouterOutputLinkPrefix;
+    QList<SharedLinkInterfacePtr>   links   = _rgLinks;
+    for (const SharedLinkInterfacePtr& link : links) {
+        SharedLinkConfigurationPtr linkConfig = link->linkConfiguration();
+        if (linkConfig->type() == LinkConfiguration::TypeUdp && linkConfig->name().startsWith(prefix)) {
+            // Hosts left in the list after this still need a link
+            if (!hosts.removeOne(linkConfig->name().mid(prefix.length()))) {
+                qCDebug(LinkManagerLog) << "MAVLink router output removed" << linkConfig->name();
+                link->disconnect();
+            }
+        }
+    }
+
+    for (const QString& host : hosts) {
+        qCDebug(LinkManagerLog) << "MAVLink router output added" << host;
+
+        UDPConfiguration* udpConfig = new UDPConfiguration(prefix + host);
+        udpConfig->setDynamic(true);
+        udpConfig->addHost(host);
+
+        SharedLinkConfigurationPtr config = addConfiguration(udpConfig);
+        if (createConnectedLink(config)) {
+            _mavlinkRouter->setOutput(sharedLinkInterfacePointerForLink(config->link()), _mavlinkRouterRules(routerSettings));
+        } else {
+            // Tried again on the next auto connect update
+            _removeConfiguration(config.get());
+        }
+    }
+}
+
+/// Applies changed rules to all router outputs
+void LinkManager::_updateMAVLinkRouterRules(void)
+{
+    const MAVLinkRouter::Rules_t rules = _mavlinkRouterRules(_toolbox->settingsManager()->mavlinkRouterSettings());
+
+    for (const SharedLinkInterfacePtr& link : _rgLinks) {
+        if (_mavlinkRouter->hasOutput(link.get())) {
+            _mavlinkRouter->setOutput(link, rules);
+        }
+    }
+}
+
 void LinkManager::_addMAVLinkForwardingLink(void)
 {
+    _updateMAVLinkRouterOutputs();
+
     if (_toolbox->settingsManager()->appSettings()->forwardMavlink()->rawValue().toBool()) {
         bool foundMAVLinkForwardingLink = false;
 
@@ -420,6 +524,7 @@ void LinkManager::_addMAVLinkForwardingLink(void)
 
             SharedLinkConfigurationPtr config = addConfiguration(udpConfig);
             createConnectedLink(config);
+            _updateMAVLinkForwardingOutput();
         }
     }
 }
@@ -37,6 +37,8 @@ class QGCApplication;
 class UDPConfiguration;
 class AutoConnectSettings;
 class LogReplayLink;
+class MAVLinkRouter;
+class MAVLinkTrafficModel;
 
 /// @brief Manage communication links
 ///
@@ -58,6 +60,7 @@ public:
     Q_PROPERTY(QStringList          serialBaudRates         READ serialBaudRates        CONSTANT)
     Q_PROPERTY(QStringList          serialPortStrings       READ serialPortStrings      NOTIFY commPortStringsChanged)
     Q_PROPERTY(QStringList          serialPorts             READ serialPorts            NOTIFY commPortsChanged)
+    Q_PROPERTY(MAVLinkTrafficModel* trafficModel            READ trafficModel           CONSTANT)
 
     /// Create/Edit Link Configuration
     Q_INVOKABLE LinkConfiguration*  createConfiguration         (int type, const QString& name);
@@ -104,6 +107,12 @@ public:
     /// Returns pointer to the mavlink forwarding link, or nullptr if it does not exist
     SharedLinkInterfacePtr mavlinkForwardingLink();
 
+    /// Forwards received messages to other links, the mavlink forwarding link is one of its outputs
+    MAVLinkRouter* mavlinkRouter(void) { return _mavlinkRouter; }
+
+    /// Received traffic of all links by sysid/compid/msgid stream
+    MAVLinkTrafficModel* trafficModel(void) { return _trafficModel; }
+
     void disconnectAll(void);
 
 #ifdef QT_DEBUG
@@ -149,6 +158,9 @@ private:
     void                _addUDPAutoConnectLink      (void);
     void                _addZeroConfAutoConnectLink (void);
     void                _addMAVLinkForwardingLink   (void);
+    void                _updateMAVLinkForwardingOutput(void);
+    void                _updateMAVLinkRouterOutputs (void);
+    void                _updateMAVLinkRouterRules   (void);
     bool                _isSerialPortConnected      (void);
 
 #ifndef NO_SERIAL_LINK
@@ -164,6 +176,8 @@ private:
 
     AutoConnectSettings*                _autoConnectSettings;
     MAVLinkProtocol*                    _mavlinkProtocol;
+    MAVLinkRouter*                      _mavlinkRouter;
+    MAVLinkTrafficModel*                _trafficModel;
 
     QList<SharedLinkInterfacePtr>       _rgLinks;
     QList<SharedLinkConfigurationPtr>   _rgLinkConfigs;
@@ -190,6 +204,7 @@ private:
 
     static const char*  _defaultUDPLinkName;
     static const char*  _mavlinkForwardingLinkName;
+    static const char*  _mavlinkRouterOutputLinkPrefix;
     static const int    _autoconnectUpdateTimerMSecs;
     static const int    _autoconnectConnectDelayMSecs;
 
@@ -0,0 +1,220 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinkSendScheduler.h"
+#include "QGCMAVLink.h"
+
+#include <QVariantMap>
+
+#include <cmath>
+
+QGC_LOGGING_CATEGORY(LinkSendSchedulerLog, "LinkSendSchedulerLog")
+
+LinkSendScheduler::LinkSendScheduler(void)
+{
+    _clock.start();
+    resetStats();
+}
+
+void LinkSendScheduler::setBytesPerSecond(int bytesPerSecond)
+{
+    QMutexLocker lock(&_mutex);
+
+    _bytesPerSecond     = qMax(0, bytesPerSecond);
+    _tokens             = 0;
+    _lastRefillUSecs    = _nowUSecs();
+    qCDebug(LinkSendSchedulerLog) << "bytesPerSecond" << _bytesPerSecond;
+}
+
+int LinkSendScheduler::bytesPerSecond(void) const
+{
+    QMutexLocker lock(&_mutex);
+    return _bytesPerSecond;
+}
+
+void LinkSendScheduler::enqueue(TrafficClass trafficClass, const QByteArray& bytes)
+{
+    QMutexLocker lock(&_mutex);
+
+    QQueue<QueueEntry_t>&   queue   = _queues[trafficClass];
+    ClassStats_t&           stats   = _stats[trafficClass];
+
+    // A class which backs up this far has a sender outrunning the link, the oldest data is the least useful
+    while (!queue.isEmpty() && stats.queuedBytes + bytes.size() > _maxQueuedBytesPerClass) {
+        stats.queuedBytes -= queue.dequeue().bytes.size();
+        stats.queuedMessages--;
+        stats.droppedMessages++;
+    }
+
+    queue.enqueue(QueueEntry_t{ bytes, _nowUSecs() });
+    stats.queuedMessages++;
+    stats.queuedBytes       += bytes.size();
+    stats.maxQueuedBytes    = qMax(stats.maxQueuedBytes, stats.queuedBytes);
+}
+
+QList<QByteArray> LinkSendScheduler::takeSendable(int& waitMSecs)
+{
+    QMutexLocker        lock(&_mutex);
+    QList<QByteArray>   sendable;
+    const qint64        nowUSecs = _nowUSecs();
+
+    _refillTokens(nowUSecs);
+    waitMSecs = -1;
+
+    for (int i=0; i<TrafficClassCount; i++) {
+        QQueue<QueueEntry_t>&   queue   = _queues[i];
+        ClassStats_t&           stats   = _stats[i];
+
+        while (!queue.isEmpty()) {
+            const int length = queue.head().bytes.size();
+
+            if (_bytesPerSecond && _tokens < length) {
+                waitMSecs = qMax(1, static_cast<int>(std::ceil((length - _tokens) * 1000.0 / _bytesPerSecond)));
+                return sendable;
+            }
+            if (_bytesPerSecond) {
+                _tokens -= length;
+            }
+
+            const QueueEntry_t  entry           = queue.dequeue();
+            const qint64        latencyUSecs    = nowUSecs - entry.enqueuedUSecs;
+
+            stats.queuedMessages--;
+            stats.queuedBytes       -= length;
+            stats.sentMessages++;
+            stats.sentBytes         += static_cast<quint64>(length);
+            stats.totalLatencyUSecs += latencyUSecs;
+            stats.maxLatencyUSecs   = qMax(stats.maxLatencyUSecs, latencyUSecs);
+
+            sendable.append(entry.bytes);
+        }
+    }
+
+    return sendable;
+}
+
+void LinkSendScheduler::_refillTokens(qint64 nowUSecs)
+{
+    if (_bytesPerSecond == 0) {
+        return;
+    }
+
+    // The bucket always holds at least one full packet, otherwise a large message could never be sent
+    const double burstBytes = qMax(static_cast<double>(_bytesPerSecond) * _burstMSecs / 1000.0, static_cast<double>(MAVLINK_MAX_PACKET_LEN));
+
+    _tokens             = qMin(burstBytes, _tokens + static_cast<double>(nowUSecs - _lastRefillUSecs) * _bytesPerSecond / 1e6);
+    _lastRefillUSecs    = nowUSecs;
+}
+
+LinkSendScheduler::ClassStats_t LinkSendScheduler::stats(TrafficClass trafficClass) const
+{
+    QMutexLocker lock(&_mutex);
+    return _stats[trafficClass];
+}
+
+void LinkSendScheduler::resetStats(void)
+{
+    QMutexLocker lock(&_mutex);
+
+    for (int i=0; i<TrafficClassCount; i++) {
+        ClassStats_t& stats = _stats[i];
+
+        // Queue depth describes what is queued right now, so only the history is reset
+        stats.queuedMessages    = 0;
+        stats.queuedBytes       = 0;
+        for (const QueueEntry_t& entry : _queues[i]) {
+            stats.queuedMessages++;
+            stats.queuedBytes += entry.bytes.size();
+        }
+        stats.maxQueuedBytes    = stats.queuedBytes;
+        stats.sentMessages      = 0;
+        stats.sentBytes         = 0;
+        stats.droppedMessages   = 0;
+        stats.totalLatencyUSecs = 0;
+        stats.maxLatencyUSecs   = 0;
+    }
+}
+
+QVariantList LinkSendScheduler::statsList(void) const
+{
+    QVariantList statsList;
+
+    for (int i=0; i<TrafficClassCount; i++) {
+        const TrafficClass  trafficClass    = static_cast<TrafficClass>(i);
+        const ClassStats_t  classStats      = stats(trafficClass);
+        QVariantMap         map;
+
+        map[QStringLiteral("name")]                 = trafficClassName(trafficClass);
+        map[QStringLiteral("queuedMessages")]       = classStats.queuedMessages;
+        map[QStringLiteral("queuedBytes")]          = classStats.queuedBytes;
+        map[QStringLiteral("maxQueuedBytes")]       = classStats.maxQueuedBytes;
+        map[QStringLiteral("sentMessages")]         = classStats.sentMessages;
+        map[QStringLiteral("droppedMessages")]      = classStats.droppedMessages;
+        map[QStringLiteral("averageLatencyMSecs")]  = classStats.sentMessages ? static_cast<double>(classStats.totalLatencyUSecs) / classStats.sentMessages / 1000.0 : 0.0;
+        map[QStringLiteral("maxLatencyMSecs")]      = static_cast<double>(classStats.maxLatencyUSecs) / 1000.0;
+        statsList.append(map);
+    }
+
+    return statsList;
+}
+
+LinkSendScheduler::TrafficClass LinkSendScheduler::trafficClassForMessage(uint32_t messageId)
+{
+    switch (messageId) {
+    case MAVLINK_MSG_ID_HEARTBEAT:
+    case MAVLINK_MSG_ID_COMMAND_LONG:
+    case MAVLINK_MSG_ID_COMMAND_INT:
+    case MAVLINK_MSG_ID_SET_MODE:
+    case MAVLINK_MSG_ID_MISSION_SET_CURRENT:
+    case MAVLINK_MSG_ID_TIMESYNC:       // Queueing behind other traffic would show up as link round trip time
+        return TrafficClassCommand;
+    case MAVLINK_MSG_ID_MANUAL_CONTROL:
+    case MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE:
+    case MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED:
+    case MAVLINK_MSG_ID_SET_POSITION_TARGET_GLOBAL_INT:
+    case MAVLINK_MSG_ID_SET_ATTITUDE_TARGET:
+        return TrafficClassControl;
+    case MAVLINK_MSG_ID_GPS_RTCM_DATA:
+    case MAVLINK_MSG_ID_GPS_INJECT_DATA:
+        return TrafficClassCorrections;
+    // The whole mission transfer protocol shares a class so its messages stay in order
+    case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
+    case MAVLINK_MSG_ID_MISSION_COUNT:
+    case MAVLINK_MSG_ID_MISSION_ITEM:
+    case MAVLINK_MSG_ID_MISSION_ITEM_INT:
+    case MAVLINK_MSG_ID_MISSION_REQUEST:
+    case MAVLINK_MSG_ID_MISSION_REQUEST_INT:
+    case MAVLINK_MSG_ID_MISSION_ACK:
+    case MAVLINK_MSG_ID_MISSION_CLEAR_ALL:
+    case MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL:
+    case MAVLINK_MSG_ID_LOG_REQUEST_LIST:
+    case MAVLINK_MSG_ID_LOG_REQUEST_DATA:
+        return TrafficClassBulk;
+    default:
+        return TrafficClassDefault;
+    }
+}
+
+QString LinkSendScheduler::trafficClassName(TrafficClass trafficClass)
+{
+    switch (trafficClass) {
+    case TrafficClassCommand:
+        return QStringLiteral("Command");
+    case TrafficClassControl:
+        return QStringLiteral("Control");
+    case TrafficClassCorrections:
+        return QStringLiteral("Corrections");
+    case TrafficClassDefault:
+        return QStringLiteral("Default");
+    case TrafficClassBulk:
+        return QStringLiteral("Bulk");
+    default:
+        return QString();
+    }
+}
@@ -0,0 +1,95 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QQueue>
+#include <QString>
+#include <QVariantList>
+
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(LinkSendSchedulerLog)
+
+/// Outgoing queue of a link. Messages are queued per traffic class and always leave highest class first, so a command
+/// never waits behind a mission upload or a burst of FTP. When the link has a known bandwidth the output is paced by
+/// a token bucket at that rate, which keeps the backlog here, where it can be reordered, instead of in the serial
+/// driver or radio buffer. Without a bandwidth messages go out as soon as the link thread gets to them.
+///
+/// enqueue may be called from any thread, takeSendable is called from the link thread.
+class LinkSendScheduler
+{
+public:
+    /// In priority order, highest first
+    enum TrafficClass {
+        TrafficClassCommand,        ///< Commands, mode changes, TIMESYNC and the GCS heartbeat
+        TrafficClassControl,        ///< Manual control and setpoints
+        TrafficClassCorrections,    ///< RTCM injection
+        TrafficClassDefault,
+        TrafficClassBulk,           ///< Mission transfer, FTP and log download
+        TrafficClassCount
+    };
+
+    typedef struct {
+        int     queuedMessages;
+        int     queuedBytes;
+        int     maxQueuedBytes;
+        quint64 sentMessages;
+        quint64 sentBytes;
+        quint64 droppedMessages;    ///< Oldest messages dropped because the class queue was full
+        qint64  totalLatencyUSecs;  ///< Time spent queued, over all sent messages
+        qint64  maxLatencyUSecs;
+    } ClassStats_t;
+
+    LinkSendScheduler(void);
+
+    /// @param bytesPerSecond Output rate, 0 for no shaping
+    void    setBytesPerSecond   (int bytesPerSecond);
+    int     bytesPerSecond      (void) const;
+
+    void enqueue(TrafficClass trafficClass, const QByteArray& bytes);
+
+    /// Takes the queued messages which may be sent now, highest class first
+    /// @param[out] waitMSecs Time until the next queued message may be sent, -1 if nothing is left queued
+    QList<QByteArray> takeSendable(int& waitMSecs);
+
+    ClassStats_t    stats       (TrafficClass trafficClass) const;
+    void            resetStats  (void);
+
+    /// @return One map per traffic class: name, queuedMessages, queuedBytes, maxQueuedBytes, sentMessages, droppedMessages,
+    ///         averageLatencyMSecs, maxLatencyMSecs
+    QVariantList statsList(void) const;
+
+    static TrafficClass trafficClassForMessage  (uint32_t messageId);
+    static QString      trafficClassName        (TrafficClass trafficClass);
+
+private:
+    typedef struct {
+        QByteArray  bytes;
+        qint64      enqueuedUSecs;
+    } QueueEntry_t;
+
+    qint64  _nowUSecs       (void) const { return _clock.nsecsElapsed() / 1000; }
+    void    _refillTokens   (qint64 nowUSecs);
+
+    mutable QMutex          _mutex;
+    QQueue<QueueEntry_t>    _queues[TrafficClassCount];
+    ClassStats_t            _stats[TrafficClassCount];
+    QElapsedTimer           _clock;
+    int                     _bytesPerSecond = 0;
+    double                  _tokens         = 0;
+    qint64                  _lastRefillUSecs = 0;
+
+    static const int _maxQueuedBytesPerClass    = 256 * 1024;
+    static const int _burstMSecs                = 50;           ///< Bucket depth at the configured rate
+};
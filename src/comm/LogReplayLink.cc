@@ -13,9 +13,11 @@
 #include "QGCApplication.h"
 
 #include <QFileInfo>
-#include <QtEndian>
+#include <QPointer>
 #include <QSignalSpy>
 
+#include <algorithm>
+
 const char*  LogReplayLinkConfiguration::_logFilenameKey = "logFilename";
 
 LogReplayLinkConfiguration::LogReplayLinkConfiguration(const QString& name)
@@ -65,7 +67,6 @@ LogReplayLink::LogReplayLink(SharedLinkConfigurationPtr& config)
     : LinkInterface              (config)
     , _logReplayConfig           (qobject_cast<LogReplayLinkConfiguration*>(config.get()))
     , _connected                 (false)
-    , _mavlinkChannel            (0)
     , _logCurrentTimeUSecs       (0)
     , _logStartTimeUSecs         (0)
     , _logEndTimeUSecs           (0)
@@ -75,6 +76,16 @@ LogReplayLink::LogReplayLink(SharedLinkConfigurationPtr& config)
     , _playbackStartLogTimeUSecs (0)
     , _mavlink                   (nullptr)
     , _logFileSize               (0)
+    , _logData                   (nullptr)
+    , _logPosition               (0)
+    , _nextFilteredOffset        (0)
+    , _messageFilterActive       (false)
+    , _unthrottled               (false)
+    , _waitingForConsumer        (false)
+    , _batchesInFlight           (0)
+    , _pauseAtLogTimeUSecs       (0)
+    , _replayMessageCount        (0)
+    , _lastReplayRateMSecs       (0)
 {
     if (!_logReplayConfig) {
         qWarning() << "Internal error";
@@ -88,6 +99,11 @@ LogReplayLink::LogReplayLink(SharedLinkConfigurationPtr& config)
     QObject::connect(this, &LogReplayLink::_playOnThread,               this, &LogReplayLink::_play);
     QObject::connect(this, &LogReplayLink::_pauseOnThread,              this, &LogReplayLink::_pause);
     QObject::connect(this, &LogReplayLink::_setPlaybackSpeedOnThread,   this, &LogReplayLink::_setPlaybackSpeed);
+    QObject::connect(this, &LogReplayLink::_setMessageFilterOnThread,   this, &LogReplayLink::_setMessageFilter);
+    QObject::connect(this, &LogReplayLink::_setUnthrottledOnThread,     this, &LogReplayLink::_setUnthrottled);
+    QObject::connect(this, &LogReplayLink::_setPauseAtLogTimeOnThread,  this, &LogReplayLink::_setPauseAtLogTime);
+    QObject::connect(this, &LogReplayLink::_setPauseAtLogSecsOnThread,  this, &LogReplayLink::_setPauseAtLogSecs);
+    QObject::connect(this, &LogReplayLink::_batchConsumed,              this, &LogReplayLink::_batchConsumedOnThread);
     
     moveToThread(this);
 }
@@ -154,20 +170,22 @@ void LogReplayLink::_writeBytes(const QByteArray bytes)
     Q_UNUSED(bytes);
 }
 
-/// Parses a BigEndian quint64 timestamp
-/// @return A Unix timestamp in microseconds UTC for found message or 0 if parsing failed
-quint64 LogReplayLink::_parseTimestamp(const QByteArray& bytes)
+/// Finds the next frame to replay at or after _logPosition, without moving past it
+/// @return false: no more frames to replay
+bool LogReplayLink::_nextFrame(MAVLinkFrameScanner::Frame_t& frame)
 {
-    quint64 timestamp = qFromBigEndian(*((quint64*)(bytes.constData())));
-    quint64 currentTimestamp = ((quint64)QDateTime::currentMSecsSinceEpoch()) * 1000;
-    
-    // Now if the parsed timestamp is in the future, it must be an old file where the timestamp was stored as
-    // little endian, so switch it.
-    if (timestamp > currentTimestamp) {
-        timestamp = qbswap(timestamp);
+    if (_messageFilterActive) {
+        while (_nextFilteredOffset < _filteredOffsets.count() && _filteredOffsets[_nextFilteredOffset] < _logPosition) {
+            _nextFilteredOffset++;
+        }
+        if (_nextFilteredOffset == _filteredOffsets.count()) {
+            _logPosition = _logFileSize;
+            return false;
+        }
+        _logPosition = _filteredOffsets[_nextFilteredOffset];
     }
-    
-    return timestamp;
+
+    return TlogIndex::nextFrame(_logData, _logFileSize, _logPosition, frame);
 }
 
 /// Reads the next mavlink message from the log
@@ -175,85 +193,21 @@ quint64 LogReplayLink::_parseTimestamp(const QByteArray& bytes)
 /// @return Unix timestamp in microseconds UTC for NEXT mavlink message or 0 if no message found
 quint64 LogReplayLink::_readNextMavlinkMessage(QByteArray& bytes)
 {
-    char                nextByte;
-    mavlink_status_t    status;
+    MAVLinkFrameScanner::Frame_t frame;
 
     bytes.clear();
 
-    while (_logFile.getChar(&nextByte)) { // Loop over every byte
-        mavlink_message_t message;
-        bool messageFound = mavlink_parse_char(_mavlinkChannel, nextByte, &message, &status);
-
-        if (status.parse_state == MAVLINK_PARSE_STATE_GOT_STX) {
-            // This is the possible beginning of a mavlink message, clear any partial bytes
-            bytes.clear();
-        }
-        bytes.append(nextByte);
-
-        if (messageFound) {
-            // Return the timestamp for the next message
-            QByteArray rawTime = _logFile.read(cbTimestamp);
-            return _parseTimestamp(rawTime);
-        }
-    }
-
-    return 0;
-}
-
-/// Seeks to the beginning of the next successfully parsed mavlink message in the log file.
-///     @param nextMsg[output] Parsed next message that was found
-/// @return A Unix timestamp in microseconds UTC for found message or 0 if parsing failed
-quint64 LogReplayLink::_seekToNextMavlinkMessage(mavlink_message_t* nextMsg)
-{
-    char                nextByte;
-    mavlink_status_t    status;
-    qint64              messageStartPos = -1;
-
-    mavlink_reset_channel_status(_mavlinkChannel);
-
-    while (_logFile.getChar(&nextByte)) {
-        bool messageFound = mavlink_parse_char(_mavlinkChannel, nextByte, nextMsg, &status);
-
-        if (status.parse_state == MAVLINK_PARSE_STATE_GOT_STX) {
-            // This is the possible beginning of a mavlink message
-            messageStartPos = _logFile.pos() - 1;
-        }
-        
-        // If we've found a message, jump back to the start of the message, grab the timestamp,
-        // and go back to the end of this file.
-        if (messageFound && messageStartPos != -1) {
-            _logFile.seek(messageStartPos - cbTimestamp);
-            QByteArray rawTime = _logFile.read(cbTimestamp);
-            return _parseTimestamp(rawTime);
-        }
+    if (!_nextFrame(frame)) {
+        return 0;
     }
-    
-    return 0;
-}
-
-quint64 LogReplayLink::_findLastTimestamp(void)
-{
-    char                nextByte;
-    mavlink_status_t    status;
-    quint64             lastTimestamp = 0;
-    mavlink_message_t   msg;
-
-    // We read through the entire file looking for the last good timestamp. This can be somewhat slow, but trying to work from the
-    // end of the file can be way slower due to all the seeking back and forth required. So instead we take the simple reliable approach.
-
-    _logFile.reset();
-    mavlink_reset_channel_status(_mavlinkChannel);
-
-    while (_logFile.bytesAvailable() > cbTimestamp) {
-        lastTimestamp = _parseTimestamp(_logFile.read(cbTimestamp));
+    bytes = QByteArray(reinterpret_cast<const char*>(frame.data), frame.length);
+    _logPosition += frame.length;
 
-        bool endOfMessage = false;
-        while (!endOfMessage && _logFile.getChar(&nextByte)) {
-            endOfMessage = mavlink_parse_char(_mavlinkChannel, nextByte, &msg, &status);
-        }
+    // Return the timestamp for the next message
+    if (!_nextFrame(frame)) {
+        return 0;
     }
-
-    return lastTimestamp;
+    return TlogIndex::frameTimestamp(_logData, _logPosition);
 }
 
 bool LogReplayLink::_loadLogFile(void)
@@ -264,6 +218,7 @@ bool LogReplayLink::_loadLogFile(void)
     int logDurationSecondsTotal;
     quint64 startTimeUSecs;
     quint64 endTimeUSecs;
+    QString indexErrorMsg;
 
     if (_logFile.isOpen()) {
         errorMsg = tr("Attempt to load new log while log being played");
@@ -278,8 +233,20 @@ bool LogReplayLink::_loadLogFile(void)
     logFileInfo.setFile(logFilename);
     _logFileSize = logFileInfo.size();
     
-    startTimeUSecs = _parseTimestamp(_logFile.read(cbTimestamp));
-    endTimeUSecs = _findLastTimestamp();
+    _logData = _logFile.map(0, _logFileSize);
+    if (!_logData) {
+        errorMsg = tr("Unable to map log file: '%1', error: %2").arg(logFilename).arg(_logFile.errorString());
+        goto Error;
+    }
+
+    // Builds the index on first replay of a log, after that it comes straight from the cache next to the log
+    if (!_logIndex.load(logFilename, _logData, _logFileSize, indexErrorMsg)) {
+        errorMsg = indexErrorMsg;
+        goto Error;
+    }
+
+    startTimeUSecs = _logIndex.startTimeUSecs();
+    endTimeUSecs = _logIndex.endTimeUSecs();
 
     if (endTimeUSecs <= startTimeUSecs) {
         errorMsg = tr("The log file '%1' is corrupt or empty.").arg(logFilename);
@@ -293,7 +260,7 @@ bool LogReplayLink::_loadLogFile(void)
     _logCurrentTimeUSecs = startTimeUSecs;
 
     // Reset our log file so when we go to read it for the first time, we start at the beginning.
-    _logFile.reset();
+    _logPosition = _logIndex.firstFrameOffset();
 
     logDurationSecondsTotal = (_logDurationUSecs) / 1000000;
     
@@ -305,6 +272,7 @@ Error:
     if (_logFile.isOpen()) {
         _logFile.close();
     }
+    _logData = nullptr;
     _replayError(errorMsg);
     return false;
 }
@@ -315,6 +283,11 @@ Error:
 /// induce a static drift into the log file replay.
 void LogReplayLink::_readNextLogEntry(void)
 {
+    if (_unthrottled) {
+        _readNextBatch();
+        return;
+    }
+
     QByteArray bytes;
 
     // Now parse MAVLink messages, grabbing their timestamps as we go. We stop once we
@@ -325,12 +298,16 @@ void LogReplayLink::_readNextLogEntry(void)
     int timeToNextExecutionMSecs = 0;
 
     while (timeToNextExecutionMSecs < 3) {
+        if (_pauseAtLogTimeReached()) {
+            return;
+        }
+
         // Read the next mavlink message from the log
         qint64 nextTimeUSecs = _readNextMavlinkMessage(bytes);
         emit bytesReceived(this, bytes);
         emit playbackPercentCompleteChanged(((float)(_logCurrentTimeUSecs - _logStartTimeUSecs) / (float)_logDurationUSecs) * 100);
 
-        if (_logFile.atEnd()) {
+        if (_atEnd()) {
             _finishPlayback();
             return;
         }
@@ -353,6 +330,111 @@ void LogReplayLink::_readNextLogEntry(void)
     _readTickTimer.start(timeToNextExecutionMSecs);
 }
 
+/// Unthrottled version of _readNextLogEntry. Reads a batch of messages and hands them on as a single buffer. The
+/// consumer provides the backpressure: once maxBatchesInFlight batches are waiting to be processed on the main thread,
+/// reading stops until _batchConsumedOnThread says one of them is done.
+void LogReplayLink::_readNextBatch(void)
+{
+    QByteArray  batch;
+    QByteArray  bytes;
+    int         messageCount    = 0;
+    bool        atEnd           = false;
+    bool        pauseReached    = false;
+
+    batch.reserve(_unthrottledBatchSize * MAVLINK_MAX_PACKET_LEN);
+
+    while (messageCount < _unthrottledBatchSize) {
+        if (_pauseAtLogTimeUSecs && _logCurrentTimeUSecs >= _pauseAtLogTimeUSecs) {
+            pauseReached = true;
+            break;
+        }
+
+        quint64 nextTimeUSecs = _readNextMavlinkMessage(bytes);
+        if (!bytes.isEmpty()) {
+            batch.append(bytes);
+            messageCount++;
+        }
+
+        if (_atEnd()) {
+            atEnd = true;
+            break;
+        }
+        _logCurrentTimeUSecs = nextTimeUSecs;
+    }
+
+    if (messageCount) {
+        emit bytesReceived(this, batch);
+        _replayMessageCount += messageCount;
+
+        // Queued behind the messagesReceived signal for this batch, so it runs once the main thread has processed it
+        _batchesInFlight++;
+        QPointer<LogReplayLink> link(this);
+        QMetaObject::invokeMethod(qgcApp(), [link]() {
+            if (link) {
+                emit link->_batchConsumed();
+            }
+        }, Qt::QueuedConnection);
+    }
+
+    emit playbackPercentCompleteChanged(((float)(_logCurrentTimeUSecs - _logStartTimeUSecs) / (float)_logDurationUSecs) * 100);
+    _signalCurrentLogTimeSecs();
+
+    if (atEnd) {
+        _finishPlayback();
+        return;
+    }
+    if (pauseReached) {
+        _pauseAtLogTimeReached();
+        return;
+    }
+
+    if (_replayRateTimer.elapsed() - _lastReplayRateMSecs >= _replayRateIntervalMSecs) {
+        _signalReplayRate();
+    }
+
+    if (_batchesInFlight < maxBatchesInFlight) {
+        _readTickTimer.start(0);
+    } else {
+        _waitingForConsumer = true;
+    }
+}
+
+void LogReplayLink::_batchConsumedOnThread(void)
+{
+    _batchesInFlight--;
+
+    if (_waitingForConsumer) {
+        _waitingForConsumer = false;
+        _readTickTimer.start(0);
+    }
+}
+
+/// Pauses playback if the next message is at or past the pause time
+/// @return true: playback was paused
+bool LogReplayLink::_pauseAtLogTimeReached(void)
+{
+    if (_pauseAtLogTimeUSecs == 0 || _logCurrentTimeUSecs < _pauseAtLogTimeUSecs) {
+        return false;
+    }
+
+    _pauseAtLogTimeUSecs = 0;
+    _signalCurrentLogTimeSecs();
+    _pause();
+    emit pauseAtLogTimeReached();
+
+    return true;
+}
+
+void LogReplayLink::_signalReplayRate(void)
+{
+    qint64 elapsedMSecs = _replayRateTimer.elapsed();
+
+    _lastReplayRateMSecs = elapsedMSecs;
+    if (elapsedMSecs > 0) {
+        emit replayRateChanged(_replayMessageCount * 1000.0 / elapsedMSecs);
+    }
+}
+
 void LogReplayLink::_play(void)
 {
     qgcApp()->toolbox()->linkManager()->setConnectionsSuspended(tr("Connect not allowed during Flight Data replay."));
@@ -361,12 +443,15 @@ void LogReplayLink::_play(void)
 #endif
     
     // Make sure we aren't at the end of the file, if we are, reset to the beginning and play from there.
-    if (_logFile.atEnd()) {
+    if (_atEnd()) {
         _resetPlaybackToBeginning();
     }
     
     _playbackStartTimeMSecs = (quint64)QDateTime::currentMSecsSinceEpoch();
     _playbackStartLogTimeUSecs = _logCurrentTimeUSecs;
+    _replayMessageCount = 0;
+    _lastReplayRateMSecs = 0;
+    _replayRateTimer.start();
     _readTickTimer.start(1);
     
     emit playbackStarted();
@@ -380,15 +465,19 @@ void LogReplayLink::_pause(void)
 #endif
     
     _readTickTimer.stop();
+    if (_unthrottled) {
+        // Batches still in flight are acknowledged, but no longer restart reading
+        _waitingForConsumer = false;
+        _signalReplayRate();
+    }
     
     emit playbackPaused();
 }
 
 void LogReplayLink::_resetPlaybackToBeginning(void)
 {
-    if (_logFile.isOpen()) {
-        _logFile.reset();
-    }
+    _logPosition = _logIndex.firstFrameOffset();
+    _nextFilteredOffset = 0;
     
     // And since we haven't starting playback, clear the time of initial playback and the current timestamp.
     _playbackStartTimeMSecs = 0;
@@ -414,45 +503,17 @@ void LogReplayLink::movePlayhead(qreal percentComplete)
         percentComplete = 100;
     }
     
-    qreal percentCompleteMult = percentComplete / 100.0;
-    
-    // But if we have a timestamped MAVLink log, then actually aim to hit that percentage in terms of
-    // time through the file.
-    qint64 newFilePos = (qint64)(percentCompleteMult * (qreal)_logFile.size());
-
-    // Now seek to the appropriate position, failing gracefully if we can't.
-    if (!_logFile.seek(newFilePos)) {
-        _replayError(tr("Unable to seek to new position"));
-        return;
-    }
-
-    // But we do align to the next MAVLink message for consistency.
-    mavlink_message_t dummy;
-    _logCurrentTimeUSecs = _seekToNextMavlinkMessage(&dummy);
-
-    // Now calculate the current file location based on time.
-    qreal newRelativeTimeUSecs = (qreal)(_logCurrentTimeUSecs - _logStartTimeUSecs);
-
-    // Calculate the effective baud rate of the file in bytes/s.
-    qreal baudRate = _logFile.size() / (qreal)_logDurationUSecs / 1e6;
-
-    // And the desired time is:
-    qreal desiredTimeUSecs = percentCompleteMult * _logDurationUSecs;
+    // The index takes us straight to the first message at or after the desired time
+    quint64 desiredTimeUSecs = _logStartTimeUSecs + static_cast<quint64>((percentComplete / 100.0) * _logDurationUSecs);
+    _logPosition = _logIndex.offsetForTime(desiredTimeUSecs);
+    _nextFilteredOffset = static_cast<int>(std::lower_bound(_filteredOffsets.constBegin(), _filteredOffsets.constEnd(), _logPosition) - _filteredOffsets.constBegin());
 
-    // And now jump the necessary number of bytes in the proper direction
-    qint64 offset = (newRelativeTimeUSecs - desiredTimeUSecs) * baudRate;
-    if (!_logFile.seek(_logFile.pos() + offset)) {
-        _replayError(tr("Unable to seek to new position"));
-        return;
-    }
-
-    // And scan until we reach the start of a MAVLink message. We make sure to record this timestamp for
-    // smooth jumping around the file.
-    _logCurrentTimeUSecs = _seekToNextMavlinkMessage(&dummy);
+    MAVLinkFrameScanner::Frame_t frame;
+    _logCurrentTimeUSecs = _nextFrame(frame) ? TlogIndex::frameTimestamp(_logData, _logPosition) : _logEndTimeUSecs;
     _signalCurrentLogTimeSecs();
 
     // Now update the UI with our actual final position.
-    newRelativeTimeUSecs = (qreal)(_logCurrentTimeUSecs - _logStartTimeUSecs);
+    qreal newRelativeTimeUSecs = (qreal)(_logCurrentTimeUSecs - _logStartTimeUSecs);
     percentComplete = (newRelativeTimeUSecs / _logDurationUSecs) * 100;
     emit playbackPercentCompleteChanged(percentComplete);
 }
@@ -467,6 +528,36 @@ void LogReplayLink::_setPlaybackSpeed(qreal playbackSpeed)
     _readTickTimer.start(1);
 }
 
+void LogReplayLink::_setMessageFilter(const QList<uint32_t>& messageIds)
+{
+    // The index already knows where every message of each id is, so nothing else in the log needs to be looked at
+    _messageFilterActive = !messageIds.isEmpty();
+    _filteredOffsets = _logIndex.offsetsForMessageIds(messageIds);
+    _nextFilteredOffset = static_cast<int>(std::lower_bound(_filteredOffsets.constBegin(), _filteredOffsets.constEnd(), _logPosition) - _filteredOffsets.constBegin());
+}
+
+void LogReplayLink::_setUnthrottled(bool unthrottled)
+{
+    _unthrottled = unthrottled;
+
+    // Throttled playback picks up pacing from the current position
+    _playbackStartTimeMSecs = (quint64)QDateTime::currentMSecsSinceEpoch();
+    _playbackStartLogTimeUSecs = _logCurrentTimeUSecs;
+    _replayMessageCount = 0;
+    _lastReplayRateMSecs = 0;
+    _replayRateTimer.start();
+}
+
+void LogReplayLink::_setPauseAtLogTime(quint64 timestampUSecs)
+{
+    _pauseAtLogTimeUSecs = timestampUSecs;
+}
+
+void LogReplayLink::_setPauseAtLogSecs(int secs)
+{
+    _pauseAtLogTimeUSecs = secs > 0 ? _logStartTimeUSecs + static_cast<quint64>(secs) * 1000000 : 0;
+}
+
 /// @brief Called when playback is complete
 void LogReplayLink::_finishPlayback(void)
 {
@@ -486,6 +577,9 @@ LogReplayLinkController::LogReplayLinkController(void)
     , _percentComplete  (0)
     , _playheadSecs     (0)
     , _playbackSpeed    (1)
+    , _unthrottled      (false)
+    , _messagesPerSecond(0)
+    , _pauseAtSecs      (0)
 {
 }
 
@@ -494,6 +588,7 @@ void LogReplayLinkController::setLink(LogReplayLink* link)
     if (_link) {
         disconnect(_link);
         disconnect(this, &LogReplayLinkController::playbackSpeedChanged, _link, &LogReplayLink::setPlaybackSpeed);
+        disconnect(this, &LogReplayLinkController::unthrottledChanged, _link, &LogReplayLink::setUnthrottled);
         _isPlaying = false;
         _percentComplete = 0;
         _playheadTime.clear();
@@ -516,8 +611,18 @@ void LogReplayLinkController::setLink(LogReplayLink* link)
         connect(_link, &LogReplayLink::playbackPercentCompleteChanged,    this, &LogReplayLinkController::_playbackPercentCompleteChanged);
         connect(_link, &LogReplayLink::currentLogTimeSecs,                this, &LogReplayLinkController::_currentLogTimeSecs);
         connect(_link, &LogReplayLink::disconnected,                      this, &LogReplayLinkController::_linkDisconnected);
+        connect(_link, &LogReplayLink::replayRateChanged,                 this, &LogReplayLinkController::_replayRateChanged);
+        connect(_link, &LogReplayLink::pauseAtLogTimeReached,             this, &LogReplayLinkController::_pauseAtLogTimeReached);
 
         connect(this, &LogReplayLinkController::playbackSpeedChanged, _link, &LogReplayLink::setPlaybackSpeed);
+        connect(this, &LogReplayLinkController::unthrottledChanged, _link, &LogReplayLink::setUnthrottled);
+
+        if (!_messageFilter.isEmpty()) {
+            _link->setMessageFilter(_messageFilterIds());
+        }
+        if (_pauseAtSecs) {
+            _link->setPauseAtLogSecs(_pauseAtSecs);
+        }
 
         emit linkChanged(_link);
     }
@@ -537,6 +642,45 @@ void LogReplayLinkController::setPercentComplete(qreal percentComplete)
     _link->movePlayhead(percentComplete);
 }
 
+void LogReplayLinkController::setMessageFilter(const QString& messageFilter)
+{
+    if (_messageFilter != messageFilter) {
+        _messageFilter = messageFilter;
+        if (_link) {
+            _link->setMessageFilter(_messageFilterIds());
+        }
+        emit messageFilterChanged(_messageFilter);
+    }
+}
+
+void LogReplayLinkController::setPauseAtSecs(int pauseAtSecs)
+{
+    pauseAtSecs = qMax(0, pauseAtSecs);
+    if (_pauseAtSecs != pauseAtSecs) {
+        _pauseAtSecs = pauseAtSecs;
+        if (_link) {
+            _link->setPauseAtLogSecs(_pauseAtSecs);
+        }
+        emit pauseAtSecsChanged(_pauseAtSecs);
+    }
+}
+
+QList<uint32_t> LogReplayLinkController::_messageFilterIds(void) const
+{
+    QList<uint32_t> messageIds;
+
+    for (const QString& messageName : _messageFilter.split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+        const mavlink_message_info_t* messageInfo = mavlink_get_message_info_by_name(messageName.trimmed().toUpper().toLatin1().constData());
+        if (messageInfo) {
+            messageIds.append(messageInfo->msgid);
+        } else {
+            qWarning() << "LogReplayLinkController unknown message in filter" << messageName;
+        }
+    }
+
+    return messageIds;
+}
+
 void LogReplayLinkController::_logFileStats(int logDurationSecs)
 {
     _totalTime = _secondsToHMS(logDurationSecs);
@@ -581,6 +725,19 @@ void LogReplayLinkController::_linkDisconnected(void)
     setLink(nullptr);
 }
 
+void LogReplayLinkController::_pauseAtLogTimeReached(void)
+{
+    // The link only pauses once at the time, after that it is cleared
+    _pauseAtSecs = 0;
+    emit pauseAtSecsChanged(_pauseAtSecs);
+}
+
+void LogReplayLinkController::_replayRateChanged(double messagesPerSecond)
+{
+    _messagesPerSecond = messagesPerSecond;
+    emit messagesPerSecondChanged(_messagesPerSecond);
+}
+
 QString LogReplayLinkController::_secondsToHMS(int seconds)
 {
     int secondsPart  = seconds;
@@ -10,9 +10,11 @@
 #pragma once
 
 #include "MAVLinkProtocol.h"
+#include "TlogIndex.h"
 
 #include <QTimer>
 #include <QFile>
+#include <QElapsedTimer>
 
 class LinkManager;
 
@@ -47,7 +49,8 @@ private:
     QString             _logFilename;
 };
 
-/// Pseudo link that reads a telemetry log and feeds it into the application.
+/// Pseudo link that reads a telemetry log and feeds it into the application. The log is memory mapped and seeked
+/// through a TlogIndex, which is cached next to the log after the first time it is played.
 class LogReplayLink : public LinkInterface
 {
     Q_OBJECT
@@ -57,12 +60,27 @@ public:
     virtual ~LogReplayLink();
 
     /// @return true: log is currently playing, false: log playback is paused
-    bool isPlaying(void) { return _readTickTimer.isActive(); }
+    bool isPlaying(void) { return _readTickTimer.isActive() || _waitingForConsumer; }
 
     void play           (void) { emit _playOnThread(); }
     void pause          (void) { emit _pauseOnThread(); }
     void movePlayhead   (qreal percentComplete);
 
+    /// Only replays messages with the specified ids, an empty list replays everything
+    void setMessageFilter(const QList<uint32_t>& messageIds) { emit _setMessageFilterOnThread(messageIds); }
+
+    /// Unthrottled playback ignores log timing and feeds messages as fast as MAVLinkProtocol and the vehicles can
+    /// process them. Messages go out in batches and the next batch is only read once the previous ones are consumed.
+    void setUnthrottled(bool unthrottled) { emit _setUnthrottledOnThread(unthrottled); }
+
+    /// Pauses playback before the first message at or after timestampUSecs (log time, usecs UTC). 0 clears it.
+    void setPauseAtLogTime(quint64 timestampUSecs) { emit _setPauseAtLogTimeOnThread(timestampUSecs); }
+
+    /// Same as setPauseAtLogTime with the time given in seconds from the start of the log. 0 clears it.
+    void setPauseAtLogSecs(int secs) { emit _setPauseAtLogSecsOnThread(secs); }
+
+    static const int maxBatchesInFlight = 2;    ///< Unthrottled batches handed on which the consumer has not processed yet
+
     // overrides from LinkInterface
     bool isConnected(void) const override { return _connected; }
     bool isLogReplay(void) override { return true; }
@@ -79,20 +97,32 @@ signals:
     void playbackAtEnd                  (void);
     void playbackPercentCompleteChanged (qreal percentComplete);
     void currentLogTimeSecs             (int secs);
+    void replayRateChanged              (double messagesPerSecond);     ///< Only signalled during unthrottled playback
+    void pauseAtLogTimeReached          (void);                         ///< Signalled after playbackPaused when the setPauseAtLogTime time is reached
 
     // Internal signals
     void _playOnThread              (void);
     void _pauseOnThread             (void);
     void _setPlaybackSpeedOnThread  (qreal playbackSpeed);
+    void _setMessageFilterOnThread  (const QList<uint32_t>& messageIds);
+    void _setUnthrottledOnThread    (bool unthrottled);
+    void _setPauseAtLogTimeOnThread (quint64 timestampUSecs);
+    void _setPauseAtLogSecsOnThread (int secs);
+    void _batchConsumed             (void);
 
 private slots:
     // LinkInterface overrides
     void _writeBytes(const QByteArray bytes) override;
 
-    void _readNextLogEntry  (void);
-    void _play              (void);
-    void _pause             (void);
-    void _setPlaybackSpeed  (qreal playbackSpeed);
+    void _readNextLogEntry      (void);
+    void _play                  (void);
+    void _pause                 (void);
+    void _setPlaybackSpeed      (qreal playbackSpeed);
+    void _setMessageFilter      (const QList<uint32_t>& messageIds);
+    void _setUnthrottled        (bool unthrottled);
+    void _setPauseAtLogTime     (quint64 timestampUSecs);
+    void _setPauseAtLogSecs     (int secs);
+    void _batchConsumedOnThread (void);
 
 private:
 
@@ -100,14 +130,16 @@ private:
     bool _connect(void) override;
 
     void    _replayError                (const QString& errorMsg);
-    quint64 _parseTimestamp             (const QByteArray& bytes);
-    quint64 _seekToNextMavlinkMessage   (mavlink_message_t* nextMsg);
-    quint64 _findLastTimestamp          (void);
+    bool    _nextFrame                  (MAVLinkFrameScanner::Frame_t& frame);
+    bool    _atEnd                      (void) const { return _logPosition >= _logFileSize; }
     quint64 _readNextMavlinkMessage     (QByteArray& bytes);
     bool    _loadLogFile                (void);
     void    _finishPlayback             (void);
     void    _resetPlaybackToBeginning   (void);
     void    _signalCurrentLogTimeSecs   (void);
+    void    _readNextBatch              (void);
+    bool    _pauseAtLogTimeReached      (void);
+    void    _signalReplayRate           (void);
 
     // QThread overrides
     void run(void) override;
@@ -115,7 +147,6 @@ private:
     LogReplayLinkConfiguration* _logReplayConfig;
 
     bool    _connected;
-    uint8_t _mavlinkChannel;
     QTimer  _readTickTimer;      ///< Timer which signals a read of next log record
 
     QString _errorTitle; ///< Title for communicatorError signals
@@ -132,8 +163,23 @@ private:
     MAVLinkProtocol*    _mavlink;
     QFile               _logFile;
     quint64             _logFileSize;
-
-    static const int cbTimestamp = sizeof(quint64);
+    const uint8_t*      _logData;               ///< Memory mapped log file
+    quint64             _logPosition;           ///< Offset to look for the next frame from
+    TlogIndex           _logIndex;
+    QVector<quint64>    _filteredOffsets;       ///< Frames to replay when a message filter is set
+    int                 _nextFilteredOffset;
+    bool                _messageFilterActive;
+
+    bool                _unthrottled;
+    bool                _waitingForConsumer;    ///< true: Unthrottled playback is waiting for batches to be consumed
+    int                 _batchesInFlight;
+    quint64             _pauseAtLogTimeUSecs;
+    quint64             _replayMessageCount;    ///< Messages replayed since unthrottled playback started
+    QElapsedTimer       _replayRateTimer;
+    qint64              _lastReplayRateMSecs;
+
+    static const int _unthrottledBatchSize      = 256;
+    static const int _replayRateIntervalMSecs   = 1000;
 };
 
 class LogReplayLinkController : public QObject
@@ -147,16 +193,24 @@ public:
     Q_PROPERTY(QString          totalTime       MEMBER _totalTime                                   NOTIFY totalTimeChanged)
     Q_PROPERTY(QString          playheadTime    MEMBER _playheadTime                                NOTIFY playheadTimeChanged)
     Q_PROPERTY(qreal            playbackSpeed   MEMBER _playbackSpeed                               NOTIFY playbackSpeedChanged)
+    Q_PROPERTY(bool             unthrottled     MEMBER _unthrottled                                 NOTIFY unthrottledChanged)
+    Q_PROPERTY(double           messagesPerSecond MEMBER _messagesPerSecond                         NOTIFY messagesPerSecondChanged)
+    Q_PROPERTY(QString          messageFilter   READ messageFilter      WRITE setMessageFilter      NOTIFY messageFilterChanged)    ///< Comma separated message names, empty replays everything
+    Q_PROPERTY(int              pauseAtSecs     READ pauseAtSecs        WRITE setPauseAtSecs        NOTIFY pauseAtSecsChanged)      ///< Seconds from the start of the log to pause at, 0 for none
 
     LogReplayLinkController(void);
 
     LogReplayLink*  link            (void) { return _link; }
     bool            isPlaying       (void) const{ return _isPlaying; }
     qreal           percentComplete (void) const{ return _percentComplete; }
+    QString         messageFilter   (void) const{ return _messageFilter; }
+    int             pauseAtSecs     (void) const{ return _pauseAtSecs; }
 
     void setLink            (LogReplayLink* link);
     void setIsPlaying       (bool isPlaying);
     void setPercentComplete (qreal percentComplete);
+    void setMessageFilter   (const QString& messageFilter);
+    void setPauseAtSecs     (int pauseAtSecs);
 
 signals:
     void linkChanged            (LogReplayLink* link);
@@ -165,6 +219,10 @@ signals:
     void playheadTimeChanged    (QString playheadTime);
     void totalTimeChanged       (QString totalTime);
     void playbackSpeedChanged   (qreal playbackSpeed);
+    void unthrottledChanged     (bool unthrottled);
+    void messagesPerSecondChanged(double messagesPerSecond);
+    void messageFilterChanged   (QString messageFilter);
+    void pauseAtSecsChanged     (int pauseAtSecs);
 
 private slots:
     void _logFileStats                   (int logDurationSecs);
@@ -174,9 +232,12 @@ private slots:
     void _playbackPercentCompleteChanged (qreal percentComplete);
     void _currentLogTimeSecs             (int secs);
     void _linkDisconnected               (void);
+    void _replayRateChanged              (double messagesPerSecond);
+    void _pauseAtLogTimeReached          (void);
 
 private:
-    QString _secondsToHMS(int seconds);
+    QString         _secondsToHMS       (int seconds);
+    QList<uint32_t> _messageFilterIds   (void) const;
 
     LogReplayLink*  _link;
     bool            _isPlaying;
@@ -185,5 +246,9 @@ private:
     QString         _playheadTime;
     QString         _totalTime;
     qreal           _playbackSpeed;
+    bool            _unthrottled;
+    double          _messagesPerSecond;
+    QString         _messageFilter;
+    int             _pauseAtSecs;
 };
 
@@ -0,0 +1,196 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkFrameScanner.h"
+
+#include <cstring>
+
+MAVLinkFrameScanner::MAVLinkFrameScanner(void)
+{
+
+}
+
+void MAVLinkFrameScanner::scan(const QByteArray& bytes, const FrameHandler& handler)
+{
+    scan(reinterpret_cast<const uint8_t*>(bytes.constData()), bytes.size(), handler);
+}
+
+void MAVLinkFrameScanner::scan(const uint8_t* data, int length, const FrameHandler& handler)
+{
+    int consumed = 0;
+
+    // Finish off a frame which was split across buffers. Only the bytes it is still missing are copied from the head
+    // of this buffer. If it turns out to be bad the scan restarts inside _pending and the loop completes whatever
+    // frame starts there next.
+    while (!_pending.isEmpty()) {
+        const int   frameLength = _frameLength(reinterpret_cast<const uint8_t*>(_pending.constData()), _pending.size());
+        int         needed      = 0;
+
+        if (frameLength == _incompleteFrame) {
+            needed = _minHeaderLength - _pending.size();
+        } else if (frameLength != _invalidFrame) {
+            needed = frameLength - _pending.size();
+        }
+        if (needed > 0) {
+            const int available = qMin(needed, length - consumed);
+            _pending.append(reinterpret_cast<const char*>(data + consumed), available);
+            consumed += available;
+            if (available < needed) {
+                return;
+            }
+            if (frameLength == _incompleteFrame) {
+                // Now the frame length is known
+                continue;
+            }
+        }
+
+        _pending.remove(0, _scanBuffer(reinterpret_cast<const uint8_t*>(_pending.constData()), _pending.size(), handler));
+    }
+
+    // Everything else is handed back directly from the caller's buffer
+    consumed += _scanBuffer(data + consumed, length - consumed, handler);
+    if (consumed < length) {
+        _pending.append(reinterpret_cast<const char*>(data + consumed), length - consumed);
+    }
+}
+
+void MAVLinkFrameScanner::reset(void)
+{
+    _pending.clear();
+}
+
+/// @return Number of bytes consumed. Anything after that is the start of an incomplete frame.
+int MAVLinkFrameScanner::_scanBuffer(const uint8_t* data, int length, const FrameHandler& handler)
+{
+    int position = 0;
+
+    while (position < length) {
+        // Skip to the next start marker
+        int start = position;
+        while (start < length && data[start] != MAVLINK_STX && data[start] != MAVLINK_STX_MAVLINK1) {
+            start++;
+        }
+        _droppedByteCount += static_cast<quint64>(start - position);
+        position = start;
+        if (position == length) {
+            break;
+        }
+
+        const uint8_t*  frame       = data + position;
+        int             available   = length - position;
+        int             frameLength = _frameLength(frame, available);
+
+        if (frameLength == _incompleteFrame || frameLength > available) {
+            break;
+        }
+        if (frameLength == _invalidFrame) {
+            _droppedByteCount++;
+            position++;
+            continue;
+        }
+        if (!_checkCRC(frame)) {
+            _crcErrorCount++;
+            _droppedByteCount++;
+            position++;
+            continue;
+        }
+
+        _frameCount++;
+        handler(Frame_t{ frame, frameLength });
+        position += frameLength;
+    }
+
+    return position;
+}
+
+/// @return Full length of the frame starting at data, _incompleteFrame if not enough of the header is there yet to tell,
+///         _invalidFrame if the header can't be the start of a frame
+int MAVLinkFrameScanner::_frameLength(const uint8_t* data, int length)
+{
+    if (data[0] == MAVLINK_STX_MAVLINK1) {
+        if (length < 2) {
+            return _incompleteFrame;
+        }
+        return _v1HeaderLength + data[1] + MAVLINK_NUM_CHECKSUM_BYTES;
+    }
+
+    if (length < 3) {
+        return _incompleteFrame;
+    }
+    uint8_t incompatFlags = data[2];
+    if (incompatFlags & ~MAVLINK_IFLAG_MASK) {
+        // Same as mavlink_parse_char, we don't know how to handle unknown incompatible flags
+        return _invalidFrame;
+    }
+    return _v2HeaderLength + data[1] + MAVLINK_NUM_CHECKSUM_BYTES + ((incompatFlags & MAVLINK_IFLAG_SIGNED) ? MAVLINK_SIGNATURE_BLOCK_LEN : 0);
+}
+
+bool MAVLinkFrameScanner::_checkCRC(const uint8_t* data)
+{
+    int         headerLength;
+    uint32_t    msgId;
+
+    if (data[0] == MAVLINK_STX_MAVLINK1) {
+        headerLength    = _v1HeaderLength;
+        msgId           = data[5];
+    } else {
+        headerLength    = _v2HeaderLength;
+        msgId           = data[7] | (data[8] << 8) | (data[9] << 16);
+    }
+
+    // Unknown messages are checked with a zero crc extra, which is what mavlink_parse_char does
+    const mavlink_msg_entry_t*  entry       = mavlink_get_msg_entry(msgId);
+    uint8_t                     payloadLen  = data[1];
+    uint16_t                    crc         = crc_calculate(data + 1, static_cast<uint16_t>(headerLength - 1 + payloadLen));
+    crc_accumulate(entry ? entry->crc_extra : 0, &crc);
+
+    const uint8_t* ck = data + headerLength + payloadLen;
+    return ck[0] == (crc & 0xFF) && ck[1] == (crc >> 8);
+}
+
+void MAVLinkFrameScanner::decode(const Frame_t& frame, mavlink_message_t& message)
+{
+    const uint8_t*  data = frame.data;
+    int             headerLength;
+
+    message.magic   = data[0];
+    message.len     = data[1];
+
+    if (message.magic == MAVLINK_STX_MAVLINK1) {
+        headerLength            = _v1HeaderLength;
+        message.incompat_flags  = 0;
+        message.compat_flags    = 0;
+        message.seq             = data[2];
+        message.sysid           = data[3];
+        message.compid          = data[4];
+        message.msgid           = data[5];
+    } else {
+        headerLength            = _v2HeaderLength;
+        message.incompat_flags  = data[2];
+        message.compat_flags    = data[3];
+        message.seq             = data[4];
+        message.sysid           = data[5];
+        message.compid          = data[6];
+        message.msgid           = data[7] | (data[8] << 8) | (data[9] << 16);
+    }
+
+    // Zero fill behind the payload so truncated v2 payloads decode correctly
+    char* payload = _MAV_PAYLOAD_NON_CONST(&message);
+    memcpy(payload, data + headerLength, message.len);
+    memset(payload + message.len, 0, sizeof(message.payload64) - message.len);
+
+    const uint8_t* ck = data + headerLength + message.len;
+    message.ck[0]       = ck[0];
+    message.ck[1]       = ck[1];
+    message.checksum    = static_cast<uint16_t>(ck[0] | (ck[1] << 8));
+
+    if (message.incompat_flags & MAVLINK_IFLAG_SIGNED) {
+        memcpy(message.signature, ck + MAVLINK_NUM_CHECKSUM_BYTES, MAVLINK_SIGNATURE_BLOCK_LEN);
+    }
+}
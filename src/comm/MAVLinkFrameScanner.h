@@ -0,0 +1,68 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+
+#include <functional>
+
+#include "QGCMAVLink.h"
+
+/// Frames MAVLink v1 and v2 packets out of a stream a buffer at a time, instead of pushing every byte through the
+/// mavlink_parse_char state machine. The scanner jumps from start marker to start marker, checks the length and CRC of
+/// the whole frame in one go and hands back a view of the frame in the caller's buffer. Only a frame which is split
+/// across two buffers is copied.
+///
+/// On a bad frame the scan restarts at the byte after the start marker, so a false start marker in noise can never
+/// swallow a good frame which follows it.
+class MAVLinkFrameScanner
+{
+public:
+    /// View of a complete, CRC validated frame. Only valid for the duration of the FrameHandler call.
+    typedef struct {
+        const uint8_t*  data;
+        int             length;
+    } Frame_t;
+
+    typedef std::function<void(const Frame_t& frame)> FrameHandler;
+
+    MAVLinkFrameScanner(void);
+
+    /// Scans bytes for complete frames, calling handler for each one in stream order. A partial frame at the end of the
+    /// buffer is held back and completed by the next call.
+    void scan(const QByteArray& bytes, const FrameHandler& handler);
+    void scan(const uint8_t* data, int length, const FrameHandler& handler);
+
+    /// Discards any partially received frame
+    void reset(void);
+
+    quint64 frameCount      (void) const { return _frameCount; }
+    quint64 crcErrorCount   (void) const { return _crcErrorCount; }
+    quint64 droppedByteCount(void) const { return _droppedByteCount; }  ///< Bytes skipped while looking for a frame
+
+    /// Fills in message from a frame the same way mavlink_parse_char would
+    static void decode(const Frame_t& frame, mavlink_message_t& message);
+
+private:
+    int         _scanBuffer (const uint8_t* data, int length, const FrameHandler& handler);
+    static int  _frameLength(const uint8_t* data, int length);
+    static bool _checkCRC   (const uint8_t* data);
+
+    QByteArray  _pending;                   ///< Start of a frame which was split across buffers
+    quint64     _frameCount         = 0;
+    quint64     _crcErrorCount      = 0;
+    quint64     _droppedByteCount   = 0;
+
+    static const int _v1HeaderLength    = MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1;    ///< Includes start marker
+    static const int _v2HeaderLength    = MAVLINK_CORE_HEADER_LEN + 1;             ///< Includes start marker
+    static const int _minHeaderLength   = 3;                                        ///< Enough of any header to tell the frame length
+    static const int _incompleteFrame   = -1;
+    static const int _invalidFrame      = 0;
+};
@@ -0,0 +1,211 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkMessagePool.h"
+
+#include <QThreadStorage>
+
+QGC_LOGGING_CATEGORY(MAVLinkMessagePoolLog, "MAVLinkMessagePoolLog")
+
+QAtomicInteger<quint64> MAVLinkMessagePool::_heapAllocationCount;
+
+/// Held in thread local storage, lets the pool know when its thread finishes
+class MAVLinkMessagePoolOwner
+{
+public:
+    MAVLinkMessagePoolOwner(void) : pool(new MAVLinkMessagePool) { }
+    ~MAVLinkMessagePoolOwner() { pool->_threadFinished(); }
+
+    MAVLinkMessagePool* pool;
+};
+
+static QThreadStorage<MAVLinkMessagePoolOwner*> _poolOwners;
+
+MAVLinkMessagePool::MAVLinkMessagePool(void)
+    : _liveCount(1)
+{
+
+}
+
+MAVLinkMessagePool* MAVLinkMessagePool::_threadPool(void)
+{
+    if (!_poolOwners.hasLocalData()) {
+        _poolOwners.setLocalData(new MAVLinkMessagePoolOwner);
+    }
+    return _poolOwners.localData()->pool;
+}
+
+int MAVLinkMessagePool::freeCount(void)
+{
+    return _poolOwners.hasLocalData() ? _poolOwners.localData()->pool->_freeCount : 0;
+}
+
+MAVLinkMessagePool::Node_t* MAVLinkMessagePool::_acquire(void)
+{
+    if (!_freeList) {
+        // Pick up everything other threads have released in one go
+        Node_t* returned = _returnedList.fetchAndStoreAcquire(nullptr);
+        while (returned) {
+            Node_t* next = returned->next;
+            _recycle(returned);
+            returned = next;
+        }
+    }
+
+    Node_t* node = _freeList;
+    if (node) {
+        _freeList = node->next;
+        _freeCount--;
+    } else {
+        node = new Node_t;
+        node->pool = this;
+        _liveCount.ref();
+        _heapAllocationCount.fetchAndAddRelaxed(1);
+    }
+
+    node->refCount.storeRelaxed(1);
+    node->receivedNSecs = 0;
+    node->next = nullptr;
+    return node;
+}
+
+void MAVLinkMessagePool::_release(Node_t* node)
+{
+    MAVLinkMessagePool* pool = node->pool;
+
+    if (_poolOwners.hasLocalData() && _poolOwners.localData()->pool == pool) {
+        pool->_recycle(node);
+        return;
+    }
+
+    // The pool must stay alive while this thread looks at it, its own thread may finish at any point
+    pool->_liveCount.ref();
+    pool->_pushReturned(node);
+    if (pool->_orphaned.loadAcquire()) {
+        pool->_freeReturned();
+    }
+    pool->_deref();
+}
+
+void MAVLinkMessagePool::_recycle(Node_t* node)
+{
+    if (_freeCount >= _maxFreeCount) {
+        _freeNode(node);
+        return;
+    }
+    node->next = _freeList;
+    _freeList = node;
+    _freeCount++;
+}
+
+void MAVLinkMessagePool::_pushReturned(Node_t* node)
+{
+    Node_t* head;
+    do {
+        head = _returnedList.loadRelaxed();
+        node->next = head;
+    } while (!_returnedList.testAndSetOrdered(head, node));
+}
+
+/// Frees the return list once the owning thread is gone. Called by the thread finishing as well as by any thread
+/// which returns a message afterwards, the exchange hands each message to exactly one of them.
+void MAVLinkMessagePool::_freeReturned(void)
+{
+    Node_t* returned = _returnedList.fetchAndStoreOrdered(nullptr);
+    while (returned) {
+        Node_t* next = returned->next;
+        _freeNode(returned);
+        returned = next;
+    }
+}
+
+void MAVLinkMessagePool::_freeNode(Node_t* node)
+{
+    delete node;
+    _deref();
+}
+
+void MAVLinkMessagePool::_threadFinished(void)
+{
+    qCDebug(MAVLinkMessagePoolLog) << "Thread finished, outstanding messages" << _liveCount.loadRelaxed() - 1 - _freeCount;
+
+    _orphaned.fetchAndStoreOrdered(1);
+
+    while (_freeList) {
+        Node_t* next = _freeList->next;
+        _freeNode(_freeList);
+        _freeList = next;
+    }
+    _freeCount = 0;
+    _freeReturned();
+
+    _deref();
+}
+
+void MAVLinkMessagePool::_deref(void)
+{
+    if (!_liveCount.deref()) {
+        delete this;
+    }
+}
+
+MAVLinkMessageRef::MAVLinkMessageRef(const MAVLinkMessageRef& other)
+    : _node(other._node)
+{
+    if (_node) {
+        _node->refCount.ref();
+    }
+}
+
+MAVLinkMessageRef& MAVLinkMessageRef::operator=(const MAVLinkMessageRef& other)
+{
+    if (other._node) {
+        other._node->refCount.ref();
+    }
+    _reset();
+    _node = other._node;
+    return *this;
+}
+
+MAVLinkMessageRef& MAVLinkMessageRef::operator=(MAVLinkMessageRef&& other) noexcept
+{
+    if (this != &other) {
+        _reset();
+        _node = other._node;
+        other._node = nullptr;
+    }
+    return *this;
+}
+
+MAVLinkMessageRef MAVLinkMessageRef::create(void)
+{
+    return MAVLinkMessageRef(MAVLinkMessagePool::_threadPool()->_acquire());
+}
+
+MAVLinkMessageRef MAVLinkMessageRef::create(const mavlink_message_t& message)
+{
+    MAVLinkMessageRef ref = create();
+    ref._node->message = message;
+    return ref;
+}
+
+MAVLinkMessageRef MAVLinkMessageRef::clone(void) const
+{
+    MAVLinkMessageRef ref = create(**this);
+    ref._node->receivedNSecs = _node->receivedNSecs;
+    return ref;
+}
+
+void MAVLinkMessageRef::_reset(void)
+{
+    if (_node && !_node->refCount.deref()) {
+        MAVLinkMessagePool::_release(_node);
+    }
+    _node = nullptr;
+}
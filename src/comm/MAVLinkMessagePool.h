@@ -0,0 +1,113 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QMetaType>
+
+#include "QGCLoggingCategory.h"
+#include "QGCMAVLink.h"
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkMessagePoolLog)
+
+class MAVLinkMessageRef;
+
+/// Per thread free list of message storage for MAVLinkMessageRef. A message is taken from the pool of the thread which
+/// creates it. When its last reference is dropped it goes back to that same pool: directly on the owning thread, or
+/// through a lock free return list when dropped on another thread, which the owner picks up the next time it runs dry.
+/// A pool outlives its thread until every message it handed out has come back.
+class MAVLinkMessagePool
+{
+public:
+    /// @return Number of messages which have been allocated from the heap, over all pools
+    static quint64 heapAllocationCount(void) { return _heapAllocationCount.loadRelaxed(); }
+
+    /// @return Number of free messages in the pool of the calling thread
+    static int freeCount(void);
+
+private:
+    typedef struct Node_t {
+        mavlink_message_t   message;
+        qint64              receivedNSecs;
+        QAtomicInt          refCount;
+        MAVLinkMessagePool* pool;
+        struct Node_t*      next;
+    } Node_t;
+
+    MAVLinkMessagePool(void);
+
+    static MAVLinkMessagePool*  _threadPool     (void);
+    static void                 _release        (Node_t* node);
+
+    Node_t* _acquire        (void);
+    void    _recycle        (Node_t* node);
+    void    _pushReturned   (Node_t* node);
+    void    _freeReturned   (void);
+    void    _freeNode       (Node_t* node);
+    void    _threadFinished (void);
+    void    _deref          (void);
+
+    Node_t*                 _freeList       = nullptr;  ///< Only used by the owning thread
+    int                     _freeCount      = 0;
+    QAtomicPointer<Node_t>  _returnedList;              ///< Messages released on other threads
+    QAtomicInt              _orphaned;                  ///< Owning thread has finished
+    QAtomicInt              _liveCount;                 ///< One for the owning thread, plus one per allocated message
+
+    static QAtomicInteger<quint64> _heapAllocationCount;
+
+    static const int _maxFreeCount = 1024;  ///< Released messages beyond this go back to the heap
+
+    friend class MAVLinkMessageRef;
+    friend class MAVLinkMessagePoolOwner;
+};
+
+/// Intrusively reference counted handle to a received message. Copying the handle, including through queued signals,
+/// only bumps the reference count, so any number of handlers share one copy of the message.
+class MAVLinkMessageRef
+{
+public:
+    MAVLinkMessageRef(void) = default;
+    MAVLinkMessageRef(const MAVLinkMessageRef& other);
+    MAVLinkMessageRef(MAVLinkMessageRef&& other) noexcept : _node(other._node) { other._node = nullptr; }
+    ~MAVLinkMessageRef() { _reset(); }
+
+    MAVLinkMessageRef& operator=(const MAVLinkMessageRef& other);
+    MAVLinkMessageRef& operator=(MAVLinkMessageRef&& other) noexcept;
+
+    /// @return New message from the pool of the calling thread, the contents are not initialized
+    static MAVLinkMessageRef create(void);
+    static MAVLinkMessageRef create(const mavlink_message_t& message);
+
+    /// @return Handle to a private copy of the message, including its receive timestamp
+    MAVLinkMessageRef clone(void) const;
+
+    bool isNull     (void) const { return !_node; }
+    int  refCount   (void) const { return _node ? _node->refCount.loadRelaxed() : 0; }
+
+    const mavlink_message_t& operator*  (void) const { return _node->message; }
+    const mavlink_message_t* operator-> (void) const { return &_node->message; }
+
+    /// Changes made through this are seen by every holder of the message, use clone for a private copy
+    mavlink_message_t& mutableMessage(void) { return _node->message; }
+
+    /// @return When the link received the message, on the MAVLinkTimesync::nowNSecs clock. 0 if not received from a link.
+    qint64  receivedNSecs       (void) const { return _node->receivedNSecs; }
+    void    setReceivedNSecs    (qint64 receivedNSecs) { _node->receivedNSecs = receivedNSecs; }
+
+private:
+    explicit MAVLinkMessageRef(MAVLinkMessagePool::Node_t* node) : _node(node) { }
+
+    void _reset(void);
+
+    MAVLinkMessagePool::Node_t* _node = nullptr;
+};
+
+Q_DECLARE_METATYPE(MAVLinkMessageRef)
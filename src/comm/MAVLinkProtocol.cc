@@ -32,8 +32,6 @@
 #include "MultiVehicleManager.h"
 #include "SettingsManager.h"
 
-Q_DECLARE_METATYPE(mavlink_message_t)
-
 QGC_LOGGING_CATEGORY(MAVLinkProtocolLog, "MAVLinkProtocolLog")
 
 const char* MAVLinkProtocol::_tempLogFileTemplate   = "FlightDataXXXXXX";   ///< Template for temporary log file
@@ -46,8 +44,6 @@ const char* MAVLinkProtocol::_logFileExtension      = "mavlink";            ///<
 MAVLinkProtocol::MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
     , m_enable_version_check(true)
-    , _message({})
-    , _status({})
     , versionMismatchIgnore(false)
     , systemId(255)
     , _current_version(100)
@@ -63,8 +59,8 @@ MAVLinkProtocol::MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox)
     memset(totalLossCounter,    0, sizeof(totalLossCounter));
     memset(runningLossPercent,  0, sizeof(runningLossPercent));
     memset(firstMessage,        1, sizeof(firstMessage));
-    memset(&_status,            0, sizeof(_status));
-    memset(&_message,           0, sizeof(_message));
+
+    connect(&_logWriter, &TelemetryLogWriter::writeError, this, &MAVLinkProtocol::_logWriteError);
 }
 
 MAVLinkProtocol::~MAVLinkProtocol()
@@ -99,6 +95,8 @@ void MAVLinkProtocol::setToolbox(QGCToolbox *toolbox)
    _multiVehicleManager =   _toolbox->multiVehicleManager();
 
    qRegisterMetaType<mavlink_message_t>("mavlink_message_t");
+   qRegisterMetaType<MAVLinkMessageRef>("MAVLinkMessageRef");
+   qRegisterMetaType<QVector<MAVLinkMessageRef>>("QVector<MAVLinkMessageRef>");
 
    loadSettings();
 
@@ -160,217 +158,160 @@ void MAVLinkProtocol::resetMetadataForLink(LinkInterface *link)
 
 void MAVLinkProtocol::logSentBytes(LinkInterface* link, QByteArray b){
 
-    uint8_t bytes_time[sizeof(quint64)];
-
     Q_UNUSED(link);
-    if (!_logSuspendError && !_logSuspendReplay && _tempLogFile.isOpen()) {
-
-        quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
-
-        qToBigEndian(time,bytes_time);
-
-        b.insert(0,QByteArray((const char*)bytes_time,sizeof(bytes_time)));
-
-        int len = b.count();
-
-        if(_tempLogFile.write(b) != len)
-        {
-            // If there's an error logging data, raise an alert and stop logging.
-            emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
-            _stopLogging();
-            _logSuspendError = true;
-        }
+    if (!_logSuspendError && !_logSuspendReplay && _logWriter.logActive()) {
+        _logWriter.logBytes(b);
     }
 
 }
 
 /**
- * This method parses all incoming bytes and constructs a MAVLink packet.
- * It can handle multiple links in parallel, as each link has it's own buffer/
- * parsing state machine.
- * @param link The interface to read from
- * @see LinkInterface
+ * Handles the messages framed by a link. Framing and CRC checks have already been done on the
+ * link thread, so this only does the per message bookkeeping which needs to happen on the main thread.
+ * @param link The interface the messages arrived on
+ * @see LinkInterface::messagesReceived
  **/
 
-void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
+void MAVLinkProtocol::receiveMessages(LinkInterface* link, QVector<MAVLinkMessageRef> messages)
 {
-    // Since receiveBytes signals cross threads we can end up with signals in the queue
+    // Since receiveMessages signals cross threads we can end up with signals in the queue
     // that come through after the link is disconnected. For these we just drop the data
     // since the link is closed.
     SharedLinkInterfacePtr linkPtr = _linkMgr->sharedLinkInterfacePointerForLink(link, true);
     if (!linkPtr) {
-        qCDebug(MAVLinkProtocolLog) << "receiveBytes: link gone!" << b.size() << " bytes arrived too late";
+        qCDebug(MAVLinkProtocolLog) << "receiveMessages: link gone!" << messages.count() << " messages arrived too late";
         return;
     }
 
     uint8_t mavlinkChannel = link->mavlinkChannel();
 
-    for (int position = 0; position < b.size(); position++) {
-        if (mavlink_parse_char(mavlinkChannel, static_cast<uint8_t>(b[position]), &_message, &_status)) {
-            // Got a valid message
-            if (!link->decodedFirstMavlinkPacket()) {
-                link->setDecodedFirstMavlinkPacket(true);
-                mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
-                if (!(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1) && (mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
-                    qCDebug(MAVLinkProtocolLog) << "Switching outbound to mavlink 2.0 due to incoming mavlink 2.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
-                    mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
-                    // Set all links to v2
-                    setVersion(200);
-                }
-            }
+    for (const MAVLinkMessageRef& messageRef : messages) {
+        const mavlink_message_t& message = *messageRef;
 
-            //-----------------------------------------------------------------
-            // MAVLink Status
-            uint8_t lastSeq = lastIndex[_message.sysid][_message.compid];
-            uint8_t expectedSeq = lastSeq + 1;
-            // Increase receive counter
-            totalReceiveCounter[mavlinkChannel]++;
-            // Determine what the next expected sequence number is, accounting for
-            // never having seen a message for this system/component pair.
-            if(firstMessage[_message.sysid][_message.compid]) {
-                firstMessage[_message.sysid][_message.compid] = 0;
-                lastSeq     = _message.seq;
-                expectedSeq = _message.seq;
-            }
-            // And if we didn't encounter that sequence number, record the error
-            //int foo = 0;
-            if (_message.seq != expectedSeq)
-            {
-                //foo = 1;
-                int lostMessages = 0;
-                //-- Account for overflow during packet loss
-                if(_message.seq < expectedSeq) {
-                    lostMessages = (_message.seq + 255) - expectedSeq;
-                } else {
-                    lostMessages = _message.seq - expectedSeq;
-                }
-                // Log how many were lost
-                totalLossCounter[mavlinkChannel] += static_cast<uint64_t>(lostMessages);
+        if (!link->decodedFirstMavlinkPacket()) {
+            link->setDecodedFirstMavlinkPacket(true);
+            mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
+            if (message.magic != MAVLINK_STX_MAVLINK1 && (mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
+                qCDebug(MAVLinkProtocolLog) << "Switching outbound to mavlink 2.0 due to incoming mavlink 2.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
+                mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+                // Set all links to v2
+                setVersion(200);
             }
+        }
 
-            // And update the last sequence number for this system/component pair
-            lastIndex[_message.sysid][_message.compid] = _message.seq;;
-            // Calculate new loss ratio
-            uint64_t totalSent = totalReceiveCounter[mavlinkChannel] + totalLossCounter[mavlinkChannel];
-            float receiveLossPercent = static_cast<float>(static_cast<double>(totalLossCounter[mavlinkChannel]) / static_cast<double>(totalSent));
-            receiveLossPercent *= 100.0f;
-            receiveLossPercent = (receiveLossPercent * 0.5f) + (runningLossPercent[mavlinkChannel] * 0.5f);
-            runningLossPercent[mavlinkChannel] = receiveLossPercent;
-
-            //qDebug() << foo << _message.seq << expectedSeq << lastSeq << totalLossCounter[mavlinkChannel] << totalReceiveCounter[mavlinkChannel] << totalSentCounter[mavlinkChannel] << "(" << _message.sysid << _message.compid << ")";
-
-            //-----------------------------------------------------------------
-            // MAVLink forwarding
-            bool forwardingEnabled = _app->toolbox()->settingsManager()->appSettings()->forwardMavlink()->rawValue().toBool();
-            if (forwardingEnabled) {
-                SharedLinkInterfacePtr forwardingLink = _linkMgr->mavlinkForwardingLink();
-
-                if (forwardingLink) {
-                    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
-                    int len = mavlink_msg_to_send_buffer(buf, &_message);
-                    forwardingLink->writeBytesThreadSafe((const char*)buf, len);
-                }
+        //-----------------------------------------------------------------
+        // MAVLink Status
+        uint8_t lastSeq = lastIndex[message.sysid][message.compid];
+        uint8_t expectedSeq = lastSeq + 1;
+        // Increase receive counter
+        totalReceiveCounter[mavlinkChannel]++;
+        // Determine what the next expected sequence number is, accounting for
+        // never having seen a message for this system/component pair.
+        if(firstMessage[message.sysid][message.compid]) {
+            firstMessage[message.sysid][message.compid] = 0;
+            lastSeq     = message.seq;
+            expectedSeq = message.seq;
+        }
+        // And if we didn't encounter that sequence number, record the error
+        //int foo = 0;
+        if (message.seq != expectedSeq)
+        {
+            //foo = 1;
+            int lostMessages = 0;
+            //-- Account for overflow during packet loss
+            if(message.seq < expectedSeq) {
+                lostMessages = (message.seq + 255) - expectedSeq;
+            } else {
+                lostMessages = message.seq - expectedSeq;
             }
+            // Log how many were lost
+            totalLossCounter[mavlinkChannel] += static_cast<uint64_t>(lostMessages);
+        }
 
-            //-----------------------------------------------------------------
-            // Log data
-            if (!_logSuspendError && !_logSuspendReplay && _tempLogFile.isOpen()) {
-                uint8_t buf[MAVLINK_MAX_PACKET_LEN+sizeof(quint64)];
-
-                // Write the uint64 time in microseconds in big endian format before the message.
-                // This timestamp is saved in UTC time. We are only saving in ms precision because
-                // getting more than this isn't possible with Qt without a ton of extra code.
-                quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
-                qToBigEndian(time, buf);
-
-                // Then write the message to the buffer
-                int len = mavlink_msg_to_send_buffer(buf + sizeof(quint64), &_message);
-
-                // Determine how many bytes were written by adding the timestamp size to the message size
-                len += sizeof(quint64);
-
-                // Now write this timestamp/message pair to the log.
-                QByteArray b(reinterpret_cast<const char*>(buf), len);
-                if(_tempLogFile.write(b) != len)
-                {
-                    // If there's an error logging data, raise an alert and stop logging.
-                    emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
-                    _stopLogging();
-                    _logSuspendError = true;
-                }
-
-                // Check for the vehicle arming going by. This is used to trigger log save.
-                if (!_vehicleWasArmed && _message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                    mavlink_heartbeat_t state;
-                    mavlink_msg_heartbeat_decode(&_message, &state);
-                    if (state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY) {
-                        _vehicleWasArmed = true;
-                    }
+        // And update the last sequence number for this system/component pair
+        lastIndex[message.sysid][message.compid] = message.seq;;
+        // Calculate new loss ratio
+        uint64_t totalSent = totalReceiveCounter[mavlinkChannel] + totalLossCounter[mavlinkChannel];
+        float receiveLossPercent = static_cast<float>(static_cast<double>(totalLossCounter[mavlinkChannel]) / static_cast<double>(totalSent));
+        receiveLossPercent *= 100.0f;
+        receiveLossPercent = (receiveLossPercent * 0.5f) + (runningLossPercent[mavlinkChannel] * 0.5f);
+        runningLossPercent[mavlinkChannel] = receiveLossPercent;
+
+        //qDebug() << foo << message.seq << expectedSeq << lastSeq << totalLossCounter[mavlinkChannel] << totalReceiveCounter[mavlinkChannel] << totalSentCounter[mavlinkChannel] << "(" << message.sysid << message.compid << ")";
+
+        // MAVLink forwarding is done by MAVLinkRouter, from the raw frames on the link thread
+
+        //-----------------------------------------------------------------
+        // Log data
+        if (!_logSuspendError && !_logSuspendReplay && _logWriter.logActive()) {
+            // The writer thread timestamps the message in usecs and batches it into large block writes
+            _logWriter.logMessage(message);
+
+            // Check for the vehicle arming going by. This is used to trigger log save.
+            if (!_vehicleWasArmed && message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+                mavlink_heartbeat_t state;
+                mavlink_msg_heartbeat_decode(&message, &state);
+                if (state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY) {
+                    _vehicleWasArmed = true;
                 }
             }
+        }
 
-            if (_message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                _startLogging();
-                mavlink_heartbeat_t heartbeat;
-                mavlink_msg_heartbeat_decode(&_message, &heartbeat);
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, heartbeat.autopilot, heartbeat.type);
-            } else if (_message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY) {
-                _startLogging();
-                mavlink_high_latency_t highLatency;
-                mavlink_msg_high_latency_decode(&_message, &highLatency);
-                // HIGH_LATENCY does not provide autopilot or type information, generic is our safest bet
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, MAV_AUTOPILOT_GENERIC, MAV_TYPE_GENERIC);
-            } else if (_message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY2) {
-                _startLogging();
-                mavlink_high_latency2_t highLatency2;
-                mavlink_msg_high_latency2_decode(&_message, &highLatency2);
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, highLatency2.autopilot, highLatency2.type);
-            }
+        if (message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+            _startLogging();
+            mavlink_heartbeat_t heartbeat;
+            mavlink_msg_heartbeat_decode(&message, &heartbeat);
+            emit vehicleHeartbeatInfo(link, message.sysid, message.compid, heartbeat.autopilot, heartbeat.type);
+        } else if (message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY) {
+            _startLogging();
+            mavlink_high_latency_t highLatency;
+            mavlink_msg_high_latency_decode(&message, &highLatency);
+            // HIGH_LATENCY does not provide autopilot or type information, generic is our safest bet
+            emit vehicleHeartbeatInfo(link, message.sysid, message.compid, MAV_AUTOPILOT_GENERIC, MAV_TYPE_GENERIC);
+        } else if (message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY2) {
+            _startLogging();
+            mavlink_high_latency2_t highLatency2;
+            mavlink_msg_high_latency2_decode(&message, &highLatency2);
+            emit vehicleHeartbeatInfo(link, message.sysid, message.compid, highLatency2.autopilot, highLatency2.type);
+        }
 
 #if 0
-            // Given the current state of SiK Radio firmwares there is no way to make the code below work.
-            // The ArduPilot implementation of SiK Radio firmware always sends MAVLINK_MSG_ID_RADIO_STATUS as a mavlink 1
-            // packet even if the vehicle is sending Mavlink 2.
-
-            // Detect if we are talking to an old radio not supporting v2
-            mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
-            if (_message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _radio_version_mismatch_count != -1) {
-                if ((mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)
-                && !(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
-                    _radio_version_mismatch_count++;
-                }
+        // Given the current state of SiK Radio firmwares there is no way to make the code below work.
+        // The ArduPilot implementation of SiK Radio firmware always sends MAVLINK_MSG_ID_RADIO_STATUS as a mavlink 1
+        // packet even if the vehicle is sending Mavlink 2.
+
+        // Detect if we are talking to an old radio not supporting v2
+        mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
+        if (message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _radio_version_mismatch_count != -1) {
+            if ((mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)
+            && !(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
+                _radio_version_mismatch_count++;
             }
+        }
 
-            if (_radio_version_mismatch_count == 5) {
-                // Warn the user if the radio continues to send v1 while the link uses v2
-                emit protocolStatusMessage(tr("MAVLink Protocol"), tr("Detected radio still using MAVLink v1.0 on a link with MAVLink v2.0 enabled. Please upgrade the radio firmware."));
-                // Set to flag warning already shown
-                _radio_version_mismatch_count = -1;
-                // Flick link back to v1
-                qDebug() << "Switching outbound to mavlink 1.0 due to incoming mavlink 1.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
-                mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
-            }
+        if (_radio_version_mismatch_count == 5) {
+            // Warn the user if the radio continues to send v1 while the link uses v2
+            emit protocolStatusMessage(tr("MAVLink Protocol"), tr("Detected radio still using MAVLink v1.0 on a link with MAVLink v2.0 enabled. Please upgrade the radio firmware."));
+            // Set to flag warning already shown
+            _radio_version_mismatch_count = -1;
+            // Flick link back to v1
+            qDebug() << "Switching outbound to mavlink 1.0 due to incoming mavlink 1.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
+            mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        }
 #endif
 
-            // Update MAVLink status on every 32th packet
-            if ((totalReceiveCounter[mavlinkChannel] & 0x1F) == 0) {
-                emit mavlinkMessageStatus(_message.sysid, totalSent, totalReceiveCounter[mavlinkChannel], totalLossCounter[mavlinkChannel], receiveLossPercent);
-            }
-
-            // The packet is emitted as a whole, as it is only 255 - 261 bytes short
-            // kind of inefficient, but no issue for a groundstation pc.
-            // It buys as reentrancy for the whole code over all threads
-            emit messageReceived(link, _message);
+        // Update MAVLink status on every 32th packet
+        if ((totalReceiveCounter[mavlinkChannel] & 0x1F) == 0) {
+            emit mavlinkMessageStatus(message.sysid, totalSent, totalReceiveCounter[mavlinkChannel], totalLossCounter[mavlinkChannel], receiveLossPercent);
+        }
 
-            // Anyone handling the message could close the connection, which deletes the link,
-            // so we check if it's expired
-            if (1 == linkPtr.use_count()) {
-                break;
-            }
+        // Handlers share the pooled message, it is only copied by a handler which needs a private copy
+        emit messageReceived(link, messageRef);
 
-            // Reset message parsing
-            memset(&_status,  0, sizeof(_status));
-            memset(&_message, 0, sizeof(_message));
+        // Anyone handling the message could close the connection, which deletes the link,
+        // so we check if it's expired
+        if (1 == linkPtr.use_count()) {
+            break;
         }
     }
 }
@@ -420,6 +361,7 @@ void MAVLinkProtocol::_vehicleCountChanged(void)
 bool MAVLinkProtocol::_closeLogFile(void)
 {
     if (_tempLogFile.isOpen()) {
+        _logWriter.stopLog();
         if (_tempLogFile.size() == 0) {
             // Don't save zero byte files
             _tempLogFile.remove();
@@ -462,6 +404,7 @@ void MAVLinkProtocol::_startLogging(void)
             }
 
             qCDebug(MAVLinkProtocolLog) << "Temp log" << _tempLogFile.fileName();
+            _logWriter.startLog(&_tempLogFile);
             emit checkTelemetrySavePath();
 
             _logSuspendError = false;
@@ -485,6 +428,15 @@ void MAVLinkProtocol::_stopLogging(void)
     _vehicleWasArmed = false;
 }
 
+void MAVLinkProtocol::_logWriteError(const QString& errorString)
+{
+    // If there's an error logging data, raise an alert and stop logging.
+    qCWarning(MAVLinkProtocolLog) << "Log write failed" << errorString;
+    emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
+    _stopLogging();
+    _logSuspendError = true;
+}
+
 /// @brief Checks the temp directory for log files which may have been left there.
 ///         This could happen if QGC crashes without the temp log file being saved.
 ///         Give the user an option to save these orphaned files.
@@ -23,6 +23,7 @@
 #include "QGC.h"
 #include "QGCTemporaryFile.h"
 #include "QGCToolbox.h"
+#include "TelemetryLogWriter.h"
 
 class LinkManager;
 class MultiVehicleManager;
@@ -79,7 +80,7 @@ public:
 
 public slots:
     /** @brief Receive bytes from a communication interface */
-    void receiveBytes(LinkInterface* link, QByteArray b);
+    void receiveMessages(LinkInterface* link, QVector<MAVLinkMessageRef> messages);
 
     /** @brief Log bytes sent from a communication interface */
     void logSentBytes(LinkInterface* link, QByteArray b);
@@ -109,8 +110,6 @@ protected:
     uint64_t    totalLossCounter[MAVLINK_COMM_NUM_BUFFERS];     ///< Total messages lost during transmission.
     float       runningLossPercent[MAVLINK_COMM_NUM_BUFFERS];   ///< Loss rate
 
-    mavlink_message_t _message;
-    mavlink_status_t _status;
 
     bool        versionMismatchIgnore;
     int         systemId;
@@ -121,8 +120,8 @@ signals:
     /// Heartbeat received on link
     void vehicleHeartbeatInfo(LinkInterface* link, int vehicleId, int componentId, int vehicleFirmwareType, int vehicleType);
 
-    /** @brief Message received and directly copied via signal */
-    void messageReceived(LinkInterface* link, mavlink_message_t message);
+    /** @brief Message received, all receivers share the same pooled message */
+    void messageReceived(LinkInterface* link, const MAVLinkMessageRef& message);
     /** @brief Emitted if version check is enabled / disabled */
     void versionCheckChanged(bool enabled);
     /** @brief Emitted if a message from the protocol should reach the user */
@@ -154,6 +153,7 @@ signals:
 
 private slots:
     void _vehicleCountChanged(void);
+    void _logWriteError      (const QString& errorString);
 
 private:
     bool _closeLogFile(void);
@@ -165,6 +165,7 @@ private:
     bool _vehicleWasArmed;      ///< true: Vehicle was armed during log sequence
 
     QGCTemporaryFile    _tempLogFile;            ///< File to log to
+    TelemetryLogWriter  _logWriter;              ///< Writes _tempLogFile from its own thread
     static const char*  _tempLogFileTemplate;    ///< Template for temporary log file
     static const char*  _logFileExtension;       ///< Extension for log files
 
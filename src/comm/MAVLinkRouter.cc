@@ -0,0 +1,245 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkRouter.h"
+
+#include <QVariantMap>
+
+QGC_LOGGING_CATEGORY(MAVLinkRouterLog, "MAVLinkRouterLog")
+
+MAVLinkRouter::MAVLinkRouter(QObject* parent)
+    : QThread(parent)
+{
+    _clock.start();
+}
+
+MAVLinkRouter::~MAVLinkRouter()
+{
+    QMutexLocker locker(&_queueMutex);
+    _stopRequested = true;
+    _queueCondition.wakeOne();
+    locker.unlock();
+
+    wait();
+}
+
+void MAVLinkRouter::setOutput(const SharedLinkInterfacePtr& link, const Rules_t& rules)
+{
+    QMutexLocker locker(&_outputsMutex);
+
+    for (Output_t& output : _outputs) {
+        if (output.linkId == link.get()) {
+            output.rules = rules;
+            output.lastForwardUSecs.clear();
+            return;
+        }
+    }
+
+    const QString name = link->linkConfiguration() ? link->linkConfiguration()->name() : QString();
+    qCDebug(MAVLinkRouterLog) << "Output added" << name;
+
+    _outputs.append(Output_t{ link, link.get(), name, rules, QHash<quint64, qint64>(), 0, 0, 0 });
+    _outputCount.storeRelaxed(_outputs.count());
+    locker.unlock();
+
+    if (!isRunning()) {
+        start();
+    }
+}
+
+void MAVLinkRouter::removeOutput(LinkInterface* link)
+{
+    QMutexLocker locker(&_outputsMutex);
+
+    for (int i=0; i<_outputs.count(); i++) {
+        if (_outputs[i].linkId == link) {
+            qCDebug(MAVLinkRouterLog) << "Output removed" << _outputs[i].name;
+            _outputs.removeAt(i);
+            break;
+        }
+    }
+    _outputCount.storeRelaxed(_outputs.count());
+}
+
+bool MAVLinkRouter::hasOutput(LinkInterface* link) const
+{
+    QMutexLocker locker(&_outputsMutex);
+
+    for (const Output_t& output : _outputs) {
+        if (output.linkId == link) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MAVLinkRouter::route(LinkInterface* source, const QVector<MAVLinkMessageRef>& messages, const QByteArray& frames)
+{
+    if (messages.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&_queueMutex);
+
+    if (_queuedBytes + frames.size() > _maxQueuedBytes) {
+        if (_droppedBatchCount.fetchAndAddRelaxed(1) == 0) {
+            qCWarning(MAVLinkRouterLog) << "Router can't keep up, dropping messages";
+        }
+        return;
+    }
+    _queue.enqueue(Batch_t{ source, messages, frames });
+    _queuedBytes += frames.size();
+    _queueCondition.wakeOne();
+}
+
+void MAVLinkRouter::run(void)
+{
+    QMutexLocker locker(&_queueMutex);
+
+    while (!_stopRequested) {
+        if (_queue.isEmpty()) {
+            _queueCondition.wait(&_queueMutex);
+            continue;
+        }
+
+        QQueue<Batch_t> batches;
+        batches.swap(_queue);
+        _queuedBytes = 0;
+        locker.unlock();
+
+        for (const Batch_t& batch : batches) {
+            _routeBatch(batch);
+        }
+        // Messages are released here, outside of the lock
+        batches.clear();
+
+        locker.relock();
+    }
+}
+
+void MAVLinkRouter::_routeBatch(const Batch_t& batch)
+{
+    QMutexLocker    locker(&_outputsMutex);
+    const qint64    nowUSecs    = _clock.nsecsElapsed() / 1000;
+    int             offset      = 0;
+
+    // Hold on to the output links while writing, so none can go away half way through the batch
+    QVector<SharedLinkInterfacePtr> links(_outputs.count());
+    for (int i=_outputs.count()-1; i>=0; i--) {
+        links[i] = _outputs[i].link.lock();
+        if (!links[i]) {
+            qCDebug(MAVLinkRouterLog) << "Output link gone" << _outputs[i].name;
+            _outputs.removeAt(i);
+            links.removeAt(i);
+        }
+    }
+    _outputCount.storeRelaxed(_outputs.count());
+
+    for (const MAVLinkMessageRef& messageRef : batch.messages) {
+        const mavlink_message_t&    message = *messageRef;
+        const int                   length  = frameLength(message);
+
+        if (offset + length > batch.frames.size()) {
+            qCWarning(MAVLinkRouterLog) << "Frames don't match messages" << batch.frames.size() << offset << length;
+            return;
+        }
+        const char* frame = batch.frames.constData() + offset;
+        offset += length;
+
+        for (int i=0; i<_outputs.count(); i++) {
+            if (_outputs[i].linkId != batch.source && _forward(_outputs[i], message, nowUSecs)) {
+                links[i]->writeBytesThreadSafe(frame, length, LinkSendScheduler::trafficClassForMessage(message.msgid));
+            }
+        }
+    }
+}
+
+bool MAVLinkRouter::_forward(Output_t& output, const mavlink_message_t& message, qint64 nowUSecs)
+{
+    if (!_passesRules(output.rules, message)) {
+        output.filteredCount++;
+        return false;
+    }
+
+    if (output.rules.maxRateHz > 0) {
+        const quint64   key             = (static_cast<quint64>(message.sysid) << 32) | (static_cast<quint64>(message.compid) << 24) | message.msgid;
+        const qint64    intervalUSecs   = static_cast<qint64>(1e6 / output.rules.maxRateHz);
+
+        auto lastForward = output.lastForwardUSecs.find(key);
+        if (lastForward != output.lastForwardUSecs.end()) {
+            if (nowUSecs - lastForward.value() < intervalUSecs) {
+                output.rateLimitedCount++;
+                return false;
+            }
+            lastForward.value() = nowUSecs;
+        } else {
+            output.lastForwardUSecs.insert(key, nowUSecs);
+        }
+    }
+
+    output.forwardedCount++;
+    return true;
+}
+
+bool MAVLinkRouter::_passesRules(const Rules_t& rules, const mavlink_message_t& message)
+{
+    if (rules.deniedSysids.contains(message.sysid) || rules.deniedMsgids.contains(static_cast<int>(message.msgid))) {
+        return false;
+    }
+    if (!rules.allowedSysids.isEmpty() && !rules.allowedSysids.contains(message.sysid)) {
+        return false;
+    }
+    if (!rules.allowedMsgids.isEmpty() && !rules.allowedMsgids.contains(static_cast<int>(message.msgid))) {
+        return false;
+    }
+    return true;
+}
+
+int MAVLinkRouter::frameLength(const mavlink_message_t& message)
+{
+    if (message.magic == MAVLINK_STX_MAVLINK1) {
+        return MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 + message.len + MAVLINK_NUM_CHECKSUM_BYTES;
+    }
+    return MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len + ((message.incompat_flags & MAVLINK_IFLAG_SIGNED) ? MAVLINK_SIGNATURE_BLOCK_LEN : 0);
+}
+
+QSet<int> MAVLinkRouter::parseIdList(const QString& idList)
+{
+    QSet<int> ids;
+
+    for (const QString& entry : idList.split(',', Qt::SkipEmptyParts)) {
+        bool ok;
+        const int id = entry.trimmed().toInt(&ok);
+        if (ok) {
+            ids.insert(id);
+        } else {
+            qCWarning(MAVLinkRouterLog) << "Invalid id in list" << entry;
+        }
+    }
+
+    return ids;
+}
+
+QVariantList MAVLinkRouter::outputStats(void) const
+{
+    QMutexLocker locker(&_outputsMutex);
+    QVariantList outputStats;
+
+    for (const Output_t& output : _outputs) {
+        QVariantMap map;
+
+        map[QStringLiteral("name")]         = output.name;
+        map[QStringLiteral("forwarded")]    = output.forwardedCount;
+        map[QStringLiteral("filtered")]     = output.filteredCount;
+        map[QStringLiteral("rateLimited")]  = output.rateLimitedCount;
+        outputStats.append(map);
+    }
+
+    return outputStats;
+}
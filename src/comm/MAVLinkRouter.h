@@ -0,0 +1,113 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QQueue>
+#include <QSet>
+#include <QVariantList>
+#include <QWaitCondition>
+
+#include "QGCLoggingCategory.h"
+#include "LinkInterface.h"
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkRouterLog)
+
+/// Forwards received messages to any number of output links, on its own thread. Links hand over the raw frames they
+/// validated while framing, so forwarding never re-encodes a message and costs the main thread nothing. Each output
+/// has its own sysid/msgid allow and deny lists and an optional rate cap. Messages are never sent back out on the
+/// link they arrived on.
+///
+/// route may be called from any thread, outputs are configured from the main thread.
+class MAVLinkRouter : public QThread
+{
+    Q_OBJECT
+
+public:
+    /// Empty allow lists let everything through, deny lists win over allow lists
+    typedef struct {
+        QSet<int>   allowedSysids;
+        QSet<int>   deniedSysids;
+        QSet<int>   allowedMsgids;
+        QSet<int>   deniedMsgids;
+        double      maxRateHz = 0;      ///< Cap for each sysid/compid/msgid stream, 0 for no cap
+    } Rules_t;
+
+    MAVLinkRouter(QObject* parent = nullptr);
+    ~MAVLinkRouter();
+
+    /// Adds link as an output, or replaces the rules of an existing output. Outputs go away by themselves when their
+    /// link is deleted.
+    void setOutput      (const SharedLinkInterfacePtr& link, const Rules_t& rules);
+    void removeOutput   (LinkInterface* link);
+    bool hasOutput      (LinkInterface* link) const;
+
+    /// @return true if there are outputs, links only collect frames for the router when this is true
+    bool isActive(void) const { return _outputCount.loadRelaxed() != 0; }
+
+    /// Queues messages received on source for forwarding
+    ///     @param frames The raw frames of messages, back to back in the same order
+    void route(LinkInterface* source, const QVector<MAVLinkMessageRef>& messages, const QByteArray& frames);
+
+    /// @return One map per output: name, forwarded, filtered, rateLimited
+    Q_INVOKABLE QVariantList outputStats(void) const;
+
+    quint32 droppedBatchCount(void) const { return _droppedBatchCount.loadRelaxed(); }
+
+    /// @return Length of the frame message was decoded from
+    static int frameLength(const mavlink_message_t& message);
+
+    /// @return Ids from a comma separated list such as "1,2, 255", entries which are not numbers are skipped
+    static QSet<int> parseIdList(const QString& idList);
+
+protected:
+    // QThread override
+    void run(void) final;
+
+private:
+    typedef struct {
+        LinkInterface*              source;
+        QVector<MAVLinkMessageRef>  messages;
+        QByteArray                  frames;
+    } Batch_t;
+
+    typedef struct {
+        WeakLinkInterfacePtr    link;
+        LinkInterface*          linkId;             ///< Only compared, never dereferenced
+        QString                 name;
+        Rules_t                 rules;
+        QHash<quint64, qint64>  lastForwardUSecs;   ///< By sysid/compid/msgid, for the rate cap
+        quint64                 forwardedCount;
+        quint64                 filteredCount;
+        quint64                 rateLimitedCount;
+    } Output_t;
+
+    void        _routeBatch     (const Batch_t& batch);
+    bool        _forward        (Output_t& output, const mavlink_message_t& message, qint64 nowUSecs);
+    static bool _passesRules    (const Rules_t& rules, const mavlink_message_t& message);
+
+    mutable QMutex          _outputsMutex;
+    QList<Output_t>         _outputs;
+    QAtomicInt              _outputCount;
+
+    QMutex                  _queueMutex;
+    QWaitCondition          _queueCondition;
+    QQueue<Batch_t>         _queue;
+    int                     _queuedBytes = 0;
+    bool                    _stopRequested = false;
+    QAtomicInteger<quint32> _droppedBatchCount;
+    QElapsedTimer           _clock;
+
+    static const int _maxQueuedBytes = 4 * 1024 * 1024;    ///< Batches beyond this are dropped when the router falls behind
+};
@@ -0,0 +1,124 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkTimesync.h"
+
+#include <chrono>
+
+QGC_LOGGING_CATEGORY(MAVLinkTimesyncLog, "MAVLinkTimesyncLog")
+
+MAVLinkTimesync::MAVLinkTimesync(void)
+{
+    reset();
+}
+
+qint64 MAVLinkTimesync::nowNSecs(void)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+mavlink_message_t MAVLinkTimesync::requestMessage(uint8_t systemId, uint8_t componentId, uint8_t channel, qint64 nowNSecs)
+{
+    mavlink_timesync_t  timesync;
+    mavlink_message_t   message;
+
+    memset(&timesync, 0, sizeof(timesync));
+    timesync.tc1 = 0;
+    timesync.ts1 = nowNSecs;
+    mavlink_msg_timesync_encode_chan(systemId, componentId, channel, &message, &timesync);
+
+    return message;
+}
+
+mavlink_message_t MAVLinkTimesync::replyMessage(uint8_t systemId, uint8_t componentId, uint8_t channel, const mavlink_timesync_t& request, qint64 nowNSecs)
+{
+    mavlink_timesync_t  timesync;
+    mavlink_message_t   message;
+
+    memset(&timesync, 0, sizeof(timesync));
+    timesync.tc1 = nowNSecs;
+    timesync.ts1 = request.ts1;
+    mavlink_msg_timesync_encode_chan(systemId, componentId, channel, &message, &timesync);
+
+    return message;
+}
+
+void MAVLinkTimesync::requestSent(qint64 ts1NSecs)
+{
+    _pendingRequests[_nextPendingRequest] = ts1NSecs;
+    _nextPendingRequest = (_nextPendingRequest + 1) % static_cast<int>(sizeof(_pendingRequests) / sizeof(_pendingRequests[0]));
+}
+
+bool MAVLinkTimesync::replyReceived(const mavlink_timesync_t& reply, qint64 receivedNSecs)
+{
+    if (reply.tc1 == 0) {
+        // A request, not a reply
+        return false;
+    }
+
+    // The vehicle answers everyone's requests on a shared link, only use replies to ours
+    bool pending = false;
+    for (qint64& pendingRequest : _pendingRequests) {
+        if (pendingRequest != 0 && pendingRequest == reply.ts1) {
+            pendingRequest = 0;
+            pending = true;
+            break;
+        }
+    }
+    if (!pending) {
+        return false;
+    }
+
+    const qint64 rttNSecs = receivedNSecs - reply.ts1;
+    if (rttNSecs < 0 || rttNSecs > _maxRttNSecs) {
+        return false;
+    }
+
+    // Assume the delay was the same both ways
+    const qint64 offsetNSecs = reply.tc1 - (reply.ts1 + rttNSecs / 2);
+
+    if (_sampleCount > 0 && qAbs(offsetNSecs - _offsetNSecs) > _maxOffsetJumpNSecs) {
+        qCDebug(MAVLinkTimesyncLog) << "Vehicle clock jumped, restarting estimate" << (offsetNSecs - _offsetNSecs) / 1000000 << "msecs";
+        _sampleCount = 0;
+    }
+
+    if (_sampleCount == 0) {
+        _rttNSecs       = rttNSecs;
+        _rttJitterNSecs = rttNSecs / 2;
+        _offsetNSecs    = offsetNSecs;
+        _sampleCount    = 1;
+        return true;
+    }
+
+    // Plain average over the first few samples so the estimate settles quickly
+    const int   weight      = qMin(_sampleCount + 1, static_cast<int>(_smoothingFactor));
+    const bool  rttOutlier  = _sampleCount >= _minSampleCount && rttNSecs > _rttNSecs + 4 * _rttJitterNSecs;
+
+    _rttJitterNSecs += (qAbs(rttNSecs - _rttNSecs) - _rttJitterNSecs) / weight;
+    _rttNSecs       += (rttNSecs - _rttNSecs) / weight;
+
+    if (!rttOutlier) {
+        _offsetNSecs += (offsetNSecs - _offsetNSecs) / weight;
+    }
+    _sampleCount++;
+
+    return true;
+}
+
+void MAVLinkTimesync::reset(void)
+{
+    for (qint64& pendingRequest : _pendingRequests) {
+        pendingRequest = 0;
+    }
+    _nextPendingRequest = 0;
+    _offsetNSecs        = 0;
+    _rttNSecs           = 0;
+    _rttJitterNSecs     = 0;
+    _sampleCount        = 0;
+}
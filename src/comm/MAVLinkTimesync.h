@@ -0,0 +1,67 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtGlobal>
+
+#include "QGCLoggingCategory.h"
+#include "QGCMAVLink.h"
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkTimesyncLog)
+
+/// Estimates the clock offset to a vehicle and the round trip time of one link from TIMESYNC exchanges. We send
+/// requests with our own clock in ts1, the vehicle answers with its clock in tc1 and echoes ts1 back. Offset samples
+/// from exchanges which took much longer than usual are skipped, since how the delay splits between the two
+/// directions is unknown and the sample would be off by up to half of it.
+class MAVLinkTimesync
+{
+public:
+    MAVLinkTimesync(void);
+
+    /// @return Monotonic clock all receive timestamps and TIMESYNC requests are taken from
+    static qint64 nowNSecs(void);
+
+    /// @return TIMESYNC request to send on the link, or a reply to the request in message
+    static mavlink_message_t requestMessage (uint8_t systemId, uint8_t componentId, uint8_t channel, qint64 nowNSecs);
+    static mavlink_message_t replyMessage   (uint8_t systemId, uint8_t componentId, uint8_t channel, const mavlink_timesync_t& request, qint64 nowNSecs);
+
+    /// Remembers a request which has been sent, replies to anything else are ignored
+    void requestSent(qint64 ts1NSecs);
+
+    /// Updates the estimates from a reply to one of our requests
+    ///     @param receivedNSecs When the reply was received on the link
+    /// @return false: reply ignored
+    bool replyReceived(const mavlink_timesync_t& reply, qint64 receivedNSecs);
+
+    /// @return true: Enough replies have arrived for the estimates to be used
+    bool    valid           (void) const { return _sampleCount >= _minSampleCount; }
+    qint64  offsetNSecs     (void) const { return _offsetNSecs; }       ///< Vehicle clock minus our clock
+    qint64  rttNSecs        (void) const { return _rttNSecs; }          ///< Smoothed round trip time
+    qint64  rttJitterNSecs  (void) const { return _rttJitterNSecs; }    ///< Smoothed deviation of the round trip time
+    int     sampleCount     (void) const { return _sampleCount; }
+
+    /// @return Time on the vehicle clock of a local timestamp
+    qint64 vehicleNSecs(qint64 localNSecs) const { return localNSecs + _offsetNSecs; }
+
+    void reset(void);
+
+private:
+    qint64  _pendingRequests[8];
+    int     _nextPendingRequest = 0;
+    qint64  _offsetNSecs        = 0;
+    qint64  _rttNSecs           = 0;
+    qint64  _rttJitterNSecs     = 0;
+    int     _sampleCount        = 0;
+
+    static const int    _minSampleCount     = 3;
+    static const int    _smoothingFactor    = 8;                    ///< Estimates move 1/8th towards each new sample, as TCP does for RTT
+    static const qint64 _maxRttNSecs        = 10000000000LL;        ///< Replies which take longer than this are stale
+    static const qint64 _maxOffsetJumpNSecs = 1000000000LL;         ///< Larger jumps in offset mean the vehicle clock was reset
+};
@@ -0,0 +1,212 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkTrafficModel.h"
+#include "LinkManager.h"
+
+#include <algorithm>
+
+QGC_LOGGING_CATEGORY(MAVLinkTrafficModelLog, "MAVLinkTrafficModelLog")
+
+MAVLinkTrafficModel::MAVLinkTrafficModel(LinkManager* linkManager)
+    : QAbstractListModel(linkManager)
+    , _linkManager      (linkManager)
+{
+    _sinceUpdate.start();
+    _updateTimer.setInterval(_updateIntervalMSecs);
+    connect(&_updateTimer, &QTimer::timeout, this, &MAVLinkTrafficModel::update);
+    _updateTimer.start();
+}
+
+quint64 MAVLinkTrafficModel::_streamKey(uint8_t sysid, uint8_t compid, uint32_t msgid)
+{
+    return (static_cast<quint64>(sysid) << 32) | (static_cast<quint64>(compid) << 24) | msgid;
+}
+
+void MAVLinkTrafficModel::update(void)
+{
+    const QList<SharedLinkInterfacePtr> links           = _linkManager->links();
+    const double                        elapsedSecs     = qMax(_sinceUpdate.restart(), static_cast<qint64>(1)) / 1000.0;
+    bool                                linkRemoved     = false;
+
+    for (const Row_t& row : _rows) {
+        bool found = false;
+        for (const SharedLinkInterfacePtr& link : links) {
+            if (link.get() == row.link) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            linkRemoved = true;
+            break;
+        }
+    }
+    if (linkRemoved) {
+        beginResetModel();
+        _rows.clear();
+        _rowIndices.clear();
+        endResetModel();
+    }
+
+    QList<Row_t> newRows;
+
+    for (const SharedLinkInterfacePtr& link : links) {
+        QHash<quint64, int>&    rowIndices  = _rowIndices[link.get()];
+        const QString           linkName    = link->linkConfiguration() ? link->linkConfiguration()->name() : QString();
+
+        for (const MAVLinkTrafficStats::Stream_t& stream : link->trafficStats().streams()) {
+            const quint64   key         = _streamKey(stream.sysid, stream.compid, stream.msgid);
+            auto            rowIndex    = rowIndices.constFind(key);
+
+            if (rowIndex == rowIndices.constEnd()) {
+                const mavlink_message_info_t* messageInfo = mavlink_get_message_info_by_id(stream.msgid);
+
+                Row_t row;
+                row.link                = link.get();
+                row.linkName            = linkName;
+                row.sysid               = stream.sysid;
+                row.compid              = stream.compid;
+                row.msgid               = stream.msgid;
+                row.messageName         = messageInfo ? QString(messageInfo->name) : QString::number(stream.msgid);
+                row.messageCount        = stream.messageCount;
+                row.byteCount           = stream.byteCount;
+                // Nothing to calculate a rate over yet, the stream may well have started before the last update
+                row.messageRate         = 0;
+                row.byteRate            = 0;
+                row.meanIntervalMSecs   = stream.meanIntervalMSecs;
+                row.jitterMSecs         = stream.jitterMSecs;
+
+                rowIndices[key] = _rows.count() + newRows.count();
+                newRows.append(row);
+                continue;
+            }
+
+            Row_t& row = _rows[rowIndex.value()];
+            row.messageRate         = (stream.messageCount - row.messageCount) / elapsedSecs;
+            row.byteRate            = (stream.byteCount - row.byteCount) / elapsedSecs;
+            row.messageCount        = stream.messageCount;
+            row.byteCount           = stream.byteCount;
+            row.meanIntervalMSecs   = stream.meanIntervalMSecs;
+            row.jitterMSecs         = stream.jitterMSecs;
+        }
+    }
+
+    if (!_rows.isEmpty()) {
+        emit dataChanged(index(0), index(_rows.count() - 1));
+    }
+    if (!newRows.isEmpty()) {
+        beginInsertRows(QModelIndex(), _rows.count(), _rows.count() + newRows.count() - 1);
+        _rows.append(newRows);
+        endInsertRows();
+        qCDebug(MAVLinkTrafficModelLog) << "New streams" << newRows.count();
+    }
+}
+
+int MAVLinkTrafficModel::rowCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+    return _rows.count();
+}
+
+QVariant MAVLinkTrafficModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= _rows.count()) {
+        return QVariant();
+    }
+    return _rowData(_rows[index.row()], role);
+}
+
+QVariant MAVLinkTrafficModel::_rowData(const Row_t& row, int role) const
+{
+    switch (role) {
+    case LinkNameRole:
+        return row.linkName;
+    case SysidRole:
+        return row.sysid;
+    case CompidRole:
+        return row.compid;
+    case MsgidRole:
+        return row.msgid;
+    case MessageNameRole:
+        return row.messageName;
+    case MessageCountRole:
+        return row.messageCount;
+    case ByteCountRole:
+        return row.byteCount;
+    case MessageRateRole:
+        return row.messageRate;
+    case ByteRateRole:
+        return row.byteRate;
+    case MeanIntervalRole:
+        return row.meanIntervalMSecs;
+    case JitterRole:
+        return row.jitterMSecs;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> MAVLinkTrafficModel::roleNames(void) const
+{
+    QHash<int, QByteArray> hash;
+
+    hash[LinkNameRole]      = "linkName";
+    hash[SysidRole]         = "sysid";
+    hash[CompidRole]        = "compid";
+    hash[MsgidRole]         = "msgid";
+    hash[MessageNameRole]   = "messageName";
+    hash[MessageCountRole]  = "messageCount";
+    hash[ByteCountRole]     = "byteCount";
+    hash[MessageRateRole]   = "messageRate";
+    hash[ByteRateRole]      = "byteRate";
+    hash[MeanIntervalRole]  = "meanIntervalMSecs";
+    hash[JitterRole]        = "jitterMSecs";
+
+    return hash;
+}
+
+QVariantMap MAVLinkTrafficModel::_rowMap(const Row_t& row) const
+{
+    const QHash<int, QByteArray>    roles = roleNames();
+    QVariantMap                     map;
+
+    for (auto role = roles.constBegin(); role != roles.constEnd(); role++) {
+        map[QString::fromLatin1(role.value())] = _rowData(row, role.key());
+    }
+
+    return map;
+}
+
+QVariantList MAVLinkTrafficModel::snapshot(void) const
+{
+    QVariantList snapshot;
+
+    for (const Row_t& row : _rows) {
+        snapshot.append(_rowMap(row));
+    }
+
+    return snapshot;
+}
+
+QVariantList MAVLinkTrafficModel::topByteRate(int count) const
+{
+    QList<const Row_t*> rows;
+    for (const Row_t& row : _rows) {
+        rows.append(&row);
+    }
+    std::sort(rows.begin(), rows.end(), [](const Row_t* row1, const Row_t* row2) { return row1->byteRate > row2->byteRate; });
+
+    QVariantList topByteRate;
+    for (int i=0; i<qMin(count, rows.count()); i++) {
+        topByteRate.append(_rowMap(*rows[i]));
+    }
+
+    return topByteRate;
+}
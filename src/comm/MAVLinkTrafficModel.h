@@ -0,0 +1,96 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QAbstractListModel>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QTimer>
+#include <QVariantList>
+#include <QVariantMap>
+
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkTrafficModelLog)
+
+class LinkInterface;
+class LinkManager;
+
+/// Received traffic of every link by sysid/compid/msgid stream, one row per stream. The rows are refreshed from each
+/// link's MAVLinkTrafficStats at a fixed cadence, which is also what the rates are calculated over. Shows which
+/// stream is using up the bandwidth of a link.
+class MAVLinkTrafficModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    MAVLinkTrafficModel(LinkManager* linkManager);
+
+    Q_PROPERTY(int updateIntervalMSecs READ updateIntervalMSecs CONSTANT)
+
+    int updateIntervalMSecs(void) const { return _updateIntervalMSecs; }
+
+    /// @return One map per stream with the same keys as the role names
+    Q_INVOKABLE QVariantList snapshot(void) const;
+
+    /// @return The count streams using the most bandwidth right now, highest first
+    Q_INVOKABLE QVariantList topByteRate(int count) const;
+
+    /// Refreshes the rows now instead of waiting for the next update
+    Q_INVOKABLE void update(void);
+
+    // Overrides from QAbstractListModel
+    int                     rowCount    (const QModelIndex& parent = QModelIndex()) const override;
+    QVariant                data        (const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray>  roleNames   (void) const override;
+
+private:
+    typedef struct {
+        const LinkInterface*    link;               ///< Only compared, never dereferenced
+        QString                 linkName;
+        uint8_t                 sysid;
+        uint8_t                 compid;
+        uint32_t                msgid;
+        QString                 messageName;
+        quint64                 messageCount;
+        quint64                 byteCount;
+        double                  messageRate;        ///< Messages per second over the last update interval
+        double                  byteRate;           ///< Bytes per second over the last update interval
+        double                  meanIntervalMSecs;
+        double                  jitterMSecs;
+    } Row_t;
+
+    enum {
+        LinkNameRole = Qt::UserRole + 1,
+        SysidRole,
+        CompidRole,
+        MsgidRole,
+        MessageNameRole,
+        MessageCountRole,
+        ByteCountRole,
+        MessageRateRole,
+        ByteRateRole,
+        MeanIntervalRole,
+        JitterRole,
+    };
+
+    QVariant    _rowData    (const Row_t& row, int role) const;
+    QVariantMap _rowMap     (const Row_t& row) const;
+
+    static quint64 _streamKey(uint8_t sysid, uint8_t compid, uint32_t msgid);
+
+    LinkManager*    _linkManager;
+    QList<Row_t>    _rows;
+    QHash<const LinkInterface*, QHash<quint64, int>> _rowIndices;   ///< Row index by link and stream
+    QTimer          _updateTimer;
+    QElapsedTimer   _sinceUpdate;
+
+    static const int _updateIntervalMSecs = 1000;
+};
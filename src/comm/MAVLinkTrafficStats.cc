@@ -0,0 +1,84 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkTrafficStats.h"
+
+#include <QtGlobal>
+
+MAVLinkTrafficStats::MAVLinkTrafficStats(void)
+{
+    _clock.start();
+}
+
+MAVLinkTrafficStats::~MAVLinkTrafficStats()
+{
+    Entry_t* entry = _head.loadAcquire();
+    while (entry) {
+        Entry_t* next = entry->next;
+        delete entry;
+        entry = next;
+    }
+}
+
+void MAVLinkTrafficStats::record(const mavlink_message_t& message, int frameLength)
+{
+    const quint64   key         = (static_cast<quint64>(message.sysid) << 32) | (static_cast<quint64>(message.compid) << 24) | message.msgid;
+    const qint64    nowUSecs    = _clock.nsecsElapsed() / 1000;
+
+    Entry_t*& entry = _entries[key];
+    if (!entry) {
+        entry = new Entry_t;
+        entry->sysid    = message.sysid;
+        entry->compid   = message.compid;
+        entry->msgid    = message.msgid;
+        entry->next     = _head.loadRelaxed();
+        entry->lastArrivalUSecs.storeRelaxed(nowUSecs);
+        // Counters are complete before the entry becomes visible to readers
+        _head.storeRelease(entry);
+    } else {
+        // Smoothed the same way as RTP interarrival jitter
+        const qint64 intervalUSecs  = nowUSecs - entry->lastArrivalUSecs.loadRelaxed();
+        qint64       meanUSecs      = entry->meanIntervalUSecs.loadRelaxed();
+        qint64       jitterUSecs    = entry->jitterUSecs.loadRelaxed();
+
+        if (entry->messageCount.loadRelaxed() == 1) {
+            meanUSecs = intervalUSecs;
+        } else {
+            jitterUSecs += (qAbs(intervalUSecs - meanUSecs) - jitterUSecs) / _smoothingFactor;
+            meanUSecs   += (intervalUSecs - meanUSecs) / _smoothingFactor;
+        }
+        entry->meanIntervalUSecs.storeRelaxed(meanUSecs);
+        entry->jitterUSecs.storeRelaxed(jitterUSecs);
+        entry->lastArrivalUSecs.storeRelaxed(nowUSecs);
+    }
+
+    entry->messageCount.storeRelaxed(entry->messageCount.loadRelaxed() + 1);
+    entry->byteCount.storeRelaxed(entry->byteCount.loadRelaxed() + static_cast<quint64>(frameLength));
+}
+
+QList<MAVLinkTrafficStats::Stream_t> MAVLinkTrafficStats::streams(void) const
+{
+    QList<Stream_t> streams;
+
+    for (const Entry_t* entry = _head.loadAcquire(); entry; entry = entry->next) {
+        Stream_t stream;
+
+        stream.sysid                = entry->sysid;
+        stream.compid               = entry->compid;
+        stream.msgid                = entry->msgid;
+        stream.messageCount         = entry->messageCount.loadRelaxed();
+        stream.byteCount            = entry->byteCount.loadRelaxed();
+        stream.lastArrivalMSecs     = entry->lastArrivalUSecs.loadRelaxed() / 1000;
+        stream.meanIntervalMSecs    = entry->meanIntervalUSecs.loadRelaxed() / 1000.0;
+        stream.jitterMSecs          = entry->jitterUSecs.loadRelaxed() / 1000.0;
+        streams.append(stream);
+    }
+
+    return streams;
+}
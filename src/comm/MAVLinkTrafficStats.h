@@ -0,0 +1,66 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+
+#include "QGCMAVLink.h"
+
+/// Counters for the messages received on one link, by sysid/compid/msgid stream. Frames are recorded by the thread
+/// which frames the link input, which the link already serializes, so there is only ever one writer. Readers on any
+/// thread walk a list of streams which only ever grows and read the counters atomically. Neither side takes a lock.
+class MAVLinkTrafficStats
+{
+public:
+    typedef struct {
+        uint8_t     sysid;
+        uint8_t     compid;
+        uint32_t    msgid;
+        quint64     messageCount;
+        quint64     byteCount;              ///< Wire bytes, including framing
+        qint64      lastArrivalMSecs;       ///< On the clock of elapsedMSecs
+        double      meanIntervalMSecs;      ///< Smoothed time between messages, 0 until two have arrived
+        double      jitterMSecs;            ///< Smoothed deviation of the time between messages from the mean
+    } Stream_t;
+
+    MAVLinkTrafficStats(void);
+    ~MAVLinkTrafficStats();
+
+    /// Records a received frame. Only one thread may record at a time.
+    void record(const mavlink_message_t& message, int frameLength);
+
+    /// @return Current counters of every stream seen so far, may be called from any thread
+    QList<Stream_t> streams(void) const;
+
+    qint64 elapsedMSecs(void) const { return _clock.elapsed(); }
+
+private:
+    typedef struct Entry_t {
+        uint8_t                 sysid;
+        uint8_t                 compid;
+        uint32_t                msgid;
+        QAtomicInteger<quint64> messageCount;
+        QAtomicInteger<quint64> byteCount;
+        QAtomicInteger<qint64>  lastArrivalUSecs;
+        QAtomicInteger<qint64>  meanIntervalUSecs;
+        QAtomicInteger<qint64>  jitterUSecs;
+        struct Entry_t*         next;           ///< Never changes once the entry is published
+    } Entry_t;
+
+    QHash<quint64, Entry_t*>    _entries;       ///< Only used by the recording thread
+    QAtomicPointer<Entry_t>     _head;          ///< Published entries, newest first
+    QElapsedTimer               _clock;
+
+    static const int _smoothingFactor = 16;     ///< Interval mean and jitter move 1/16th towards each new sample
+};
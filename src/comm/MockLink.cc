@@ -11,6 +11,7 @@
 #include "QGCLoggingCategory.h"
 #include "QGCApplication.h"
 #include "LinkManager.h"
+#include "MAVLinkTimesync.h"
 
 #ifdef UNITTEST_BUILD
 #include "UnitTest.h"
@@ -19,6 +20,7 @@
 #include <QDebug>
 #include <QFile>
 #include <QMutexLocker>
+#include <QRandomGenerator>
 #include <QTimer>
 
 #include <string.h>
@@ -48,6 +50,12 @@ const char* MockConfiguration::_vehicleTypeKey          = "VehicleType";
 const char* MockConfiguration::_sendStatusTextKey       = "SendStatusText";
 const char* MockConfiguration::_incrementVehicleIdKey   = "IncrementVehicleId";
 const char* MockConfiguration::_failureModeKey          = "FailureMode";
+const char* MockConfiguration::_remoteIDTransponderKey  = "RemoteIDTransponder";
+const char* MockConfiguration::_loadVehicleCountKey     = "LoadVehicleCount";
+const char* MockConfiguration::_loadJitterPercentKey    = "LoadJitterPercent";
+const char* MockConfiguration::_loadLossPercentKey      = "LoadLossPercent";
+const char* MockConfiguration::_loadFirstSystemIdKey    = "LoadFirstSystemId";
+const char* MockConfiguration::_loadRateProfileKey      = "LoadRateProfile";
 
 constexpr MAV_CMD MockLink::MAV_CMD_MOCKLINK_ALWAYS_RESULT_ACCEPTED;
 constexpr MAV_CMD MockLink::MAV_CMD_MOCKLINK_ALWAYS_RESULT_FAILED;
@@ -86,15 +94,16 @@ MockLink::MockLink(SharedLinkConfigurationPtr& config)
     qCDebug(MockLinkLog) << "MockLink" << this;
 
     MockConfiguration* mockConfig = qobject_cast<MockConfiguration*>(_config.get());
-    _firmwareType       = mockConfig->firmwareType();
-    _vehicleType        = mockConfig->vehicleType();
-    _sendStatusText     = mockConfig->sendStatusText();
-    _failureMode        = mockConfig->failureMode();
-    _vehicleSystemId    = mockConfig->incrementVehicleId() ?  _nextVehicleSystemId++ : _nextVehicleSystemId;
-    _vehicleLatitude    = _defaultVehicleLatitude + ((_vehicleSystemId - 128) * 0.0001);
-    _vehicleLongitude   = _defaultVehicleLongitude + ((_vehicleSystemId - 128) * 0.0001);
-    _boardVendorId      = mockConfig->boardVendorId();
-    _boardProductId     = mockConfig->boardProductId();
+    _firmwareType           = mockConfig->firmwareType();
+    _vehicleType            = mockConfig->vehicleType();
+    _sendStatusText         = mockConfig->sendStatusText();
+    _failureMode            = mockConfig->failureMode();
+    _vehicleSystemId        = mockConfig->incrementVehicleId() ?  _nextVehicleSystemId++ : _nextVehicleSystemId;
+    _vehicleLatitude        = _defaultVehicleLatitude + ((_vehicleSystemId - 128) * 0.0001);
+    _vehicleLongitude       = _defaultVehicleLongitude + ((_vehicleSystemId - 128) * 0.0001);
+    _boardVendorId          = mockConfig->boardVendorId();
+    _boardProductId         = mockConfig->boardProductId();
+    _remoteIDTransponder    = mockConfig->remoteIDTransponder();
 
     QObject::connect(this, &MockLink::writeBytesQueuedSignal, this, &MockLink::_writeBytesQueued, Qt::QueuedConnection);
 
@@ -117,6 +126,7 @@ MockLink::MockLink(SharedLinkConfigurationPtr& config)
 MockLink::~MockLink(void)
 {
     disconnect();
+    delete _loadGenerator;
     if (!_logDownloadFilename.isEmpty()) {
         QFile::remove(_logDownloadFilename);
     }
@@ -132,6 +142,19 @@ bool MockLink::_connect(void)
         mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
         mavlink_status_t* auxStatus = mavlink_get_channel_status(mavlinkAuxChannel());
         auxStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        MockConfiguration* mockConfig = qobject_cast<MockConfiguration*>(_config.get());
+        if (mockConfig->loadVehicleCount() > 0 && !_loadGenerator) {
+            // Seeded by system id so each link of a load test sends different, but repeatable, traffic
+            _loadGenerator = new MockLinkLoadGenerator(mavlinkChannel(),
+                                                       _firmwareType,
+                                                       _vehicleType,
+                                                       mockConfig->loadFirstSystemId(),
+                                                       mockConfig->loadVehicleCount(),
+                                                       mockConfig->loadRateProfile(),
+                                                       mockConfig->loadJitterPercent(),
+                                                       mockConfig->loadLossPercent(),
+                                                       mockConfig->loadFirstSystemId());
+        }
         start();
         emit connected();
     }
@@ -224,7 +247,15 @@ void MockLink::run(void)
 
 void MockLink::_run1HzTasks(void)
 {
+    if (_loadGenerator) {
+        return;
+    }
+
     if (_mavlinkStarted && _connected) {
+        if (_remoteIDTransponder) {
+            _sendRemoteIDHeartBeat();
+            _sendRemoteIDArmStatus();
+        }
         if (linkConfiguration()->isHighLatency() && _highLatencyTransmissionEnabled) {
             _sendHighLatency2();
         } else {
@@ -252,7 +283,7 @@ void MockLink::_run1HzTasks(void)
 
 void MockLink::_run10HzTasks(void)
 {
-    if (linkConfiguration()->isHighLatency()) {
+    if (linkConfiguration()->isHighLatency() || _loadGenerator) {
         return;
     }
 
@@ -273,6 +304,11 @@ void MockLink::_run500HzTasks(void)
         return;
     }
 
+    if (_loadGenerator) {
+        _runLoadGenerator();
+        return;
+    }
+
     if (_mavlinkStarted && _connected) {
         _paramRequestListWorker();
         _logDownloadWorker();
@@ -546,6 +582,34 @@ void MockLink::respondWithMavlinkMessage(const mavlink_message_t& msg)
     }
 }
 
+void MockLink::_respondWithMavlinkMessages(const QVector<mavlink_message_t>& messages)
+{
+    if (_commLost || messages.isEmpty()) {
+        return;
+    }
+
+    // All of the messages arrive at once, like a chunk read from a busy link
+    QByteArray bytes;
+    bytes.reserve(messages.count() * MAVLINK_MAX_PACKET_LEN);
+    for (const mavlink_message_t& message : messages) {
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const int cBuffer = mavlink_msg_to_send_buffer(buffer, &message);
+        bytes.append(reinterpret_cast<const char*>(buffer), cBuffer);
+    }
+    emit bytesReceived(this, bytes);
+}
+
+void MockLink::_runLoadGenerator(void)
+{
+    if (!_mavlinkStarted || !_connected) {
+        return;
+    }
+
+    QVector<mavlink_message_t> messages;
+    _loadGenerator->run(_runningTime.elapsed(), messages);
+    _respondWithMavlinkMessages(messages);
+}
+
 /// @brief Called when QGC wants to write bytes to the MAV
 void MockLink::_writeBytes(const QByteArray bytes)
 {
@@ -614,6 +678,13 @@ void MockLink::_handleIncomingMavlinkBytes(const uint8_t* bytes, int cBytes)
 
 void MockLink::_handleIncomingMavlinkMsg(const mavlink_message_t &msg)
 {
+    if (_loadGenerator) {
+        QVector<mavlink_message_t> responses;
+        _loadGenerator->handleMessage(msg, responses);
+        _respondWithMavlinkMessages(responses);
+        return;
+    }
+
     if (_missionItemHandler.handleMessage(msg)) {
         return;
     }
@@ -652,6 +723,17 @@ void MockLink::_handleIncomingMavlinkMsg(const mavlink_message_t &msg)
     case MAVLINK_MSG_ID_PARAM_MAP_RC:
         _handleParamMapRC(msg);
         break;
+    case MAVLINK_MSG_ID_TIMESYNC:
+        _handleTimesync(msg);
+        break;
+    case MAVLINK_MSG_ID_OPEN_DRONE_ID_BASIC_ID:
+    case MAVLINK_MSG_ID_OPEN_DRONE_ID_SELF_ID:
+    case MAVLINK_MSG_ID_OPEN_DRONE_ID_OPERATOR_ID:
+    case MAVLINK_MSG_ID_OPEN_DRONE_ID_SYSTEM:
+    case MAVLINK_MSG_ID_OPEN_DRONE_ID_SYSTEM_UPDATE:
+    case MAVLINK_MSG_ID_OPEN_DRONE_ID_MESSAGE_PACK:
+        _handleRemoteIDMessage(msg);
+        break;
     default:
         break;
     }
@@ -698,6 +780,18 @@ void MockLink::_handleManualControl(const mavlink_message_t& msg)
     qCDebug(MockLinkLog) << "MANUAL_CONTROL" << manualControl.x << manualControl.y << manualControl.z << manualControl.r;
 }
 
+void MockLink::_handleTimesync(const mavlink_message_t& msg)
+{
+    mavlink_timesync_t timesync;
+    mavlink_msg_timesync_decode(&msg, &timesync);
+
+    if (timesync.tc1 == 0) {
+        respondWithMavlinkMessage(MAVLinkTimesync::replyMessage(_vehicleSystemId, _vehicleComponentId, mavlinkChannel(), timesync, MAVLinkTimesync::nowNSecs()));
+    } else {
+        _timesyncReplyCount++;
+    }
+}
+
 void MockLink::_setParamFloatUnionIntoMap(int componentId, const QString& paramName, float paramFloat)
 {
     mavlink_param_union_t   valueUnion;
@@ -1059,6 +1153,11 @@ void MockLink::_handleCommandLong(const mavlink_message_t& msg)
 
     mavlink_msg_command_long_decode(&msg, &request);
 
+    if (_remoteIDTransponder && request.target_component == _remoteIDComponentId) {
+        _handleRemoteIDCommand(request);
+        return;
+    }
+
     _sendMavCommandCountMap[static_cast<MAV_CMD>(request.command)]++;
 
     switch (request.command) {
@@ -1358,11 +1457,17 @@ MockConfiguration::MockConfiguration(const QString& name)
 MockConfiguration::MockConfiguration(MockConfiguration* source)
     : LinkConfiguration(source)
 {
-    _firmwareType       = source->_firmwareType;
-    _vehicleType        = source->_vehicleType;
-    _sendStatusText     = source->_sendStatusText;
-    _incrementVehicleId = source->_incrementVehicleId;
-    _failureMode        = source->_failureMode;
+    _firmwareType           = source->_firmwareType;
+    _vehicleType            = source->_vehicleType;
+    _sendStatusText         = source->_sendStatusText;
+    _incrementVehicleId     = source->_incrementVehicleId;
+    _failureMode            = source->_failureMode;
+    _remoteIDTransponder    = source->_remoteIDTransponder;
+    _loadVehicleCount       = source->_loadVehicleCount;
+    _loadJitterPercent      = source->_loadJitterPercent;
+    _loadLossPercent        = source->_loadLossPercent;
+    _loadFirstSystemId      = source->_loadFirstSystemId;
+    _loadRateProfile        = source->_loadRateProfile;
 }
 
 void MockConfiguration::copyFrom(LinkConfiguration *source)
@@ -1375,11 +1480,17 @@ void MockConfiguration::copyFrom(LinkConfiguration *source)
         return;
     }
 
-    _firmwareType       = usource->_firmwareType;
-    _vehicleType        = usource->_vehicleType;
-    _sendStatusText     = usource->_sendStatusText;
-    _incrementVehicleId = usource->_incrementVehicleId;
-    _failureMode        = usource->_failureMode;
+    _firmwareType           = usource->_firmwareType;
+    _vehicleType            = usource->_vehicleType;
+    _sendStatusText         = usource->_sendStatusText;
+    _incrementVehicleId     = usource->_incrementVehicleId;
+    _failureMode            = usource->_failureMode;
+    _remoteIDTransponder    = usource->_remoteIDTransponder;
+    _loadVehicleCount       = usource->_loadVehicleCount;
+    _loadJitterPercent      = usource->_loadJitterPercent;
+    _loadLossPercent        = usource->_loadLossPercent;
+    _loadFirstSystemId      = usource->_loadFirstSystemId;
+    _loadRateProfile        = usource->_loadRateProfile;
 }
 
 void MockConfiguration::saveSettings(QSettings& settings, const QString& root)
@@ -1390,6 +1501,12 @@ void MockConfiguration::saveSettings(QSettings& settings, const QString& root)
     settings.setValue(_sendStatusTextKey,       _sendStatusText);
     settings.setValue(_incrementVehicleIdKey,   _incrementVehicleId);
     settings.setValue(_failureModeKey,          (int)_failureMode);
+    settings.setValue(_remoteIDTransponderKey,  _remoteIDTransponder);
+    settings.setValue(_loadVehicleCountKey,     _loadVehicleCount);
+    settings.setValue(_loadJitterPercentKey,    _loadJitterPercent);
+    settings.setValue(_loadLossPercentKey,      _loadLossPercent);
+    settings.setValue(_loadFirstSystemIdKey,    _loadFirstSystemId);
+    settings.setValue(_loadRateProfileKey,      MockLinkLoadGenerator::rateProfileToString(_loadRateProfile));
     settings.sync();
     settings.endGroup();
 }
@@ -1397,11 +1514,17 @@ void MockConfiguration::saveSettings(QSettings& settings, const QString& root)
 void MockConfiguration::loadSettings(QSettings& settings, const QString& root)
 {
     settings.beginGroup(root);
-    _firmwareType       = (MAV_AUTOPILOT)settings.value(_firmwareTypeKey, (int)MAV_AUTOPILOT_PX4).toInt();
-    _vehicleType        = (MAV_TYPE)settings.value(_vehicleTypeKey, (int)MAV_TYPE_QUADROTOR).toInt();
-    _sendStatusText     = settings.value(_sendStatusTextKey, false).toBool();
-    _incrementVehicleId = settings.value(_incrementVehicleIdKey, true).toBool();
-    _failureMode        = (FailureMode_t)settings.value(_failureModeKey, (int)FailNone).toInt();
+    _firmwareType           = (MAV_AUTOPILOT)settings.value(_firmwareTypeKey, (int)MAV_AUTOPILOT_PX4).toInt();
+    _vehicleType            = (MAV_TYPE)settings.value(_vehicleTypeKey, (int)MAV_TYPE_QUADROTOR).toInt();
+    _sendStatusText         = settings.value(_sendStatusTextKey, false).toBool();
+    _incrementVehicleId     = settings.value(_incrementVehicleIdKey, true).toBool();
+    _failureMode            = (FailureMode_t)settings.value(_failureModeKey, (int)FailNone).toInt();
+    _remoteIDTransponder    = settings.value(_remoteIDTransponderKey, false).toBool();
+    _loadVehicleCount       = settings.value(_loadVehicleCountKey, 0).toInt();
+    _loadJitterPercent      = settings.value(_loadJitterPercentKey, 0).toInt();
+    _loadLossPercent        = settings.value(_loadLossPercentKey, 0).toInt();
+    _loadFirstSystemId      = static_cast<uint8_t>(qBound(1, settings.value(_loadFirstSystemIdKey, 1).toInt(), 254));
+    _loadRateProfile        = MockLinkLoadGenerator::rateProfileFromString(settings.value(_loadRateProfileKey, MockLinkLoadGenerator::rateProfileToString(MockLinkLoadGenerator::defaultRateProfile())).toString());
     settings.endGroup();
 }
 
@@ -1431,6 +1554,43 @@ MockLink* MockLink::_startMockLinkWorker(QString configName, MAV_AUTOPILOT firmw
     return _startMockLink(mockConfig);
 }
 
+QList<MockLink*> MockLink::startLoadMockLinks(int vehicleCount, int linkCount, int jitterPercent, int lossPercent, const MockLinkLoadGenerator::RateProfile_t& rateProfile)
+{
+    QList<MockLink*> mockLinks;
+
+    vehicleCount    = qBound(0, vehicleCount, static_cast<int>(MockLinkLoadGenerator::maxVehicleCount));
+    linkCount       = qBound(1, linkCount, qMax(vehicleCount, 1));
+
+    int firstSystemId = 1;
+    for (int i=0; i<linkCount; i++) {
+        const int linkVehicleCount = (vehicleCount / linkCount) + (i < vehicleCount % linkCount ? 1 : 0);
+        if (linkVehicleCount == 0) {
+            break;
+        }
+
+        MockConfiguration* mockConfig = new MockConfiguration(QStringLiteral("Load MockLink %1").arg(i + 1));
+        // The generic firmware plugin keeps the per vehicle setup traffic to a minimum
+        mockConfig->setFirmwareType(MAV_AUTOPILOT_GENERIC);
+        mockConfig->setVehicleType(MAV_TYPE_QUADROTOR);
+        mockConfig->setIncrementVehicleId(false);
+        mockConfig->setLoadVehicleCount(linkVehicleCount);
+        mockConfig->setLoadFirstSystemId(static_cast<uint8_t>(firstSystemId));
+        mockConfig->setLoadJitterPercent(jitterPercent);
+        mockConfig->setLoadLossPercent(lossPercent);
+        mockConfig->setLoadRateProfile(rateProfile);
+        firstSystemId += linkVehicleCount;
+
+        MockLink* mockLink = _startMockLink(mockConfig);
+        if (mockLink) {
+            mockLinks.append(mockLink);
+        }
+    }
+
+    qCDebug(MockLinkLog) << "Load test started, vehicles" << vehicleCount << "links" << mockLinks.count();
+
+    return mockLinks;
+}
+
 MockLink*  MockLink::startPX4MockLink(bool sendStatusText, MockConfiguration::FailureMode_t failureMode)
 {
     return _startMockLinkWorker("PX4 MultiRotor MockLink", MAV_AUTOPILOT_PX4, MAV_TYPE_QUADROTOR, sendStatusText, failureMode);
@@ -1738,3 +1898,137 @@ void MockLink::simulateConnectionRemoved(void)
     _commLost = true;
     _connectionRemoved();
 }
+
+void MockLink::setRemoteIDTransponder(bool enabled, uint8_t componentId)
+{
+    if (componentId < MAV_COMP_ID_ODID_TXRX_1 || componentId > MAV_COMP_ID_ODID_TXRX_3) {
+        qCWarning(MockLinkLog) << "setRemoteIDTransponder: invalid ODID component id" << componentId;
+        return;
+    }
+    _remoteIDComponentId    = componentId;
+    _remoteIDTransponder    = enabled;
+}
+
+void MockLink::setRemoteIDArmStatus(bool goodToArm, const QString& error)
+{
+    QMutexLocker lock(&_remoteIDMutex);
+    _remoteIDGoodToArm  = goodToArm;
+    _remoteIDArmError   = error;
+}
+
+QList<MockLink::RemoteIDReceivedMessage_t> MockLink::remoteIDReceivedMessages(void)
+{
+    QMutexLocker lock(&_remoteIDMutex);
+    return _remoteIDReceivedMessages;
+}
+
+int MockLink::remoteIDReceivedMessageCount(uint32_t msgId)
+{
+    QMutexLocker lock(&_remoteIDMutex);
+
+    int count = 0;
+    for (const RemoteIDReceivedMessage_t& received : _remoteIDReceivedMessages) {
+        if (received.message.msgid == msgId) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void MockLink::clearRemoteIDReceivedMessages(void)
+{
+    QMutexLocker lock(&_remoteIDMutex);
+    _remoteIDReceivedMessages.clear();
+}
+
+bool MockLink::_remoteIDPacketLost(void)
+{
+    const int lossPercent = _remoteIDPacketLossPercent;
+    return lossPercent > 0 && static_cast<int>(QRandomGenerator::global()->bounded(100)) < lossPercent;
+}
+
+void MockLink::_sendRemoteIDHeartBeat(void)
+{
+    if (_remoteIDHeartbeatDropout || _remoteIDPacketLost()) {
+        return;
+    }
+
+    mavlink_message_t msg;
+    mavlink_msg_heartbeat_pack_chan(_vehicleSystemId,
+                                    _remoteIDComponentId,
+                                    mavlinkChannel(),
+                                    &msg,
+                                    MAV_TYPE_ODID,
+                                    MAV_AUTOPILOT_INVALID,
+                                    0,                      // MAV_MODE
+                                    0,                      // custom mode
+                                    MAV_STATE_ACTIVE);
+    respondWithMavlinkMessage(msg);
+}
+
+void MockLink::_sendRemoteIDArmStatus(void)
+{
+    if (_remoteIDPacketLost()) {
+        return;
+    }
+
+    mavlink_open_drone_id_arm_status_t armStatus;
+    memset(&armStatus, 0, sizeof(armStatus));
+    {
+        QMutexLocker lock(&_remoteIDMutex);
+        armStatus.status = _remoteIDGoodToArm ? MAV_ODID_ARM_STATUS_GOOD_TO_ARM : MAV_ODID_ARM_STATUS_PRE_ARM_FAIL_GENERIC;
+        strncpy(armStatus.error, _remoteIDArmError.toLocal8Bit().constData(), sizeof(armStatus.error) - 1);
+    }
+
+    mavlink_message_t msg;
+    mavlink_msg_open_drone_id_arm_status_encode_chan(_vehicleSystemId,
+                                                     _remoteIDComponentId,
+                                                     mavlinkChannel(),
+                                                     &msg,
+                                                     &armStatus);
+    respondWithMavlinkMessage(msg);
+}
+
+void MockLink::_handleRemoteIDCommand(const mavlink_command_long_t& request)
+{
+    if (_remoteIDPacketLost()) {
+        return;
+    }
+
+    // The transponder only knows how to tell QGC whether it takes message packs
+    uint8_t commandResult = MAV_RESULT_UNSUPPORTED;
+    if (request.command == MAV_CMD_REQUEST_MESSAGE && static_cast<int>(request.param1) == MAVLINK_MSG_ID_OPEN_DRONE_ID_MESSAGE_PACK && _remoteIDMessagePackSupport) {
+        commandResult = MAV_RESULT_ACCEPTED;
+    }
+
+    mavlink_message_t commandAck;
+    mavlink_msg_command_ack_pack_chan(_vehicleSystemId,
+                                      _remoteIDComponentId,
+                                      mavlinkChannel(),
+                                      &commandAck,
+                                      request.command,
+                                      commandResult,
+                                      0,    // progress
+                                      0,    // result_param2
+                                      0,    // target_system
+                                      0);   // target_component
+    respondWithMavlinkMessage(commandAck);
+}
+
+void MockLink::_handleRemoteIDMessage(const mavlink_message_t& msg)
+{
+    if (!_remoteIDTransponder || _remoteIDPacketLost()) {
+        return;
+    }
+
+    RemoteIDReceivedMessage_t received;
+    received.receivedNSecs  = _runningTime.nsecsElapsed();
+    received.message        = msg;
+    {
+        QMutexLocker lock(&_remoteIDMutex);
+        _remoteIDReceivedMessages.append(received);
+    }
+    qCDebug(MockLinkVerboseLog) << "RemoteID message received" << msg.msgid;
+
+    emit remoteIDMessageReceived(msg.msgid, received.receivedNSecs);
+}
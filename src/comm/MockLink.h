@@ -14,9 +14,13 @@
 #include <QLoggingCategory>
 #include <QMap>
 #include <QMutex>
+#include <QList>
+
+#include <atomic>
 
 #include "MockLinkMissionItemHandler.h"
 #include "MockLinkFTP.h"
+#include "MockLinkLoadGenerator.h"
 #include "QGCMAVLink.h"
 
 Q_DECLARE_LOGGING_CATEGORY(MockLinkLog)
@@ -36,6 +40,10 @@ public:
     Q_PROPERTY(int      vehicle             READ vehicle            WRITE setVehicle            NOTIFY vehicleChanged)
     Q_PROPERTY(bool     sendStatus          READ sendStatusText     WRITE setSendStatusText     NOTIFY sendStatusChanged)
     Q_PROPERTY(bool     incrementVehicleId  READ incrementVehicleId WRITE setIncrementVehicleId NOTIFY incrementVehicleIdChanged)
+    Q_PROPERTY(bool     remoteIDTransponder READ remoteIDTransponder WRITE setRemoteIDTransponder NOTIFY remoteIDTransponderChanged)
+    Q_PROPERTY(int      loadVehicleCount    READ loadVehicleCount   WRITE setLoadVehicleCount   NOTIFY loadVehicleCountChanged)
+    Q_PROPERTY(int      loadJitterPercent   READ loadJitterPercent  WRITE setLoadJitterPercent  NOTIFY loadJitterPercentChanged)
+    Q_PROPERTY(int      loadLossPercent     READ loadLossPercent    WRITE setLoadLossPercent    NOTIFY loadLossPercentChanged)
 
     int     firmware                (void)                      { return (int)_firmwareType; }
     void    setFirmware             (int type)                  { _firmwareType = (MAV_AUTOPILOT)type; emit firmwareChanged(); }
@@ -43,6 +51,22 @@ public:
     bool    incrementVehicleId      (void) const                     { return _incrementVehicleId; }
     void    setVehicle              (int type)                  { _vehicleType = (MAV_TYPE)type; emit vehicleChanged(); }
     void    setIncrementVehicleId   (bool incrementVehicleId)   { _incrementVehicleId = incrementVehicleId; emit incrementVehicleIdChanged(); }
+    bool    remoteIDTransponder     (void) const                { return _remoteIDTransponder; }
+    void    setRemoteIDTransponder  (bool remoteIDTransponder)  { _remoteIDTransponder = remoteIDTransponder; emit remoteIDTransponderChanged(); }
+
+    /// Load generator mode: with a vehicle count above 0 the link simulates that many lightweight vehicles, see
+    /// MockLinkLoadGenerator, instead of a single full vehicle.
+    int     loadVehicleCount        (void) const                { return _loadVehicleCount; }
+    void    setLoadVehicleCount     (int loadVehicleCount)      { _loadVehicleCount = qBound(0, loadVehicleCount, static_cast<int>(MockLinkLoadGenerator::maxVehicleCount)); emit loadVehicleCountChanged(); }
+    int     loadJitterPercent       (void) const                { return _loadJitterPercent; }
+    void    setLoadJitterPercent    (int loadJitterPercent)     { _loadJitterPercent = qBound(0, loadJitterPercent, 100); emit loadJitterPercentChanged(); }
+    int     loadLossPercent         (void) const                { return _loadLossPercent; }
+    void    setLoadLossPercent      (int loadLossPercent)       { _loadLossPercent = qBound(0, loadLossPercent, 100); emit loadLossPercentChanged(); }
+    uint8_t loadFirstSystemId       (void) const                { return _loadFirstSystemId; }
+    void    setLoadFirstSystemId    (uint8_t loadFirstSystemId) { _loadFirstSystemId = qMax(loadFirstSystemId, static_cast<uint8_t>(1)); }
+
+    const MockLinkLoadGenerator::RateProfile_t& loadRateProfile(void) const { return _loadRateProfile; }
+    void setLoadRateProfile(const MockLinkLoadGenerator::RateProfile_t& loadRateProfile) { _loadRateProfile = loadRateProfile; }
 
 
     MAV_AUTOPILOT   firmwareType        (void)                          { return _firmwareType; }
@@ -82,21 +106,37 @@ signals:
     void vehicleChanged             (void);
     void sendStatusChanged          (void);
     void incrementVehicleIdChanged  (void);
+    void remoteIDTransponderChanged (void);
+    void loadVehicleCountChanged    (void);
+    void loadJitterPercentChanged   (void);
+    void loadLossPercentChanged     (void);
 
 private:
-    MAV_AUTOPILOT   _firmwareType       = MAV_AUTOPILOT_PX4;
-    MAV_TYPE        _vehicleType        = MAV_TYPE_QUADROTOR;
-    bool            _sendStatusText     = false;
-    FailureMode_t   _failureMode        = FailNone;
-    bool            _incrementVehicleId = true;
-    uint16_t        _boardVendorId      = 0;
-    uint16_t        _boardProductId     = 0;
+    MAV_AUTOPILOT   _firmwareType           = MAV_AUTOPILOT_PX4;
+    MAV_TYPE        _vehicleType            = MAV_TYPE_QUADROTOR;
+    bool            _sendStatusText         = false;
+    FailureMode_t   _failureMode            = FailNone;
+    bool            _incrementVehicleId     = true;
+    bool            _remoteIDTransponder    = false;
+    uint16_t        _boardVendorId          = 0;
+    uint16_t        _boardProductId         = 0;
+    int             _loadVehicleCount       = 0;
+    int             _loadJitterPercent      = 0;
+    int             _loadLossPercent        = 0;
+    uint8_t         _loadFirstSystemId      = 1;
+    MockLinkLoadGenerator::RateProfile_t _loadRateProfile = MockLinkLoadGenerator::defaultRateProfile();
 
     static const char* _firmwareTypeKey;
     static const char* _vehicleTypeKey;
     static const char* _sendStatusTextKey;
     static const char* _incrementVehicleIdKey;
     static const char* _failureModeKey;
+    static const char* _remoteIDTransponderKey;
+    static const char* _loadVehicleCountKey;
+    static const char* _loadJitterPercentKey;
+    static const char* _loadLossPercentKey;
+    static const char* _loadFirstSystemIdKey;
+    static const char* _loadRateProfileKey;
 };
 
 class MockLink : public LinkInterface
@@ -162,6 +202,14 @@ public:
     static MockLink* startAPMArduSubMockLink        (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
     static MockLink* startAPMArduRoverMockLink      (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
 
+    /// Starts load generator links which together simulate vehicleCount vehicles, spread evenly over linkCount links.
+    /// System ids are handed out contiguously from 1.
+    static QList<MockLink*> startLoadMockLinks      (int vehicleCount,
+                                                     int linkCount,
+                                                     int jitterPercent = 0,
+                                                     int lossPercent = 0,
+                                                     const MockLinkLoadGenerator::RateProfile_t& rateProfile = MockLinkLoadGenerator::defaultRateProfile());
+
     // Special commands for testing COMMAND_LONG handlers. By default all commands except for MAV_CMD_MOCKLINK_NO_RESPONSE_NO_RETRY should retry.
     static constexpr MAV_CMD MAV_CMD_MOCKLINK_ALWAYS_RESULT_ACCEPTED            = MAV_CMD_USER_1;
     static constexpr MAV_CMD MAV_CMD_MOCKLINK_ALWAYS_RESULT_FAILED              = MAV_CMD_USER_2;
@@ -181,10 +229,37 @@ public:
     } RequestMessageFailureMode_t;
     void setRequestMessageFailureMode(RequestMessageFailureMode_t failureMode) { _requestMessageFailureMode = failureMode; }
 
+    /// Open Drone ID transponder simulation. When enabled MockLink also acts as an ODID transceiver component of the
+    /// vehicle. It sends HEARTBEAT and OPEN_DRONE_ID_ARM_STATUS at 1Hz and records the ODID messages QGC sends to it.
+    typedef struct {
+        qint64              receivedNSecs;  ///< Time of arrival at the transponder, see runningTimeNSecs()
+        mavlink_message_t   message;
+    } RemoteIDReceivedMessage_t;
+
+    void    setRemoteIDTransponder          (bool enabled, uint8_t componentId = MAV_COMP_ID_ODID_TXRX_1);
+    void    setRemoteIDArmStatus            (bool goodToArm, const QString& error = QString());
+    void    setRemoteIDPacketLossPercent    (int percent)   { _remoteIDPacketLossPercent = qBound(0, percent, 100); }   ///< Drops messages in both directions
+    void    setRemoteIDHeartbeatDropout     (bool dropout)  { _remoteIDHeartbeatDropout = dropout; }                    ///< Stops transponder heartbeats only
+    void    setRemoteIDMessagePackSupport   (bool support)  { _remoteIDMessagePackSupport = support; }                  ///< Accepts REQUEST_MESSAGE for OPEN_DRONE_ID_MESSAGE_PACK
+    bool    remoteIDTransponder             (void) const    { return _remoteIDTransponder; }
+
+    QList<RemoteIDReceivedMessage_t>    remoteIDReceivedMessages        (void);
+    int                                 remoteIDReceivedMessageCount    (uint32_t msgId);
+    void                                clearRemoteIDReceivedMessages   (void);
+
+    /// TIMESYNC replies received from the GCS, which only replies to requests from the vehicle
+    int timesyncReplyCount(void) const { return _timesyncReplyCount; }
+
+    /// Monotonic time since the link was created, used to timestamp received ODID messages
+    qint64 runningTimeNSecs(void) const { return _runningTime.nsecsElapsed(); }
+
 signals:
     void writeBytesQueuedSignal                 (const QByteArray bytes);
     void highLatencyTransmissionEnabledChanged  (bool highLatencyTransmissionEnabled);
 
+    /// Signalled from the MockLink thread each time the transponder records an ODID message
+    void remoteIDMessageReceived                (uint32_t msgId, qint64 receivedNSecs);
+
 private slots:
     // LinkInterface overrides
     void _writeBytes(const QByteArray bytes) final;
@@ -224,6 +299,7 @@ private:
     void _handleLogRequestList          (const mavlink_message_t& msg);
     void _handleLogRequestData          (const mavlink_message_t& msg);
     void _handleParamMapRC              (const mavlink_message_t& msg);
+    void _handleTimesync                (const mavlink_message_t& msg);
     bool _handleRequestMessage          (const mavlink_command_long_t& request, bool& noAck);
     float _floatUnionForParam           (int componentId, const QString& paramName);
     void _setParamFloatUnionIntoMap     (int componentId, const QString& paramName, float paramFloat);
@@ -241,6 +317,13 @@ private:
     void _sendADSBVehicles              (void);
     void _moveADSBVehicle               (void);
     void _sendGeneralMetaData           (void);
+    void _sendRemoteIDHeartBeat         (void);
+    void _sendRemoteIDArmStatus         (void);
+    void _handleRemoteIDMessage         (const mavlink_message_t& msg);
+    void _handleRemoteIDCommand         (const mavlink_command_long_t& request);
+    bool _remoteIDPacketLost            (void);
+    void _runLoadGenerator              (void);
+    void _respondWithMavlinkMessages    (const QVector<mavlink_message_t>& messages);
 
     static MockLink* _startMockLinkWorker(QString configName, MAV_AUTOPILOT firmwareType, MAV_TYPE vehicleType, bool sendStatusText, MockConfiguration::FailureMode_t failureMode);
     static MockLink* _startMockLink(MockConfiguration* mockConfig);
@@ -288,6 +371,8 @@ private:
 
     MockLinkFTP* _mockLinkFTP = nullptr;
 
+    MockLinkLoadGenerator*  _loadGenerator = nullptr;   ///< Only set in load generator mode, used on the MockLink thread
+
     bool _sendStatusText;
     bool _apmSendHomePositionOnEmptyList;
     MockConfiguration::FailureMode_t _failureMode;
@@ -310,6 +395,18 @@ private:
 
     RequestMessageFailureMode_t _requestMessageFailureMode = FailRequestMessageNone;
 
+    // Set from the test thread while the MockLink thread is running
+    std::atomic<bool>                   _remoteIDTransponder        { false };
+    std::atomic<uint8_t>                _remoteIDComponentId        { MAV_COMP_ID_ODID_TXRX_1 };
+    std::atomic<int>                    _remoteIDPacketLossPercent  { 0 };
+    std::atomic<bool>                   _remoteIDHeartbeatDropout   { false };
+    std::atomic<bool>                   _remoteIDMessagePackSupport { false };
+    std::atomic<int>                    _timesyncReplyCount         { 0 };
+    bool                                _remoteIDGoodToArm          = true;
+    QString                             _remoteIDArmError;
+    QList<RemoteIDReceivedMessage_t>    _remoteIDReceivedMessages;
+    QMutex                              _remoteIDMutex;             ///< Received messages and arm status are shared with the test thread
+
     QMap<MAV_CMD, int>  _sendMavCommandCountMap;
     QMap<int, QMap<QString, QVariant>>          _mapParamName2Value;
     QMap<int, QMap<QString, MAV_PARAM_TYPE>>    _mapParamName2MavParamType;
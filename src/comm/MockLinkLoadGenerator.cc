@@ -0,0 +1,402 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MockLinkLoadGenerator.h"
+#include "QGCLoggingCategory.h"
+
+#include <QStringList>
+#include <QtMath>
+
+#include <string.h>
+
+QGC_LOGGING_CATEGORY(MockLinkLoadGeneratorLog, "MockLinkLoadGeneratorLog")
+
+// Same area as the single MockLink vehicle
+static const double gridLatitude        = 47.397;
+static const double gridLongitude       = 8.5455;
+static const double gridAltitude        = 488.056;
+static const double gridSpacingDegrees  = 0.001;
+static const double circleRadiusMeters  = 30;
+static const double metersPerDegree     = 111111;
+
+MockLinkLoadGenerator::MockLinkLoadGenerator(uint8_t               channel,
+                                             MAV_AUTOPILOT         firmwareType,
+                                             MAV_TYPE              vehicleType,
+                                             uint8_t               firstSystemId,
+                                             int                   vehicleCount,
+                                             const RateProfile_t&  rateProfile,
+                                             int                   jitterPercent,
+                                             int                   lossPercent,
+                                             quint32               seed)
+    : _channel      (channel)
+    , _firmwareType (firmwareType)
+    , _vehicleType  (vehicleType)
+    , _jitterPercent(qBound(0, jitterPercent, 100))
+    , _lossPercent  (qBound(0, lossPercent, 100))
+    , _random       (seed)
+{
+    vehicleCount = qBound(0, vehicleCount, qMin(static_cast<int>(maxVehicleCount), 255 - firstSystemId));
+
+    for (auto rate = rateProfile.constBegin(); rate != rateProfile.constEnd(); rate++) {
+        if (!messageSupported(rate.key())) {
+            qCWarning(MockLinkLoadGeneratorLog) << "Message not supported, skipped" << rate.key();
+        }
+    }
+
+    for (int i=0; i<vehicleCount; i++) {
+        Vehicle_t vehicle;
+
+        vehicle.systemId    = static_cast<uint8_t>(firstSystemId + i);
+        vehicle.sequence    = 0;
+        vehicle.index       = i;
+
+        for (auto rate = rateProfile.constBegin(); rate != rateProfile.constEnd(); rate++) {
+            if (rate.value() <= 0 || !messageSupported(rate.key())) {
+                continue;
+            }
+            Stream_t stream;
+            stream.msgId            = rate.key();
+            stream.intervalUSecs    = qMax(static_cast<qint64>(1000000.0 / rate.value()), static_cast<qint64>(1));
+            // Spread the vehicles over the interval so they don't all send at once
+            stream.nextUSecs        = stream.intervalUSecs * i / vehicleCount;
+            vehicle.streams.append(stream);
+        }
+
+        _vehicles.append(vehicle);
+    }
+
+    qCDebug(MockLinkLoadGeneratorLog) << "Vehicles" << _vehicles.count() << "first system id" << firstSystemId << "profile" << rateProfileToString(rateProfile);
+}
+
+MockLinkLoadGenerator::RateProfile_t MockLinkLoadGenerator::defaultRateProfile(void)
+{
+    RateProfile_t rateProfile;
+
+    rateProfile[MAVLINK_MSG_ID_HEARTBEAT]           = 1;
+    rateProfile[MAVLINK_MSG_ID_SYS_STATUS]          = 1;
+    rateProfile[MAVLINK_MSG_ID_BATTERY_STATUS]      = 1;
+    rateProfile[MAVLINK_MSG_ID_GPS_RAW_INT]         = 2;
+    rateProfile[MAVLINK_MSG_ID_VFR_HUD]             = 4;
+    rateProfile[MAVLINK_MSG_ID_GLOBAL_POSITION_INT] = 5;
+    rateProfile[MAVLINK_MSG_ID_ATTITUDE]            = 10;
+
+    return rateProfile;
+}
+
+bool MockLinkLoadGenerator::messageSupported(uint32_t msgId)
+{
+    switch (msgId) {
+    case MAVLINK_MSG_ID_HEARTBEAT:
+    case MAVLINK_MSG_ID_SYS_STATUS:
+    case MAVLINK_MSG_ID_BATTERY_STATUS:
+    case MAVLINK_MSG_ID_GPS_RAW_INT:
+    case MAVLINK_MSG_ID_VFR_HUD:
+    case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+    case MAVLINK_MSG_ID_ATTITUDE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+QString MockLinkLoadGenerator::rateProfileToString(const RateProfile_t& rateProfile)
+{
+    QStringList rates;
+
+    for (auto rate = rateProfile.constBegin(); rate != rateProfile.constEnd(); rate++) {
+        rates.append(QStringLiteral("%1:%2").arg(rate.key()).arg(rate.value()));
+    }
+
+    return rates.join(QLatin1Char(','));
+}
+
+MockLinkLoadGenerator::RateProfile_t MockLinkLoadGenerator::rateProfileFromString(const QString& rateProfileString)
+{
+    RateProfile_t rateProfile;
+
+    for (const QString& rate : rateProfileString.split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+        const QStringList   pair        = rate.split(QLatin1Char(':'));
+        bool                msgIdOk     = false;
+        bool                hzOk        = false;
+
+        if (pair.count() == 2) {
+            const uint32_t  msgId   = pair[0].trimmed().toUInt(&msgIdOk);
+            const double    hz      = pair[1].trimmed().toDouble(&hzOk);
+            if (msgIdOk && hzOk) {
+                rateProfile[msgId] = hz;
+                continue;
+            }
+        }
+        qCWarning(MockLinkLoadGeneratorLog) << "Bad rate in profile" << rate;
+    }
+
+    return rateProfile;
+}
+
+void MockLinkLoadGenerator::run(qint64 nowMSecs, QVector<mavlink_message_t>& messages)
+{
+    const qint64 nowUSecs = nowMSecs * 1000;
+
+    for (Vehicle_t& vehicle : _vehicles) {
+        for (Stream_t& stream : vehicle.streams) {
+            if (stream.nextUSecs > nowUSecs) {
+                continue;
+            }
+
+            stream.nextUSecs += _nextIntervalUSecs(stream.intervalUSecs);
+            if (stream.nextUSecs <= nowUSecs) {
+                // Fell behind, which shouldn't turn into a burst once the caller catches up
+                stream.nextUSecs = nowUSecs + stream.intervalUSecs;
+            }
+
+            if (_lost()) {
+                vehicle.sequence++;
+                _lostCount++;
+                continue;
+            }
+            messages.append(_encodeTelemetry(vehicle, stream.msgId, nowMSecs));
+            _sentCount++;
+        }
+    }
+}
+
+bool MockLinkLoadGenerator::_lost(void)
+{
+    return _lossPercent > 0 && static_cast<int>(_random.bounded(100)) < _lossPercent;
+}
+
+qint64 MockLinkLoadGenerator::_nextIntervalUSecs(qint64 intervalUSecs)
+{
+    if (_jitterPercent == 0) {
+        return intervalUSecs;
+    }
+
+    const int maxJitterUSecs = static_cast<int>(intervalUSecs * _jitterPercent / 100);
+    return intervalUSecs + _random.bounded(-maxJitterUSecs, maxJitterUSecs + 1);
+}
+
+void MockLinkLoadGenerator::_prepareEncode(Vehicle_t& vehicle)
+{
+    // Vehicles share the channel, but each one needs its own sequence numbers
+    mavlink_get_channel_status(_channel)->current_tx_seq = vehicle.sequence++;
+}
+
+mavlink_message_t MockLinkLoadGenerator::_encodeTelemetry(Vehicle_t& vehicle, uint32_t msgId, qint64 nowMSecs)
+{
+    mavlink_message_t message;
+
+    const double    angle       = (2 * M_PI * (nowMSecs % _circlePeriodMSecs) / _circlePeriodMSecs) + vehicle.index;
+    const double    headingDeg  = fmod(qRadiansToDegrees(angle) + 90, 360);
+    const double    speed       = 2 * M_PI * circleRadiusMeters / (_circlePeriodMSecs / 1000.0);
+    const double    latitude    = gridLatitude + ((vehicle.index / _vehiclesPerRow) * gridSpacingDegrees) + (circleRadiusMeters * qCos(angle) / metersPerDegree);
+    const double    longitude   = gridLongitude + ((vehicle.index % _vehiclesPerRow) * gridSpacingDegrees) + (circleRadiusMeters * qSin(angle) / (metersPerDegree * qCos(qDegreesToRadians(gridLatitude))));
+    const double    altitude    = gridAltitude + 20;
+    const uint32_t  bootMSecs   = static_cast<uint32_t>(nowMSecs);
+
+    _prepareEncode(vehicle);
+
+    switch (msgId) {
+    case MAVLINK_MSG_ID_HEARTBEAT:
+    {
+        mavlink_heartbeat_t heartbeat;
+        memset(&heartbeat, 0, sizeof(heartbeat));
+        heartbeat.type          = _vehicleType;
+        heartbeat.autopilot     = _firmwareType;
+        heartbeat.base_mode     = MAV_MODE_FLAG_CUSTOM_MODE_ENABLED;
+        heartbeat.system_status = MAV_STATE_STANDBY;
+        mavlink_msg_heartbeat_encode_chan(vehicle.systemId, _componentId, _channel, &message, &heartbeat);
+        break;
+    }
+    case MAVLINK_MSG_ID_SYS_STATUS:
+    {
+        mavlink_sys_status_t sysStatus;
+        memset(&sysStatus, 0, sizeof(sysStatus));
+        sysStatus.voltage_battery   = 16000;
+        sysStatus.current_battery   = -1;
+        sysStatus.battery_remaining = 80;
+        sysStatus.load              = 300;
+        mavlink_msg_sys_status_encode_chan(vehicle.systemId, _componentId, _channel, &message, &sysStatus);
+        break;
+    }
+    case MAVLINK_MSG_ID_BATTERY_STATUS:
+    {
+        mavlink_battery_status_t batteryStatus;
+        memset(&batteryStatus, 0, sizeof(batteryStatus));
+        for (size_t i=0; i<sizeof(batteryStatus.voltages) / sizeof(batteryStatus.voltages[0]); i++) {
+            batteryStatus.voltages[i] = UINT16_MAX;
+        }
+        batteryStatus.voltages[0]       = 16000;
+        batteryStatus.current_battery   = -1;
+        batteryStatus.current_consumed  = -1;
+        batteryStatus.energy_consumed   = -1;
+        batteryStatus.temperature       = INT16_MAX;
+        batteryStatus.battery_remaining = 80;
+        batteryStatus.battery_function  = MAV_BATTERY_FUNCTION_ALL;
+        batteryStatus.type              = MAV_BATTERY_TYPE_LIPO;
+        batteryStatus.charge_state      = MAV_BATTERY_CHARGE_STATE_OK;
+        mavlink_msg_battery_status_encode_chan(vehicle.systemId, _componentId, _channel, &message, &batteryStatus);
+        break;
+    }
+    case MAVLINK_MSG_ID_GPS_RAW_INT:
+    {
+        mavlink_gps_raw_int_t gpsRawInt;
+        memset(&gpsRawInt, 0, sizeof(gpsRawInt));
+        gpsRawInt.time_usec             = static_cast<uint64_t>(nowMSecs) * 1000;
+        gpsRawInt.lat                   = static_cast<int32_t>(latitude * 1E7);
+        gpsRawInt.lon                   = static_cast<int32_t>(longitude * 1E7);
+        gpsRawInt.alt                   = static_cast<int32_t>(altitude * 1000);
+        gpsRawInt.eph                   = 100;
+        gpsRawInt.epv                   = 150;
+        gpsRawInt.vel                   = static_cast<uint16_t>(speed * 100);
+        gpsRawInt.cog                   = static_cast<uint16_t>(headingDeg * 100);
+        gpsRawInt.fix_type              = GPS_FIX_TYPE_3D_FIX;
+        gpsRawInt.satellites_visible    = 12;
+        mavlink_msg_gps_raw_int_encode_chan(vehicle.systemId, _componentId, _channel, &message, &gpsRawInt);
+        break;
+    }
+    case MAVLINK_MSG_ID_VFR_HUD:
+    {
+        mavlink_vfr_hud_t vfrHud;
+        memset(&vfrHud, 0, sizeof(vfrHud));
+        vfrHud.airspeed     = static_cast<float>(speed);
+        vfrHud.groundspeed  = static_cast<float>(speed);
+        vfrHud.heading      = static_cast<int16_t>(headingDeg);
+        vfrHud.throttle     = 50;
+        vfrHud.alt          = static_cast<float>(altitude);
+        mavlink_msg_vfr_hud_encode_chan(vehicle.systemId, _componentId, _channel, &message, &vfrHud);
+        break;
+    }
+    case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+    {
+        mavlink_global_position_int_t globalPositionInt;
+        memset(&globalPositionInt, 0, sizeof(globalPositionInt));
+        globalPositionInt.time_boot_ms  = bootMSecs;
+        globalPositionInt.lat           = static_cast<int32_t>(latitude * 1E7);
+        globalPositionInt.lon           = static_cast<int32_t>(longitude * 1E7);
+        globalPositionInt.alt           = static_cast<int32_t>(altitude * 1000);
+        globalPositionInt.relative_alt  = static_cast<int32_t>((altitude - gridAltitude) * 1000);
+        globalPositionInt.vx            = static_cast<int16_t>(speed * qCos(qDegreesToRadians(headingDeg)) * 100);
+        globalPositionInt.vy            = static_cast<int16_t>(speed * qSin(qDegreesToRadians(headingDeg)) * 100);
+        globalPositionInt.hdg           = static_cast<uint16_t>(headingDeg * 100);
+        mavlink_msg_global_position_int_encode_chan(vehicle.systemId, _componentId, _channel, &message, &globalPositionInt);
+        break;
+    }
+    case MAVLINK_MSG_ID_ATTITUDE:
+    default:
+    {
+        mavlink_attitude_t attitude;
+        memset(&attitude, 0, sizeof(attitude));
+        attitude.time_boot_ms   = bootMSecs;
+        // Banked into the turn
+        attitude.roll           = static_cast<float>(qDegreesToRadians(10.0));
+        attitude.yaw            = static_cast<float>(qDegreesToRadians(headingDeg > 180 ? headingDeg - 360 : headingDeg));
+        attitude.yawspeed       = static_cast<float>(2 * M_PI / (_circlePeriodMSecs / 1000.0));
+        mavlink_msg_attitude_encode_chan(vehicle.systemId, _componentId, _channel, &message, &attitude);
+        break;
+    }
+    }
+
+    return message;
+}
+
+MockLinkLoadGenerator::Vehicle_t* MockLinkLoadGenerator::_targetVehicle(uint8_t targetSystemId)
+{
+    if (_vehicles.isEmpty()) {
+        return nullptr;
+    }
+
+    // System ids are contiguous
+    const int index = targetSystemId - _vehicles.first().systemId;
+    return index >= 0 && index < _vehicles.count() ? &_vehicles[index] : nullptr;
+}
+
+void MockLinkLoadGenerator::handleMessage(const mavlink_message_t& message, QVector<mavlink_message_t>& responses)
+{
+    Vehicle_t*          vehicle = nullptr;
+    mavlink_message_t   response;
+
+    switch (message.msgid) {
+    case MAVLINK_MSG_ID_COMMAND_LONG:
+    case MAVLINK_MSG_ID_COMMAND_INT:
+    {
+        uint8_t     targetSystemId;
+        uint16_t    command;
+
+        if (message.msgid == MAVLINK_MSG_ID_COMMAND_LONG) {
+            mavlink_command_long_t commandLong;
+            mavlink_msg_command_long_decode(&message, &commandLong);
+            targetSystemId  = commandLong.target_system;
+            command         = commandLong.command;
+        } else {
+            mavlink_command_int_t commandInt;
+            mavlink_msg_command_int_decode(&message, &commandInt);
+            targetSystemId  = commandInt.target_system;
+            command         = commandInt.command;
+        }
+        if (!(vehicle = _targetVehicle(targetSystemId))) {
+            return;
+        }
+
+        // The simulated vehicles don't do anything, so QGC stops asking
+        mavlink_command_ack_t commandAck;
+        memset(&commandAck, 0, sizeof(commandAck));
+        commandAck.command          = command;
+        commandAck.result           = MAV_RESULT_UNSUPPORTED;
+        commandAck.target_system    = message.sysid;
+        commandAck.target_component = message.compid;
+        _prepareEncode(*vehicle);
+        mavlink_msg_command_ack_encode_chan(vehicle->systemId, _componentId, _channel, &response, &commandAck);
+        break;
+    }
+    case MAVLINK_MSG_ID_PARAM_REQUEST_LIST:
+    case MAVLINK_MSG_ID_PARAM_REQUEST_READ:
+    {
+        const uint8_t targetSystemId = message.msgid == MAVLINK_MSG_ID_PARAM_REQUEST_LIST ?
+                    mavlink_msg_param_request_list_get_target_system(&message) :
+                    mavlink_msg_param_request_read_get_target_system(&message);
+        if (!(vehicle = _targetVehicle(targetSystemId))) {
+            return;
+        }
+
+        // A single parameter is enough for the parameter load to complete
+        mavlink_param_value_t paramValue;
+        memset(&paramValue, 0, sizeof(paramValue));
+        strncpy(paramValue.param_id, "MOCK_LOAD_ID", sizeof(paramValue.param_id));
+        paramValue.param_value  = vehicle->systemId;
+        paramValue.param_type   = MAV_PARAM_TYPE_REAL32;
+        paramValue.param_count  = 1;
+        paramValue.param_index  = 0;
+        _prepareEncode(*vehicle);
+        mavlink_msg_param_value_encode_chan(vehicle->systemId, _componentId, _channel, &response, &paramValue);
+        break;
+    }
+    case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
+    {
+        mavlink_mission_request_list_t requestList;
+        mavlink_msg_mission_request_list_decode(&message, &requestList);
+        if (!(vehicle = _targetVehicle(requestList.target_system))) {
+            return;
+        }
+
+        mavlink_mission_count_t missionCount;
+        memset(&missionCount, 0, sizeof(missionCount));
+        missionCount.target_system      = message.sysid;
+        missionCount.target_component   = message.compid;
+        missionCount.count              = 0;
+        missionCount.mission_type       = requestList.mission_type;
+        _prepareEncode(*vehicle);
+        mavlink_msg_mission_count_encode_chan(vehicle->systemId, _componentId, _channel, &response, &missionCount);
+        break;
+    }
+    default:
+        return;
+    }
+
+    responses.append(response);
+}
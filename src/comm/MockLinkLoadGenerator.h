@@ -0,0 +1,97 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QMap>
+#include <QRandomGenerator>
+#include <QString>
+#include <QVector>
+
+#include "QGCMAVLink.h"
+
+/// Simulates a fleet of vehicles for load testing the receive path. Each vehicle sends every message of a rate
+/// profile at its own rate, with optional jitter on the send times and random message loss. A lost message still
+/// uses up a sequence number, so QGC sees the gap just like on a real link. Vehicles answer just enough of the
+/// initial connection (command acks, a single parameter, an empty mission) for QGC to settle down.
+///
+/// The generator runs on the clock and random seed it is given, so the same settings produce the same traffic.
+/// It is not thread safe, all calls must come from the same thread.
+class MockLinkLoadGenerator
+{
+public:
+    typedef QMap<uint32_t, double> RateProfile_t;   ///< Send rate in Hz by message id
+
+    /// @param channel Mavlink channel to encode on, the sequence numbers of the channel are overwritten per vehicle
+    MockLinkLoadGenerator(uint8_t               channel,
+                          MAV_AUTOPILOT         firmwareType,
+                          MAV_TYPE              vehicleType,
+                          uint8_t               firstSystemId,
+                          int                   vehicleCount,
+                          const RateProfile_t&  rateProfile,
+                          int                   jitterPercent,
+                          int                   lossPercent,
+                          quint32               seed);
+
+    /// Appends every message which is due at nowMSecs, and wasn't lost
+    void run(qint64 nowMSecs, QVector<mavlink_message_t>& messages);
+
+    /// Appends the responses of the simulated vehicles to a message from QGC
+    void handleMessage(const mavlink_message_t& message, QVector<mavlink_message_t>& responses);
+
+    int     vehicleCount    (void) const { return _vehicles.count(); }
+    quint64 sentCount       (void) const { return _sentCount; }
+    quint64 lostCount       (void) const { return _lostCount; }
+
+    /// Telemetry at roughly the rates of a PX4 vehicle on a telemetry radio
+    static RateProfile_t defaultRateProfile(void);
+
+    /// @return true if the generator knows how to fill in the message
+    static bool messageSupported(uint32_t msgId);
+
+    /// Rate profiles are stored in settings as "msgid:hz" pairs separated by commas
+    static QString          rateProfileToString     (const RateProfile_t& rateProfile);
+    static RateProfile_t    rateProfileFromString   (const QString& rateProfileString);
+
+    static const int maxVehicleCount = 250;
+
+private:
+    typedef struct {
+        uint32_t    msgId;
+        qint64      intervalUSecs;
+        qint64      nextUSecs;
+    } Stream_t;
+
+    typedef struct {
+        uint8_t             systemId;
+        uint8_t             sequence;
+        int                 index;
+        QVector<Stream_t>   streams;
+    } Vehicle_t;
+
+    bool                _lost               (void);
+    qint64              _nextIntervalUSecs  (qint64 intervalUSecs);
+    void                _prepareEncode      (Vehicle_t& vehicle);
+    mavlink_message_t   _encodeTelemetry    (Vehicle_t& vehicle, uint32_t msgId, qint64 nowMSecs);
+    Vehicle_t*          _targetVehicle      (uint8_t targetSystemId);
+
+    uint8_t             _channel;
+    MAV_AUTOPILOT       _firmwareType;
+    MAV_TYPE            _vehicleType;
+    int                 _jitterPercent;
+    int                 _lossPercent;
+    QRandomGenerator    _random;
+    QVector<Vehicle_t>  _vehicles;
+    quint64             _sentCount = 0;
+    quint64             _lostCount = 0;
+
+    static const uint8_t    _componentId        = MAV_COMP_ID_AUTOPILOT1;
+    static const int        _vehiclesPerRow     = 20;       ///< Vehicles are laid out on a grid
+    static const int        _circlePeriodMSecs  = 60000;    ///< Each vehicle flies a circle around its grid position
+};
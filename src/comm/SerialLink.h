@@ -81,6 +81,7 @@ public:
     void        updateSettings  ();
     QString     settingsURL     () { return "SerialSettings.qml"; }
     QString     settingsTitle   () { return tr("Serial Link Settings"); }
+    int         sendBytesPerSecond() { return _usbDirect ? 0 : _baud / 10; }   ///< Start, 8 data and stop bit per byte. Direct USB is not limited by the baud rate
 
 signals:
     void baudChanged            ();
@@ -0,0 +1,197 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryLogWriter.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QtEndian>
+
+#include <string.h>
+
+QGC_LOGGING_CATEGORY(TelemetryLogWriterLog, "TelemetryLogWriterLog")
+
+static_assert((TelemetryLogWriter::ringCapacity & (TelemetryLogWriter::ringCapacity - 1)) == 0, "ringCapacity must be a power of two");
+
+TelemetryLogWriter::TelemetryLogWriter(QObject* parent)
+    : QThread   (parent)
+    , _ring     (new uint8_t[ringCapacity])
+{
+
+}
+
+TelemetryLogWriter::~TelemetryLogWriter()
+{
+    stopLog();
+    delete[] _ring;
+}
+
+void TelemetryLogWriter::startLog(QFile* file)
+{
+    stopLog();
+
+    _file           = file;
+    _writeFailed    = false;
+    _startUtcUSecs  = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch()) * 1000;
+
+    _head.storeRelaxed(0);
+    _tail.storeRelaxed(0);
+    _droppedRecordCount.storeRelaxed(0);
+    _blockWriteCount.storeRelaxed(0);
+    _stopRequested.storeRelaxed(0);
+    _block.clear();
+    _block.reserve(blockSize);
+    _logClock.start();
+    _logActive = true;
+
+    qCDebug(TelemetryLogWriterLog) << "Logging to" << _file->fileName();
+    start(QThread::LowPriority);
+}
+
+void TelemetryLogWriter::stopLog(void)
+{
+    if (!_logActive) {
+        return;
+    }
+    _logActive = false;
+
+    _stopRequested.storeRelease(1);
+    _wakeCondition.wakeOne();
+    wait();
+
+    if (_droppedRecordCount.loadRelaxed()) {
+        qCWarning(TelemetryLogWriterLog) << "Ring overflow, records not logged:" << _droppedRecordCount.loadRelaxed() << _file->fileName();
+    }
+    qCDebug(TelemetryLogWriterLog) << "Log complete" << _file->fileName() << "block writes" << _blockWriteCount.loadRelaxed();
+    _file = nullptr;
+}
+
+quint64 TelemetryLogWriter::_timestampUSecs(void) const
+{
+    // A monotonic clock offset from the start time, so timestamps never step backwards when the system clock is adjusted
+    return _startUtcUSecs + static_cast<quint64>(_logClock.nsecsElapsed() / 1000);
+}
+
+void TelemetryLogWriter::logMessage(const mavlink_message_t& message)
+{
+    if (!_logActive) {
+        return;
+    }
+
+    uint8_t frame[MAVLINK_MAX_PACKET_LEN];
+    const int frameLength = mavlink_msg_to_send_buffer(frame, &message);
+    _queueRecord(frame, frameLength);
+}
+
+void TelemetryLogWriter::logBytes(const QByteArray& bytes)
+{
+    if (!_logActive) {
+        return;
+    }
+
+    // Sent data is logged in write sized chunks, anything larger than a frame is split so each record still fits the ring
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(bytes.constData());
+    for (int offset=0; offset<bytes.size(); offset+=MAVLINK_MAX_PACKET_LEN) {
+        _queueRecord(data + offset, qMin(static_cast<int>(MAVLINK_MAX_PACKET_LEN), bytes.size() - offset));
+    }
+}
+
+void TelemetryLogWriter::_queueRecord(const uint8_t* frame, int frameLength)
+{
+    uint8_t record[_maxRecordLength];
+    qToBigEndian<quint64>(_timestampUSecs(), record);
+    memcpy(&record[sizeof(quint64)], frame, frameLength);
+    const quint32 recordLength = sizeof(quint64) + frameLength;
+
+    const quint32 head = _head.loadRelaxed();
+    const quint32 tail = _tail.loadAcquire();
+    if (head - tail + recordLength > static_cast<quint32>(ringCapacity)) {
+        // Writer thread is stuck on the disk, losing the newest record is better than stalling the GUI thread
+        _droppedRecordCount.fetchAndAddRelaxed(1);
+        return;
+    }
+
+    const quint32 offset    = head & (ringCapacity - 1);
+    const quint32 firstPart = qMin(recordLength, static_cast<quint32>(ringCapacity) - offset);
+    memcpy(&_ring[offset], record, firstPart);
+    memcpy(_ring, &record[firstPart], recordLength - firstPart);
+    _head.storeRelease(head + recordLength);
+
+    if ((head + recordLength) / blockSize != head / blockSize && head + recordLength - tail >= static_cast<quint32>(blockSize)) {
+        _wakeCondition.wakeOne();
+    }
+}
+
+void TelemetryLogWriter::run(void)
+{
+    _flushTimer.start();
+
+    while (!_stopRequested.loadAcquire()) {
+        _wakeMutex.lock();
+        _wakeCondition.wait(&_wakeMutex, _flushIntervalMSecs);
+        _wakeMutex.unlock();
+
+        _drain(_flushTimer.elapsed() >= _flushIntervalMSecs);
+    }
+
+    // Anything logged before stopLog was called still goes to disk
+    _drain(true);
+    if (!_writeFailed) {
+        _file->flush();
+    }
+}
+
+/// Moves everything between tail and head into blocks, writing each block once it is full
+void TelemetryLogWriter::_drain(bool flushPartialBlock)
+{
+    quint32         tail = _tail.loadRelaxed();
+    const quint32   head = _head.loadAcquire();
+
+    while (tail != head) {
+        const quint32 offset        = tail & (ringCapacity - 1);
+        const quint32 contiguous    = qMin(head - tail, static_cast<quint32>(ringCapacity) - offset);
+        const quint32 copyLength    = qMin(contiguous, static_cast<quint32>(blockSize - _block.size()));
+
+        _block.append(reinterpret_cast<const char*>(&_ring[offset]), copyLength);
+        tail += copyLength;
+
+        // Hand the space back straight away so a slow write does not cause drops
+        _tail.storeRelease(tail);
+
+        if (_block.size() == blockSize) {
+            _writeBlock();
+        }
+    }
+
+    if (flushPartialBlock && !_block.isEmpty()) {
+        _writeBlock();
+    }
+}
+
+void TelemetryLogWriter::_writeBlock(void)
+{
+    _flushTimer.start();
+
+    if (_writeFailed) {
+        // Keep draining so the ring does not fill up and count everything as dropped
+        _block.clear();
+        return;
+    }
+
+    _blockWriteCount.fetchAndAddRelaxed(1);
+    const bool writeOk = _file->write(_block) == _block.size();
+    // Keeps the allocation for the next block
+    _block.resize(0);
+
+    if (!writeOk) {
+        _writeFailed = true;
+        qCWarning(TelemetryLogWriterLog) << "Log write failed" << _file->fileName() << _file->errorString();
+        emit writeError(_file->errorString());
+    }
+}
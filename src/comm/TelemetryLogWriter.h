@@ -0,0 +1,89 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QThread>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include "QGCLoggingCategory.h"
+#include "QGCMAVLink.h"
+
+Q_DECLARE_LOGGING_CATEGORY(TelemetryLogWriterLog)
+
+class QFile;
+
+/// Writes the telemetry log (tlog) on its own thread. The GUI thread serializes each record, a big endian usec UTC
+/// timestamp followed by the frame, straight into a byte ring. The writer thread moves the ring into fixed size blocks
+/// and only writes a block to disk once it is full, or once a second so a crash loses little. A slow disk never
+/// blocks the GUI thread: if the ring fills up, new records are dropped and counted.
+class TelemetryLogWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    TelemetryLogWriter(QObject* parent = nullptr);
+    ~TelemetryLogWriter();
+
+    /// Starts writing to file, which must already be open for writing. The file is only touched by the writer thread
+    /// until stopLog returns.
+    void startLog(QFile* file);
+
+    /// Writes out everything still queued and stops the writer thread
+    void stopLog(void);
+
+    bool    logActive           (void) const { return _logActive; }
+    quint32 droppedRecordCount  (void) const { return _droppedRecordCount.loadRelaxed(); }
+    quint32 blockWriteCount     (void) const { return _blockWriteCount.loadRelaxed(); }  ///< Number of write calls made to the file
+
+    /// Queues a received message. Must be called from the thread which called startLog.
+    void logMessage(const mavlink_message_t& message);
+
+    /// Queues raw bytes sent on a link. Must be called from the thread which called startLog.
+    void logBytes(const QByteArray& bytes);
+
+    static const int blockSize      = 64 * 1024;
+    static const int ringCapacity   = 4 * 1024 * 1024;    ///< Must be a power of two
+
+signals:
+    /// Emitted from the writer thread the first time a write fails. Nothing further is written to the file.
+    void writeError(const QString& errorString);
+
+protected:
+    // QThread override
+    void run(void) final;
+
+private:
+    quint64 _timestampUSecs (void) const;
+    void    _queueRecord    (const uint8_t* frame, int frameLength);
+    void    _drain          (bool flushPartialBlock);
+    void    _writeBlock     (void);
+
+    QFile*                  _file           = nullptr;
+    bool                    _logActive      = false;
+    bool                    _writeFailed    = false;    ///< Only used by the writer thread
+    quint64                 _startUtcUSecs  = 0;
+    QElapsedTimer           _logClock;
+    uint8_t*                _ring;
+    QByteArray              _block;                     ///< Only used by the writer thread
+    QElapsedTimer           _flushTimer;                ///< Only used by the writer thread
+    QAtomicInteger<quint32> _head;                      ///< Byte offset of next free byte, only advanced by the logging thread
+    QAtomicInteger<quint32> _tail;                      ///< Byte offset of next byte to write, only advanced by the writer thread
+    QAtomicInteger<quint32> _droppedRecordCount;
+    QAtomicInteger<quint32> _blockWriteCount;
+    QAtomicInt              _stopRequested;
+    QMutex                  _wakeMutex;
+    QWaitCondition          _wakeCondition;
+
+    static const int _flushIntervalMSecs    = 1000;
+    static const int _maxRecordLength       = sizeof(quint64) + MAVLINK_MAX_PACKET_LEN;
+};
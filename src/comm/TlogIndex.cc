@@ -0,0 +1,352 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogIndex.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <string.h>
+
+QGC_LOGGING_CATEGORY(TlogIndexLog, "TlogIndexLog")
+
+const char* TlogIndex::indexFileExtension   = "qgcidx";
+const char  TlogIndex::_fileMagic[8]        = { 'Q', 'G', 'C', 'T', 'L', 'I', 'D', 'X' };
+
+TlogIndex::TlogIndex(void)
+{
+
+}
+
+void TlogIndex::_clearIndex(void)
+{
+    _loadedFromCache    = false;
+    _frameCount         = 0;
+    _firstFrameOffset   = 0;
+    _startTimeUSecs     = 0;
+    _endTimeUSecs       = 0;
+    _timeEntries.clear();
+    _messageOffsets.clear();
+}
+
+QString TlogIndex::indexFileName(const QString& tlogFile)
+{
+    return QStringLiteral("%1.%2").arg(tlogFile, indexFileExtension);
+}
+
+bool TlogIndex::load(const QString& tlogFile, const uint8_t* data, quint64 size, QString& errorString)
+{
+    QFileInfo   tlogInfo(tlogFile);
+    QString     indexFile           = indexFileName(tlogFile);
+    qint64      tlogModifiedMSecs   = tlogInfo.lastModified().toMSecsSinceEpoch();
+
+    if (static_cast<quint64>(tlogInfo.size()) != size) {
+        errorString = QObject::tr("Log file '%1' changed while loading").arg(tlogFile);
+        return false;
+    }
+
+    _clearIndex();
+    _data = data;
+    _size = size;
+
+    if (_readIndexFile(indexFile, size, tlogModifiedMSecs)) {
+        _loadedFromCache = true;
+        qCDebug(TlogIndexLog) << "Loaded index" << indexFile << "frames" << _frameCount;
+        return true;
+    }
+
+    build(data, size);
+
+    // A log in a read only location is still indexed, it just gets rebuilt next time
+    if (!_writeIndexFile(indexFile, size, tlogModifiedMSecs)) {
+        qCDebug(TlogIndexLog) << "Unable to save index" << indexFile;
+    }
+
+    return true;
+}
+
+void TlogIndex::build(const uint8_t* data, quint64 size)
+{
+    QElapsedTimer       timer;
+    MAVLinkFrameScanner scanner;
+    quint64             chunkStart  = 0;
+    bool                firstFrame  = true;
+
+    _clearIndex();
+    _data = data;
+    _size = size;
+
+    timer.start();
+
+    // The scanner works on int sized buffers, so large logs are scanned a chunk at a time
+    while (chunkStart < size) {
+        const int   chunkLength = static_cast<int>(qMin(static_cast<quint64>(_buildChunkSize), size - chunkStart));
+        quint64     consumed    = chunkStart;
+
+        scanner.reset();
+        scanner.scan(data + chunkStart, chunkLength, [&](const MAVLinkFrameScanner::Frame_t& frame) {
+            const quint64 offset = static_cast<quint64>(frame.data - data);
+
+            consumed = offset + frame.length;
+            if (offset < _cbTimestamp) {
+                // No room for a timestamp in front, so not a tlog record
+                return;
+            }
+
+            const quint64 timestampUSecs = parseTimestamp(frame.data - _cbTimestamp);
+            if (firstFrame) {
+                firstFrame          = false;
+                _firstFrameOffset   = offset;
+                _startTimeUSecs     = timestampUSecs;
+            }
+            if (_timeEntries.isEmpty() || timestampUSecs >= _timeEntries.last().timestampUSecs + _timeEntryIntervalUSecs) {
+                _timeEntries.append(TimeEntry_t{ timestampUSecs, offset });
+            }
+            _endTimeUSecs = timestampUSecs;
+
+            _messageOffsets[_frameMessageId(frame.data)].append(offset);
+            _frameCount++;
+        });
+
+        if (chunkStart + chunkLength == size) {
+            break;
+        }
+
+        // Start the next chunk behind the last frame found, but far enough back that a frame split across the chunk
+        // boundary is seen whole
+        chunkStart = qMax(consumed, chunkStart + chunkLength - MAVLINK_MAX_PACKET_LEN);
+    }
+
+    qCDebug(TlogIndexLog) << "Built index frames" << _frameCount << "bytes" << size << "msecs" << timer.elapsed();
+}
+
+quint64 TlogIndex::offsetForTime(quint64 timestampUSecs) const
+{
+    if (_frameCount == 0) {
+        return _size;
+    }
+    if (timestampUSecs <= _startTimeUSecs) {
+        return _firstFrameOffset;
+    }
+
+    // Jump to the last time entry before the requested time, then walk the frames from there
+    auto entry = std::upper_bound(_timeEntries.constBegin(), _timeEntries.constEnd(), timestampUSecs,
+                                  [](quint64 timestampUSecs, const TimeEntry_t& entry) { return timestampUSecs < entry.timestampUSecs; });
+    if (entry != _timeEntries.constBegin()) {
+        entry--;
+    }
+
+    quint64                         offset = entry->offset;
+    MAVLinkFrameScanner::Frame_t    frame;
+    while (nextFrame(_data, _size, offset, frame)) {
+        if (frameTimestamp(_data, offset) >= timestampUSecs) {
+            return offset;
+        }
+        offset += frame.length;
+    }
+
+    return _size;
+}
+
+QVector<quint64> TlogIndex::offsetsForMessageIds(const QList<uint32_t>& messageIds) const
+{
+    QVector<quint64> offsets;
+
+    for (uint32_t messageId : messageIds) {
+        auto messageOffsets = _messageOffsets.constFind(messageId);
+        if (messageOffsets != _messageOffsets.constEnd()) {
+            const int mergeStart = offsets.count();
+            offsets.append(messageOffsets.value());
+            std::inplace_merge(offsets.begin(), offsets.begin() + mergeStart, offsets.end());
+        }
+    }
+
+    return offsets;
+}
+
+bool TlogIndex::nextFrame(const uint8_t* data, quint64 size, quint64& offset, MAVLinkFrameScanner::Frame_t& frame)
+{
+    MAVLinkFrameScanner scanner;
+
+    // Scan a small window at a time, the next frame is almost always right behind the timestamp at offset
+    while (offset < size) {
+        const int   windowLength    = static_cast<int>(qMin(static_cast<quint64>(_searchWindowLength), size - offset));
+        bool        found           = false;
+
+        scanner.reset();
+        scanner.scan(data + offset, windowLength, [&](const MAVLinkFrameScanner::Frame_t& windowFrame) {
+            if (!found) {
+                found = true;
+                frame = windowFrame;
+            }
+        });
+
+        if (found) {
+            offset = static_cast<quint64>(frame.data - data);
+            return true;
+        }
+        if (offset + windowLength == size) {
+            break;
+        }
+        offset += windowLength - MAVLINK_MAX_PACKET_LEN;
+    }
+
+    offset = size;
+    return false;
+}
+
+quint64 TlogIndex::frameTimestamp(const uint8_t* data, quint64 frameOffset)
+{
+    if (frameOffset < _cbTimestamp) {
+        return 0;
+    }
+    return parseTimestamp(data + frameOffset - _cbTimestamp);
+}
+
+quint64 TlogIndex::parseTimestamp(const uint8_t* timestamp)
+{
+    quint64 timestampUSecs      = qFromBigEndian<quint64>(timestamp);
+    quint64 currentTimeUSecs    = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch()) * 1000;
+
+    if (timestampUSecs > currentTimeUSecs) {
+        timestampUSecs = qbswap(timestampUSecs);
+    }
+
+    return timestampUSecs;
+}
+
+uint32_t TlogIndex::_frameMessageId(const uint8_t* frame)
+{
+    if (frame[0] == MAVLINK_STX_MAVLINK1) {
+        return frame[5];
+    }
+    return frame[7] | (frame[8] << 8) | (frame[9] << 16);
+}
+
+bool TlogIndex::_readIndexFile(const QString& indexFile, quint64 tlogSize, qint64 tlogModifiedMSecs)
+{
+    QFile file(indexFile);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    char    magic[sizeof(_fileMagic)];
+    quint32 version;
+    quint64 indexedSize;
+    qint64  indexedModifiedMSecs;
+    quint32 timeEntryCount;
+    quint32 messageIdCount;
+
+    if (stream.readRawData(magic, sizeof(magic)) != sizeof(magic) || memcmp(magic, _fileMagic, sizeof(_fileMagic)) != 0) {
+        qCWarning(TlogIndexLog) << "Not a tlog index" << indexFile;
+        return false;
+    }
+    stream >> version >> indexedSize >> indexedModifiedMSecs;
+    if (version != _fileVersion || indexedSize != tlogSize || indexedModifiedMSecs != tlogModifiedMSecs) {
+        qCDebug(TlogIndexLog) << "Stale index" << indexFile;
+        return false;
+    }
+    stream >> _frameCount >> _firstFrameOffset >> _startTimeUSecs >> _endTimeUSecs >> timeEntryCount >> messageIdCount;
+
+    // Counts are checked against what the tlog could possibly hold before anything is allocated for them, a damaged
+    // or foreign index which happens to match size and time must not turn into a huge allocation
+    const quint64 maxFrameCount = tlogSize / _minRecordSize;
+    if (stream.status() != QDataStream::Ok || _frameCount > maxFrameCount || timeEntryCount > _frameCount || messageIdCount > _frameCount ||
+            (_frameCount && _firstFrameOffset >= tlogSize)) {
+        qCWarning(TlogIndexLog) << "Corrupt tlog index" << indexFile;
+        _clearIndex();
+        return false;
+    }
+
+    _timeEntries.resize(static_cast<int>(timeEntryCount));
+    for (TimeEntry_t& entry : _timeEntries) {
+        stream >> entry.timestampUSecs >> entry.offset;
+        if (entry.offset >= tlogSize) {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+    }
+
+    quint64 totalOffsetCount = 0;
+    for (quint32 i=0; i<messageIdCount && stream.status() == QDataStream::Ok; i++) {
+        uint32_t    messageId;
+        quint32     offsetCount;
+
+        stream >> messageId >> offsetCount;
+        totalOffsetCount += offsetCount;
+        if (totalOffsetCount > _frameCount) {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+
+        QVector<quint64>& offsets = _messageOffsets[messageId];
+        offsets.resize(static_cast<int>(offsetCount));
+        const int byteCount = static_cast<int>(offsetCount * sizeof(quint64));
+        if (stream.readRawData(reinterpret_cast<char*>(offsets.data()), byteCount) != byteCount) {
+            stream.setStatus(QDataStream::ReadPastEnd);
+            break;
+        }
+        qFromLittleEndian<quint64>(offsets.constData(), offsetCount, offsets.data());
+        if (offsetCount && offsets.last() >= tlogSize) {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+    }
+
+    if (stream.status() != QDataStream::Ok || !stream.atEnd() || totalOffsetCount != _frameCount) {
+        qCWarning(TlogIndexLog) << "Corrupt tlog index" << indexFile;
+        _clearIndex();
+        return false;
+    }
+
+    return true;
+}
+
+bool TlogIndex::_writeIndexFile(const QString& indexFile, quint64 tlogSize, qint64 tlogModifiedMSecs) const
+{
+    // QSaveFile so a crash part way through never leaves a truncated index which looks valid
+    QSaveFile file(indexFile);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    stream.writeRawData(_fileMagic, sizeof(_fileMagic));
+    stream << _fileVersion << tlogSize << tlogModifiedMSecs;
+    stream << _frameCount << _firstFrameOffset << _startTimeUSecs << _endTimeUSecs;
+    stream << static_cast<quint32>(_timeEntries.count()) << static_cast<quint32>(_messageOffsets.count());
+
+    for (const TimeEntry_t& entry : _timeEntries) {
+        stream << entry.timestampUSecs << entry.offset;
+    }
+
+    for (auto messageOffsets = _messageOffsets.constBegin(); messageOffsets != _messageOffsets.constEnd(); messageOffsets++) {
+        const QVector<quint64>& offsets = messageOffsets.value();
+        QVector<quint64>        littleEndianOffsets(offsets.count());
+
+        qToLittleEndian<quint64>(offsets.constData(), offsets.count(), littleEndianOffsets.data());
+        stream << messageOffsets.key() << static_cast<quint32>(offsets.count());
+        stream.writeRawData(reinterpret_cast<const char*>(littleEndianOffsets.constData()), static_cast<int>(offsets.count() * sizeof(quint64)));
+    }
+
+    return stream.status() == QDataStream::Ok && file.commit();
+}
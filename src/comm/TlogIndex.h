@@ -0,0 +1,103 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "MAVLinkFrameScanner.h"
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(TlogIndexLog)
+
+/// Index over a telemetry log (tlog) which is held in memory, normally a memory mapped file. It maps log time to file
+/// offset and lists the offset of every frame by message id, so a multi gigabyte log can be seeked into instantly and
+/// replayed for a subset of message ids without decoding the rest.
+///
+/// The index is built with a single scan of the log and cached in a sidecar file next to the tlog (see indexFileName).
+/// The cache is rebuilt whenever the size or modification time of the tlog no longer match, or its contents could not
+/// possibly describe a log of that size.
+///
+/// All offsets are to the start of a frame. The big endian usec timestamp of a frame is in the 8 bytes in front of it.
+class TlogIndex
+{
+public:
+    TlogIndex(void);
+
+    /// Loads the sidecar index for tlogFile, building and saving it if it is missing or stale. data/size must stay
+    /// valid for as long as the index is used.
+    bool load(const QString& tlogFile, const uint8_t* data, quint64 size, QString& errorString);
+
+    /// Builds the index from data without looking for or saving a sidecar file
+    void build(const uint8_t* data, quint64 size);
+
+    bool            loadedFromCache     (void) const { return _loadedFromCache; }
+    quint64         frameCount          (void) const { return _frameCount; }
+    quint64         firstFrameOffset    (void) const { return _firstFrameOffset; }
+    quint64         startTimeUSecs      (void) const { return _startTimeUSecs; }
+    quint64         endTimeUSecs        (void) const { return _endTimeUSecs; }
+    QList<uint32_t> messageIds          (void) const { return _messageOffsets.keys(); }
+
+    /// @return Offset of the first frame with a timestamp at or after timestampUSecs, size of the log if there is none
+    quint64 offsetForTime(quint64 timestampUSecs) const;
+
+    /// @return Offsets of all frames with the specified message id, in file order
+    QVector<quint64> offsetsForMessageId(uint32_t messageId) const { return _messageOffsets.value(messageId); }
+
+    /// @return Offsets of all frames with any of the specified message ids, in file order
+    QVector<quint64> offsetsForMessageIds(const QList<uint32_t>& messageIds) const;
+
+    /// Finds the first valid frame at or after offset
+    /// @param offset[in,out] Where to start looking, set to the offset of the frame if one is found
+    /// @return false: no more frames in the log
+    static bool nextFrame(const uint8_t* data, quint64 size, quint64& offset, MAVLinkFrameScanner::Frame_t& frame);
+
+    /// @return Timestamp of the frame at frameOffset, 0 if there is no room for one in front of it
+    static quint64 frameTimestamp(const uint8_t* data, quint64 frameOffset);
+
+    /// Parses a tlog timestamp. Old logs stored timestamps little endian, which show up as being in the future.
+    static quint64 parseTimestamp(const uint8_t* timestamp);
+
+    static QString indexFileName(const QString& tlogFile);
+
+    static const char* indexFileExtension;
+
+private:
+    void _clearIndex    (void);
+    bool _readIndexFile (const QString& indexFile, quint64 tlogSize, qint64 tlogModifiedMSecs);
+    bool _writeIndexFile(const QString& indexFile, quint64 tlogSize, qint64 tlogModifiedMSecs) const;
+
+    static uint32_t _frameMessageId(const uint8_t* frame);
+
+    typedef struct {
+        quint64 timestampUSecs;
+        quint64 offset;
+    } TimeEntry_t;
+
+    const uint8_t*                      _data               = nullptr;
+    quint64                             _size               = 0;
+    bool                                _loadedFromCache    = false;
+    quint64                             _frameCount         = 0;
+    quint64                             _firstFrameOffset   = 0;
+    quint64                             _startTimeUSecs     = 0;
+    quint64                             _endTimeUSecs       = 0;
+    QVector<TimeEntry_t>                _timeEntries;       ///< One entry per _timeEntryIntervalUSecs of log, increasing timestamps
+    QHash<uint32_t, QVector<quint64>>   _messageOffsets;
+
+    static const char       _fileMagic[8];
+    static const quint32    _fileVersion                = 1;
+    static const quint64    _timeEntryIntervalUSecs     = 100000;
+    static const int        _buildChunkSize             = 16 * 1024 * 1024;
+    static const int        _searchWindowLength         = 2 * MAVLINK_MAX_PACKET_LEN;   ///< Keeps nextFrame from validating many frames past the one it wants
+    static const int        _cbTimestamp                = sizeof(quint64);
+    static const int        _minRecordSize              = _cbTimestamp + MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 + MAVLINK_NUM_CHECKSUM_BYTES;  ///< Timestamp and an empty MAVLink 1 frame
+};
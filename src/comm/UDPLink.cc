@@ -16,6 +16,9 @@
 #include <QNetworkInterface>
 #include <iostream>
 #include <QHostInfo>
+#include <QVariantMap>
+#include <QMetaMethod>
+#include <QVarLengthArray>
 
 #include "UDPLink.h"
 #include "QGC.h"
@@ -23,6 +26,14 @@
 #include "SettingsManager.h"
 #include "AutoConnectSettings.h"
 
+#ifdef QGC_UDP_BATCHED_IO
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
 static const char* kZeroconfRegistration = "_qgroundcontrol._udp";
 
 static bool is_ip(const QString& address)
@@ -83,6 +94,8 @@ UDPLink::UDPLink(SharedLinkConfigurationPtr& config)
         QHostAddress &address = allAddresses[i];
         _localAddresses.append(QHostAddress(address));
     }
+    // Input is framed per sender in readBytes
+    _disableBytesReceivedFraming();
     moveToThread(this);
 }
 
@@ -105,6 +118,9 @@ void UDPLink::run()
     if (_hardwareConnect()) {
         exec();
     }
+#ifdef QGC_UDP_BATCHED_IO
+    _closeBatchedIO();
+#endif
     if (_socket) {
         _deregisterZeroconf();
         _socket->close();
@@ -138,25 +154,42 @@ bool UDPLink::_isIpLocal(const QHostAddress& add)
 }
 
 void UDPLink::_writeBytes(const QByteArray data)
+{
+    _writeBytesList(QList<QByteArray>{ data });
+}
+
+void UDPLink::_writeBytesList(const QList<QByteArray>& list)
 {
     if (!_socket) {
         return;
     }
-    emit bytesSent(this, data);
+    for (const QByteArray& data : list) {
+        emit bytesSent(this, data);
+    }
 
     QMutexLocker locker(&_sessionTargetsMutex);
 
-    // Send to all manually targeted systems
-    for (int i=0; i<_udpConfig->targetHosts().count(); i++) {
-        UDPCLient* target = _udpConfig->targetHosts()[i];
-        // Skip it if it's part of the session clients below
-        if(!contains_target(_sessionTargets, target->address, target->port)) {
-            _writeDataGram(data, target);
+    // All manually targeted systems, skipping those which are also session clients, then all connected systems
+    QList<const UDPCLient*> targets;
+    for (const UDPCLient* target : _udpConfig->targetHosts()) {
+        if (!_sessionTargets.contains(_endpointKey(target->address, target->port))) {
+            targets.append(target);
         }
     }
-    // Send to all connected systems
-    for(UDPCLient* target: _sessionTargets) {
-        _writeDataGram(data, target);
+    for (const UDPCLient* target : _sessionTargets) {
+        targets.append(target);
+    }
+
+#ifdef QGC_UDP_BATCHED_IO
+    if (_batchFd >= 0) {
+        _writeBatched(list, targets);
+        return;
+    }
+#endif
+    for (const QByteArray& data : list) {
+        for (const UDPCLient* target : targets) {
+            _writeDataGram(data, target);
+        }
     }
 }
 
@@ -173,7 +206,15 @@ void UDPLink::readBytes()
     if (!_socket) {
         return;
     }
-    QByteArray databuffer;
+#ifdef QGC_UDP_BATCHED_IO
+    if (_batchNotifier) {
+        _readBatched();
+        return;
+    }
+#endif
+    QVector<MAVLinkMessageRef>  messages;
+    QByteArray                  frames;
+    QByteArray*                 routerFrames = _routingActive() ? &frames : nullptr;
     while (_socket->hasPendingDatagrams())
     {
         QByteArray datagram;
@@ -186,34 +227,112 @@ void UDPLink::readBytes()
         if (slen == -1) {
             break;
         }
-        databuffer.append(datagram);
-        //-- Wait a bit before sending it over
-        if (databuffer.size() > 10 * 1024) {
-            emit bytesReceived(this, databuffer);
-            databuffer.clear();
-        }
-        // TODO: This doesn't validade the sender. Anything sending UDP packets to this port gets
-        // added to the list and will start receiving datagrams from here. Even a port scanner
-        // would trigger this.
-        // Add host to broadcast list if not yet present, or update its port
-        QHostAddress asender = sender;
-        if(_isIpLocal(sender)) {
-            asender = QHostAddress(QString("127.0.0.1"));
+        _datagramReceived(datagram.constData(), static_cast<int>(slen), sender, senderPort, messages, routerFrames);
+        //-- Don't hold messages back while a busy socket is drained
+        if (messages.count() >= _maxMessageBatch) {
+            _emitMessagesReceived(messages, frames);
         }
-        QMutexLocker locker(&_sessionTargetsMutex);
-        if (!contains_target(_sessionTargets, asender, senderPort)) {
-            qDebug() << "Adding target" << asender << senderPort;
-            UDPCLient* target = new UDPCLient(asender, senderPort);
-            _sessionTargets.append(target);
-        }
-        locker.unlock();
     }
     //-- Send whatever is left
-    if (databuffer.size()) {
-        emit bytesReceived(this, databuffer);
+    _emitMessagesReceived(messages, frames);
+}
+
+quint64 UDPLink::_endpointKey(const QHostAddress& address, quint16 port)
+{
+    bool            isIPv4  = false;
+    const quint32   ipv4    = address.toIPv4Address(&isIPv4);
+
+    return (static_cast<quint64>(isIPv4 ? ipv4 : qHash(address)) << 16) | port;
+}
+
+void UDPLink::_datagramReceived(const char* data, int length, const QHostAddress& sender, quint16 senderPort, QVector<MAVLinkMessageRef>& messages, QByteArray* frames)
+{
+    static const QMetaMethod bytesReceivedSignal = QMetaMethod::fromSignal(&LinkInterface::bytesReceived);
+
+    // Only copy the datagram out of the receive buffer when someone listens to the raw bytes
+    if (isSignalConnected(bytesReceivedSignal)) {
+        emit bytesReceived(this, QByteArray(data, length));
+    }
+
+    QMutexLocker locker(&_sendersMutex);
+
+    // Keyed on the real sender rather than the loopback mapping used for session targets, so local instances stay apart
+    UDPSender_t*& udpSender = _senders[_endpointKey(sender, senderPort)];
+    if (!udpSender) {
+        udpSender = new UDPSender_t{ sender, senderPort, MAVLinkFrameScanner(), 0, 0, 0, 0, QHash<quint16, uint8_t>() };
+        qCDebug(LinkInterfaceLog) << "New UDP sender" << sender << senderPort;
+        _addSessionTarget(sender, senderPort);
+    }
+
+    const int firstMessage = messages.count();
+    _frameMessages(udpSender->scanner, QByteArray::fromRawData(data, length), messages, frames);
+
+    udpSender->datagramCount++;
+    udpSender->byteCount    += static_cast<quint64>(length);
+    udpSender->messageCount += static_cast<quint64>(messages.count() - firstMessage);
+
+    // Sequence gaps are tracked per sender, so vehicles sharing the port don't show each other's loss
+    for (int i=firstMessage; i<messages.count(); i++) {
+        const mavlink_message_t&    message = *messages[i];
+        const quint16               key     = static_cast<quint16>((message.sysid << 8) | message.compid);
+
+        auto next = udpSender->nextSequence.find(key);
+        if (next == udpSender->nextSequence.end()) {
+            udpSender->nextSequence.insert(key, static_cast<uint8_t>(message.seq + 1));
+        } else {
+            udpSender->lostMessageCount += static_cast<uint8_t>(message.seq - next.value());
+            next.value() = static_cast<uint8_t>(message.seq + 1);
+        }
     }
 }
 
+void UDPLink::_addSessionTarget(const QHostAddress& sender, quint16 senderPort)
+{
+    // TODO: This doesn't validade the sender. Anything sending UDP packets to this port gets
+    // added to the list and will start receiving datagrams from here. Even a port scanner
+    // would trigger this.
+    // Add host to broadcast list if not yet present, or update its port
+    QHostAddress asender = sender;
+    if(_isIpLocal(sender)) {
+        asender = QHostAddress(QString("127.0.0.1"));
+    }
+    QMutexLocker locker(&_sessionTargetsMutex);
+    UDPCLient*& target = _sessionTargets[_endpointKey(asender, senderPort)];
+    if (!target) {
+        qDebug() << "Adding target" << asender << senderPort;
+        target = new UDPCLient(asender, senderPort);
+    }
+}
+
+void UDPLink::_clearSenders(void)
+{
+    QMutexLocker locker(&_sendersMutex);
+    qDeleteAll(_senders);
+    _senders.clear();
+}
+
+QVariantList UDPLink::senderStats(void)
+{
+    QMutexLocker    locker(&_sendersMutex);
+    QVariantList    senderStats;
+
+    for (const UDPSender_t* udpSender: _senders) {
+        QVariantMap map;
+
+        map[QStringLiteral("address")]      = udpSender->address.toString();
+        map[QStringLiteral("port")]         = udpSender->port;
+        map[QStringLiteral("datagrams")]    = udpSender->datagramCount;
+        map[QStringLiteral("bytes")]        = udpSender->byteCount;
+        map[QStringLiteral("messages")]     = udpSender->messageCount;
+        map[QStringLiteral("lostMessages")] = udpSender->lostMessageCount;
+        map[QStringLiteral("crcErrors")]    = udpSender->scanner.crcErrorCount();
+        map[QStringLiteral("droppedBytes")] = udpSender->scanner.droppedByteCount();
+        senderStats.append(map);
+    }
+
+    return senderStats;
+}
+
 void UDPLink::disconnect(void)
 {
     _running = false;
@@ -227,6 +346,8 @@ void UDPLink::disconnect(void)
         _socket = nullptr;
         emit disconnected();
     }
+    // Partial frames from the last session must not be completed by the next one
+    _clearSenders();
     _connectState = false;
 }
 
@@ -263,7 +384,13 @@ bool UDPLink::_hardwareConnect()
         _socket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 512 * 1024);
 #endif
         _registerZeroconf(_udpConfig->localPort(), kZeroconfRegistration);
+#ifdef QGC_UDP_BATCHED_IO
+        if (!_openBatchedIO()) {
+            QObject::connect(_socket, &QUdpSocket::readyRead, this, &UDPLink::readBytes);
+        }
+#else
         QObject::connect(_socket, &QUdpSocket::readyRead, this, &UDPLink::readBytes);
+#endif
         emit connected();
     } else {
         emit communicationError(tr("UDP Link Error"), tr("Error binding UDP port: %1").arg(_socket->errorString()));
@@ -310,6 +437,144 @@ void UDPLink::_deregisterZeroconf()
 #endif
 }
 
+#ifdef QGC_UDP_BATCHED_IO
+/// Batched I/O works on a duplicate of the socket descriptor with its own notifier. The QUdpSocket still owns the
+/// binding and options. Its own read notifier goes quiet by itself, since readyRead is not connected and readDatagram
+/// is never called to re-enable it.
+bool UDPLink::_openBatchedIO(void)
+{
+    _batchFd = ::dup(static_cast<int>(_socket->socketDescriptor()));
+    if (_batchFd < 0) {
+        qWarning() << "Batched UDP I/O not available:" << strerror(errno);
+        return false;
+    }
+    _batchBuffer.resize(_batchCount * _batchBufferSize);
+    _batchNotifier = new QSocketNotifier(_batchFd, QSocketNotifier::Read, this);
+    QObject::connect(_batchNotifier, SIGNAL(activated(int)), this, SLOT(readBytes()));
+    return true;
+}
+
+void UDPLink::_closeBatchedIO(void)
+{
+    delete _batchNotifier;
+    _batchNotifier = nullptr;
+    if (_batchFd >= 0) {
+        ::close(_batchFd);
+        _batchFd = -1;
+    }
+    _batchBuffer.clear();
+}
+
+void UDPLink::_readBatched(void)
+{
+    mmsghdr                     headers[_batchCount];
+    iovec                       iovecs[_batchCount];
+    sockaddr_in                 addresses[_batchCount];
+    QVector<MAVLinkMessageRef>  messages;
+    QByteArray                  frames;
+    QByteArray*                 routerFrames = _routingActive() ? &frames : nullptr;
+
+    while (true) {
+        for (int i=0; i<_batchCount; i++) {
+            iovecs[i].iov_base              = _batchBuffer.data() + i * _batchBufferSize;
+            iovecs[i].iov_len               = _batchBufferSize;
+            headers[i]                      = {};
+            headers[i].msg_hdr.msg_name     = &addresses[i];
+            headers[i].msg_hdr.msg_namelen  = sizeof(sockaddr_in);
+            headers[i].msg_hdr.msg_iov      = &iovecs[i];
+            headers[i].msg_hdr.msg_iovlen   = 1;
+        }
+
+        const int count = ::recvmmsg(_batchFd, headers, _batchCount, MSG_DONTWAIT, nullptr);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                qWarning() << "Error reading UDP datagrams:" << strerror(errno);
+            }
+            break;
+        }
+
+        for (int i=0; i<count; i++) {
+            _datagramReceived(static_cast<const char*>(iovecs[i].iov_base),
+                              static_cast<int>(headers[i].msg_len),
+                              QHostAddress(ntohl(addresses[i].sin_addr.s_addr)),
+                              ntohs(addresses[i].sin_port),
+                              messages,
+                              routerFrames);
+            if (messages.count() >= _maxMessageBatch) {
+                _emitMessagesReceived(messages, frames);
+            }
+        }
+
+        // A short batch means the socket has been drained
+        if (count < _batchCount) {
+            break;
+        }
+    }
+
+    _emitMessagesReceived(messages, frames);
+}
+
+/// Sends every message to every target in as few system calls as possible
+void UDPLink::_writeBatched(const QList<QByteArray>& list, const QList<const UDPCLient*>& targets)
+{
+    QVarLengthArray<sockaddr_in, 16>    addresses;
+    QVarLengthArray<iovec, 64>          iovecs;
+    QVarLengthArray<mmsghdr, 256>       headers;
+
+    for (const UDPCLient* target : targets) {
+        bool            isIPv4  = false;
+        const quint32   ipv4    = target->address.toIPv4Address(&isIPv4);
+
+        // The socket is bound to IPv4 only
+        if (isIPv4) {
+            sockaddr_in address = {};
+            address.sin_family      = AF_INET;
+            address.sin_port        = htons(target->port);
+            address.sin_addr.s_addr = htonl(ipv4);
+            addresses.append(address);
+        }
+    }
+    for (const QByteArray& data : list) {
+        iovecs.append(iovec{ const_cast<char*>(data.constData()), static_cast<size_t>(data.size()) });
+    }
+
+    // Headers point into the other arrays, which are complete by now and won't move
+    for (int i=0; i<iovecs.count(); i++) {
+        for (int j=0; j<addresses.count(); j++) {
+            mmsghdr header = {};
+            header.msg_hdr.msg_name     = &addresses[j];
+            header.msg_hdr.msg_namelen  = sizeof(sockaddr_in);
+            header.msg_hdr.msg_iov      = &iovecs[i];
+            header.msg_hdr.msg_iovlen   = 1;
+            headers.append(header);
+        }
+    }
+
+    int sent = 0;
+    while (sent < headers.count()) {
+        const int result = ::sendmmsg(_batchFd, headers.data() + sent, static_cast<unsigned int>(headers.count() - sent), 0);
+        if (result > 0) {
+            sent += result;
+            continue;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            qWarning() << "UDP send buffer full, dropped" << headers.count() - sent << "datagrams";
+            break;
+        }
+        // Only the first datagram of the call failed, skip it the same way as a failed writeDatagram
+        const sockaddr_in* address = static_cast<const sockaddr_in*>(headers[sent].msg_hdr.msg_name);
+        qWarning() << "Error writing to" << QHostAddress(ntohl(address->sin_addr.s_addr)) << ntohs(address->sin_port) << strerror(errno);
+        sent++;
+    }
+}
+#endif
+
 //--------------------------------------------------------------------------
 //-- UDPConfiguration
 
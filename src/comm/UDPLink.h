@@ -17,6 +17,9 @@
 #include <QMutex>
 #include <QQueue>
 #include <QByteArray>
+#include <QHash>
+#include <QVariantList>
+#include <QSocketNotifier>
 
 #if defined(QGC_ZEROCONF_ENABLED)
 #include <dns_sd.h>
@@ -25,6 +28,12 @@
 #include "QGCConfig.h"
 #include "LinkConfiguration.h"
 #include "LinkInterface.h"
+#include "MAVLinkFrameScanner.h"
+
+// recvmmsg/sendmmsg move many datagrams per system call
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+#define QGC_UDP_BATCHED_IO
+#endif
 
 class LinkManager;
 
@@ -107,6 +116,9 @@ public:
     // QThread overrides
     void run(void) override;
 
+    /// @return One map per remote sender: address, port, datagrams, bytes, messages, lostMessages, crcErrors, droppedBytes
+    Q_INVOKABLE QVariantList senderStats(void);
+
 public slots:
     void readBytes(void);
 
@@ -114,7 +126,23 @@ private slots:
     // LinkInterface overrides
     void _writeBytes(const QByteArray data) override;
 
+protected:
+    // LinkInterface overrides
+    void _writeBytesList(const QList<QByteArray>& list) override;
+
 private:
+    /// Framing state and counters for one remote endpoint. Each sender has its own so partial frames from different
+    /// senders can't corrupt each other. The scanner needs no mavlink channel, so any number of senders can share the port.
+    typedef struct {
+        QHostAddress            address;
+        quint16                 port;
+        MAVLinkFrameScanner     scanner;
+        quint64                 datagramCount;
+        quint64                 byteCount;
+        quint64                 messageCount;
+        quint64                 lostMessageCount;
+        QHash<quint16, uint8_t> nextSequence;       ///< Next expected sequence number by sysid << 8 | compid
+    } UDPSender_t;
 
     // LinkInterface overrides
     bool _connect(void) override;
@@ -124,14 +152,38 @@ private:
     void _registerZeroconf  (uint16_t port, const std::string& regType);
     void _deregisterZeroconf(void);
     void _writeDataGram     (const QByteArray data, const UDPCLient* target);
+    void _datagramReceived  (const char* data, int length, const QHostAddress& sender, quint16 senderPort, QVector<MAVLinkMessageRef>& messages, QByteArray* frames);
+    void _addSessionTarget  (const QHostAddress& sender, quint16 senderPort);
+    void _clearSenders      (void);
+#ifdef QGC_UDP_BATCHED_IO
+    bool _openBatchedIO     (void);
+    void _closeBatchedIO    (void);
+    void _readBatched       (void);
+    void _writeBatched      (const QList<QByteArray>& list, const QList<const UDPCLient*>& targets);
+#endif
+
+    static quint64 _endpointKey(const QHostAddress& address, quint16 port);
 
     bool                _running;
     QUdpSocket*         _socket;
     UDPConfiguration*   _udpConfig;
     bool                _connectState;
-    QList<UDPCLient*>   _sessionTargets;
+    QHash<quint64, UDPCLient*> _sessionTargets;     ///< Keyed by _endpointKey
     QMutex              _sessionTargetsMutex;
     QList<QHostAddress> _localAddresses;
+    QHash<quint64, UDPSender_t*> _senders;
+    QMutex              _sendersMutex;          ///< senderStats is called from the main thread
+
+    static const int _maxMessageBatch = 256;    ///< Messages handed on while a busy socket is still being drained
+
+#ifdef QGC_UDP_BATCHED_IO
+    int                 _batchFd        = -1;       ///< Duplicate of the socket descriptor, read and written directly
+    QSocketNotifier*    _batchNotifier  = nullptr;
+    QByteArray          _batchBuffer;               ///< _batchCount receive buffers of _batchBufferSize bytes
+
+    static const int _batchCount        = 16;
+    static const int _batchBufferSize   = 65536;    ///< Largest possible datagram, so nothing is ever truncated
+#endif
 #if defined(QGC_ZEROCONF_ENABLED)
     DNSServiceRef       _dnssServiceRef;
 #endif
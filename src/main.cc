@@ -21,6 +21,7 @@
 #include "QGC.h"
 #include "QGCApplication.h"
 #include "AppMessages.h"
+#include "CmdLineOptParser.h"
 
 #ifndef NO_SERIAL_LINK
     #include "SerialLink.h"
@@ -28,7 +29,9 @@
 
 #ifndef __mobile__
     #include "QGCSerialPortInfo.h"
+    #include "RemoteIDFlightRecorder.h"
     #include "RunGuard.h"
+    #include "TlogColumnarExporter.h"
 #ifndef NO_SERIAL_LINK
     #include <QSerialPort>
 #endif
@@ -39,7 +42,6 @@
 #endif
 
 #ifdef QT_DEBUG
-    #include "CmdLineOptParser.h"
     #ifdef Q_OS_WIN
         #include <crtdbg.h>
     #endif
@@ -238,6 +240,34 @@ void sigHandler(int s)
 int main(int argc, char *argv[])
 {
 #ifndef __mobile__
+    // Headless exports run without the ui and alongside a running instance, so they are handled before the run guard:
+    //      --export-tlog:<a.tlog,b.tlog> [--export-dir:<dir>] [--export-fields:<MESSAGE,MESSAGE.field,...>]
+    //      --export-remoteid:<a.odid,b.odid> [--export-dir:<dir>]
+    bool    exportTlog          = false;
+    bool    exportRemoteID      = false;
+    bool    exportDirSet        = false;
+    bool    exportFieldsSet     = false;
+    QString exportTlogFiles;
+    QString exportRemoteIDFiles;
+    QString exportDir;
+    QString exportFields;
+    CmdLineOpt_t rgExportCmdLineOptions[] = {
+        { "--export-tlog",      &exportTlog,        &exportTlogFiles },
+        { "--export-remoteid",  &exportRemoteID,    &exportRemoteIDFiles },
+        { "--export-dir",       &exportDirSet,      &exportDir },
+        { "--export-fields",    &exportFieldsSet,   &exportFields },
+    };
+
+    ParseCmdLineOptions(argc, argv, rgExportCmdLineOptions, sizeof(rgExportCmdLineOptions)/sizeof(rgExportCmdLineOptions[0]), false);
+    if (exportTlog) {
+        QCoreApplication exportApp(argc, argv);
+        return TlogColumnarExporter::runCommandLine(exportTlogFiles, exportDir, exportFields);
+    }
+    if (exportRemoteID) {
+        QCoreApplication exportApp(argc, argv);
+        return RemoteIDFlightRecorder::runCommandLine(exportRemoteIDFiles, exportDir);
+    }
+
     // We make the runguard key different for custom and non custom
     // builds, so they can be executed together in the same device.
     // Stable and Daily have same QGC_APPLICATION_NAME so they would
@@ -0,0 +1,91 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinkSendSchedulerTest.h"
+#include "LinkSendScheduler.h"
+#include "QGCMAVLink.h"
+
+#include <QThread>
+
+LinkSendSchedulerTest::LinkSendSchedulerTest(void)
+{
+
+}
+
+void LinkSendSchedulerTest::_priorityTest(void)
+{
+    LinkSendScheduler   scheduler;
+    int                 waitMSecs;
+
+    QCOMPARE(LinkSendScheduler::trafficClassForMessage(MAVLINK_MSG_ID_COMMAND_LONG),       LinkSendScheduler::TrafficClassCommand);
+    QCOMPARE(LinkSendScheduler::trafficClassForMessage(MAVLINK_MSG_ID_MANUAL_CONTROL),     LinkSendScheduler::TrafficClassControl);
+    QCOMPARE(LinkSendScheduler::trafficClassForMessage(MAVLINK_MSG_ID_GPS_RTCM_DATA),      LinkSendScheduler::TrafficClassCorrections);
+    QCOMPARE(LinkSendScheduler::trafficClassForMessage(MAVLINK_MSG_ID_PARAM_SET),          LinkSendScheduler::TrafficClassDefault);
+    QCOMPARE(LinkSendScheduler::trafficClassForMessage(MAVLINK_MSG_ID_MISSION_ITEM_INT),   LinkSendScheduler::TrafficClassBulk);
+
+    // A command queued behind a mission upload goes out first, each class stays in order
+    scheduler.enqueue(LinkSendScheduler::TrafficClassBulk,      QByteArray("bulk1"));
+    scheduler.enqueue(LinkSendScheduler::TrafficClassBulk,      QByteArray("bulk2"));
+    scheduler.enqueue(LinkSendScheduler::TrafficClassDefault,   QByteArray("default"));
+    scheduler.enqueue(LinkSendScheduler::TrafficClassCommand,   QByteArray("command"));
+
+    const QList<QByteArray> sendable = scheduler.takeSendable(waitMSecs);
+    QCOMPARE(sendable, QList<QByteArray>({ "command", "default", "bulk1", "bulk2" }));
+    QCOMPARE(waitMSecs, -1);
+
+    const LinkSendScheduler::ClassStats_t bulkStats = scheduler.stats(LinkSendScheduler::TrafficClassBulk);
+    QCOMPARE(bulkStats.sentMessages,    static_cast<quint64>(2));
+    QCOMPARE(bulkStats.queuedMessages,  0);
+    QCOMPARE(bulkStats.maxQueuedBytes,  10);
+    QCOMPARE(scheduler.statsList().count(), static_cast<int>(LinkSendScheduler::TrafficClassCount));
+}
+
+void LinkSendSchedulerTest::_shapingTest(void)
+{
+    LinkSendScheduler   scheduler;
+    int                 waitMSecs;
+    const int           bytesPerSecond  = 10000;
+    const int           burstBytes      = 500;     // 50 msecs at bytesPerSecond
+
+    scheduler.setBytesPerSecond(bytesPerSecond);
+    for (int i=0; i<10; i++) {
+        scheduler.enqueue(LinkSendScheduler::TrafficClassDefault, QByteArray(100, 'x'));
+    }
+
+    // The bucket starts empty and never holds more than one burst
+    QVERIFY(scheduler.takeSendable(waitMSecs).isEmpty());
+    QVERIFY(waitMSecs > 0);
+
+    QThread::msleep(200);
+    QCOMPARE(scheduler.takeSendable(waitMSecs).count(), burstBytes / 100);
+    QVERIFY(waitMSecs > 0);
+
+    // Higher classes jump the remaining backlog
+    scheduler.enqueue(LinkSendScheduler::TrafficClassCommand, QByteArray(100, 'c'));
+    QThread::msleep(20);
+    const QList<QByteArray> sendable = scheduler.takeSendable(waitMSecs);
+    QVERIFY(!sendable.isEmpty());
+    QCOMPARE(sendable.first(), QByteArray(100, 'c'));
+}
+
+void LinkSendSchedulerTest::_overflowTest(void)
+{
+    LinkSendScheduler   scheduler;
+    const QByteArray    rtcm(MAVLINK_MAX_PACKET_LEN, 'r');
+
+    // Stale corrections are dropped oldest first rather than queueing without limit
+    for (int i=0; i<2000; i++) {
+        scheduler.enqueue(LinkSendScheduler::TrafficClassCorrections, rtcm);
+    }
+
+    const LinkSendScheduler::ClassStats_t stats = scheduler.stats(LinkSendScheduler::TrafficClassCorrections);
+    QVERIFY(stats.droppedMessages > 0);
+    QCOMPARE(stats.queuedMessages + static_cast<int>(stats.droppedMessages), 2000);
+    QVERIFY(stats.queuedBytes <= 256 * 1024);
+}
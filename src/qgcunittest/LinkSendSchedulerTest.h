@@ -0,0 +1,26 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Checks LinkSendScheduler priority order, token bucket pacing and queue limits
+class LinkSendSchedulerTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    LinkSendSchedulerTest(void);
+
+private slots:
+    void _priorityTest  (void);
+    void _shapingTest   (void);
+    void _overflowTest  (void);
+};
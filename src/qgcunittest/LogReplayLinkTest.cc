@@ -0,0 +1,236 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LogReplayLinkTest.h"
+#include "LogReplayLink.h"
+#include "TlogBuilder.h"
+#include "QGCApplication.h"
+#include "LinkManager.h"
+#include "MAVLinkProtocol.h"
+
+#include <QDir>
+#include <QSignalSpy>
+#include <QThread>
+
+LogReplayLinkTest::LogReplayLinkTest(void)
+    : _tempDir          (nullptr)
+    , _replayLink       (nullptr)
+    , _mavlinkChannel   (LinkManager::invalidMavlinkChannel())
+    , _startTimeUSecs   (0)
+    , _slowConsumer     (false)
+{
+    _resetCounts();
+}
+
+void LogReplayLinkTest::init(void)
+{
+    UnitTest::init();
+
+    _mavlinkChannel = qgcApp()->toolbox()->linkManager()->allocateMavlinkChannel();
+    QVERIFY(_mavlinkChannel != LinkManager::invalidMavlinkChannel());
+
+    _tempDir = new QTemporaryDir;
+    QVERIFY(_tempDir->isValid());
+
+    _resetCounts();
+    connect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, [this](LinkInterface* link, const MAVLinkMessageRef& message) {
+        if (link != _replayLink) {
+            return;
+        }
+        if (message->msgid == MAVLINK_MSG_ID_ATTITUDE) {
+            _attitudeCount++;
+            _lastAttitudeTimeBootMSecs = mavlink_msg_attitude_get_time_boot_ms(&*message);
+        } else if (message->msgid == MAVLINK_MSG_ID_VFR_HUD) {
+            _vfrHudCount++;
+        }
+        if (_slowConsumer) {
+            // Keeps the main thread behind the link thread so the batch backpressure kicks in
+            QThread::usleep(20);
+        }
+    });
+}
+
+void LogReplayLinkTest::cleanup(void)
+{
+    disconnect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, nullptr);
+    if (_replayLink) {
+        qgcApp()->toolbox()->linkManager()->disconnectAll();
+        _replayLink = nullptr;
+    }
+
+    delete _tempDir;
+    _tempDir = nullptr;
+
+    qgcApp()->toolbox()->linkManager()->freeMavlinkChannel(_mavlinkChannel);
+    _mavlinkChannel = LinkManager::invalidMavlinkChannel();
+    _slowConsumer = false;
+
+    UnitTest::cleanup();
+}
+
+void LogReplayLinkTest::_resetCounts(void)
+{
+    _attitudeCount  = 0;
+    _vfrHudCount    = 0;
+    _pausedCount    = 0;
+    _atEndCount     = 0;
+    _lastAttitudeTimeBootMSecs = 0;
+}
+
+/// Alternates ATTITUDE and VFR_HUD records, 1 msec apart
+QString LogReplayLinkTest::_writeTlog(void)
+{
+    TlogBuilder builder;
+
+    mavlink_get_channel_status(_mavlinkChannel)->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    _startTimeUSecs = TlogBuilder::pastStartTimeUSecs();
+
+    for (int i=0; i<_recordCount; i++) {
+        mavlink_message_t message;
+
+        if (i % 2 == 0) {
+            mavlink_msg_attitude_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _mavlinkChannel, &message, static_cast<uint32_t>(i), 0.1f, 0.2f, 0.3f, 0, 0, 0);
+        } else {
+            mavlink_msg_vfr_hud_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _mavlinkChannel, &message, 10.0f, 10.0f, 90, 50, 100.0f, 0);
+        }
+        builder.append(_startTimeUSecs + i * _recordIntervalUSecs, message);
+    }
+
+    const QString tlogFile = QDir(_tempDir->path()).filePath(QStringLiteral("replay.tlog"));
+    return builder.save(tlogFile) ? tlogFile : QString();
+}
+
+/// Playback starts by itself once the log is loaded. This pauses it and moves back to the start of the log, so the
+/// test can set up playback the way it wants before calling play.
+LogReplayLink* LogReplayLinkTest::_startPausedReplay(const QString& tlogFile)
+{
+    _replayLink = qgcApp()->toolbox()->linkManager()->startLogReplay(tlogFile);
+    if (!_replayLink) {
+        return nullptr;
+    }
+    connect(_replayLink, &LogReplayLink::playbackPaused, this, [this]() { _pausedCount++; });
+    connect(_replayLink, &LogReplayLink::playbackAtEnd,  this, [this]() { _atEndCount++; });
+
+    _replayLink->pause();
+    if (!QTest::qWaitFor([this]() { return _pausedCount > 0; }, 5000)) {
+        return nullptr;
+    }
+    _replayLink->movePlayhead(0);
+
+    _resetCounts();
+    return _replayLink;
+}
+
+void LogReplayLinkTest::_messageFilterTest(void)
+{
+    const QString tlogFile = _writeTlog();
+    QVERIFY(!tlogFile.isEmpty());
+
+    LogReplayLink* replayLink = _startPausedReplay(tlogFile);
+    QVERIFY(replayLink);
+
+    // Only ATTITUDE is replayed, straight from the index offsets
+    replayLink->setMessageFilter({ MAVLINK_MSG_ID_ATTITUDE });
+    replayLink->setUnthrottled(true);
+    replayLink->play();
+    QVERIFY(QTest::qWaitFor([this]() { return _atEndCount > 0; }, 10000));
+
+    QCOMPARE(_attitudeCount,    _recordCount / 2);
+    QCOMPARE(_vfrHudCount,      0);
+}
+
+void LogReplayLinkTest::_unthrottledReplayTest(void)
+{
+    const QString tlogFile = _writeTlog();
+    QVERIFY(!tlogFile.isEmpty());
+
+    LogReplayLink* replayLink = _startPausedReplay(tlogFile);
+    QVERIFY(replayLink);
+
+    // A batch is in flight from the time it is handed on until the main thread has processed it
+    _batchesSent        = 0;
+    _batchesConsumed    = 0;
+    _maxBatchesInFlight = 0;
+    connect(replayLink, &LogReplayLink::bytesReceived, this, [this]() {
+        const int batchesInFlight = ++_batchesSent - _batchesConsumed;
+        if (batchesInFlight > _maxBatchesInFlight) {
+            _maxBatchesInFlight = batchesInFlight;
+        }
+    }, Qt::DirectConnection);
+    connect(replayLink, &LogReplayLink::_batchConsumed, this, [this]() { _batchesConsumed++; }, Qt::DirectConnection);
+
+    _slowConsumer = true;
+    replayLink->setUnthrottled(true);
+    replayLink->play();
+    QVERIFY(QTest::qWaitFor([this]() { return _atEndCount > 0; }, 10000));
+
+    QCOMPARE(_attitudeCount,    _recordCount / 2);
+    QCOMPARE(_vfrHudCount,      _recordCount / 2);
+    QVERIFY(_batchesSent > 1);
+    QVERIFY(_maxBatchesInFlight > 0);
+    QVERIFY(_maxBatchesInFlight <= static_cast<int>(LogReplayLink::maxBatchesInFlight));
+}
+
+void LogReplayLinkTest::_pauseAtLogTimeTest(void)
+{
+    const QString tlogFile = _writeTlog();
+    QVERIFY(!tlogFile.isEmpty());
+
+    LogReplayLink* replayLink = _startPausedReplay(tlogFile);
+    QVERIFY(replayLink);
+
+    // Pause time falls between two records, so playback stops before the first record after it
+    const int pauseRecord = 1001;
+    QSignalSpy pauseReachedSpy(replayLink, &LogReplayLink::pauseAtLogTimeReached);
+    replayLink->setPauseAtLogTime(_startTimeUSecs + pauseRecord * _recordIntervalUSecs - (_recordIntervalUSecs / 2));
+    replayLink->setUnthrottled(true);
+    replayLink->play();
+    QVERIFY(QTest::qWaitFor([this]() { return _pausedCount > 0; }, 10000));
+
+    QCOMPARE(pauseReachedSpy.count(),   1);
+    QCOMPARE(_atEndCount,               0);
+    QCOMPARE(_attitudeCount + _vfrHudCount, pauseRecord);
+    QCOMPARE(_lastAttitudeTimeBootMSecs, static_cast<uint32_t>(pauseRecord - 1));
+
+    // The pause time is cleared once reached, so playback runs on to the end
+    _resetCounts();
+    replayLink->play();
+    QVERIFY(QTest::qWaitFor([this]() { return _atEndCount > 0; }, 10000));
+    QCOMPARE(_attitudeCount + _vfrHudCount, _recordCount - pauseRecord);
+    QCOMPARE(pauseReachedSpy.count(), 1);
+}
+
+void LogReplayLinkTest::_pauseAtSecsTest(void)
+{
+    const QString tlogFile = _writeTlog();
+    QVERIFY(!tlogFile.isEmpty());
+
+    LogReplayLink* replayLink = _startPausedReplay(tlogFile);
+    QVERIFY(replayLink);
+
+    LogReplayLinkController controller;
+    QSignalSpy pauseAtSecsSpy(&controller, &LogReplayLinkController::pauseAtSecsChanged);
+
+    controller.setLink(replayLink);
+    controller.setPauseAtSecs(1);
+    QCOMPARE(controller.pauseAtSecs(), 1);
+    replayLink->setUnthrottled(true);
+    replayLink->play();
+    QVERIFY(QTest::qWaitFor([this]() { return _pausedCount > 0; }, 10000));
+
+    // One second into the log is exactly on a record, which is the first one not played
+    const int pauseRecord = static_cast<int>(1000000 / _recordIntervalUSecs);
+    QCOMPARE(_attitudeCount + _vfrHudCount, pauseRecord);
+
+    // Once reached the controller goes back to no pause time
+    QVERIFY(QTest::qWaitFor([&controller]() { return controller.pauseAtSecs() == 0; }, 5000));
+    QCOMPARE(pauseAtSecsSpy.count(), 2);
+
+    controller.setLink(nullptr);
+}
@@ -0,0 +1,63 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "QGCMAVLink.h"
+
+#include <QTemporaryDir>
+
+#include <atomic>
+
+class LogReplayLink;
+
+/// Replays a synthetic tlog through LogReplayLink and MAVLinkProtocol. The log has no heartbeats, so no vehicle is
+/// created and the replayed messages are counted straight off MAVLinkProtocol::messageReceived.
+class LogReplayLinkTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    LogReplayLinkTest(void);
+
+protected:
+    void init   (void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _messageFilterTest     (void);
+    void _unthrottledReplayTest (void);
+    void _pauseAtLogTimeTest    (void);
+    void _pauseAtSecsTest       (void);
+
+private:
+    QString         _writeTlog          (void);
+    LogReplayLink*  _startPausedReplay  (const QString& tlogFile);
+    void            _resetCounts        (void);
+
+    QTemporaryDir*  _tempDir;
+    LogReplayLink*  _replayLink;
+    uint8_t         _mavlinkChannel;
+    quint64         _startTimeUSecs;
+    int             _attitudeCount;
+    int             _vfrHudCount;
+    int             _pausedCount;
+    int             _atEndCount;
+    uint32_t        _lastAttitudeTimeBootMSecs;
+    bool            _slowConsumer;
+
+    // Unthrottled batches, bytesReceived is counted on the link thread
+    std::atomic<int> _batchesSent       { 0 };
+    std::atomic<int> _batchesConsumed   { 0 };
+    std::atomic<int> _maxBatchesInFlight{ 0 };
+
+    static const int        _recordCount            = 2000;
+    static const quint64    _recordIntervalUSecs    = 1000;
+};
@@ -0,0 +1,317 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkFrameScannerTest.h"
+#include "MAVLinkFrameScanner.h"
+#include "TlogBuilder.h"
+#include "QGCApplication.h"
+#include "LinkManager.h"
+
+#include <QFile>
+
+const char* MAVLinkFrameScannerTest::_benchmarkEnvVar = "QGC_BENCHMARK_TLOG";
+
+MAVLinkFrameScannerTest::MAVLinkFrameScannerTest(void)
+    : _mavlinkChannel(LinkManager::invalidMavlinkChannel())
+{
+
+}
+
+void MAVLinkFrameScannerTest::init(void)
+{
+    UnitTest::init();
+
+    _mavlinkChannel = qgcApp()->toolbox()->linkManager()->allocateMavlinkChannel();
+    QVERIFY(_mavlinkChannel != LinkManager::invalidMavlinkChannel());
+}
+
+void MAVLinkFrameScannerTest::cleanup(void)
+{
+    qgcApp()->toolbox()->linkManager()->freeMavlinkChannel(_mavlinkChannel);
+    _mavlinkChannel = LinkManager::invalidMavlinkChannel();
+
+    UnitTest::cleanup();
+}
+
+/// Builds a stream of typical telemetry. Every fifth message is sent as mavlink 1 and the zero filled v2 payloads are
+/// truncated on the wire, so both framings and short payloads are covered.
+QByteArray MAVLinkFrameScannerTest::_buildStream(int messageCount, QList<mavlink_message_t>& messages)
+{
+    QByteArray          stream;
+    mavlink_status_t*   mavlinkStatus = mavlink_get_channel_status(_mavlinkChannel);
+
+    for (int i=0; i<messageCount; i++) {
+        mavlink_message_t message;
+
+        if (i % 5 == 4) {
+            mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        } else {
+            mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        }
+
+        switch (i % 4) {
+        case 0:
+        {
+            mavlink_heartbeat_t heartbeat = {};
+            heartbeat.type          = MAV_TYPE_QUADROTOR;
+            heartbeat.autopilot     = MAV_AUTOPILOT_PX4;
+            heartbeat.system_status = MAV_STATE_ACTIVE;
+            mavlink_msg_heartbeat_encode_chan(1, MAV_COMP_ID_AUTOPILOT1, _mavlinkChannel, &message, &heartbeat);
+        }
+            break;
+        case 1:
+        {
+            mavlink_attitude_t attitude = {};
+            attitude.time_boot_ms   = static_cast<uint32_t>(i * 20);
+            attitude.roll           = 0.1f * i;
+            attitude.pitch          = -0.05f * i;
+            attitude.yaw            = 1.5f;
+            mavlink_msg_attitude_encode_chan(1, MAV_COMP_ID_AUTOPILOT1, _mavlinkChannel, &message, &attitude);
+        }
+            break;
+        case 2:
+        {
+            mavlink_gps_raw_int_t gpsRaw = {};
+            gpsRaw.time_usec            = static_cast<uint64_t>(i) * 200000;
+            gpsRaw.lat                  = 473977418 + i;
+            gpsRaw.lon                  = 85455939 - i;
+            gpsRaw.satellites_visible   = 12;
+            gpsRaw.fix_type             = GPS_FIX_TYPE_3D_FIX;
+            mavlink_msg_gps_raw_int_encode_chan(1, MAV_COMP_ID_AUTOPILOT1, _mavlinkChannel, &message, &gpsRaw);
+        }
+            break;
+        default:
+        {
+            mavlink_sys_status_t sysStatus = {};
+            sysStatus.voltage_battery   = 12600;
+            sysStatus.battery_remaining = 80;
+            mavlink_msg_sys_status_encode_chan(2, MAV_COMP_ID_AUTOPILOT1, _mavlinkChannel, &message, &sysStatus);
+        }
+            break;
+        }
+
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        int     length = mavlink_msg_to_send_buffer(buffer, &message);
+        stream.append(reinterpret_cast<const char*>(buffer), length);
+        messages.append(message);
+    }
+
+    return stream;
+}
+
+/// Same layout as a tlog written by MAVLinkProtocol: big endian usec timestamp followed by the frame
+QByteArray MAVLinkFrameScannerTest::_buildTlog(int messageCount)
+{
+    TlogBuilder                 builder;
+    QList<mavlink_message_t>    messages;
+    quint64                     timestamp = TlogBuilder::pastStartTimeUSecs();
+
+    _buildStream(messageCount, messages);
+
+    for (const mavlink_message_t& message: messages) {
+        builder.append(timestamp, message);
+        timestamp += 5000;
+    }
+
+    return builder.tlog();
+}
+
+void MAVLinkFrameScannerTest::_compareMessages(const mavlink_message_t& expected, const mavlink_message_t& actual)
+{
+    QCOMPARE(actual.magic,          expected.magic);
+    QCOMPARE(actual.len,            expected.len);
+    QCOMPARE(actual.seq,            expected.seq);
+    QCOMPARE(actual.sysid,          expected.sysid);
+    QCOMPARE(actual.compid,         expected.compid);
+    // msgid is a bit field and checksum is packed, neither can be bound to the references QCOMPARE takes
+    QCOMPARE(static_cast<uint32_t>(actual.msgid),       static_cast<uint32_t>(expected.msgid));
+    QCOMPARE(static_cast<uint16_t>(actual.checksum),    static_cast<uint16_t>(expected.checksum));
+    QCOMPARE(memcmp(_MAV_PAYLOAD(&actual), _MAV_PAYLOAD(&expected), expected.len), 0);
+}
+
+void MAVLinkFrameScannerTest::_chunkedStreamTest(void)
+{
+    QList<mavlink_message_t>    sent;
+    QByteArray                  stream = _buildStream(200, sent);
+
+    // Chunk sizes range from a byte at a time, as a slow serial link can deliver it, up to the whole stream at once
+    for (int chunkSize: { 1, 3, 17, 256, stream.size() }) {
+        MAVLinkFrameScanner         scanner;
+        QList<mavlink_message_t>    received;
+
+        for (int offset=0; offset<stream.size(); offset+=chunkSize) {
+            scanner.scan(stream.mid(offset, chunkSize), [&received](const MAVLinkFrameScanner::Frame_t& frame) {
+                mavlink_message_t message;
+                MAVLinkFrameScanner::decode(frame, message);
+                received.append(message);
+            });
+        }
+
+        QCOMPARE(received.count(), sent.count());
+        for (int i=0; i<sent.count(); i++) {
+            _compareMessages(sent[i], received[i]);
+        }
+        QCOMPARE(scanner.crcErrorCount(),       static_cast<quint64>(0));
+        QCOMPARE(scanner.droppedByteCount(),    static_cast<quint64>(0));
+    }
+}
+
+void MAVLinkFrameScannerTest::_resyncTest(void)
+{
+    QList<mavlink_message_t>    sent;
+    QByteArray                  stream = _buildStream(3, sent);
+    int                         firstLength = mavlink_msg_get_send_buffer_length(&sent[0]);
+
+    // Noise containing start markers in front, a corrupted copy of the first frame in the middle, and a v2 start marker
+    // claiming a long payload which would swallow the last frame if the scan did not restart after it
+    QByteArray corrupted = stream.left(firstLength);
+    corrupted[firstLength - 3] = static_cast<char>(corrupted[firstLength - 3] ^ 0xFF);
+
+    QByteArray noisy;
+    noisy.append(QByteArray::fromHex("00fe05fd0101"));
+    noisy.append(stream.left(firstLength));
+    noisy.append(corrupted);
+    noisy.append(QByteArray::fromHex("fd1000"));
+    noisy.append(stream.mid(firstLength));
+
+    // The bad frames also have to be recovered from when they are split across buffers
+    for (int chunkSize: { 1, 2, 5, noisy.size() }) {
+        MAVLinkFrameScanner         scanner;
+        QList<mavlink_message_t>    received;
+
+        for (int offset=0; offset<noisy.size(); offset+=chunkSize) {
+            scanner.scan(noisy.mid(offset, chunkSize), [&received](const MAVLinkFrameScanner::Frame_t& frame) {
+                mavlink_message_t message;
+                MAVLinkFrameScanner::decode(frame, message);
+                received.append(message);
+            });
+        }
+
+        QCOMPARE(received.count(), sent.count());
+        for (int i=0; i<sent.count(); i++) {
+            _compareMessages(sent[i], received[i]);
+        }
+        QVERIFY(scanner.crcErrorCount() > 0);
+    }
+}
+
+void MAVLinkFrameScannerTest::_splitFrameTest(void)
+{
+    QList<mavlink_message_t>    sent;
+    QByteArray                  stream = _buildStream(200, sent);
+    MAVLinkFrameScanner         scanner;
+    int                         frameCount      = 0;
+    int                         copiedCount     = 0;
+    int                         splitCount      = 0;
+    int                         frameStart      = 0;
+
+    // Read boundaries which never line up with the frames, as on a serial link
+    const int chunkSize = 61;
+    for (int offset=0; offset<stream.size(); offset+=chunkSize) {
+        const QByteArray    chunk       = stream.mid(offset, chunkSize);
+        const uint8_t*      chunkData   = reinterpret_cast<const uint8_t*>(chunk.constData());
+
+        scanner.scan(chunk, [&](const MAVLinkFrameScanner::Frame_t& frame) {
+            if (frameStart < offset) {
+                splitCount++;
+            }
+            if (frame.data < chunkData || frame.data >= chunkData + chunk.size()) {
+                copiedCount++;
+            }
+            frameStart += frame.length;
+            frameCount++;
+        });
+    }
+
+    // Only the frames which straddle a read boundary come from a copy
+    QCOMPARE(frameCount,    sent.count());
+    QVERIFY(splitCount > 0);
+    QCOMPARE(copiedCount,   splitCount);
+}
+
+int MAVLinkFrameScannerTest::_parseCharCount(const QByteArray& bytes, int chunkSize)
+{
+    int                 count = 0;
+    mavlink_message_t   message;
+    mavlink_status_t    status;
+
+    mavlink_reset_channel_status(_mavlinkChannel);
+
+    for (int offset=0; offset<bytes.size(); offset+=chunkSize) {
+        int end = qMin(offset + chunkSize, bytes.size());
+        for (int position=offset; position<end; position++) {
+            if (mavlink_parse_char(_mavlinkChannel, static_cast<uint8_t>(bytes[position]), &message, &status)) {
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
+int MAVLinkFrameScannerTest::_scannerCount(const QByteArray& bytes, int chunkSize)
+{
+    int                 count = 0;
+    mavlink_message_t   message;
+    MAVLinkFrameScanner scanner;
+    const uint8_t*      data = reinterpret_cast<const uint8_t*>(bytes.constData());
+
+    for (int offset=0; offset<bytes.size(); offset+=chunkSize) {
+        scanner.scan(data + offset, qMin(chunkSize, bytes.size() - offset), [&count, &message](const MAVLinkFrameScanner::Frame_t& frame) {
+            MAVLinkFrameScanner::decode(frame, message);
+            count++;
+        });
+    }
+
+    return count;
+}
+
+void MAVLinkFrameScannerTest::_tlogBenchmark_data(void)
+{
+    QTest::addColumn<bool>("scanner");
+
+    QTest::newRow("mavlink_parse_char")     << false;
+    QTest::newRow("MAVLinkFrameScanner")    << true;
+}
+
+void MAVLinkFrameScannerTest::_tlogBenchmark(void)
+{
+    QFETCH(bool, scanner);
+
+    if (!qEnvironmentVariableIsSet(_benchmarkEnvVar)) {
+        QSKIP("Set QGC_BENCHMARK_TLOG to run");
+    }
+
+    QByteArray  tlog;
+    QString     tlogFile = qEnvironmentVariable(_benchmarkEnvVar);
+
+    if (QFile::exists(tlogFile)) {
+        QFile file(tlogFile);
+        QVERIFY2(file.open(QIODevice::ReadOnly), qPrintable(file.errorString()));
+        tlog = file.readAll();
+    } else {
+        tlog = _buildTlog(50000);
+    }
+
+    // The timestamps in front of each frame are noise as far as both parsers are concerned, which is also a reasonable
+    // stand in for the line noise on a real link.
+    // A false start marker in a timestamp can make mavlink_parse_char swallow the frame behind it, the scanner recovers it
+    const int parseCharMessages = _parseCharCount(tlog, _benchmarkChunkSize);
+    const int scannerMessages   = _scannerCount(tlog, _benchmarkChunkSize);
+    QVERIFY(scannerMessages >= parseCharMessages);
+    QVERIFY(scannerMessages > 0);
+
+    QBENCHMARK {
+        if (scanner) {
+            _scannerCount(tlog, _benchmarkChunkSize);
+        } else {
+            _parseCharCount(tlog, _benchmarkChunkSize);
+        }
+    }
+}
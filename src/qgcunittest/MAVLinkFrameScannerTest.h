@@ -0,0 +1,46 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "QGCMAVLink.h"
+
+/// Checks MAVLinkFrameScanner against mavlink_parse_char and benchmarks the two on a tlog. The benchmark only runs with
+/// QGC_BENCHMARK_TLOG set. Point it at a recorded tlog to benchmark with real traffic, otherwise a synthetic tlog is used.
+class MAVLinkFrameScannerTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MAVLinkFrameScannerTest(void);
+
+protected:
+    void init   (void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _chunkedStreamTest (void);
+    void _resyncTest        (void);
+    void _splitFrameTest    (void);
+    void _tlogBenchmark_data(void);
+    void _tlogBenchmark     (void);
+
+private:
+    QByteArray  _buildStream        (int messageCount, QList<mavlink_message_t>& messages);
+    QByteArray  _buildTlog          (int messageCount);
+    int         _parseCharCount     (const QByteArray& bytes, int chunkSize);
+    int         _scannerCount       (const QByteArray& bytes, int chunkSize);
+    void        _compareMessages    (const mavlink_message_t& expected, const mavlink_message_t& actual);
+
+    uint8_t _mavlinkChannel;
+
+    static const int    _benchmarkChunkSize = 1024;     ///< Typical size of a single link read
+    static const char*  _benchmarkEnvVar;
+};
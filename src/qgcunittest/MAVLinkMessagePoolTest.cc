@@ -0,0 +1,112 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkMessagePoolTest.h"
+#include "MAVLinkMessagePool.h"
+
+#include <QSemaphore>
+#include <QThread>
+
+MAVLinkMessagePoolTest::MAVLinkMessagePoolTest(void)
+{
+
+}
+
+void MAVLinkMessagePoolTest::_shareTest(void)
+{
+    MAVLinkMessageRef message = MAVLinkMessageRef::create();
+    message.mutableMessage().msgid = MAVLINK_MSG_ID_ATTITUDE;
+    QCOMPARE(message.refCount(), 1);
+
+    // Copies share the message, changes are seen through every handle
+    MAVLinkMessageRef copy = message;
+    QCOMPARE(message.refCount(), 2);
+    copy.mutableMessage().sysid = 42;
+    QCOMPARE(static_cast<int>(message->sysid), 42);
+
+    // A clone is a separate message
+    MAVLinkMessageRef clone = message.clone();
+    QCOMPARE(clone.refCount(), 1);
+    QCOMPARE(clone->msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_ATTITUDE));
+    clone.mutableMessage().sysid = 7;
+    QCOMPARE(static_cast<int>(message->sysid), 42);
+
+    copy = MAVLinkMessageRef();
+    QVERIFY(copy.isNull());
+    QCOMPARE(message.refCount(), 1);
+
+    MAVLinkMessageRef moved = std::move(message);
+    QVERIFY(message.isNull());
+    QCOMPARE(moved.refCount(), 1);
+}
+
+void MAVLinkMessagePoolTest::_recycleTest(void)
+{
+    QVector<MAVLinkMessageRef> messages;
+
+    // Fill the pool, after that a steady stream of messages must not touch the heap
+    for (int i=0; i<_messageCount; i++) {
+        messages.append(MAVLinkMessageRef::create());
+    }
+    messages.clear();
+    QVERIFY(MAVLinkMessagePool::freeCount() >= _messageCount);
+
+    const quint64 heapAllocationCount = MAVLinkMessagePool::heapAllocationCount();
+    for (int pass=0; pass<10; pass++) {
+        for (int i=0; i<_messageCount; i++) {
+            messages.append(MAVLinkMessageRef::create());
+        }
+        QVector<MAVLinkMessageRef> handlerCopies = messages;
+        messages.clear();
+    }
+    QCOMPARE(MAVLinkMessagePool::heapAllocationCount(), heapAllocationCount);
+}
+
+void MAVLinkMessagePoolTest::_crossThreadTest(void)
+{
+    QVector<MAVLinkMessageRef>  messages;
+    MAVLinkMessageRef           outstandingMessage;
+    QSemaphore                  created;
+    QSemaphore                  released;
+    quint64                     secondPassAllocationCount = 0;
+
+    // Messages are created on a link style thread and dropped on this one
+    QThread* thread = QThread::create([&]() {
+        for (int i=0; i<_messageCount; i++) {
+            messages.append(MAVLinkMessageRef::create());
+        }
+        created.release();
+        released.acquire();
+
+        const quint64 heapAllocationCount = MAVLinkMessagePool::heapAllocationCount();
+        for (int i=0; i<_messageCount; i++) {
+            messages.append(MAVLinkMessageRef::create());
+        }
+        secondPassAllocationCount = MAVLinkMessagePool::heapAllocationCount() - heapAllocationCount;
+
+        outstandingMessage = MAVLinkMessageRef::create();
+        outstandingMessage.mutableMessage().msgid = MAVLINK_MSG_ID_HEARTBEAT;
+    });
+
+    thread->start();
+    created.acquire();
+    messages.clear();
+    released.release();
+    QVERIFY(thread->wait(10000));
+    delete thread;
+
+    // The second pass reused what came back from this thread
+    QCOMPARE(secondPassAllocationCount, static_cast<quint64>(0));
+    QCOMPARE(messages.count(), static_cast<int>(_messageCount));
+
+    // The pool of the finished thread stays around until its last message comes back
+    messages.clear();
+    QCOMPARE(outstandingMessage->msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_HEARTBEAT));
+    outstandingMessage = MAVLinkMessageRef();
+}
@@ -0,0 +1,29 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Checks that MAVLinkMessageRef shares and recycles messages instead of allocating, on one thread and across threads
+class MAVLinkMessagePoolTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MAVLinkMessagePoolTest(void);
+
+private slots:
+    void _shareTest         (void);
+    void _recycleTest       (void);
+    void _crossThreadTest   (void);
+
+private:
+    static const int _messageCount = 500;
+};
@@ -0,0 +1,201 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkRouterTest.h"
+#include "QGCApplication.h"
+#include "LinkManager.h"
+#include "UDPLink.h"
+
+#include <QUdpSocket>
+
+MAVLinkRouterTest::MAVLinkRouterTest(void)
+    : _mavlinkChannel(LinkManager::invalidMavlinkChannel())
+{
+
+}
+
+void MAVLinkRouterTest::init(void)
+{
+    UnitTest::init();
+
+    LinkManager* linkManager = qgcApp()->toolbox()->linkManager();
+
+    _mavlinkChannel = linkManager->allocateMavlinkChannel();
+    QVERIFY(_mavlinkChannel != LinkManager::invalidMavlinkChannel());
+
+    _receiver = new QUdpSocket(this);
+    QVERIFY(_receiver->bind(QHostAddress::LocalHost));
+
+    UDPConfiguration* udpConfig = new UDPConfiguration(QStringLiteral("MAVLinkRouterTest"));
+    udpConfig->setLocalPort(_linkPort);
+    udpConfig->addHost(QStringLiteral("127.0.0.1"), _receiver->localPort());
+    SharedLinkConfigurationPtr config = linkManager->addConfiguration(udpConfig);
+    QVERIFY(linkManager->createConnectedLink(config));
+    _outputLink = linkManager->sharedLinkInterfacePointerForLink(config->link());
+    QVERIFY(_outputLink);
+    QVERIFY(QTest::qWaitFor([this]() { return _outputLink->isConnected(); }, 5000));
+}
+
+void MAVLinkRouterTest::cleanup(void)
+{
+    if (_outputLink) {
+        _outputLink->disconnect();
+        _outputLink.reset();
+    }
+    delete _receiver;
+    _receiver = nullptr;
+
+    qgcApp()->toolbox()->linkManager()->freeMavlinkChannel(_mavlinkChannel);
+    _mavlinkChannel = LinkManager::invalidMavlinkChannel();
+
+    UnitTest::cleanup();
+}
+
+QByteArray MAVLinkRouterTest::_encode(uint8_t sysid, uint32_t msgid)
+{
+    mavlink_message_t   message;
+    uint8_t             buffer[MAVLINK_MAX_PACKET_LEN];
+
+    if (msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        mavlink_heartbeat_t heartbeat = {};
+        heartbeat.type      = MAV_TYPE_QUADROTOR;
+        heartbeat.autopilot = MAV_AUTOPILOT_PX4;
+        mavlink_msg_heartbeat_encode_chan(sysid, MAV_COMP_ID_AUTOPILOT1, _mavlinkChannel, &message, &heartbeat);
+    } else {
+        mavlink_attitude_t attitude = {};
+        attitude.roll = 0.5f;
+        mavlink_msg_attitude_encode_chan(sysid, MAV_COMP_ID_AUTOPILOT1, _mavlinkChannel, &message, &attitude);
+    }
+
+    return QByteArray(reinterpret_cast<const char*>(buffer), mavlink_msg_to_send_buffer(buffer, &message));
+}
+
+/// Routes frames the same way a link does after framing them
+void MAVLinkRouterTest::_route(MAVLinkRouter& router, LinkInterface* source, const QList<QByteArray>& frames)
+{
+    MAVLinkFrameScanner         scanner;
+    QVector<MAVLinkMessageRef>  messages;
+    QByteArray                  rawFrames;
+
+    for (const QByteArray& frame : frames) {
+        scanner.scan(frame, [&messages, &rawFrames](const MAVLinkFrameScanner::Frame_t& scannedFrame) {
+            MAVLinkMessageRef message = MAVLinkMessageRef::create();
+            MAVLinkFrameScanner::decode(scannedFrame, message.mutableMessage());
+            QCOMPARE(MAVLinkRouter::frameLength(*message), scannedFrame.length);
+            messages.append(message);
+            rawFrames.append(reinterpret_cast<const char*>(scannedFrame.data), scannedFrame.length);
+        });
+    }
+    QCOMPARE(messages.count(), frames.count());
+
+    router.route(source, messages, rawFrames);
+}
+
+/// Collects forwarded frames, skipping the GCS heartbeats which are also sent on the output link
+QList<QByteArray> MAVLinkRouterTest::_receiveFrames(int expectedCount)
+{
+    QList<QByteArray>   received;
+    const int           gcsSystemId = qgcApp()->toolbox()->mavlinkProtocol()->getSystemId();
+
+    auto receive = [this, &received, gcsSystemId, expectedCount]() {
+        while (_receiver->hasPendingDatagrams()) {
+            QByteArray datagram(static_cast<int>(_receiver->pendingDatagramSize()), 0);
+            _receiver->readDatagram(datagram.data(), datagram.size());
+
+            MAVLinkFrameScanner scanner;
+            scanner.scan(datagram, [&received, gcsSystemId](const MAVLinkFrameScanner::Frame_t& frame) {
+                mavlink_message_t message;
+                MAVLinkFrameScanner::decode(frame, message);
+                if (message.sysid != gcsSystemId) {
+                    received.append(QByteArray(reinterpret_cast<const char*>(frame.data), frame.length));
+                }
+            });
+        }
+        return received.count() >= expectedCount;
+    };
+
+    QTest::qWaitFor(receive, 2000);
+    // Anything more would have to arrive well within this
+    QTest::qWait(200);
+    receive();
+
+    return received;
+}
+
+int MAVLinkRouterTest::_outputStat(MAVLinkRouter& router, const char* name)
+{
+    const QVariantList outputStats = router.outputStats();
+    return outputStats.isEmpty() ? -1 : outputStats[0].toMap()[QString(name)].toInt();
+}
+
+void MAVLinkRouterTest::_filterTest(void)
+{
+    MAVLinkRouter           router;
+    MAVLinkRouter::Rules_t  rules;
+
+    rules.allowedSysids = { 1 };
+    rules.deniedMsgids  = { MAVLINK_MSG_ID_ATTITUDE };
+    router.setOutput(_outputLink, rules);
+    QVERIFY(router.isActive());
+
+    const QByteArray heartbeat1 = _encode(1, MAVLINK_MSG_ID_HEARTBEAT);
+    const QByteArray heartbeat2 = _encode(2, MAVLINK_MSG_ID_HEARTBEAT);
+    _route(router, nullptr, { heartbeat1, _encode(1, MAVLINK_MSG_ID_ATTITUDE), heartbeat2 });
+
+    // The frame goes out byte for byte as it came in
+    const QList<QByteArray> received = _receiveFrames(1);
+    QCOMPARE(received.count(), 1);
+    QCOMPARE(received[0], heartbeat1);
+    QCOMPARE(_outputStat(router, "forwarded"), 1);
+    QCOMPARE(_outputStat(router, "filtered"), 2);
+}
+
+void MAVLinkRouterTest::_rateCapTest(void)
+{
+    MAVLinkRouter           router;
+    MAVLinkRouter::Rules_t  rules;
+
+    rules.maxRateHz = 1;
+    router.setOutput(_outputLink, rules);
+
+    // Each sysid/compid/msgid stream is capped on its own
+    QList<QByteArray> frames;
+    for (int i=0; i<10; i++) {
+        frames.append(_encode(1, MAVLINK_MSG_ID_ATTITUDE));
+    }
+    frames.append(_encode(1, MAVLINK_MSG_ID_HEARTBEAT));
+    _route(router, nullptr, frames);
+
+    QCOMPARE(_receiveFrames(2).count(), 2);
+    QCOMPARE(_outputStat(router, "forwarded"), 2);
+    QCOMPARE(_outputStat(router, "rateLimited"), 9);
+}
+
+void MAVLinkRouterTest::_sourceTest(void)
+{
+    MAVLinkRouter router;
+
+    router.setOutput(_outputLink, MAVLinkRouter::Rules_t());
+
+    // Never back out on the link the messages arrived on
+    _route(router, _outputLink.get(), { _encode(1, MAVLINK_MSG_ID_HEARTBEAT) });
+    QCOMPARE(_receiveFrames(0).count(), 0);
+
+    router.removeOutput(_outputLink.get());
+    QVERIFY(!router.isActive());
+}
+
+void MAVLinkRouterTest::_parseIdListTest(void)
+{
+    // Rules from the settings are typed in by hand
+    QCOMPARE(MAVLinkRouter::parseIdList(QString()), QSet<int>());
+    QCOMPARE(MAVLinkRouter::parseIdList(QStringLiteral("1")), QSet<int>({ 1 }));
+    QCOMPARE(MAVLinkRouter::parseIdList(QStringLiteral(" 1, 2,,255 ")), QSet<int>({ 1, 2, 255 }));
+    QCOMPARE(MAVLinkRouter::parseIdList(QStringLiteral("30,abc,33")), QSet<int>({ 30, 33 }));
+}
@@ -0,0 +1,49 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "QGCMAVLink.h"
+#include "LinkInterface.h"
+#include "MAVLinkRouter.h"
+
+class QUdpSocket;
+
+/// Checks MAVLinkRouter filtering, rate caps and that frames are forwarded unchanged. The output is a UDP link which
+/// targets a local socket.
+class MAVLinkRouterTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MAVLinkRouterTest(void);
+
+protected:
+    void init   (void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _filterTest    (void);
+    void _rateCapTest   (void);
+    void _sourceTest    (void);
+    void _parseIdListTest(void);
+
+private:
+    QByteArray          _encode         (uint8_t sysid, uint32_t msgid);
+    void                _route          (MAVLinkRouter& router, LinkInterface* source, const QList<QByteArray>& frames);
+    QList<QByteArray>   _receiveFrames  (int expectedCount);
+    int                 _outputStat     (MAVLinkRouter& router, const char* name);
+
+    uint8_t                 _mavlinkChannel;
+    SharedLinkInterfacePtr  _outputLink;
+    QUdpSocket*             _receiver = nullptr;
+
+    static const quint16 _linkPort = 14592;
+};
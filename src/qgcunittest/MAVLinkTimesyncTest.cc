@@ -0,0 +1,114 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkTimesyncTest.h"
+#include "MAVLinkTimesync.h"
+
+static const qint64 _msecs = 1000000LL;
+
+MAVLinkTimesyncTest::MAVLinkTimesyncTest(void)
+{
+
+}
+
+/// Runs one request/reply exchange through timesync
+///     @param uplinkNSecs      Delay from us to the vehicle
+///     @param downlinkNSecs    Delay from the vehicle back to us
+/// @return Result of replyReceived
+static bool exchange(MAVLinkTimesync& timesync, qint64& nowNSecs, qint64 offsetNSecs, qint64 uplinkNSecs, qint64 downlinkNSecs)
+{
+    mavlink_timesync_t reply;
+
+    timesync.requestSent(nowNSecs);
+    reply.ts1 = nowNSecs;
+    reply.tc1 = nowNSecs + uplinkNSecs + offsetNSecs;
+    nowNSecs += uplinkNSecs + downlinkNSecs;
+
+    const bool result = timesync.replyReceived(reply, nowNSecs);
+    nowNSecs += 1000 * _msecs;
+    return result;
+}
+
+void MAVLinkTimesyncTest::_estimateTest(void)
+{
+    MAVLinkTimesync timesync;
+    qint64          nowNSecs    = 5000 * _msecs;
+    const qint64    offsetNSecs = 123456 * _msecs;
+
+    QVERIFY(!timesync.valid());
+
+    // Symmetric delays of 20 and 30ms
+    for (int i=0; i<10; i++) {
+        const qint64 delayNSecs = (i % 2 ? 20 : 30) * _msecs;
+        QVERIFY(exchange(timesync, nowNSecs, offsetNSecs, delayNSecs, delayNSecs));
+    }
+
+    QVERIFY(timesync.valid());
+    QVERIFY(qAbs(timesync.rttNSecs() - 50 * _msecs) < 5 * _msecs);
+    QVERIFY(qAbs(timesync.offsetNSecs() - offsetNSecs) < _msecs);
+    QVERIFY(qAbs(timesync.vehicleNSecs(nowNSecs) - (nowNSecs + offsetNSecs)) < _msecs);
+}
+
+void MAVLinkTimesyncTest::_foreignReplyTest(void)
+{
+    MAVLinkTimesync     timesync;
+    mavlink_timesync_t  timesyncMessage;
+
+    timesync.requestSent(1000 * _msecs);
+
+    // Reply to a request someone else sent
+    timesyncMessage.ts1 = 999 * _msecs;
+    timesyncMessage.tc1 = 5000 * _msecs;
+    QVERIFY(!timesync.replyReceived(timesyncMessage, 1010 * _msecs));
+
+    // A request from the vehicle
+    timesyncMessage.ts1 = 1000 * _msecs;
+    timesyncMessage.tc1 = 0;
+    QVERIFY(!timesync.replyReceived(timesyncMessage, 1010 * _msecs));
+
+    // Our request, but each one is only used once
+    timesyncMessage.tc1 = 5000 * _msecs;
+    QVERIFY(timesync.replyReceived(timesyncMessage, 1010 * _msecs));
+    QVERIFY(!timesync.replyReceived(timesyncMessage, 1020 * _msecs));
+    QCOMPARE(timesync.sampleCount(), 1);
+}
+
+void MAVLinkTimesyncTest::_outlierTest(void)
+{
+    MAVLinkTimesync timesync;
+    qint64          nowNSecs    = 5000 * _msecs;
+    const qint64    offsetNSecs = -2000 * _msecs;
+
+    for (int i=0; i<10; i++) {
+        QVERIFY(exchange(timesync, nowNSecs, offsetNSecs, 10 * _msecs, 10 * _msecs));
+    }
+    const qint64 settledOffsetNSecs = timesync.offsetNSecs();
+
+    // A reply stuck in a queue on the way back says nothing useful about the offset, but does count towards RTT
+    const qint64 settledRttNSecs = timesync.rttNSecs();
+    QVERIFY(exchange(timesync, nowNSecs, offsetNSecs, 10 * _msecs, 500 * _msecs));
+    QCOMPARE(timesync.offsetNSecs(), settledOffsetNSecs);
+    QVERIFY(timesync.rttNSecs() > settledRttNSecs);
+}
+
+void MAVLinkTimesyncTest::_clockResetTest(void)
+{
+    MAVLinkTimesync timesync;
+    qint64          nowNSecs = 5000 * _msecs;
+
+    for (int i=0; i<10; i++) {
+        QVERIFY(exchange(timesync, nowNSecs, 60000 * _msecs, 10 * _msecs, 10 * _msecs));
+    }
+    QVERIFY(timesync.valid());
+
+    // Vehicle rebooted, its clock starts over
+    QVERIFY(exchange(timesync, nowNSecs, -nowNSecs, 10 * _msecs, 10 * _msecs));
+    QVERIFY(!timesync.valid());
+    QVERIFY(qAbs(timesync.offsetNSecs() + nowNSecs) < 2000 * _msecs);
+}
@@ -0,0 +1,27 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Feeds MAVLinkTimesync made up TIMESYNC exchanges with known delays and vehicle clock offsets
+class MAVLinkTimesyncTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MAVLinkTimesyncTest(void);
+
+private slots:
+    void _estimateTest      (void);
+    void _foreignReplyTest  (void);
+    void _outlierTest       (void);
+    void _clockResetTest    (void);
+};
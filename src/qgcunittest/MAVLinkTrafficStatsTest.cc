@@ -0,0 +1,122 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkTrafficStatsTest.h"
+#include "MAVLinkTrafficStats.h"
+
+#include <QAtomicInt>
+#include <QThread>
+
+MAVLinkTrafficStatsTest::MAVLinkTrafficStatsTest(void)
+{
+
+}
+
+static mavlink_message_t makeMessage(uint8_t sysid, uint8_t compid, uint32_t msgid)
+{
+    mavlink_message_t message;
+    memset(&message, 0, sizeof(message));
+    message.sysid   = sysid;
+    message.compid  = compid;
+    message.msgid   = msgid;
+    return message;
+}
+
+void MAVLinkTrafficStatsTest::_countTest(void)
+{
+    MAVLinkTrafficStats stats;
+
+    QVERIFY(stats.streams().isEmpty());
+
+    for (int i=0; i<3; i++) {
+        stats.record(makeMessage(1, 1, MAVLINK_MSG_ID_HEARTBEAT), 21);
+    }
+    stats.record(makeMessage(1, 1, MAVLINK_MSG_ID_ATTITUDE), 40);
+    stats.record(makeMessage(2, 1, MAVLINK_MSG_ID_HEARTBEAT), 21);
+
+    const QList<MAVLinkTrafficStats::Stream_t> streams = stats.streams();
+    QCOMPARE(streams.count(), 3);
+
+    int found = 0;
+    for (const MAVLinkTrafficStats::Stream_t& stream : streams) {
+        if (stream.sysid == 1 && stream.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+            QCOMPARE(stream.messageCount, static_cast<quint64>(3));
+            QCOMPARE(stream.byteCount, static_cast<quint64>(63));
+            found++;
+        } else if (stream.sysid == 1 && stream.msgid == MAVLINK_MSG_ID_ATTITUDE) {
+            QCOMPARE(stream.messageCount, static_cast<quint64>(1));
+            QCOMPARE(stream.byteCount, static_cast<quint64>(40));
+            // A single message has no interval yet
+            QCOMPARE(stream.meanIntervalMSecs, 0.0);
+            found++;
+        } else if (stream.sysid == 2) {
+            QCOMPARE(stream.messageCount, static_cast<quint64>(1));
+            found++;
+        }
+    }
+    QCOMPARE(found, 3);
+}
+
+void MAVLinkTrafficStatsTest::_intervalTest(void)
+{
+    MAVLinkTrafficStats stats;
+
+    // A steady 20ms stream, then a burst which must show up as jitter
+    for (int i=0; i<10; i++) {
+        stats.record(makeMessage(1, 1, MAVLINK_MSG_ID_ATTITUDE), 40);
+        QThread::msleep(20);
+    }
+
+    MAVLinkTrafficStats::Stream_t stream = stats.streams().first();
+    QVERIFY(stream.meanIntervalMSecs >= 15);
+    QVERIFY(stream.meanIntervalMSecs <= 100);
+    const double steadyJitterMSecs = stream.jitterMSecs;
+
+    for (int i=0; i<10; i++) {
+        stats.record(makeMessage(1, 1, MAVLINK_MSG_ID_ATTITUDE), 40);
+    }
+
+    stream = stats.streams().first();
+    QCOMPARE(stream.messageCount, static_cast<quint64>(20));
+    QVERIFY(stream.jitterMSecs > steadyJitterMSecs);
+    QVERIFY(stream.lastArrivalMSecs <= stats.elapsedMSecs());
+}
+
+void MAVLinkTrafficStatsTest::_crossThreadTest(void)
+{
+    MAVLinkTrafficStats stats;
+    QAtomicInt          done(0);
+
+    // One recording thread, as links have, while this thread keeps reading
+    QThread* recorder = QThread::create([&stats, &done]() {
+        for (int i=0; i<_messageCount; i++) {
+            stats.record(makeMessage(1, 1, static_cast<uint32_t>(i % 50)), 20);
+        }
+        done.storeRelease(1);
+    });
+    recorder->start();
+
+    bool countsValid = true;
+    while (!done.loadAcquire()) {
+        for (const MAVLinkTrafficStats::Stream_t& stream : stats.streams()) {
+            countsValid &= stream.byteCount <= static_cast<quint64>(_messageCount) * 20;
+        }
+    }
+    recorder->wait();
+    delete recorder;
+    QVERIFY(countsValid);
+
+    quint64 messageCount = 0;
+    const QList<MAVLinkTrafficStats::Stream_t> streams = stats.streams();
+    for (const MAVLinkTrafficStats::Stream_t& stream : streams) {
+        messageCount += stream.messageCount;
+    }
+    QCOMPARE(streams.count(), 50);
+    QCOMPARE(messageCount, static_cast<quint64>(_messageCount));
+}
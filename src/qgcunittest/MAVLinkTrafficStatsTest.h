@@ -0,0 +1,29 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Checks the per stream counters of MAVLinkTrafficStats, including reads while another thread is recording
+class MAVLinkTrafficStatsTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MAVLinkTrafficStatsTest(void);
+
+private slots:
+    void _countTest         (void);
+    void _intervalTest      (void);
+    void _crossThreadTest   (void);
+
+private:
+    static const int _messageCount = 1000;
+};
@@ -0,0 +1,198 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MockLinkLoadGeneratorTest.h"
+#include "LinkManager.h"
+#include "QGCApplication.h"
+
+#include <string.h>
+
+MockLinkLoadGeneratorTest::MockLinkLoadGeneratorTest(void)
+{
+
+}
+
+void MockLinkLoadGeneratorTest::init(void)
+{
+    UnitTest::init();
+
+    _mavlinkChannel = qgcApp()->toolbox()->linkManager()->allocateMavlinkChannel();
+    QVERIFY(_mavlinkChannel != LinkManager::invalidMavlinkChannel());
+}
+
+void MockLinkLoadGeneratorTest::cleanup(void)
+{
+    qgcApp()->toolbox()->linkManager()->freeMavlinkChannel(_mavlinkChannel);
+
+    UnitTest::cleanup();
+}
+
+/// Runs the generator in the same 2 msec steps MockLink uses
+QVector<mavlink_message_t> MockLinkLoadGeneratorTest::_run(MockLinkLoadGenerator& generator, int seconds)
+{
+    QVector<mavlink_message_t> messages;
+
+    for (qint64 nowMSecs=0; nowMSecs<seconds*1000; nowMSecs+=2) {
+        generator.run(nowMSecs, messages);
+    }
+
+    return messages;
+}
+
+void MockLinkLoadGeneratorTest::_rateTest(void)
+{
+    MockLinkLoadGenerator::RateProfile_t rateProfile;
+    rateProfile[MAVLINK_MSG_ID_HEARTBEAT]   = 1;
+    rateProfile[MAVLINK_MSG_ID_ATTITUDE]    = 50;
+
+    const int               vehicleCount = 10;
+    MockLinkLoadGenerator   generator(_mavlinkChannel, MAV_AUTOPILOT_GENERIC, MAV_TYPE_QUADROTOR, 1, vehicleCount, rateProfile, 0, 0, 1);
+
+    const QVector<mavlink_message_t> messages = _run(generator, 10);
+
+    QMap<uint8_t, int>      heartbeatCounts;
+    QMap<uint8_t, int>      attitudeCounts;
+    QMap<uint8_t, uint8_t>  nextSequences;
+    bool                    sequenceGap = false;
+
+    for (const mavlink_message_t& message : messages) {
+        if (message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+            heartbeatCounts[message.sysid]++;
+        } else if (message.msgid == MAVLINK_MSG_ID_ATTITUDE) {
+            attitudeCounts[message.sysid]++;
+        }
+        // Each vehicle has its own sequence numbers
+        if (nextSequences.contains(message.sysid) && nextSequences[message.sysid] != message.seq) {
+            sequenceGap = true;
+        }
+        nextSequences[message.sysid] = message.seq + 1;
+    }
+    QVERIFY(!sequenceGap);
+
+    QCOMPARE(heartbeatCounts.count(), vehicleCount);
+    QCOMPARE(heartbeatCounts.firstKey(), static_cast<uint8_t>(1));
+    QCOMPARE(heartbeatCounts.lastKey(), static_cast<uint8_t>(vehicleCount));
+    for (uint8_t sysid : heartbeatCounts.keys()) {
+        QCOMPARE(heartbeatCounts[sysid], 10);
+        QCOMPARE(attitudeCounts[sysid], 500);
+    }
+    QCOMPARE(generator.sentCount(), static_cast<quint64>(messages.count()));
+    QCOMPARE(generator.lostCount(), static_cast<quint64>(0));
+}
+
+void MockLinkLoadGeneratorTest::_lossTest(void)
+{
+    MockLinkLoadGenerator generator(_mavlinkChannel, MAV_AUTOPILOT_GENERIC, MAV_TYPE_QUADROTOR, 1, 10, MockLinkLoadGenerator::defaultRateProfile(), 0, 20, 1);
+
+    const QVector<mavlink_message_t> messages = _run(generator, 10);
+
+    const double lossRate = static_cast<double>(generator.lostCount()) / (generator.sentCount() + generator.lostCount());
+    QVERIFY(lossRate > 0.15 && lossRate < 0.25);
+
+    // Every lost message leaves a gap in the sequence numbers of its vehicle
+    QMap<uint8_t, uint8_t>  nextSequences;
+    quint64                 missingCount = 0;
+    for (const mavlink_message_t& message : messages) {
+        if (nextSequences.contains(message.sysid)) {
+            missingCount += static_cast<uint8_t>(message.seq - nextSequences[message.sysid]);
+        } else {
+            missingCount += message.seq;
+        }
+        nextSequences[message.sysid] = message.seq + 1;
+    }
+    // Messages lost after the last one which got through don't show up as a gap
+    QVERIFY(missingCount <= generator.lostCount());
+    QVERIFY(missingCount + 10 * 7 >= generator.lostCount());
+}
+
+void MockLinkLoadGeneratorTest::_repeatableTest(void)
+{
+    MockLinkLoadGenerator generator1(_mavlinkChannel, MAV_AUTOPILOT_GENERIC, MAV_TYPE_QUADROTOR, 1, 5, MockLinkLoadGenerator::defaultRateProfile(), 30, 10, 42);
+    MockLinkLoadGenerator generator2(_mavlinkChannel, MAV_AUTOPILOT_GENERIC, MAV_TYPE_QUADROTOR, 1, 5, MockLinkLoadGenerator::defaultRateProfile(), 30, 10, 42);
+
+    const QVector<mavlink_message_t> messages1 = _run(generator1, 5);
+    const QVector<mavlink_message_t> messages2 = _run(generator2, 5);
+
+    QCOMPARE(messages1.count(), messages2.count());
+    bool same = true;
+    for (int i=0; i<messages1.count(); i++) {
+        if (messages1[i].sysid != messages2[i].sysid || messages1[i].msgid != messages2[i].msgid || messages1[i].seq != messages2[i].seq) {
+            same = false;
+            break;
+        }
+    }
+    QVERIFY(same);
+}
+
+void MockLinkLoadGeneratorTest::_responseTest(void)
+{
+    MockLinkLoadGenerator       generator(_mavlinkChannel, MAV_AUTOPILOT_GENERIC, MAV_TYPE_QUADROTOR, 20, 10, MockLinkLoadGenerator::defaultRateProfile(), 0, 0, 1);
+    QVector<mavlink_message_t>  responses;
+    mavlink_message_t           message;
+
+    mavlink_command_long_t commandLong;
+    memset(&commandLong, 0, sizeof(commandLong));
+    commandLong.target_system       = 25;
+    commandLong.target_component    = MAV_COMP_ID_AUTOPILOT1;
+    commandLong.command             = MAV_CMD_REQUEST_MESSAGE;
+    mavlink_msg_command_long_encode_chan(255, MAV_COMP_ID_MISSIONPLANNER, _mavlinkChannel, &message, &commandLong);
+    generator.handleMessage(message, responses);
+    QCOMPARE(responses.count(), 1);
+    QCOMPARE(responses[0].msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_COMMAND_ACK));
+    QCOMPARE(responses[0].sysid, static_cast<uint8_t>(25));
+    QCOMPARE(mavlink_msg_command_ack_get_command(&responses[0]), static_cast<uint16_t>(MAV_CMD_REQUEST_MESSAGE));
+    QCOMPARE(mavlink_msg_command_ack_get_target_system(&responses[0]), static_cast<uint8_t>(255));
+
+    // Not one of the simulated vehicles
+    responses.clear();
+    commandLong.target_system = 30;
+    mavlink_msg_command_long_encode_chan(255, MAV_COMP_ID_MISSIONPLANNER, _mavlinkChannel, &message, &commandLong);
+    generator.handleMessage(message, responses);
+    QVERIFY(responses.isEmpty());
+
+    mavlink_msg_param_request_list_pack_chan(255, MAV_COMP_ID_MISSIONPLANNER, _mavlinkChannel, &message, 20, MAV_COMP_ID_AUTOPILOT1);
+    generator.handleMessage(message, responses);
+    QCOMPARE(responses.count(), 1);
+    QCOMPARE(responses[0].msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_PARAM_VALUE));
+    QCOMPARE(mavlink_msg_param_value_get_param_count(&responses[0]), static_cast<uint16_t>(1));
+
+    responses.clear();
+    mavlink_mission_request_list_t requestList;
+    memset(&requestList, 0, sizeof(requestList));
+    requestList.target_system       = 29;
+    requestList.target_component    = MAV_COMP_ID_AUTOPILOT1;
+    requestList.mission_type        = MAV_MISSION_TYPE_FENCE;
+    mavlink_msg_mission_request_list_encode_chan(255, MAV_COMP_ID_MISSIONPLANNER, _mavlinkChannel, &message, &requestList);
+    generator.handleMessage(message, responses);
+    QCOMPARE(responses.count(), 1);
+    QCOMPARE(responses[0].msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_MISSION_COUNT));
+    QCOMPARE(mavlink_msg_mission_count_get_count(&responses[0]), static_cast<uint16_t>(0));
+    QCOMPARE(mavlink_msg_mission_count_get_mission_type(&responses[0]), static_cast<uint8_t>(MAV_MISSION_TYPE_FENCE));
+}
+
+void MockLinkLoadGeneratorTest::_rateProfileTest(void)
+{
+    const MockLinkLoadGenerator::RateProfile_t rateProfile = MockLinkLoadGenerator::defaultRateProfile();
+
+    QCOMPARE(MockLinkLoadGenerator::rateProfileFromString(MockLinkLoadGenerator::rateProfileToString(rateProfile)), rateProfile);
+
+    const MockLinkLoadGenerator::RateProfile_t parsed = MockLinkLoadGenerator::rateProfileFromString(QStringLiteral("0:1, 30:12.5,bad,33:"));
+    QCOMPARE(parsed.count(), 2);
+    QCOMPARE(parsed[MAVLINK_MSG_ID_ATTITUDE], 12.5);
+
+    // Unknown messages are skipped, vehicles are capped to the system id range
+    MockLinkLoadGenerator::RateProfile_t unsupported;
+    unsupported[MAVLINK_MSG_ID_HEARTBEAT]       = 1;
+    unsupported[MAVLINK_MSG_ID_STATUSTEXT]      = 1;
+    MockLinkLoadGenerator generator(_mavlinkChannel, MAV_AUTOPILOT_GENERIC, MAV_TYPE_QUADROTOR, 250, 20, unsupported, 0, 0, 1);
+    QCOMPARE(generator.vehicleCount(), 5);
+    for (const mavlink_message_t& message : _run(generator, 1)) {
+        QCOMPARE(message.msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_HEARTBEAT));
+    }
+}
@@ -0,0 +1,38 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "MockLinkLoadGenerator.h"
+
+/// Runs MockLinkLoadGenerator on a simulated clock and checks the rates, loss and responses of the vehicles
+class MockLinkLoadGeneratorTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MockLinkLoadGeneratorTest(void);
+
+protected:
+    void init   (void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _rateTest          (void);
+    void _lossTest          (void);
+    void _repeatableTest    (void);
+    void _responseTest      (void);
+    void _rateProfileTest   (void);
+
+private:
+    QVector<mavlink_message_t> _run(MockLinkLoadGenerator& generator, int seconds);
+
+    uint8_t _mavlinkChannel;
+};
@@ -0,0 +1,95 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryLogWriterTest.h"
+#include "TelemetryLogWriter.h"
+#include "QGCApplication.h"
+#include "LinkManager.h"
+
+#include <QTemporaryFile>
+#include <QtEndian>
+
+TelemetryLogWriterTest::TelemetryLogWriterTest(void)
+    : _mavlinkChannel(LinkManager::invalidMavlinkChannel())
+{
+
+}
+
+void TelemetryLogWriterTest::init(void)
+{
+    UnitTest::init();
+
+    _mavlinkChannel = qgcApp()->toolbox()->linkManager()->allocateMavlinkChannel();
+    QVERIFY(_mavlinkChannel != LinkManager::invalidMavlinkChannel());
+}
+
+void TelemetryLogWriterTest::cleanup(void)
+{
+    qgcApp()->toolbox()->linkManager()->freeMavlinkChannel(_mavlinkChannel);
+    _mavlinkChannel = LinkManager::invalidMavlinkChannel();
+
+    UnitTest::cleanup();
+}
+
+void TelemetryLogWriterTest::_logMessages(TelemetryLogWriter& writer, QList<mavlink_message_t>& messages)
+{
+    for (int i=0; i<_messageCount; i++) {
+        mavlink_message_t message;
+
+        mavlink_msg_attitude_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _mavlinkChannel, &message,
+                                       static_cast<uint32_t>(i * 20), 0.1f * i, -0.05f * i, 1.5f, 0, 0, 0);
+        writer.logMessage(message);
+        messages.append(message);
+    }
+}
+
+void TelemetryLogWriterTest::_verifyTlog(const QByteArray& tlog, const QList<mavlink_message_t>& messages)
+{
+    const uint8_t*  data            = reinterpret_cast<const uint8_t*>(tlog.constData());
+    int             offset          = 0;
+    quint64         lastTimestamp   = 0;
+
+    for (const mavlink_message_t& message : messages) {
+        uint8_t frame[MAVLINK_MAX_PACKET_LEN];
+        const int frameLength = mavlink_msg_to_send_buffer(frame, &message);
+
+        QVERIFY(offset + static_cast<int>(sizeof(quint64)) + frameLength <= tlog.size());
+
+        const quint64 timestamp = qFromBigEndian<quint64>(&data[offset]);
+        QVERIFY(timestamp >= lastTimestamp);
+        lastTimestamp = timestamp;
+        offset += sizeof(quint64);
+
+        QCOMPARE(memcmp(&data[offset], frame, frameLength), 0);
+        offset += frameLength;
+    }
+
+    QCOMPARE(offset, tlog.size());
+}
+
+void TelemetryLogWriterTest::_plainLogTest(void)
+{
+    QTemporaryFile              file;
+    TelemetryLogWriter          writer;
+    QList<mavlink_message_t>    messages;
+
+    QVERIFY(file.open());
+    writer.startLog(&file);
+    _logMessages(writer, messages);
+    writer.stopLog();
+
+    QCOMPARE(writer.droppedRecordCount(), static_cast<quint32>(0));
+
+    QVERIFY(file.seek(0));
+    const QByteArray tlog = file.readAll();
+    _verifyTlog(tlog, messages);
+
+    // Only full blocks plus the final partial one, rather than a write per message
+    QVERIFY(writer.blockWriteCount() <= static_cast<quint32>(tlog.size() / TelemetryLogWriter::blockSize + 2));
+}
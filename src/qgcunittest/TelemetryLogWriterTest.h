@@ -0,0 +1,39 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "QGCMAVLink.h"
+
+class TelemetryLogWriter;
+
+/// Checks that TelemetryLogWriter produces a regular tlog from batched block writes
+class TelemetryLogWriterTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TelemetryLogWriterTest(void);
+
+protected:
+    void init   (void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _plainLogTest      (void);
+
+private:
+    void _logMessages   (TelemetryLogWriter& writer, QList<mavlink_message_t>& messages);
+    void _verifyTlog    (const QByteArray& tlog, const QList<mavlink_message_t>& messages);
+
+    uint8_t _mavlinkChannel;
+
+    static const int _messageCount = 5000;
+};
@@ -0,0 +1,42 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogBuilder.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QtEndian>
+
+TlogBuilder::TlogBuilder(void)
+    : _recordCount(0)
+{
+
+}
+
+void TlogBuilder::append(quint64 timestampUSecs, const mavlink_message_t& message)
+{
+    uint8_t buffer[sizeof(quint64) + MAVLINK_MAX_PACKET_LEN];
+
+    qToBigEndian<quint64>(timestampUSecs, buffer);
+    const int length = mavlink_msg_to_send_buffer(buffer + sizeof(quint64), &message);
+    _tlog.append(reinterpret_cast<const char*>(buffer), static_cast<int>(sizeof(quint64)) + length);
+    _recordCount++;
+}
+
+bool TlogBuilder::save(const QString& fileName) const
+{
+    QFile file(fileName);
+
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(_tlog) == _tlog.size();
+}
+
+quint64 TlogBuilder::pastStartTimeUSecs(void)
+{
+    return static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() - 3600 * 1000) * 1000;
+}
@@ -0,0 +1,40 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+#include "QGCMAVLink.h"
+
+/// Builds synthetic telemetry logs (tlogs) for unit tests. Each record is the big endian usec timestamp followed by the
+/// frame, the same as the logs written by MAVLinkProtocol.
+class TlogBuilder
+{
+public:
+    TlogBuilder(void);
+
+    /// Appends a record with the specified timestamp
+    void append(quint64 timestampUSecs, const mavlink_message_t& message);
+
+    const QByteArray&   tlog        (void) const { return _tlog; }
+    int                 recordCount (void) const { return _recordCount; }
+
+    /// Writes the log to fileName, replacing anything already there
+    bool save(const QString& fileName) const;
+
+    /// An hour before now. Timestamps in the future are taken to be byte swapped by TlogIndex::parseTimestamp, so test
+    /// logs always start in the past.
+    static quint64 pastStartTimeUSecs(void);
+
+private:
+    QByteArray  _tlog;
+    int         _recordCount;
+};
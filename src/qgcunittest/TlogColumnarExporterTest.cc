@@ -0,0 +1,146 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogColumnarExporterTest.h"
+#include "TlogColumnarExporter.h"
+#include "TlogBuilder.h"
+#include "QGCApplication.h"
+#include "LinkManager.h"
+
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+TlogColumnarExporterTest::TlogColumnarExporterTest(void)
+    : _mavlinkChannel   (LinkManager::invalidMavlinkChannel())
+    , _startTimeUSecs   (0)
+{
+
+}
+
+void TlogColumnarExporterTest::init(void)
+{
+    UnitTest::init();
+
+    _mavlinkChannel = qgcApp()->toolbox()->linkManager()->allocateMavlinkChannel();
+    QVERIFY(_mavlinkChannel != LinkManager::invalidMavlinkChannel());
+}
+
+void TlogColumnarExporterTest::cleanup(void)
+{
+    qgcApp()->toolbox()->linkManager()->freeMavlinkChannel(_mavlinkChannel);
+    _mavlinkChannel = LinkManager::invalidMavlinkChannel();
+
+    UnitTest::cleanup();
+}
+
+/// Alternates HEARTBEAT and ATTITUDE records, 10 msecs apart, with ATTITUDE coming from two systems
+QByteArray TlogColumnarExporterTest::_buildTlog(void)
+{
+    TlogBuilder builder;
+
+    mavlink_get_channel_status(_mavlinkChannel)->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    _startTimeUSecs = TlogBuilder::pastStartTimeUSecs();
+
+    for (int i=0; i<_recordCount; i++) {
+        mavlink_message_t message;
+
+        if (i % 2 == 0) {
+            mavlink_msg_heartbeat_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _mavlinkChannel, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+        } else {
+            const uint8_t systemId = (i / 2) % 2 ? 2 : 1;
+            mavlink_msg_attitude_pack_chan(systemId, MAV_COMP_ID_AUTOPILOT1, _mavlinkChannel, &message, static_cast<uint32_t>(i), i * 0.001f, 0.2f, 0.3f, 0, 0, 0);
+        }
+        builder.append(_startTimeUSecs + i * _recordIntervalUSecs, message);
+    }
+
+    return builder.tlog();
+}
+
+void TlogColumnarExporterTest::_exportTest(void)
+{
+    QTemporaryDir   tempDir;
+    QString         tlogFile    = tempDir.filePath(QStringLiteral("export.tlog"));
+    QString         outputDir   = tempDir.filePath(QStringLiteral("export"));
+    QString         errorString;
+
+    QVERIFY(tempDir.isValid());
+    QFile file(tlogFile);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QVERIFY(file.write(_buildTlog()) > 0);
+    file.close();
+
+    TlogColumnarExporter exporter;
+    exporter.setChunkSize(_chunkSize);
+    exporter.setFieldProjection({ QStringLiteral("HEARTBEAT"), QStringLiteral("ATTITUDE.time_boot_ms"), QStringLiteral("ATTITUDE.roll") });
+    QVERIFY2(exporter.exportLog(tlogFile, outputDir, errorString), qPrintable(errorString));
+    QCOMPARE(exporter.exportedRowCount(), static_cast<quint64>(_recordCount));
+
+    QFile schemaFile(QDir(outputDir).filePath(TlogColumnarExporter::schemaFileName));
+    QVERIFY(schemaFile.open(QIODevice::ReadOnly));
+    const QJsonArray jsonMessages = QJsonDocument::fromJson(schemaFile.readAll()).object()[QStringLiteral("messages")].toArray();
+    QCOMPARE(jsonMessages.count(), 2);
+
+    const QJsonObject jsonAttitude = jsonMessages[1].toObject();
+    QCOMPARE(jsonAttitude[QStringLiteral("name")].toString(),      QStringLiteral("ATTITUDE"));
+    QCOMPARE(jsonAttitude[QStringLiteral("rowCount")].toInt(),     _recordCount / 2);
+    QCOMPARE(jsonAttitude[QStringLiteral("columns")].toArray().count(), 5);
+
+    // Every frame lands in exactly one row group, including the ones split across chunk boundaries
+    const QJsonArray    jsonRowGroups   = jsonAttitude[QStringLiteral("rowGroups")].toArray();
+    int                 rowGroupRows    = 0;
+    double              minTimestamp    = 0;
+    double              maxTimestamp    = 0;
+    QVERIFY(jsonRowGroups.count() > 1);
+    for (int i=0; i<jsonRowGroups.count(); i++) {
+        const QJsonObject jsonRowGroup      = jsonRowGroups[i].toObject();
+        const QJsonObject jsonTimestamp     = jsonRowGroup[QStringLiteral("stats")].toObject()[QStringLiteral("timestamp_usec")].toObject();
+        QCOMPARE(jsonRowGroup[QStringLiteral("firstRow")].toInt(), rowGroupRows);
+        rowGroupRows += jsonRowGroup[QStringLiteral("rowCount")].toInt();
+        minTimestamp = i == 0 ? jsonTimestamp[QStringLiteral("min")].toDouble() : minTimestamp;
+        maxTimestamp = jsonTimestamp[QStringLiteral("max")].toDouble();
+    }
+    QCOMPARE(rowGroupRows, _recordCount / 2);
+    QCOMPARE(static_cast<quint64>(minTimestamp), _startTimeUSecs + _recordIntervalUSecs);
+    QCOMPARE(static_cast<quint64>(maxTimestamp), _startTimeUSecs + (_recordCount - 1) * _recordIntervalUSecs);
+
+    QFile rollFile(QDir(outputDir).filePath(QStringLiteral("ATTITUDE/roll.%1").arg(TlogColumnarExporter::columnFileExtension)));
+    QFile sysidFile(QDir(outputDir).filePath(QStringLiteral("ATTITUDE/sysid.%1").arg(TlogColumnarExporter::columnFileExtension)));
+    QVERIFY(rollFile.open(QIODevice::ReadOnly));
+    QVERIFY(sysidFile.open(QIODevice::ReadOnly));
+    const QByteArray rolls      = rollFile.readAll();
+    const QByteArray systemIds  = sysidFile.readAll();
+    QCOMPARE(rolls.size(),      static_cast<int>(_recordCount / 2 * sizeof(float)));
+    QCOMPARE(systemIds.size(),  _recordCount / 2);
+    for (int row=0; row<_recordCount / 2; row++) {
+        const int   record = row * 2 + 1;
+        float       roll;
+
+        memcpy(&roll, rolls.constData() + row * sizeof(float), sizeof(float));
+        QCOMPARE(roll, record * 0.001f);
+        QCOMPARE(static_cast<int>(systemIds[row]), row % 2 ? 2 : 1);
+    }
+
+    // Timestamps are little endian like every other column, whatever the byte order of the log
+    QFile timestampFile(QDir(outputDir).filePath(QStringLiteral("ATTITUDE/timestamp_usec.%1").arg(TlogColumnarExporter::columnFileExtension)));
+    QVERIFY(timestampFile.open(QIODevice::ReadOnly));
+    const QByteArray timestamps = timestampFile.readAll();
+    QCOMPARE(timestamps.size(), static_cast<int>(_recordCount / 2 * sizeof(quint64)));
+    for (int row=0; row<_recordCount / 2; row++) {
+        const quint64 timestampUSecs = qFromLittleEndian<quint64>(timestamps.constData() + row * sizeof(quint64));
+        QCOMPARE(timestampUSecs, _startTimeUSecs + (row * 2 + 1) * _recordIntervalUSecs);
+    }
+
+    QVERIFY(!QFile::exists(QDir(outputDir).filePath(QStringLiteral("ATTITUDE/pitch.%1").arg(TlogColumnarExporter::columnFileExtension))));
+    QVERIFY(QFile::exists(QDir(outputDir).filePath(QStringLiteral("HEARTBEAT/custom_mode.%1").arg(TlogColumnarExporter::columnFileExtension))));
+}
@@ -0,0 +1,39 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "QGCMAVLink.h"
+
+/// Exports a synthetic tlog split into many small chunks and checks the columns and schema which come out
+class TlogColumnarExporterTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TlogColumnarExporterTest(void);
+
+protected:
+    void init   (void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _exportTest(void);
+
+private:
+    QByteArray _buildTlog(void);
+
+    uint8_t _mavlinkChannel;
+    quint64 _startTimeUSecs;
+
+    static const int        _recordCount            = 2000;
+    static const quint64    _recordIntervalUSecs    = 10000;
+    static const int        _chunkSize              = 4096;
+};
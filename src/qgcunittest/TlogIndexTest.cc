@@ -0,0 +1,190 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogIndexTest.h"
+#include "TlogIndex.h"
+#include "TlogBuilder.h"
+#include "QGCApplication.h"
+#include "LinkManager.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+TlogIndexTest::TlogIndexTest(void)
+    : _mavlinkChannel   (LinkManager::invalidMavlinkChannel())
+    , _startTimeUSecs   (0)
+{
+
+}
+
+void TlogIndexTest::init(void)
+{
+    UnitTest::init();
+
+    _mavlinkChannel = qgcApp()->toolbox()->linkManager()->allocateMavlinkChannel();
+    QVERIFY(_mavlinkChannel != LinkManager::invalidMavlinkChannel());
+}
+
+void TlogIndexTest::cleanup(void)
+{
+    qgcApp()->toolbox()->linkManager()->freeMavlinkChannel(_mavlinkChannel);
+    _mavlinkChannel = LinkManager::invalidMavlinkChannel();
+
+    UnitTest::cleanup();
+}
+
+/// Alternates HEARTBEAT and ATTITUDE records, 10 msecs apart
+QByteArray TlogIndexTest::_buildTlog(void)
+{
+    TlogBuilder builder;
+
+    mavlink_get_channel_status(_mavlinkChannel)->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    _startTimeUSecs = TlogBuilder::pastStartTimeUSecs();
+
+    for (int i=0; i<_recordCount; i++) {
+        mavlink_message_t message;
+
+        if (i % 2 == 0) {
+            mavlink_msg_heartbeat_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _mavlinkChannel, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+        } else {
+            mavlink_msg_attitude_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _mavlinkChannel, &message, static_cast<uint32_t>(i), 0.1f, 0.2f, 0.3f, 0, 0, 0);
+        }
+        builder.append(_startTimeUSecs + i * _recordIntervalUSecs, message);
+    }
+
+    return builder.tlog();
+}
+
+void TlogIndexTest::_verifyIndex(const TlogIndex& index, const QByteArray& tlog)
+{
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(tlog.constData());
+
+    QCOMPARE(index.frameCount(),        static_cast<quint64>(_recordCount));
+    QCOMPARE(index.firstFrameOffset(),  static_cast<quint64>(sizeof(quint64)));
+    QCOMPARE(index.startTimeUSecs(),    _startTimeUSecs);
+    QCOMPARE(index.endTimeUSecs(),      _startTimeUSecs + (_recordCount - 1) * _recordIntervalUSecs);
+
+    const QVector<quint64> heartbeatOffsets = index.offsetsForMessageId(MAVLINK_MSG_ID_HEARTBEAT);
+    const QVector<quint64> attitudeOffsets  = index.offsetsForMessageId(MAVLINK_MSG_ID_ATTITUDE);
+    QCOMPARE(heartbeatOffsets.count(),  _recordCount / 2);
+    QCOMPARE(attitudeOffsets.count(),   _recordCount / 2);
+    QCOMPARE(index.offsetsForMessageIds({ MAVLINK_MSG_ID_ATTITUDE, MAVLINK_MSG_ID_HEARTBEAT }).count(), static_cast<int>(_recordCount));
+    QVERIFY(index.offsetsForMessageId(MAVLINK_MSG_ID_GPS_RAW_INT).isEmpty());
+    for (quint64 offset : attitudeOffsets) {
+        QCOMPARE(static_cast<int>(data[offset + 7]), static_cast<int>(MAVLINK_MSG_ID_ATTITUDE));
+    }
+
+    // Seeking lands on the first record at or after the requested time, including between index entries
+    for (int record : { 0, 1, 777, 1500, _recordCount - 1 }) {
+        const quint64 timestampUSecs = _startTimeUSecs + record * _recordIntervalUSecs;
+        const quint64 offset         = index.offsetForTime(timestampUSecs);
+
+        QCOMPARE(TlogIndex::frameTimestamp(data, offset), timestampUSecs);
+        QCOMPARE(index.offsetForTime(timestampUSecs - _recordIntervalUSecs / 2), offset);
+    }
+    QCOMPARE(index.offsetForTime(index.endTimeUSecs() + 1), static_cast<quint64>(tlog.size()));
+}
+
+void TlogIndexTest::_indexTest(void)
+{
+    QTemporaryDir   tempDir;
+    QByteArray      tlog        = _buildTlog();
+    QString         tlogFile    = tempDir.filePath(QStringLiteral("index.tlog"));
+    QString         errorString;
+    const uint8_t*  data        = reinterpret_cast<const uint8_t*>(tlog.constData());
+
+    QVERIFY(tempDir.isValid());
+    QFile file(tlogFile);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(tlog), static_cast<qint64>(tlog.size()));
+    file.close();
+
+    TlogIndex builtIndex;
+    QVERIFY2(builtIndex.load(tlogFile, data, tlog.size(), errorString), qPrintable(errorString));
+    QVERIFY(!builtIndex.loadedFromCache());
+    QVERIFY(QFile::exists(TlogIndex::indexFileName(tlogFile)));
+    _verifyIndex(builtIndex, tlog);
+
+    TlogIndex cachedIndex;
+    QVERIFY2(cachedIndex.load(tlogFile, data, tlog.size(), errorString), qPrintable(errorString));
+    QVERIFY(cachedIndex.loadedFromCache());
+    _verifyIndex(cachedIndex, tlog);
+}
+
+void TlogIndexTest::_staleIndexTest(void)
+{
+    QTemporaryDir   tempDir;
+    QByteArray      tlog        = _buildTlog();
+    QString         tlogFile    = tempDir.filePath(QStringLiteral("stale.tlog"));
+    QString         errorString;
+
+    QVERIFY(tempDir.isValid());
+    QFile file(tlogFile);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(tlog), static_cast<qint64>(tlog.size()));
+    file.close();
+
+    TlogIndex builtIndex;
+    QVERIFY2(builtIndex.load(tlogFile, reinterpret_cast<const uint8_t*>(tlog.constData()), tlog.size(), errorString), qPrintable(errorString));
+    QVERIFY(!builtIndex.loadedFromCache());
+
+    // The log is cut short after the index was saved, the sidecar no longer matches and is rebuilt
+    const int   keepCount       = _recordCount / 2;
+    QByteArray  shortTlog       = tlog.left(static_cast<int>(builtIndex.offsetForTime(_startTimeUSecs + keepCount * _recordIntervalUSecs) - sizeof(quint64)));
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QCOMPARE(file.write(shortTlog), static_cast<qint64>(shortTlog.size()));
+    file.close();
+
+    TlogIndex rebuiltIndex;
+    QVERIFY2(rebuiltIndex.load(tlogFile, reinterpret_cast<const uint8_t*>(shortTlog.constData()), shortTlog.size(), errorString), qPrintable(errorString));
+    QVERIFY(!rebuiltIndex.loadedFromCache());
+    QCOMPARE(rebuiltIndex.frameCount(), static_cast<quint64>(keepCount));
+
+    TlogIndex cachedIndex;
+    QVERIFY2(cachedIndex.load(tlogFile, reinterpret_cast<const uint8_t*>(shortTlog.constData()), shortTlog.size(), errorString), qPrintable(errorString));
+    QVERIFY(cachedIndex.loadedFromCache());
+    QCOMPARE(cachedIndex.frameCount(), static_cast<quint64>(keepCount));
+}
+
+void TlogIndexTest::_corruptIndexTest(void)
+{
+    QTemporaryDir   tempDir;
+    QByteArray      tlog        = _buildTlog();
+    QString         tlogFile    = tempDir.filePath(QStringLiteral("corrupt.tlog"));
+    QString         errorString;
+    const uint8_t*  data        = reinterpret_cast<const uint8_t*>(tlog.constData());
+
+    QVERIFY(tempDir.isValid());
+    QFile file(tlogFile);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(tlog), static_cast<qint64>(tlog.size()));
+    file.close();
+
+    TlogIndex builtIndex;
+    QVERIFY2(builtIndex.load(tlogFile, data, tlog.size(), errorString), qPrintable(errorString));
+
+    // Size and modification time still match, but the frame count is more than the log could ever hold
+    QFile indexFile(TlogIndex::indexFileName(tlogFile));
+    QVERIFY(indexFile.open(QIODevice::ReadWrite));
+    QVERIFY(indexFile.seek(_indexFrameCountOffset));
+    uint8_t frameCount[sizeof(quint64)];
+    qToLittleEndian<quint64>(static_cast<quint64>(tlog.size()), frameCount);
+    QCOMPARE(indexFile.write(reinterpret_cast<const char*>(frameCount), sizeof(frameCount)), static_cast<qint64>(sizeof(frameCount)));
+    indexFile.close();
+
+    TlogIndex rebuiltIndex;
+    QVERIFY2(rebuiltIndex.load(tlogFile, data, tlog.size(), errorString), qPrintable(errorString));
+    QVERIFY(!rebuiltIndex.loadedFromCache());
+    _verifyIndex(rebuiltIndex, tlog);
+
+    TlogIndex cachedIndex;
+    QVERIFY2(cachedIndex.load(tlogFile, data, tlog.size(), errorString), qPrintable(errorString));
+    QVERIFY(cachedIndex.loadedFromCache());
+}
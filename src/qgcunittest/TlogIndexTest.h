@@ -0,0 +1,45 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "QGCMAVLink.h"
+
+class TlogIndex;
+
+/// Checks TlogIndex against a synthetic tlog, both freshly built and loaded back from the sidecar cache, and that a
+/// sidecar which no longer matches its tlog is rebuilt
+class TlogIndexTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TlogIndexTest(void);
+
+protected:
+    void init   (void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _indexTest         (void);
+    void _staleIndexTest    (void);
+    void _corruptIndexTest  (void);
+
+private:
+    QByteArray  _buildTlog      (void);
+    void        _verifyIndex    (const TlogIndex& index, const QByteArray& tlog);
+
+    uint8_t _mavlinkChannel;
+    quint64 _startTimeUSecs;
+
+    static const int        _recordCount            = 3000;
+    static const quint64    _recordIntervalUSecs    = 10000;
+    static const int        _indexFrameCountOffset  = 8 + 4 + 8 + 8;    ///< Magic, version, tlog size, tlog modified time
+};
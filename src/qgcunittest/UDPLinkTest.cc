@@ -0,0 +1,151 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "UDPLinkTest.h"
+#include "UDPLink.h"
+#include "QGCApplication.h"
+#include "LinkManager.h"
+#include "MAVLinkMessagePool.h"
+
+#include <QUdpSocket>
+
+UDPLinkTest::UDPLinkTest(void)
+{
+
+}
+
+/// Attitude only, so no vehicle is created for the test senders
+QByteArray UDPLinkTest::_buildStream(uint8_t mavlinkChannel, uint8_t sysid, int messageCount)
+{
+    QByteArray stream;
+
+    for (int i=0; i<messageCount; i++) {
+        mavlink_message_t   message;
+        mavlink_attitude_t  attitude = {};
+        uint8_t             buffer[MAVLINK_MAX_PACKET_LEN];
+
+        attitude.time_boot_ms   = static_cast<uint32_t>(i * 20);
+        attitude.roll           = 0.1f * i;
+        mavlink_msg_attitude_encode_chan(sysid, MAV_COMP_ID_AUTOPILOT1, mavlinkChannel, &message, &attitude);
+        stream.append(reinterpret_cast<const char*>(buffer), mavlink_msg_to_send_buffer(buffer, &message));
+    }
+
+    return stream;
+}
+
+UDPLink* UDPLinkTest::_connectLink(SharedLinkConfigurationPtr& config)
+{
+    LinkManager*        linkManager = qgcApp()->toolbox()->linkManager();
+    UDPConfiguration*   udpConfig   = new UDPConfiguration(QStringLiteral("UDPLinkTest"));
+
+    udpConfig->setLocalPort(_localPort);
+    config = linkManager->addConfiguration(udpConfig);
+    if (!linkManager->createConnectedLink(config)) {
+        return nullptr;
+    }
+
+    UDPLink* link = qobject_cast<UDPLink*>(config->link());
+    if (link && !QTest::qWaitFor([link]() { return link->isConnected(); }, 5000)) {
+        return nullptr;
+    }
+    return link;
+}
+
+void UDPLinkTest::_interleavedSendersTest(void)
+{
+    LinkManager*    linkManager     = qgcApp()->toolbox()->linkManager();
+    const uint8_t   mavlinkChannel  = linkManager->allocateMavlinkChannel();
+    QVERIFY(mavlinkChannel != LinkManager::invalidMavlinkChannel());
+
+    const QByteArray streamA = _buildStream(mavlinkChannel, 101, _messageCount);
+    const QByteArray streamB = _buildStream(mavlinkChannel, 102, _messageCount);
+    linkManager->freeMavlinkChannel(mavlinkChannel);
+
+    SharedLinkConfigurationPtr  config;
+    UDPLink*                    link = _connectLink(config);
+    QVERIFY(link);
+
+    QMap<int, QList<mavlink_message_t>> received;
+    connect(link, &LinkInterface::messagesReceived, this, [&received](LinkInterface*, QVector<MAVLinkMessageRef> messages) {
+        for (const MAVLinkMessageRef& message: messages) {
+            received[message->sysid].append(*message);
+        }
+    });
+
+    // Alternating partial frames from two senders, which corrupt each other when parsed as one stream
+    QUdpSocket senderA;
+    QUdpSocket senderB;
+    QVERIFY(senderA.bind(QHostAddress::LocalHost));
+    QVERIFY(senderB.bind(QHostAddress::LocalHost));
+    for (int offset=0; offset<streamA.size(); offset+=_chunkSize) {
+        senderA.writeDatagram(streamA.mid(offset, _chunkSize), QHostAddress::LocalHost, _localPort);
+        senderB.writeDatagram(streamB.mid(offset, _chunkSize), QHostAddress::LocalHost, _localPort);
+    }
+
+    QTRY_COMPARE_WITH_TIMEOUT(received[101].count() + received[102].count(), 2 * _messageCount, 5000);
+    QCOMPARE(received[101].count(), static_cast<int>(_messageCount));
+    QCOMPARE(received[102].count(), static_cast<int>(_messageCount));
+    for (int i=0; i<_messageCount; i++) {
+        QCOMPARE(mavlink_msg_attitude_get_time_boot_ms(&received[101][i]), static_cast<uint32_t>(i * 20));
+        QCOMPARE(mavlink_msg_attitude_get_time_boot_ms(&received[102][i]), static_cast<uint32_t>(i * 20));
+    }
+
+    const QVariantList senderStats = link->senderStats();
+    QCOMPARE(senderStats.count(), 2);
+    for (const QVariant& stats: senderStats) {
+        const QVariantMap map = stats.toMap();
+        QCOMPARE(map[QStringLiteral("messages")].toInt(),       static_cast<int>(_messageCount));
+        QCOMPARE(map[QStringLiteral("lostMessages")].toInt(),   0);
+        QCOMPARE(map[QStringLiteral("crcErrors")].toInt(),      0);
+    }
+
+    link->disconnect();
+}
+
+void UDPLinkTest::_sessionTargetsTest(void)
+{
+    SharedLinkConfigurationPtr  config;
+    UDPLink*                    link = _connectLink(config);
+    QVERIFY(link);
+
+    // Anything which sends to the link becomes a session target
+    QList<QUdpSocket*> senders;
+    for (int i=0; i<_senderCount; i++) {
+        QUdpSocket* sender = new QUdpSocket(this);
+        QVERIFY(sender->bind(QHostAddress::LocalHost));
+        sender->writeDatagram(QByteArray(1, 0), QHostAddress::LocalHost, _localPort);
+        senders.append(sender);
+    }
+    QTRY_COMPARE_WITH_TIMEOUT(link->senderStats().count(), static_cast<int>(_senderCount), 5000);
+
+    const QList<QByteArray> outgoing = { QByteArray("first"), QByteArray("second"), QByteArray("third") };
+    for (const QByteArray& bytes : outgoing) {
+        link->writeBytesThreadSafe(bytes.constData(), bytes.size());
+    }
+
+    // Every session target gets every message, in order. Anything else arriving, like the GCS heartbeat, is skipped.
+    for (QUdpSocket* sender : senders) {
+        QList<QByteArray> received;
+        auto receiveAll = [sender, &received, &outgoing]() {
+            while (sender->hasPendingDatagrams()) {
+                QByteArray datagram(static_cast<int>(sender->pendingDatagramSize()), 0);
+                sender->readDatagram(datagram.data(), datagram.size());
+                if (outgoing.contains(datagram)) {
+                    received.append(datagram);
+                }
+            }
+            return received.count() == outgoing.count();
+        };
+        QVERIFY(QTest::qWaitFor(receiveAll, 5000));
+        QCOMPARE(received, outgoing);
+    }
+
+    link->disconnect();
+    qDeleteAll(senders);
+}
@@ -0,0 +1,38 @@
+/****************************************************************************
+ *
+ * (c) 2009-2022 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "QGCMAVLink.h"
+#include "LinkConfiguration.h"
+
+class UDPLink;
+
+/// Checks that UDPLink frames the input of every sender separately and writes to every sender it has heard from
+class UDPLinkTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    UDPLinkTest(void);
+
+private slots:
+    void _interleavedSendersTest(void);
+    void _sessionTargetsTest    (void);
+
+private:
+    QByteArray  _buildStream(uint8_t mavlinkChannel, uint8_t sysid, int messageCount);
+    UDPLink*    _connectLink(SharedLinkConfigurationPtr& config);
+
+    static const quint16    _localPort      = 14591;
+    static const int        _messageCount   = 20;
+    static const int        _chunkSize      = 7;    ///< Splits every frame across datagrams
+    static const int        _senderCount    = 4;
+};
@@ -16,6 +16,18 @@
 #include "FactSystemTestPX4.h"
 //#include "FileDialogTest.h"
 #include "GeoTest.h"
+#include "LinkSendSchedulerTest.h"
+#include "LogReplayLinkTest.h"
+#include "MAVLinkFrameScannerTest.h"
+#include "MAVLinkMessagePoolTest.h"
+#include "MAVLinkRouterTest.h"
+#include "MAVLinkTimesyncTest.h"
+#include "MAVLinkTrafficStatsTest.h"
+#include "MockLinkLoadGeneratorTest.h"
+#include "TelemetryLogWriterTest.h"
+#include "TlogColumnarExporterTest.h"
+#include "TlogIndexTest.h"
+#include "UDPLinkTest.h"
 //#include "MessageBoxTest.h"
 #include "MissionItemTest.h"
 #include "SimpleMissionItemTest.h"
@@ -48,21 +60,39 @@
 #include "FTPManagerTest.h"
 #include "MissionCommandTreeEditorTest.h"
 #include "VehicleLinkManagerTest.h"
+#include "MAVLinkMessageDispatcherTest.h"
+#include "MAVLinkStreamRateControllerTest.h"
 #include "LandingComplexItemTest.h"
 #include "InitialConnectTest.h"
+#include "RemoteIDManagerTest.h"
 
 UT_REGISTER_TEST(ComponentInformationCacheTest)
 UT_REGISTER_TEST(FactSystemTestGeneric)
 UT_REGISTER_TEST(FactSystemTestPX4)
 //UT_REGISTER_TEST(FileDialogTest)
 UT_REGISTER_TEST(GeoTest)
+UT_REGISTER_TEST(LinkSendSchedulerTest)
+UT_REGISTER_TEST(LogReplayLinkTest)
+UT_REGISTER_TEST(MAVLinkFrameScannerTest)
+UT_REGISTER_TEST(MAVLinkMessagePoolTest)
+UT_REGISTER_TEST(MAVLinkRouterTest)
+UT_REGISTER_TEST(MAVLinkTimesyncTest)
+UT_REGISTER_TEST(MAVLinkTrafficStatsTest)
+UT_REGISTER_TEST(MockLinkLoadGeneratorTest)
+UT_REGISTER_TEST(TelemetryLogWriterTest)
+UT_REGISTER_TEST(TlogColumnarExporterTest)
+UT_REGISTER_TEST(TlogIndexTest)
+UT_REGISTER_TEST(UDPLinkTest)
 UT_REGISTER_TEST(VehicleLinkManagerTest)
+UT_REGISTER_TEST(MAVLinkMessageDispatcherTest)
+UT_REGISTER_TEST(MAVLinkStreamRateControllerTest)
 //UT_REGISTER_TEST(MessageBoxTest)
 UT_REGISTER_TEST(SendMavCommandWithSignallingTest)
 UT_REGISTER_TEST(SendMavCommandWithHandlerTest)
 UT_REGISTER_TEST(RequestMessageTest)
 UT_REGISTER_TEST(FTPManagerTest)
 UT_REGISTER_TEST(InitialConnectTest)
+UT_REGISTER_TEST(RemoteIDManagerTest)
 UT_REGISTER_TEST(MissionItemTest)
 UT_REGISTER_TEST(SimpleMissionItemTest)
 UT_REGISTER_TEST(MissionControllerTest)
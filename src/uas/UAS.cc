@@ -134,7 +134,7 @@ int UAS::getUASID() const
 #pragma warning(push, 0)
 #endif
 
-void UAS::receiveMessage(mavlink_message_t message)
+void UAS::receiveMessage(const mavlink_message_t& message)
 {
     // Only accept messages from this system (condition 1)
     // and only then if a) attitudeStamped is disabled OR b) attitudeStamped is enabled
@@ -161,7 +161,7 @@ public slots:
     void pairRX(int rxType, int rxSubType);
 
     /** @brief Receive a message from one of the communication links. */
-    virtual void receiveMessage(mavlink_message_t message);
+    virtual void receiveMessage(const mavlink_message_t& message);
 
 signals:
     void rollChanged(double val,QString name);
@@ -37,6 +37,7 @@ Rectangle {
     property var  _activeVehicle:       QGroundControl.multiVehicleManager.activeVehicle
     property bool _isPX4:               _activeVehicle ? _activeVehicle.px4Firmware : false
     property bool _isAPM:               _activeVehicle ? _activeVehicle.apmFirmware : false
+    property var  _mavlinkRouterSettings: QGroundControl.settingsManager.mavlinkRouterSettings
     property Fact _disableDataPersistenceFact: QGroundControl.settingsManager.appSettings.disableAllPersistence
     property bool _disableDataPersistence:     _disableDataPersistenceFact ? _disableDataPersistenceFact.rawValue : false
 
@@ -149,6 +150,14 @@ Rectangle {
                         }
                     }
 
+                    QGCCheckBox {
+                        text:       qsTr("Emit time sync requests")
+                        checked:    QGroundControl.multiVehicleManager.timesyncEnabled
+                        onClicked: {
+                            QGroundControl.multiVehicleManager.timesyncEnabled = checked
+                        }
+                    }
+
                     QGCCheckBox {
                         text:       qsTr("Only accept MAVs with same protocol version")
                         checked:    QGroundControl.isVersionCheckEnabled
@@ -186,6 +195,108 @@ Rectangle {
                         text:       qsTr("<i> Changing the host name requires restart of application. </i>")
                         visible:    QGroundControl.settingsManager.appSettings.forwardMavlinkHostName.visible
                     }
+
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        visible:    _mavlinkRouterSettings.outputs.visible
+                        QGCLabel {
+                            width:              _labelWidth
+                            anchors.baseline:   outputsField.baseline
+                            text:               qsTr("Router outputs:")
+                        }
+                        FactTextField {
+                            id:                     outputsField
+                            fact:                   _mavlinkRouterSettings.outputs
+                            width:                  _valueWidth
+                            enabled:                QGroundControl.settingsManager.appSettings.forwardMavlink.rawValue
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                    }
+
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        visible:    _mavlinkRouterSettings.allowedSysids.visible
+                        QGCLabel {
+                            width:              _labelWidth
+                            anchors.baseline:   allowedSysidsField.baseline
+                            text:               qsTr("Allowed system ids:")
+                        }
+                        FactTextField {
+                            id:                     allowedSysidsField
+                            fact:                   _mavlinkRouterSettings.allowedSysids
+                            width:                  _valueWidth
+                            enabled:                QGroundControl.settingsManager.appSettings.forwardMavlink.rawValue
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                    }
+
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        visible:    _mavlinkRouterSettings.deniedSysids.visible
+                        QGCLabel {
+                            width:              _labelWidth
+                            anchors.baseline:   deniedSysidsField.baseline
+                            text:               qsTr("Denied system ids:")
+                        }
+                        FactTextField {
+                            id:                     deniedSysidsField
+                            fact:                   _mavlinkRouterSettings.deniedSysids
+                            width:                  _valueWidth
+                            enabled:                QGroundControl.settingsManager.appSettings.forwardMavlink.rawValue
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                    }
+
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        visible:    _mavlinkRouterSettings.allowedMsgids.visible
+                        QGCLabel {
+                            width:              _labelWidth
+                            anchors.baseline:   allowedMsgidsField.baseline
+                            text:               qsTr("Allowed message ids:")
+                        }
+                        FactTextField {
+                            id:                     allowedMsgidsField
+                            fact:                   _mavlinkRouterSettings.allowedMsgids
+                            width:                  _valueWidth
+                            enabled:                QGroundControl.settingsManager.appSettings.forwardMavlink.rawValue
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                    }
+
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        visible:    _mavlinkRouterSettings.deniedMsgids.visible
+                        QGCLabel {
+                            width:              _labelWidth
+                            anchors.baseline:   deniedMsgidsField.baseline
+                            text:               qsTr("Denied message ids:")
+                        }
+                        FactTextField {
+                            id:                     deniedMsgidsField
+                            fact:                   _mavlinkRouterSettings.deniedMsgids
+                            width:                  _valueWidth
+                            enabled:                QGroundControl.settingsManager.appSettings.forwardMavlink.rawValue
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                    }
+
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        visible:    _mavlinkRouterSettings.maxRateHz.visible
+                        QGCLabel {
+                            width:              _labelWidth
+                            anchors.baseline:   maxRateHzField.baseline
+                            text:               qsTr("Maximum rate:")
+                        }
+                        FactTextField {
+                            id:                     maxRateHzField
+                            fact:                   _mavlinkRouterSettings.maxRateHz
+                            width:                  _valueWidth
+                            enabled:                QGroundControl.settingsManager.appSettings.forwardMavlink.rawValue
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                    }
                 }
             }
             //-----------------------------------------------------------------
@@ -76,6 +76,29 @@ Rectangle {
                 Layout.fillWidth:   true
                 onClicked:          QGroundControl.startGenericMockLink(sendStatusText.checked)
             }
+            RowLayout {
+                spacing: ScreenTools.defaultFontPixelWidth
+
+                QGCLabel { text: qsTr("Vehicles") }
+                QGCTextField {
+                    id:                     loadVehicleCount
+                    text:                   "50"
+                    inputMethodHints:       Qt.ImhDigitsOnly
+                    Layout.preferredWidth:  ScreenTools.defaultFontPixelWidth * 6
+                }
+                QGCLabel { text: qsTr("Links") }
+                QGCTextField {
+                    id:                     loadLinkCount
+                    text:                   "1"
+                    inputMethodHints:       Qt.ImhDigitsOnly
+                    Layout.preferredWidth:  ScreenTools.defaultFontPixelWidth * 6
+                }
+            }
+            QGCButton {
+                text:               qsTr("Load Test Vehicles")
+                Layout.fillWidth:   true
+                onClicked:          QGroundControl.startLoadMockLinks(parseInt(loadVehicleCount.text), parseInt(loadLinkCount.text))
+            }
             QGCButton {
                 text:               qsTr("Stop One MockLink")
                 Layout.fillWidth:   true
@@ -27,6 +27,8 @@ GridLayout {
     readonly property int _MAV_TYPE_FIXED_WING:         1
     readonly property int _MAV_TYPE_QUADROTOR:          2
 
+    property bool _loadTest: parseInt(loadVehicleCount.text) > 0
+
     function saveSettings() {
         switch (firmwareTypeCombo.currentIndex) {
         case 0:
@@ -46,6 +48,10 @@ GridLayout {
         }
         subEditConfig.sendStatus = sendStatus.checked
         subEditConfig.incrementVehicleId = incrementVehicleId.checked
+        subEditConfig.remoteIDTransponder = remoteIDTransponder.checked
+        subEditConfig.loadVehicleCount = parseInt(loadVehicleCount.text)
+        subEditConfig.loadJitterPercent = parseInt(loadJitterPercent.text)
+        subEditConfig.loadLossPercent = parseInt(loadLossPercent.text)
     }
 
     Component.onCompleted: {
@@ -81,6 +87,13 @@ GridLayout {
         checked:            subEditConfig.incrementVehicleId
     }
 
+    QGCCheckBox {
+        id:                 remoteIDTransponder
+        Layout.columnSpan:  2
+        text:               qsTr("Simulate RemoteID Transponder")
+        checked:            subEditConfig.remoteIDTransponder
+    }
+
     QGCLabel { text: qsTr("Firmware") }
     QGCComboBox {
         id:                     firmwareTypeCombo
@@ -100,4 +113,36 @@ GridLayout {
         model:                  [ qsTr("ArduCopter"), qsTr("ArduPlane") ]
         visible:                firmwareTypeCombo.apmFirmwareSelected
     }
+
+    QGCLabel { text: qsTr("Load Test Vehicles") }
+    QGCTextField {
+        id:                     loadVehicleCount
+        Layout.preferredWidth:  _secondColumnWidth
+        text:                   subEditConfig.loadVehicleCount
+        inputMethodHints:       Qt.ImhDigitsOnly
+    }
+
+    QGCLabel {
+        text:       qsTr("Send Time Jitter (%)")
+        visible:    _loadTest
+    }
+    QGCTextField {
+        id:                     loadJitterPercent
+        Layout.preferredWidth:  _secondColumnWidth
+        text:                   subEditConfig.loadJitterPercent
+        inputMethodHints:       Qt.ImhDigitsOnly
+        visible:                _loadTest
+    }
+
+    QGCLabel {
+        text:       qsTr("Message Loss (%)")
+        visible:    _loadTest
+    }
+    QGCTextField {
+        id:                     loadLossPercent
+        Layout.preferredWidth:  _secondColumnWidth
+        text:                   subEditConfig.loadLossPercent
+        inputMethodHints:       Qt.ImhDigitsOnly
+        visible:                _loadTest
+    }
 }
@@ -825,6 +825,97 @@ Rectangle {
                     }
                 }
                 // -----------------------------------------------------------------------------------------
+
+                // ------------------------------------ TRANSMISSION ---------------------------------------
+                QGCLabel {
+                    id:                 transmissionLabel
+                    text:               qsTr("Transmission")
+                    Layout.alignment:   Qt.AlignHCenter
+                    font.pointSize:     ScreenTools.mediumFontPointSize
+                }
+
+                Rectangle {
+                    id:                     transmissionRectangle
+                    Layout.preferredHeight: transmissionGrid.height + (_margins * 3)
+                    Layout.preferredWidth:  transmissionGrid.width + (_margins * 2)
+                    color:                  qgcPal.windowShade
+                    visible:                true
+                    Layout.fillWidth:       true
+
+                    GridLayout {
+                        id:                         transmissionGrid
+                        anchors.margins:            _margins
+                        anchors.top:                parent.top
+                        anchors.horizontalCenter:   parent.horizontalCenter
+                        columns:                    2
+                        rowSpacing:                 _margins * 3
+                        columnSpacing:              _margins * 2
+
+                        QGCLabel {
+                            text:               QGroundControl.settingsManager.remoteIDSettings.sendMessagePack.shortDescription
+                            visible:            QGroundControl.settingsManager.remoteIDSettings.sendMessagePack.visible
+                            Layout.fillWidth:   true
+                        }
+                        FactCheckBox {
+                            fact:       QGroundControl.settingsManager.remoteIDSettings.sendMessagePack
+                            visible:    QGroundControl.settingsManager.remoteIDSettings.sendMessagePack.visible
+                        }
+
+                        QGCLabel {
+                            text:               QGroundControl.settingsManager.remoteIDSettings.systemMinInterval.shortDescription
+                            visible:            QGroundControl.settingsManager.remoteIDSettings.systemMinInterval.visible
+                            Layout.fillWidth:   true
+                        }
+                        FactTextField {
+                            fact:               QGroundControl.settingsManager.remoteIDSettings.systemMinInterval
+                            visible:            QGroundControl.settingsManager.remoteIDSettings.systemMinInterval.visible
+                            Layout.fillWidth:   true
+                        }
+
+                        QGCLabel {
+                            text:               QGroundControl.settingsManager.remoteIDSettings.systemMaxInterval.shortDescription
+                            visible:            QGroundControl.settingsManager.remoteIDSettings.systemMaxInterval.visible
+                            Layout.fillWidth:   true
+                        }
+                        FactTextField {
+                            fact:               QGroundControl.settingsManager.remoteIDSettings.systemMaxInterval
+                            visible:            QGroundControl.settingsManager.remoteIDSettings.systemMaxInterval.visible
+                            Layout.fillWidth:   true
+                        }
+
+                        QGCLabel {
+                            text:               QGroundControl.settingsManager.remoteIDSettings.systemMovementThreshold.shortDescription
+                            visible:            QGroundControl.settingsManager.remoteIDSettings.systemMovementThreshold.visible
+                            Layout.fillWidth:   true
+                        }
+                        FactTextField {
+                            fact:               QGroundControl.settingsManager.remoteIDSettings.systemMovementThreshold
+                            visible:            QGroundControl.settingsManager.remoteIDSettings.systemMovementThreshold.visible
+                            Layout.fillWidth:   true
+                        }
+
+                        QGCLabel {
+                            text:               QGroundControl.settingsManager.remoteIDSettings.observerMode.shortDescription
+                            visible:            QGroundControl.settingsManager.remoteIDSettings.observerMode.visible
+                            Layout.fillWidth:   true
+                        }
+                        FactCheckBox {
+                            fact:       QGroundControl.settingsManager.remoteIDSettings.observerMode
+                            visible:    QGroundControl.settingsManager.remoteIDSettings.observerMode.visible
+                        }
+
+                        QGCLabel {
+                            text:               QGroundControl.settingsManager.remoteIDSettings.flightRecorder.shortDescription
+                            visible:            QGroundControl.settingsManager.remoteIDSettings.flightRecorder.visible
+                            Layout.fillWidth:   true
+                        }
+                        FactCheckBox {
+                            fact:       QGroundControl.settingsManager.remoteIDSettings.flightRecorder
+                            visible:    QGroundControl.settingsManager.remoteIDSettings.flightRecorder.visible
+                        }
+                    }
+                }
+                // -----------------------------------------------------------------------------------------
             }
         }
     }